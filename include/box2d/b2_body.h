@@ -30,11 +30,14 @@ class b2Fixture;
 class b2Joint;
 class b2Contact;
 class b2Controller;
+class b2PolygonShape;
 class b2World;
 struct b2FixtureDef;
 struct b2JointEdge;
 struct b2ContactEdge;
 
+#define b2_nullSleepingIsland (-1)
+
 /// The body type.
 /// static: zero mass, zero velocity, may be manually moved
 /// kinematic: zero mass, non-zero velocity set by user, moved by solver
@@ -70,6 +73,7 @@ struct b2BodyDef
 		type = b2_staticBody;
 		active = true;
 		gravityScale = 1.0f;
+		sleepThreshold = b2_linearSleepTolerance;
 	}
 
 	/// The body type: static, kinematic, or dynamic.
@@ -125,6 +129,10 @@ struct b2BodyDef
 
 	/// Scale the gravity applied to this body.
 	float gravityScale;
+
+	/// The speed below which this body may fall asleep, usually in meters per second.
+	/// The angular threshold scales with it.
+	float sleepThreshold;
 };
 
 /// A rigid body. These are created via b2World::CreateBody.
@@ -149,6 +157,20 @@ public:
 	/// @warning This function is locked during callbacks.
 	b2Fixture* CreateFixture(const b2Shape* shape, float density);
 
+	/// Creates a fixture for each polygon with the parameters of a fixture definition, whose
+	/// shape is ignored. The mass is updated once for the whole batch, so this is much
+	/// cheaper than CreateFixture for the many pieces of a decomposed hull or fracture.
+	/// The new fixtures are at the front of the fixture list in reverse order.
+	/// @param def the fixture parameters.
+	/// @param polygons the shapes to be cloned.
+	/// @param count the number of polygons.
+	/// @param massData optional mass of the whole body, which is then set instead of computed
+	/// from the fixtures. See SetMassData.
+	/// @return the last created fixture, which is the head of the fixture list.
+	/// @warning This function is locked during callbacks.
+	b2Fixture* CreateFixtures(const b2FixtureDef* def, const b2PolygonShape* polygons, int32 count,
+								const b2MassData* massData = nullptr);
+
 	/// Destroy a fixture. This removes the fixture from the broad-phase and
 	/// destroys all contacts associated with this fixture. This will
 	/// automatically adjust the mass of the body if the body is dynamic and the
@@ -308,6 +330,13 @@ public:
 	/// Set the gravity scale of the body.
 	void SetGravityScale(float scale);
 
+	/// Get the speed below which this body may fall asleep.
+	float GetSleepThreshold() const;
+
+	/// Set the speed below which this body may fall asleep. The angular threshold scales
+	/// with it.
+	void SetSleepThreshold(float threshold);
+
 	/// Set the type of this body. This may alter the mass and velocity.
 	void SetType(b2BodyType type);
 
@@ -399,6 +428,7 @@ private:
 	friend class b2ContactManager;
 	friend class b2ContactSolver;
 	friend class b2Contact;
+	friend class b2ConstraintGraph;
 	
 	friend class b2DistanceJoint;
 	friend class b2FrictionJoint;
@@ -427,7 +457,12 @@ private:
 	b2Body(const b2BodyDef* bd, b2World* world);
 	~b2Body();
 
+	// Create a fixture and its proxies without updating the mass.
+	b2Fixture* AddFixture(const b2FixtureDef* def);
+
 	void SynchronizeFixtures();
+	bool ComputeSweptAABBs();
+	void MoveProxies();
 	void SynchronizeTransform();
 
 	// This is used to prevent connected bodies from colliding.
@@ -436,12 +471,18 @@ private:
 
 	void Advance(float t);
 
+	// Wake the other bodies of the sleeping island this body belongs to.
+	void WakeSleepingIsland();
+
 	b2BodyType m_type;
 
 	uint16 m_flags;
 
 	int32 m_islandIndex;
 
+	// Index in the world kinematic body array, or -1.
+	int32 m_kinematicIndex;
+
 	b2Transform m_xf;		// the body origin transform
 	b2Sweep m_sweep;		// the swept motion for CCD
 
@@ -471,6 +512,11 @@ private:
 	float m_gravityScale;
 
 	float m_sleepTime;
+	float m_sleepThreshold;
+
+	// The sleeping island this body fell asleep with, or b2_nullSleepingIsland.
+	int32 m_sleepingIsland;
+	b2Body* m_sleepingNext;
 
 	void* m_userData;
 };
@@ -622,6 +668,17 @@ inline void b2Body::SetGravityScale(float scale)
 	m_gravityScale = scale;
 }
 
+inline float b2Body::GetSleepThreshold() const
+{
+	return m_sleepThreshold;
+}
+
+inline void b2Body::SetSleepThreshold(float threshold)
+{
+	b2Assert(b2IsValid(threshold) && threshold >= 0.0f);
+	m_sleepThreshold = threshold;
+}
+
 inline void b2Body::SetBullet(bool flag)
 {
 	if (flag)
@@ -643,6 +700,11 @@ inline void b2Body::SetAwake(bool flag)
 {
 	if (flag)
 	{
+		if (m_sleepingIsland != b2_nullSleepingIsland)
+		{
+			WakeSleepingIsland();
+		}
+
 		m_flags |= e_awakeFlag;
 		m_sleepTime = 0.0f;
 	}
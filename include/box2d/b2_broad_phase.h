@@ -46,6 +46,12 @@ public:
 		e_nullProxy = -1
 	};
 
+	// The number of recent fat AABB changes kept for TestChanges, a power of two.
+	enum
+	{
+		e_changeCapacity = 256
+	};
+
 	b2BroadPhase();
 	~b2BroadPhase();
 
@@ -72,6 +78,17 @@ public:
 	/// Test overlap of fat AABBs.
 	bool TestOverlap(int32 proxyIdA, int32 proxyIdB) const;
 
+	/// Get a counter that changes whenever a proxy is created, destroyed or gets a new fat AABB.
+	uint32 GetRevision() const;
+
+	/// Did a proxy enter or leave a region since a revision? This tests the region against
+	/// the fat AABBs of the proxies created or re-inserted since then and the old fat AABBs of
+	/// the proxies destroyed. Results of an AABB query over the region stay valid while this
+	/// is false, because a proxy that moves within its fat AABB cannot enter a region it did
+	/// not already overlap. Returns true when the changes since the revision are no longer
+	/// known, such as after many changes or an origin shift.
+	bool TestChanges(uint32 revision, const b2AABB& aabb) const;
+
 	/// Get the number of proxies.
 	int32 GetProxyCount() const;
 
@@ -94,6 +111,10 @@ public:
 	template <typename T>
 	void RayCast(T* callback, const b2RayCastInput& input) const;
 
+	/// Sweep a box through the proxies. See b2DynamicTree::ShapeCast.
+	template <typename T>
+	void ShapeCast(T* callback, const b2AABB& aabb, const b2Vec2& translation, float maxFraction) const;
+
 	/// Get the height of the embedded tree.
 	int32 GetTreeHeight() const;
 
@@ -108,18 +129,37 @@ public:
 	/// @param newOrigin the new origin with respect to the old origin
 	void ShiftOrigin(const b2Vec2& newOrigin);
 
+	/// Get the number of bytes needed by SaveState.
+	int32 GetStateSize() const;
+
+	/// Save the tree and the move buffer. Pairs are not persisted.
+	/// @return the number of bytes written.
+	int32 SaveState(void* buffer) const;
+
+	/// Restore the state written by SaveState. The proxies must be the same
+	/// as when the state was saved.
+	/// @return the number of bytes read.
+	int32 RestoreState(const void* buffer);
+
 private:
 
 	friend class b2DynamicTree;
 
 	void BufferMove(int32 proxyId);
 	void UnBufferMove(int32 proxyId);
+	void RecordChange(const b2AABB& aabb);
 
 	bool QueryCallback(int32 proxyId);
 
 	b2DynamicTree m_tree;
 
 	int32 m_proxyCount;
+	uint32 m_revision;
+
+	// The fat AABB of each change, indexed by its revision. Revisions before the floor are
+	// unknown.
+	b2AABB m_changes[e_changeCapacity];
+	uint32 m_changeFloor;
 
 	int32* m_moveBuffer;
 	int32 m_moveCapacity;
@@ -170,6 +210,11 @@ inline int32 b2BroadPhase::GetProxyCount() const
 	return m_proxyCount;
 }
 
+inline uint32 b2BroadPhase::GetRevision() const
+{
+	return m_revision;
+}
+
 inline int32 b2BroadPhase::GetTreeHeight() const
 {
 	return m_tree.GetHeight();
@@ -253,9 +298,17 @@ inline void b2BroadPhase::RayCast(T* callback, const b2RayCastInput& input) cons
 	m_tree.RayCast(callback, input);
 }
 
+template <typename T>
+inline void b2BroadPhase::ShapeCast(T* callback, const b2AABB& aabb, const b2Vec2& translation, float maxFraction) const
+{
+	m_tree.ShapeCast(callback, aabb, translation, maxFraction);
+}
+
 inline void b2BroadPhase::ShiftOrigin(const b2Vec2& newOrigin)
 {
 	m_tree.ShiftOrigin(newOrigin);
+	++m_revision;
+	m_changeFloor = m_revision;
 }
 
 #endif
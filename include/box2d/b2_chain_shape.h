@@ -62,6 +62,29 @@ public:
 	/// Don't call this for loops.
 	void SetNextVertex(const b2Vec2& nextVertex);
 
+	/// Build a bounding volume tree over the segments. A fixture made from a chain with a tree
+	/// registers a single broad-phase proxy for the whole chain and finds the segments near
+	/// other shapes with the tree, which keeps large terrain chains out of the world tree.
+	/// Call this after the vertices and connectivity are set and before creating fixtures.
+	void CreateTree();
+
+	/// Does this chain have a segment tree?
+	bool HasTree() const { return m_nodes != nullptr; }
+
+	/// Query the segment tree for segments that may overlap an AABB given in the chain frame.
+	/// The callback gets QueryCallback(int32 childIndex) and returns false to stop.
+	template <typename T>
+	void QueryTree(T* callback, const b2AABB& aabb) const;
+
+	/// Cast a ray against all segments using the segment tree and return the closest hit.
+	bool RayCastTree(b2RayCastOutput* output, const b2RayCastInput& input, const b2Transform& transform) const;
+
+	/// Cast a ray against the segment tree. The callback gets
+	/// RayCastCallback(const b2RayCastInput& input, int32 childIndex) for each segment the ray
+	/// may cross and returns the new max fraction as with b2DynamicTree::RayCast.
+	template <typename T>
+	void RayCastTree(T* callback, const b2RayCastInput& input, const b2Transform& transform) const;
+
 	/// Implement b2Shape. Vertices are cloned using b2Alloc.
 	b2Shape* Clone(b2BlockAllocator* allocator) const override;
 
@@ -94,6 +117,10 @@ public:
 
 	b2Vec2 m_prevVertex, m_nextVertex;
 	bool m_hasPrevVertex, m_hasNextVertex;
+
+	/// The optional segment tree. Owned by this class.
+	b2StaticTreeNode* m_nodes;
+	int32 m_nodeCount;
 };
 
 inline b2ChainShape::b2ChainShape()
@@ -104,6 +131,20 @@ inline b2ChainShape::b2ChainShape()
 	m_count = 0;
 	m_hasPrevVertex = false;
 	m_hasNextVertex = false;
+	m_nodes = nullptr;
+	m_nodeCount = 0;
+}
+
+template <typename T>
+inline void b2ChainShape::QueryTree(T* callback, const b2AABB& aabb) const
+{
+	b2QueryStaticTree(m_nodes, m_nodeCount, callback, aabb);
+}
+
+template <typename T>
+inline void b2ChainShape::RayCastTree(T* callback, const b2RayCastInput& input, const b2Transform& xf) const
+{
+	b2RayCastStaticTree(m_nodes, m_nodeCount, callback, input, xf);
 }
 
 #endif
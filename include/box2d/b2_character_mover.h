@@ -0,0 +1,224 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef B2_CHARACTER_MOVER_H
+#define B2_CHARACTER_MOVER_H
+
+#include "b2_collision.h"
+#include "b2_fixture.h"
+
+class b2DynamicTree;
+class b2World;
+
+/// The maximum number of contact planes reported by a move.
+#define b2_maxCharacterPlanes	8
+
+/// A character mover definition holds the data needed to construct a mover.
+struct b2CharacterMoverDef
+{
+	b2CharacterMoverDef()
+	{
+		shape = nullptr;
+		position.SetZero();
+		up.Set(0.0f, 1.0f);
+		maxSlopeAngle = 0.25f * b2_pi;
+		stepHeight = 0.0f;
+		maxIterations = 4;
+		cacheMargin = 1.0f;
+		ignoreBody = nullptr;
+	}
+
+	/// The moving shape, a circle, polygon or capsule centered on the mover position.
+	/// The shape does not rotate. It is not copied and must outlive the mover.
+	const b2Shape* shape;
+
+	/// The initial position.
+	b2Vec2 position;
+
+	/// The unit up direction, usually opposite to gravity.
+	b2Vec2 up;
+
+	/// Surfaces tilted further than this angle from up are walls. The mover slides down
+	/// walls and cannot climb them. Walkable surfaces hold the mover in place.
+	float maxSlopeAngle;
+
+	/// The height of the steps the mover walks onto. Zero disables stepping.
+	float stepHeight;
+
+	/// The number of cast and slide iterations in a move.
+	int32 maxIterations;
+
+	/// How far the cached broad-phase query extends beyond the bounds of a move. A larger
+	/// margin keeps the cache longer at the cost of more candidates.
+	float cacheMargin;
+
+	/// The mover only hits fixtures whose filter collides with this filter.
+	b2Filter filter;
+
+	/// A body the mover passes through, usually the body that represents the character.
+	const b2Body* ignoreBody;
+};
+
+/// A surface touched by the mover.
+struct b2CharacterPlane
+{
+	/// The fixture touched.
+	b2Fixture* fixture;
+
+	/// The contact point on the fixture.
+	b2Vec2 point;
+
+	/// The surface normal, pointing towards the mover.
+	b2Vec2 normal;
+
+	/// Can the mover stand on this surface?
+	bool walkable;
+};
+
+/// A character mover moves a shape kinematically through a world. Each move casts the shape
+/// along the displacement, stops at the first surface, removes the part of the motion that
+/// goes into the surface and casts again with the rest. The surfaces touched are reported as
+/// contact planes. This is far cheaper than simulating a character with a dynamic body and
+/// gives the precise control games expect.
+/// The mover keeps the fixtures found by a broad-phase query around its bounds and reuses them
+/// in later moves while it stays inside the queried region and no proxy was created, destroyed
+/// or re-inserted in that region. The mover only reads the world, so movers may run in
+/// parallel when the world is not stepping.
+class b2CharacterMover
+{
+public:
+	b2CharacterMover(b2World* world, const b2CharacterMoverDef* def);
+	~b2CharacterMover();
+
+	/// Move by a displacement, usually the desired velocity times the time step including
+	/// gravity. The mover walks onto steps, follows the ground down slopes and steps while
+	/// it is not moving up, and does not slide down walkable slopes.
+	/// @return the displacement done.
+	b2Vec2 Move(const b2Vec2& displacement);
+
+	/// Set the position without checking for collision.
+	void SetPosition(const b2Vec2& position);
+
+	/// Get the position.
+	const b2Vec2& GetPosition() const;
+
+	/// Is the mover standing on a walkable surface after the last move?
+	bool IsGrounded() const;
+
+	/// Get the walkable surface closest to level touched by the last move or nullptr.
+	const b2CharacterPlane* GetGroundPlane() const;
+
+	/// Get the surfaces touched by the last move.
+	const b2CharacterPlane* GetPlanes() const;
+
+	/// Get the number of surfaces touched by the last move.
+	int32 GetPlaneCount() const;
+
+	/// Drop the cached broad-phase query. Call this after changing the shape.
+	void InvalidateCache();
+
+	/// Get the number of broad-phase queries done so far.
+	int32 GetQueryCount() const;
+
+private:
+
+	friend class b2DynamicTree;
+
+	bool QueryCallback(int32 proxyId);
+
+	void UpdateCache(const b2AABB& aabb);
+	bool CastShape(b2CharacterPlane* plane, float* fraction, const b2Shape* shape, const b2Vec2& position,
+					const b2Vec2& translation) const;
+	bool Cast(b2CharacterPlane* plane, float* fraction, const b2Vec2& position, const b2Vec2& translation) const;
+	bool IsWalkable(const b2CharacterPlane& plane) const;
+	b2Vec2 Clip(const b2Vec2& translation, const b2CharacterPlane& plane) const;
+	bool Step(b2Vec2* translation);
+	void AddPlane(const b2CharacterPlane& plane);
+
+	b2World* m_world;
+	const b2Shape* m_shape;
+	b2Vec2 m_position;
+	b2Vec2 m_up;
+	float m_minGroundDot;
+	float m_stepHeight;
+	int32 m_maxIterations;
+	float m_cacheMargin;
+	b2Filter m_filter;
+	const b2Body* m_ignoreBody;
+
+	b2CharacterPlane m_planes[b2_maxCharacterPlanes];
+	int32 m_planeCount;
+	int32 m_groundIndex;
+
+	b2FixtureProxy** m_candidates;
+	int32 m_candidateCount;
+	int32 m_candidateCapacity;
+	b2AABB m_cacheAABB;
+	uint32 m_cacheRevision;
+	bool m_cacheValid;
+	int32 m_queryCount;
+};
+
+inline void b2CharacterMover::SetPosition(const b2Vec2& position)
+{
+	m_position = position;
+	m_planeCount = 0;
+	m_groundIndex = -1;
+}
+
+inline const b2Vec2& b2CharacterMover::GetPosition() const
+{
+	return m_position;
+}
+
+inline bool b2CharacterMover::IsGrounded() const
+{
+	return m_groundIndex != -1;
+}
+
+inline const b2CharacterPlane* b2CharacterMover::GetGroundPlane() const
+{
+	return m_groundIndex != -1 ? m_planes + m_groundIndex : nullptr;
+}
+
+inline const b2CharacterPlane* b2CharacterMover::GetPlanes() const
+{
+	return m_planes;
+}
+
+inline int32 b2CharacterMover::GetPlaneCount() const
+{
+	return m_planeCount;
+}
+
+inline void b2CharacterMover::InvalidateCache()
+{
+	m_cacheValid = false;
+}
+
+inline int32 b2CharacterMover::GetQueryCount() const
+{
+	return m_queryCount;
+}
+
+#endif
@@ -31,8 +31,11 @@
 /// queries, and TOI queries.
 
 class b2Shape;
+class b2CapsuleShape;
+class b2ChainShape;
 class b2CircleShape;
 class b2EdgeShape;
+class b2HeightfieldShape;
 class b2PolygonShape;
 
 const uint8 b2_nullFeature = UCHAR_MAX;
@@ -219,6 +222,19 @@ struct b2AABB
 	b2Vec2 upperBound;	///< the upper vertex
 };
 
+/// A node of a static bounding volume tree over the children of a shape. The nodes are stored
+/// depth first, so the first child of an internal node follows it. Leaves store a child index.
+struct b2StaticTreeNode
+{
+	b2AABB aabb;
+
+	/// The node after this subtree.
+	int32 skip;
+
+	/// The child of a leaf or -1 for an internal node.
+	int32 child;
+};
+
 /// Compute the collision manifold between two circles.
 void b2CollideCircles(b2Manifold* manifold,
 					  const b2CircleShape* circleA, const b2Transform& xfA,
@@ -234,6 +250,21 @@ void b2CollidePolygons(b2Manifold* manifold,
 					   const b2PolygonShape* polygonA, const b2Transform& xfA,
 					   const b2PolygonShape* polygonB, const b2Transform& xfB);
 
+/// Used to warm start b2CollidePolygons. Holds the edges of max separation found by the
+/// previous call. Set both edges to zero on the first call.
+struct b2SeparationCache
+{
+	uint8 edgeA;	///< reference edge candidate on polygon A
+	uint8 edgeB;	///< reference edge candidate on polygon B
+};
+
+/// Compute the collision manifold between two polygons, testing the cached edges first.
+/// This gives the same manifold as the version without a cache.
+void b2CollidePolygons(b2Manifold* manifold,
+					   const b2PolygonShape* polygonA, const b2Transform& xfA,
+					   const b2PolygonShape* polygonB, const b2Transform& xfB,
+					   b2SeparationCache* cache);
+
 /// Compute the collision manifold between an edge and a circle.
 void b2CollideEdgeAndCircle(b2Manifold* manifold,
 							   const b2EdgeShape* polygonA, const b2Transform& xfA,
@@ -244,6 +275,59 @@ void b2CollideEdgeAndPolygon(b2Manifold* manifold,
 							   const b2EdgeShape* edgeA, const b2Transform& xfA,
 							   const b2PolygonShape* circleB, const b2Transform& xfB);
 
+/// Compute the collision manifold between a chain segment and a circle. The segment and its
+/// neighbors are read from the chain vertices, so no edge shape is built.
+void b2CollideChainAndCircle(b2Manifold* manifold,
+							   const b2ChainShape* chainA, int32 indexA, const b2Transform& xfA,
+							   const b2CircleShape* circleB, const b2Transform& xfB);
+
+/// Compute the collision manifold between a chain segment and a polygon. The segment and its
+/// neighbors are read from the chain vertices, so no edge shape is built.
+void b2CollideChainAndPolygon(b2Manifold* manifold,
+							   const b2ChainShape* chainA, int32 indexA, const b2Transform& xfA,
+							   const b2PolygonShape* polygonB, const b2Transform& xfB);
+
+/// Compute the collision manifold between a heightfield cell and a circle.
+void b2CollideHeightfieldAndCircle(b2Manifold* manifold,
+							   const b2HeightfieldShape* heightfieldA, int32 indexA, const b2Transform& xfA,
+							   const b2CircleShape* circleB, const b2Transform& xfB);
+
+/// Compute the collision manifold between a heightfield cell and a polygon.
+void b2CollideHeightfieldAndPolygon(b2Manifold* manifold,
+							   const b2HeightfieldShape* heightfieldA, int32 indexA, const b2Transform& xfA,
+							   const b2PolygonShape* polygonB, const b2Transform& xfB);
+
+/// Compute the collision manifold between two capsules from the closest points of their
+/// segments. Overlapping parallel segments give two points.
+void b2CollideCapsules(b2Manifold* manifold,
+					   const b2CapsuleShape* capsuleA, const b2Transform& xfA,
+					   const b2CapsuleShape* capsuleB, const b2Transform& xfB);
+
+/// Compute the collision manifold between a capsule and a circle.
+void b2CollideCapsuleAndCircle(b2Manifold* manifold,
+							   const b2CapsuleShape* capsuleA, const b2Transform& xfA,
+							   const b2CircleShape* circleB, const b2Transform& xfB);
+
+/// Compute the collision manifold between a capsule and a polygon.
+void b2CollideCapsuleAndPolygon(b2Manifold* manifold,
+							   const b2CapsuleShape* capsuleA, const b2Transform& xfA,
+							   const b2PolygonShape* polygonB, const b2Transform& xfB);
+
+/// Compute the collision manifold between an edge and a capsule.
+void b2CollideEdgeAndCapsule(b2Manifold* manifold,
+							   const b2EdgeShape* edgeA, const b2Transform& xfA,
+							   const b2CapsuleShape* capsuleB, const b2Transform& xfB);
+
+/// Compute the collision manifold between a chain segment and a capsule.
+void b2CollideChainAndCapsule(b2Manifold* manifold,
+							   const b2ChainShape* chainA, int32 indexA, const b2Transform& xfA,
+							   const b2CapsuleShape* capsuleB, const b2Transform& xfB);
+
+/// Compute the collision manifold between a heightfield cell and a capsule.
+void b2CollideHeightfieldAndCapsule(b2Manifold* manifold,
+							   const b2HeightfieldShape* heightfieldA, int32 indexA, const b2Transform& xfA,
+							   const b2CapsuleShape* capsuleB, const b2Transform& xfB);
+
 /// Clipping for contact manifolds.
 int32 b2ClipSegmentToLine(b2ClipVertex vOut[2], const b2ClipVertex vIn[2],
 							const b2Vec2& normal, float offset, int32 vertexIndexA);
@@ -253,6 +337,29 @@ bool b2TestOverlap(	const b2Shape* shapeA, int32 indexA,
 					const b2Shape* shapeB, int32 indexB,
 					const b2Transform& xfA, const b2Transform& xfB);
 
+/// Build a static tree over count leaf boxes into 2 * count - 1 nodes. The leaves are split
+/// at the median of their centers along the longest axis.
+void b2BuildStaticTree(b2StaticTreeNode* nodes, const b2AABB* boxes, int32 count);
+
+/// Query a static tree for the leaves that overlap an AABB. The callback gets
+/// QueryCallback(int32 child) and returns false to stop.
+template <typename T>
+void b2QueryStaticTree(const b2StaticTreeNode* nodes, int32 nodeCount, T* callback, const b2AABB& aabb);
+
+/// Cast a ray against the leaves of a static tree, which is given in the frame of the
+/// transform. The callback gets RayCastCallback(const b2RayCastInput& input, int32 child) for
+/// each leaf the ray may cross and returns the new max fraction as with b2DynamicTree::RayCast.
+/// Zero stops the cast and a negative value ignores the leaf.
+template <typename T>
+void b2RayCastStaticTree(const b2StaticTreeNode* nodes, int32 nodeCount, T* callback,
+						const b2RayCastInput& input, const b2Transform& xf);
+
+/// Cast a ray against the children of a shape using its static tree, which is given in the
+/// shape frame, and return the closest hit. The shape ray casts each child leaf.
+template <typename T>
+bool b2RayCastStaticTree(const b2StaticTreeNode* nodes, int32 nodeCount, const T* shape,
+						b2RayCastOutput* output, const b2RayCastInput& input, const b2Transform& xf);
+
 // ---------------- Inline Functions ------------------------------------------
 
 inline bool b2AABB::IsValid() const
@@ -278,4 +385,157 @@ inline bool b2TestOverlap(const b2AABB& a, const b2AABB& b)
 	return true;
 }
 
+/// Bound an AABB after moving it by a transform.
+inline b2AABB b2Mul(const b2Transform& xf, const b2AABB& aabb)
+{
+	b2Vec2 c = b2Mul(xf, aabb.GetCenter());
+	b2Vec2 e = aabb.GetExtents();
+	b2Vec2 h(b2Abs(xf.q.c) * e.x + b2Abs(xf.q.s) * e.y, b2Abs(xf.q.s) * e.x + b2Abs(xf.q.c) * e.y);
+
+	b2AABB result;
+	result.lowerBound = c - h;
+	result.upperBound = c + h;
+	return result;
+}
+
+/// Bound an AABB after moving it by the inverse of a transform.
+inline b2AABB b2MulT(const b2Transform& xf, const b2AABB& aabb)
+{
+	// The absolute rotation matrix is symmetric, so the extents map the same way.
+	b2Vec2 c = b2MulT(xf, aabb.GetCenter());
+	b2Vec2 e = aabb.GetExtents();
+	b2Vec2 h(b2Abs(xf.q.c) * e.x + b2Abs(xf.q.s) * e.y, b2Abs(xf.q.s) * e.x + b2Abs(xf.q.c) * e.y);
+
+	b2AABB result;
+	result.lowerBound = c - h;
+	result.upperBound = c + h;
+	return result;
+}
+
+template <typename T>
+inline void b2QueryStaticTree(const b2StaticTreeNode* nodes, int32 nodeCount, T* callback, const b2AABB& aabb)
+{
+	int32 index = 0;
+	while (index < nodeCount)
+	{
+		const b2StaticTreeNode* node = nodes + index;
+		if (b2TestOverlap(node->aabb, aabb) == false)
+		{
+			index = node->skip;
+			continue;
+		}
+
+		if (node->child >= 0)
+		{
+			bool proceed = callback->QueryCallback(node->child);
+			if (proceed == false)
+			{
+				return;
+			}
+		}
+
+		++index;
+	}
+}
+
+// Walks the tree in the shape frame, clipping the ray at each hit like b2DynamicTree::RayCast.
+template <typename T>
+inline void b2RayCastStaticTree(const b2StaticTreeNode* nodes, int32 nodeCount, T* callback,
+								const b2RayCastInput& input, const b2Transform& xf)
+{
+	b2Vec2 p1 = b2MulT(xf, input.p1);
+	b2Vec2 p2 = b2MulT(xf, input.p2);
+	b2Vec2 r = p2 - p1;
+	if (r.Normalize() < b2_epsilon)
+	{
+		return;
+	}
+
+	// v is perpendicular to the segment.
+	b2Vec2 v = b2Cross(1.0f, r);
+	b2Vec2 abs_v = b2Abs(v);
+
+	b2RayCastInput subInput = input;
+
+	int32 index = 0;
+	while (index < nodeCount)
+	{
+		const b2StaticTreeNode* node = nodes + index;
+
+		// Bounding box of the clipped ray.
+		b2Vec2 t = p1 + subInput.maxFraction * (p2 - p1);
+		b2AABB segmentAABB;
+		segmentAABB.lowerBound = b2Min(p1, t);
+		segmentAABB.upperBound = b2Max(p1, t);
+
+		bool overlap = b2TestOverlap(node->aabb, segmentAABB);
+		if (overlap)
+		{
+			// Separating axis for segment (Gino, p80).
+			b2Vec2 c = node->aabb.GetCenter();
+			b2Vec2 h = node->aabb.GetExtents();
+			overlap = b2Abs(b2Dot(v, p1 - c)) - b2Dot(abs_v, h) <= 0.0f;
+		}
+
+		if (overlap == false)
+		{
+			index = node->skip;
+			continue;
+		}
+
+		if (node->child >= 0)
+		{
+			float value = callback->RayCastCallback(subInput, node->child);
+			if (value == 0.0f)
+			{
+				// The client has terminated the ray cast.
+				return;
+			}
+
+			if (value > 0.0f)
+			{
+				subInput.maxFraction = value;
+			}
+		}
+
+		++index;
+	}
+}
+
+// Keeps the closest child hit of a shape.
+template <typename T>
+struct b2StaticTreeClosestHit
+{
+	float RayCastCallback(const b2RayCastInput& input, int32 child)
+	{
+		b2RayCastOutput childOutput;
+		if (shape->RayCast(&childOutput, input, xf, child))
+		{
+			*output = childOutput;
+			hit = true;
+			return childOutput.fraction;
+		}
+
+		return -1.0f;
+	}
+
+	const T* shape;
+	b2Transform xf;
+	b2RayCastOutput* output;
+	bool hit;
+};
+
+template <typename T>
+inline bool b2RayCastStaticTree(const b2StaticTreeNode* nodes, int32 nodeCount, const T* shape,
+								b2RayCastOutput* output, const b2RayCastInput& input, const b2Transform& xf)
+{
+	b2StaticTreeClosestHit<T> closest;
+	closest.shape = shape;
+	closest.xf = xf;
+	closest.output = output;
+	closest.hit = false;
+	b2RayCastStaticTree(nodes, nodeCount, &closest, input, xf);
+	return closest.hit;
+}
+
 #endif
@@ -0,0 +1,132 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef B2_COMPOUND_SHAPE_H
+#define B2_COMPOUND_SHAPE_H
+
+#include "b2_shape.h"
+
+/// A compound shape holds many convex children (circles, polygons and capsules) in one fixture.
+/// The children are given in the body frame and keep their own radius. A compound fixture has
+/// a single broad-phase proxy and finds the children near other shapes with a static tree,
+/// so a body built from many pieces needs one proxy instead of one per piece. Each touching
+/// child pair is still a contact of its own. All children share the fixture material and filter.
+class b2CompoundShape : public b2Shape
+{
+public:
+	b2CompoundShape();
+
+	/// The destructor frees the children using b2Free.
+	~b2CompoundShape();
+
+	/// Clear all data.
+	void Clear();
+
+	/// Create the compound from copies of the given shapes and build the child tree.
+	/// @param shapes the children, each a circle, polygon or capsule in the body frame
+	/// @param count the child count, at least 1
+	void Create(const b2Shape* const* shapes, int32 count);
+
+	/// Implement b2Shape. Children are cloned using b2Alloc.
+	b2Shape* Clone(b2BlockAllocator* allocator) const override;
+
+	/// @see b2Shape::GetChildCount
+	int32 GetChildCount() const override;
+
+	/// Get a child shape.
+	const b2Shape* GetChild(int32 index) const;
+
+	/// @see b2Shape::GetChildRadius
+	float GetChildRadius(int32 childIndex) const override;
+
+	/// Get the bounds of all children in the body frame.
+	const b2AABB& GetBounds() const { return m_nodes[0].aabb; }
+
+	/// Query the child tree for children that may overlap an AABB given in the body frame.
+	/// The callback gets QueryCallback(int32 childIndex) and returns false to stop.
+	template <typename T>
+	void QueryTree(T* callback, const b2AABB& aabb) const;
+
+	/// Cast a ray against all children using the child tree and return the closest hit.
+	bool RayCastTree(b2RayCastOutput* output, const b2RayCastInput& input, const b2Transform& transform) const;
+
+	/// Cast a ray against the child tree. The callback gets
+	/// RayCastCallback(const b2RayCastInput& input, int32 childIndex) for each child the ray
+	/// may cross and returns the new max fraction as with b2DynamicTree::RayCast.
+	template <typename T>
+	void RayCastTree(T* callback, const b2RayCastInput& input, const b2Transform& transform) const;
+
+	/// Test a point against every child.
+	/// @see b2Shape::TestPoint
+	bool TestPoint(const b2Transform& transform, const b2Vec2& p) const override;
+
+	/// Implement b2Shape.
+	bool RayCast(b2RayCastOutput* output, const b2RayCastInput& input,
+					const b2Transform& transform, int32 childIndex) const override;
+
+	/// @see b2Shape::ComputeAABB
+	void ComputeAABB(b2AABB* aabb, const b2Transform& transform, int32 childIndex) const override;
+
+	/// The mass of all children at the same density.
+	/// @see b2Shape::ComputeMass
+	void ComputeMass(b2MassData* massData, float density) const override;
+
+	/// The children. Owned by this class.
+	b2Shape** m_children;
+
+	/// The child count.
+	int32 m_count;
+
+	/// The child tree. Owned by this class.
+	b2StaticTreeNode* m_nodes;
+	int32 m_nodeCount;
+};
+
+inline b2CompoundShape::b2CompoundShape()
+{
+	m_type = e_compound;
+	m_radius = 0.0f;
+	m_children = nullptr;
+	m_count = 0;
+	m_nodes = nullptr;
+	m_nodeCount = 0;
+}
+
+inline const b2Shape* b2CompoundShape::GetChild(int32 index) const
+{
+	b2Assert(0 <= index && index < m_count);
+	return m_children[index];
+}
+
+template <typename T>
+inline void b2CompoundShape::QueryTree(T* callback, const b2AABB& aabb) const
+{
+	b2QueryStaticTree(m_nodes, m_nodeCount, callback, aabb);
+}
+
+template <typename T>
+inline void b2CompoundShape::RayCastTree(T* callback, const b2RayCastInput& input, const b2Transform& xf) const
+{
+	b2RayCastStaticTree(m_nodes, m_nodeCount, callback, input, xf);
+}
+
+#endif
@@ -24,6 +24,7 @@
 #define B2_CONTACT_H
 
 #include "b2_collision.h"
+#include "b2_distance.h"
 #include "b2_fixture.h"
 #include "b2_math.h"
 #include "b2_shape.h"
@@ -191,7 +192,11 @@ protected:
 	b2Contact(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB);
 	virtual ~b2Contact() {}
 
-	void Update(b2ContactListener* listener);
+	// Update the manifold. The previous manifold is reused if the shapes were touching and
+	// the relative transform moved less than the tolerances since it was computed. Returns
+	// true if the manifold was reused.
+	bool Update(b2ContactListener* listener, float linearTolerance, float angularTolerance);
+	bool CanReuseManifold(const b2Transform& xfA, const b2Transform& xfB, float linearTolerance, float angularTolerance) const;
 
 	static b2ContactRegister s_registers[b2Shape::e_typeCount][b2Shape::e_typeCount];
 	static bool s_initialized;
@@ -214,9 +219,15 @@ protected:
 
 	b2Manifold m_manifold;
 
+	// Transform of body B relative to body A when the manifold was computed.
+	b2Transform m_manifoldXf;
+
 	int32 m_toiCount;
 	float m_toi;
 
+	// Simplex from the last time of impact query, used to warm start the next one.
+	b2SimplexCache m_simplexCache;
+
 	float m_friction;
 	float m_restitution;
 
@@ -240,7 +251,7 @@ inline void b2Contact::GetWorldManifold(b2WorldManifold* worldManifold) const
 	const b2Shape* shapeA = m_fixtureA->GetShape();
 	const b2Shape* shapeB = m_fixtureB->GetShape();
 
-	worldManifold->Initialize(&m_manifold, bodyA->GetTransform(), shapeA->m_radius, bodyB->GetTransform(), shapeB->m_radius);
+	worldManifold->Initialize(&m_manifold, bodyA->GetTransform(), shapeA->GetChildRadius(m_indexA), bodyB->GetTransform(), shapeB->GetChildRadius(m_indexB));
 }
 
 inline void b2Contact::SetEnabled(bool flag)
@@ -26,6 +26,7 @@
 #include "b2_broad_phase.h"
 
 class b2Contact;
+class b2Fixture;
 class b2ContactFilter;
 class b2ContactListener;
 class b2BlockAllocator;
@@ -39,11 +40,20 @@ public:
 	// Broad-phase callback.
 	void AddPair(void* proxyUserDataA, void* proxyUserDataB);
 
+	// Create a contact between two fixture children unless one exists or filtering rejects it.
+	void AddContact(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB);
+
 	void FindNewContacts();
 
 	void Destroy(b2Contact* c);
 
+	// Insert a new contact at the head of the world and body contact lists.
+	void Link(b2Contact* c);
+
 	void Collide();
+
+	// The world box a fixture child is paired with in the broad-phase.
+	b2AABB GetPairAABB(const b2Fixture* fixture, int32 childIndex) const;
             
 	b2BroadPhase m_broadPhase;
 	b2Contact* m_contactList;
@@ -51,6 +61,12 @@ public:
 	b2ContactFilter* m_contactFilter;
 	b2ContactListener* m_contactListener;
 	b2BlockAllocator* m_allocator;
+
+	// Manifold reuse tolerances and the counters for the last Collide.
+	float m_cacheLinearTolerance;
+	float m_cacheAngularTolerance;
+	int32 m_cacheHitCount;
+	int32 m_cacheMissCount;
 };
 
 #endif
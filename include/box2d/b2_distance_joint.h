@@ -113,6 +113,8 @@ protected:
 	void InitVelocityConstraints(const b2SolverData& data) override;
 	void SolveVelocityConstraints(const b2SolverData& data) override;
 	bool SolvePositionConstraints(const b2SolverData& data) override;
+	void SerializeState(b2JointStateStream& stream) override;
+	static b2JointBatchRegister GetBatchRegister();
 
 	float m_frequencyHz;
 	float m_dampingRatio;
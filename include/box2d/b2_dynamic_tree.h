@@ -105,6 +105,14 @@ public:
 	template <typename T>
 	void RayCast(T* callback, const b2RayCastInput& input) const;
 
+	/// Sweep a box through the tree. This is a ray-cast of the box center against the
+	/// nodes grown by the box extents. The callback gets ShapeCastCallback(float maxFraction,
+	/// int32 proxyId) for each proxy in the path and returns a value like RayCastCallback.
+	/// @param aabb the box at the start of the sweep.
+	/// @param translation the box moves from aabb to aabb + maxFraction * translation.
+	template <typename T>
+	void ShapeCast(T* callback, const b2AABB& aabb, const b2Vec2& translation, float maxFraction) const;
+
 	/// Validate this tree. For testing.
 	void Validate() const;
 
@@ -127,6 +135,18 @@ public:
 	/// @param newOrigin the new origin with respect to the old origin
 	void ShiftOrigin(const b2Vec2& newOrigin);
 
+	/// Get the number of bytes needed by SaveState.
+	int32 GetStateSize() const;
+
+	/// Copy the node pool into a buffer. Proxy ids and user data are preserved.
+	/// @return the number of bytes written.
+	int32 SaveState(void* buffer) const;
+
+	/// Restore the node pool from a buffer written by SaveState. The pool is
+	/// only reallocated if the capacity changed.
+	/// @return the number of bytes read.
+	int32 RestoreState(const void* buffer);
+
 private:
 
 	int32 AllocateNode();
@@ -290,4 +310,81 @@ inline void b2DynamicTree::RayCast(T* callback, const b2RayCastInput& input) con
 	}
 }
 
+template <typename T>
+inline void b2DynamicTree::ShapeCast(T* callback, const b2AABB& aabb, const b2Vec2& translation, float maxFraction) const
+{
+	b2Vec2 p1 = aabb.GetCenter();
+	b2Vec2 extents = aabb.GetExtents();
+
+	// v is perpendicular to the sweep. A box that does not move only uses the overlap test.
+	b2Vec2 r = translation;
+	b2Vec2 v(0.0f, 0.0f);
+	if (r.Normalize() > b2_epsilon)
+	{
+		v = b2Cross(1.0f, r);
+	}
+	b2Vec2 abs_v = b2Abs(v);
+
+	// Build a bounding box for the swept box.
+	b2AABB sweepAABB;
+	{
+		b2Vec2 t = p1 + maxFraction * translation;
+		sweepAABB.lowerBound = b2Min(p1, t) - extents;
+		sweepAABB.upperBound = b2Max(p1, t) + extents;
+	}
+
+	b2GrowableStack<int32, 256> stack;
+	stack.Push(m_root);
+
+	while (stack.GetCount() > 0)
+	{
+		int32 nodeId = stack.Pop();
+		if (nodeId == b2_nullNode)
+		{
+			continue;
+		}
+
+		const b2TreeNode* node = m_nodes + nodeId;
+
+		if (b2TestOverlap(node->aabb, sweepAABB) == false)
+		{
+			continue;
+		}
+
+		// Separating axis for the center segment against the grown node.
+		b2Vec2 c = node->aabb.GetCenter();
+		b2Vec2 h = node->aabb.GetExtents() + extents;
+		float separation = b2Abs(b2Dot(v, p1 - c)) - b2Dot(abs_v, h);
+		if (separation > 0.0f)
+		{
+			continue;
+		}
+
+		if (node->IsLeaf())
+		{
+			float value = callback->ShapeCastCallback(maxFraction, nodeId);
+
+			if (value == 0.0f)
+			{
+				// The client has terminated the shape cast.
+				return;
+			}
+
+			if (0.0f < value && value < maxFraction)
+			{
+				// Update the swept bounding box.
+				maxFraction = value;
+				b2Vec2 t = p1 + maxFraction * translation;
+				sweepAABB.lowerBound = b2Min(p1, t) - extents;
+				sweepAABB.upperBound = b2Max(p1, t) + extents;
+			}
+		}
+		else
+		{
+			stack.Push(node->child1);
+			stack.Push(node->child2);
+		}
+	}
+}
+
 #endif
@@ -31,6 +31,7 @@ class b2BlockAllocator;
 class b2Body;
 class b2BroadPhase;
 class b2Fixture;
+struct b2ShapeCastOutput;
 
 /// This holds contact filtering data.
 struct b2Filter
@@ -55,6 +56,18 @@ struct b2Filter
 	int16 groupIndex;
 };
 
+/// Return true if fixtures with these filters should collide. This is the rule used by
+/// the default b2ContactFilter.
+inline bool b2ShouldCollide(const b2Filter& filterA, const b2Filter& filterB)
+{
+	if (filterA.groupIndex == filterB.groupIndex && filterA.groupIndex != 0)
+	{
+		return filterA.groupIndex > 0;
+	}
+
+	return (filterA.maskBits & filterB.categoryBits) != 0 && (filterA.categoryBits & filterB.maskBits) != 0;
+}
+
 /// A fixture definition is used to create a fixture. This class defines an
 /// abstract fixture definition. You can reuse fixture definitions safely.
 struct b2FixtureDef
@@ -68,10 +81,11 @@ struct b2FixtureDef
 		restitution = 0.0f;
 		density = 0.0f;
 		isSensor = false;
+		shareShape = false;
 	}
 
 	/// The shape, this must be set. The shape will be cloned, so you
-	/// can create the shape on the stack.
+	/// can create the shape on the stack, unless shareShape is set.
 	const b2Shape* shape;
 
 	/// Use this to store application specific fixture data.
@@ -90,6 +104,11 @@ struct b2FixtureDef
 	/// response.
 	bool isSensor;
 
+	/// Reference the shape instead of cloning it. The shape is owned by you, it must
+	/// outlive the fixture and it must not be modified while it is in use. This lets
+	/// fixtures in any number of worlds share one copy of large shapes such as chains.
+	bool shareShape;
+
 	/// Contact filtering data.
 	b2Filter filter;
 };
@@ -117,7 +136,8 @@ public:
 
 	/// Get the child shape. You can modify the child shape, however you should not change the
 	/// number of vertices because this will crash some collision caching mechanisms.
-	/// Manipulating the shape may lead to non-physical behavior.
+	/// Manipulating the shape may lead to non-physical behavior. Shared shapes must not
+	/// be modified.
 	b2Shape* GetShape();
 	const b2Shape* GetShape() const;
 
@@ -165,6 +185,22 @@ public:
 	/// @param input the ray-cast input parameters.
 	bool RayCast(b2RayCastOutput* output, const b2RayCastInput& input, int32 childIndex) const;
 
+	/// Test a shape for overlap with a child of this fixture. Chains with a segment tree,
+	/// heightfields and compounds ignore the child index and test all of their children.
+	/// @param shape a circle, polygon, edge or capsule.
+	/// @param transform the transform of the shape.
+	bool TestOverlap(const b2Shape* shape, const b2Transform& transform, int32 childIndex) const;
+
+	/// Cast a shape against a child of this fixture. Chains with a segment tree, heightfields
+	/// and compounds ignore the child index and report their closest child. A shape that
+	/// touches the fixture at the start is free to move away from it or along it.
+	/// @param output the point on this fixture, its surface normal and the translation fraction.
+	/// @param shape a circle, polygon, edge or capsule.
+	/// @param transform the transform of the shape at the start.
+	/// @param translation the shape moves from transform.p to transform.p + translation.
+	bool ShapeCast(b2ShapeCastOutput* output, const b2Shape* shape, const b2Transform& transform,
+					const b2Vec2& translation, int32 childIndex) const;
+
 	/// Get the mass data for this fixture. The mass data is based on the density and
 	/// the shape. The rotational inertia is about the shape's origin. This operation
 	/// may be expensive.
@@ -193,7 +229,8 @@ public:
 
 	/// Get the fixture's AABB. This AABB may be enlarge and/or stale.
 	/// If you need a more accurate AABB, compute it using the shape and
-	/// the body transform.
+	/// the body transform. A chain with a segment tree, a heightfield and a compound have a
+	/// single AABB at child index 0.
 	const b2AABB& GetAABB(int32 childIndex) const;
 
 	/// Dump this fixture to the log file.
@@ -219,6 +256,11 @@ protected:
 
 	void Synchronize(b2BroadPhase* broadPhase, const b2Transform& xf1, const b2Transform& xf2);
 
+	// Synchronize in two passes. The first only writes the proxy AABBs, so it can run in
+	// parallel across fixtures. The second updates the broad-phase.
+	void ComputeSweptAABBs(const b2Transform& xf1, const b2Transform& xf2);
+	void MoveProxies(b2BroadPhase* broadPhase, const b2Vec2& displacement);
+
 	float m_density;
 
 	b2Fixture* m_next;
@@ -232,10 +274,16 @@ protected:
 	b2FixtureProxy* m_proxies;
 	int32 m_proxyCount;
 
+	// One proxy covers all children, which are found with a shape query. This is the case
+	// for chains with a segment tree, heightfields and compounds.
+	bool m_singleProxy;
+
 	b2Filter m_filter;
 
 	bool m_isSensor;
 
+	bool m_sharedShape;
+
 	void* m_userData;
 };
 
@@ -0,0 +1,155 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef B2_FRACTURE_H
+#define B2_FRACTURE_H
+
+#include "b2_math.h"
+
+class b2Body;
+class b2Fixture;
+class b2PolygonShape;
+struct b2FractureRequest;
+
+/// A fracture pattern is a set of Voronoi cells in the square [-1, 1] x [-1, 1]. The cells are
+/// computed once and placed at each impact, scaled to cover the broken body and turned along
+/// the impulse, so breaking a body only clips its polygons against the cells.
+class b2FracturePattern
+{
+public:
+	b2FracturePattern();
+	~b2FracturePattern();
+
+	/// Compute the Voronoi cells of the given sites, clipped to the square. The cell of the
+	/// site closest to the origin is the one that takes the impact.
+	/// @param sites the cell sites inside the square. Sites must be unique.
+	/// @param count the number of sites, at least 1.
+	void Create(const b2Vec2* sites, int32 count);
+
+	/// Create a pattern of rings around the origin that get finer towards the impact.
+	/// @param ringCount the number of rings around the center cell.
+	/// @param ringSiteCount the number of cells in each ring.
+	void CreateRadial(int32 ringCount, int32 ringSiteCount);
+
+	/// Free the cells.
+	void Clear();
+
+	/// Get the number of cells.
+	int32 GetCellCount() const
+	{
+		return m_cellCount;
+	}
+
+	/// Get the counter-clockwise vertices of a cell.
+	const b2Vec2* GetCellVertices(int32 index, int32* count) const;
+
+	/// Get the cell that takes the impact.
+	int32 GetImpactCell() const
+	{
+		return m_impactCell;
+	}
+
+	/// Get the largest number of vertices of a cell.
+	int32 GetMaxCellVertexCount() const
+	{
+		return m_maxCellVertexCount;
+	}
+
+private:
+
+	b2Vec2* m_vertices;
+
+	// Cell i uses vertices [m_cellStarts[i], m_cellStarts[i + 1]).
+	int32* m_cellStarts;
+	int32 m_cellCount;
+	int32 m_maxCellVertexCount;
+	int32 m_impactCell;
+};
+
+/// Breaks bodies into fragments with a fracture pattern. Breaks are usually found in contact
+/// callbacks such as b2ContactListener::PostSolve, where the world is locked, so they are
+/// queued and done by Process after the time step. Process stops when its fragment budget is
+/// used, which keeps the cost of a step bounded when many bodies break at once.
+///
+/// The polygon fixtures of a broken body are clipped against the pattern cells. The pieces
+/// in each cell make one fragment body that keeps the fixture materials, the body settings
+/// and the velocity of the broken body at its center. User data is not copied. The fragment
+/// masses are computed while clipping. The impulse is applied to the fragment closest to the
+/// impact point. The polygon fixtures are removed from the broken body, which is destroyed
+/// with its joints if it has no fixtures left. The scratch memory is kept between breaks.
+class b2FractureQueue
+{
+public:
+	b2FractureQueue();
+	~b2FractureQueue();
+
+	/// Queue a body to break. This is safe in world callbacks. A body that is already queued
+	/// is ignored.
+	/// @param body the body to break.
+	/// @param pattern the pattern, which must outlive the request.
+	/// @param point the impact point in world coordinates.
+	/// @param impulse the impact impulse in world coordinates. The pattern is turned along it.
+	void Add(b2Body* body, const b2FracturePattern* pattern, const b2Vec2& point, const b2Vec2& impulse);
+
+	/// Remove the request of a body. Call this before destroying a queued body.
+	void Remove(b2Body* body);
+
+	/// Get the number of queued requests.
+	int32 GetCount() const
+	{
+		return m_requestCount;
+	}
+
+	/// Break queued bodies in order until the budget is used. The first request is always
+	/// processed, so each call makes progress. The remaining requests stay queued.
+	/// @param maxFragments the fragment budget.
+	/// @return the number of fragments created.
+	int32 Process(int32 maxFragments);
+
+	/// Break a body now.
+	/// @param fragments optional array that receives the fragment bodies.
+	/// @param capacity the size of the fragments array, usually the pattern cell count.
+	/// @return the number of fragments created.
+	/// @warning This function is locked during callbacks.
+	int32 Fracture(b2Body* body, const b2FracturePattern* pattern, const b2Vec2& point, const b2Vec2& impulse,
+					b2Body** fragments = nullptr, int32 capacity = 0);
+
+private:
+
+	int32 Break(b2Body* body, const b2FracturePattern* pattern, const b2Vec2& point, const b2Vec2& impulse,
+				b2Body** fragments, int32 capacity);
+	void ReservePieces(int32 capacity);
+
+	b2FractureRequest* m_requests;
+	int32 m_requestCount;
+	int32 m_requestCapacity;
+
+	// Clipped pieces of the current body in body coordinates.
+	b2PolygonShape* m_pieces;
+	b2Fixture** m_pieceFixtures;
+	int32 m_pieceCapacity;
+
+	b2Vec2* m_clipVertices;
+	int32 m_clipCapacity;
+};
+
+#endif
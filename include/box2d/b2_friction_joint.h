@@ -95,6 +95,8 @@ protected:
 	void InitVelocityConstraints(const b2SolverData& data) override;
 	void SolveVelocityConstraints(const b2SolverData& data) override;
 	bool SolvePositionConstraints(const b2SolverData& data) override;
+	void SerializeState(b2JointStateStream& stream) override;
+	static b2JointBatchRegister GetBatchRegister();
 
 	b2Vec2 m_localAnchorA;
 	b2Vec2 m_localAnchorB;
@@ -87,6 +87,8 @@ protected:
 	void InitVelocityConstraints(const b2SolverData& data) override;
 	void SolveVelocityConstraints(const b2SolverData& data) override;
 	bool SolvePositionConstraints(const b2SolverData& data) override;
+	void SerializeState(b2JointStateStream& stream) override;
+	static b2JointBatchRegister GetBatchRegister();
 
 	b2Joint* m_joint1;
 	b2Joint* m_joint2;
@@ -0,0 +1,231 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef B2_HEIGHTFIELD_SHAPE_H
+#define B2_HEIGHTFIELD_SHAPE_H
+
+#include "b2_shape.h"
+
+class b2EdgeShape;
+
+/// A sample with this height removes the cells on both sides of it.
+#define b2_heightfieldHole	(-32768)
+
+/// A heightfield is a row of uniformly spaced height samples joined by line segments. It is
+/// meant for terrain and rows of tiles. Sample i sits at (i * spacing, heights[i] * heightScale)
+/// in the body frame and cell i joins samples i and i + 1. The heights are stored as int16.
+/// Like a chain, the surface has two-sided collision and uses the neighboring cells for
+/// smooth collision. A heightfield fixture has a single broad-phase proxy and finds the
+/// cells near other shapes with index math instead of a tree.
+class b2HeightfieldShape : public b2Shape
+{
+public:
+	b2HeightfieldShape();
+
+	/// The destructor frees the heights using b2Free.
+	~b2HeightfieldShape();
+
+	/// Clear all data.
+	void Clear();
+
+	/// Create the heightfield.
+	/// @param heights the samples, these are copied
+	/// @param count the sample count, at least 2
+	/// @param spacing the horizontal distance between samples
+	/// @param heightScale the height of one sample unit
+	void Create(const int16* heights, int32 count, float spacing, float heightScale);
+
+	/// Implement b2Shape. Heights are cloned using b2Alloc.
+	b2Shape* Clone(b2BlockAllocator* allocator) const override;
+
+	/// One child per cell, including cells next to holes.
+	/// @see b2Shape::GetChildCount
+	int32 GetChildCount() const override;
+
+	/// Get a cell as an edge with its neighbors.
+	void GetChildEdge(b2EdgeShape* edge, int32 index) const;
+
+	/// Get a sample position.
+	b2Vec2 GetVertex(int32 index) const;
+
+	/// Is a cell missing because one of its samples is a hole?
+	bool IsHole(int32 index) const;
+
+	/// Get the bounds of all samples in the heightfield frame.
+	const b2AABB& GetBounds() const { return m_bounds; }
+
+	/// Find the cells that may overlap an AABB given in the heightfield frame. Holes are
+	/// skipped. The callback gets QueryCallback(int32 childIndex) and returns false to stop.
+	template <typename T>
+	void QueryCells(T* callback, const b2AABB& aabb) const;
+
+	/// Cast a ray against the cells it crosses, in order, and return the first hit.
+	bool RayCastCells(b2RayCastOutput* output, const b2RayCastInput& input, const b2Transform& transform) const;
+
+	/// Visit the cells a ray crosses, in order. Holes are skipped. The callback gets
+	/// RayCastCallback(const b2RayCastInput& input, int32 childIndex) and returns the new max
+	/// fraction as with b2DynamicTree::RayCast.
+	template <typename T>
+	void RayCastCells(T* callback, const b2RayCastInput& input, const b2Transform& transform) const;
+
+	/// This always return false.
+	/// @see b2Shape::TestPoint
+	bool TestPoint(const b2Transform& transform, const b2Vec2& p) const override;
+
+	/// Implement b2Shape.
+	bool RayCast(b2RayCastOutput* output, const b2RayCastInput& input,
+					const b2Transform& transform, int32 childIndex) const override;
+
+	/// @see b2Shape::ComputeAABB
+	void ComputeAABB(b2AABB* aabb, const b2Transform& transform, int32 childIndex) const override;
+
+	/// Heightfields have zero mass.
+	/// @see b2Shape::ComputeMass
+	void ComputeMass(b2MassData* massData, float density) const override;
+
+	/// The samples. Owned by this class.
+	int16* m_heights;
+
+	/// The sample count.
+	int32 m_count;
+
+	float m_spacing;
+	float m_heightScale;
+
+	b2AABB m_bounds;
+};
+
+inline b2HeightfieldShape::b2HeightfieldShape()
+{
+	m_type = e_heightfield;
+	m_radius = b2_polygonRadius;
+	m_heights = nullptr;
+	m_count = 0;
+	m_spacing = 1.0f;
+	m_heightScale = 1.0f;
+	m_bounds.lowerBound.SetZero();
+	m_bounds.upperBound.SetZero();
+}
+
+inline b2Vec2 b2HeightfieldShape::GetVertex(int32 index) const
+{
+	b2Assert(0 <= index && index < m_count);
+	return b2Vec2(index * m_spacing, m_heights[index] * m_heightScale);
+}
+
+inline bool b2HeightfieldShape::IsHole(int32 index) const
+{
+	b2Assert(0 <= index && index < m_count - 1);
+	return m_heights[index] == b2_heightfieldHole || m_heights[index + 1] == b2_heightfieldHole;
+}
+
+template <typename T>
+inline void b2HeightfieldShape::QueryCells(T* callback, const b2AABB& aabb) const
+{
+	if (b2TestOverlap(aabb, m_bounds) == false)
+	{
+		return;
+	}
+
+	// The cells covered in x follow from the spacing.
+	float inv_spacing = 1.0f / m_spacing;
+	int32 lower = int32(b2Max(aabb.lowerBound.x, 0.0f) * inv_spacing);
+	int32 upper = b2Min(int32(b2Min(aabb.upperBound.x, m_bounds.upperBound.x) * inv_spacing), m_count - 2);
+
+	for (int32 i = lower; i <= upper; ++i)
+	{
+		int32 h1 = m_heights[i];
+		int32 h2 = m_heights[i + 1];
+		if (h1 == b2_heightfieldHole || h2 == b2_heightfieldHole)
+		{
+			continue;
+		}
+
+		float y1 = b2Min(h1, h2) * m_heightScale;
+		float y2 = b2Max(h1, h2) * m_heightScale;
+		if (aabb.upperBound.y < y1 || y2 < aabb.lowerBound.y)
+		{
+			continue;
+		}
+
+		bool proceed = callback->QueryCallback(i);
+		if (proceed == false)
+		{
+			return;
+		}
+	}
+}
+
+// The ray moves monotonically in x, so the cells are visited in the order the ray crosses them.
+template <typename T>
+inline void b2HeightfieldShape::RayCastCells(T* callback, const b2RayCastInput& input, const b2Transform& xf) const
+{
+	b2Vec2 p1 = b2MulT(xf, input.p1);
+	b2Vec2 p2 = b2MulT(xf, input.p2);
+	float x1 = p1.x;
+	float x2 = p1.x + input.maxFraction * (p2.x - p1.x);
+
+	float lowerX = b2Max(b2Min(x1, x2), 0.0f);
+	float upperX = b2Min(b2Max(x1, x2), m_bounds.upperBound.x);
+	if (lowerX > upperX)
+	{
+		return;
+	}
+
+	float inv_spacing = 1.0f / m_spacing;
+	int32 lower = b2Clamp(int32(lowerX * inv_spacing), 0, m_count - 2);
+	int32 upper = b2Clamp(int32(upperX * inv_spacing), 0, m_count - 2);
+	if (lower > upper)
+	{
+		return;
+	}
+
+	int32 first = x1 <= x2 ? lower : upper;
+	int32 last = x1 <= x2 ? upper : lower;
+	int32 step = x1 <= x2 ? 1 : -1;
+
+	b2RayCastInput subInput = input;
+	for (int32 i = first; ; i += step)
+	{
+		if (IsHole(i) == false)
+		{
+			float value = callback->RayCastCallback(subInput, i);
+			if (value == 0.0f)
+			{
+				// The client has terminated the ray cast.
+				return;
+			}
+
+			if (value > 0.0f)
+			{
+				subInput.maxFraction = value;
+			}
+		}
+
+		if (i == last)
+		{
+			break;
+		}
+	}
+}
+
+#endif
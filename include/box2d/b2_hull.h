@@ -0,0 +1,64 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef B2_HULL_H
+#define B2_HULL_H
+
+#include "b2_math.h"
+
+class b2PolygonShape;
+
+/// The outcome of a hull computation. The hull functions report bad input with these codes
+/// instead of asserting, so generated geometry such as fracture pieces can be skipped.
+enum b2HullResult
+{
+	b2_hullOk = 0,
+
+	/// Fewer than three points remain after welding.
+	b2_hullTooFewPoints,
+
+	/// The points are collinear or the hull has no area.
+	b2_hullCollinear,
+
+	/// The hull has more than b2_maxPolygonVertices vertices.
+	b2_hullTooManyVertices
+};
+
+/// Compute the convex hull of a point set using quickhull. Hull vertices closer than
+/// half the linear slop are welded and vertices within the linear slop of the line through
+/// their neighbors are removed. The hull is counter-clockwise.
+/// @param hull receives the hull vertices. It must hold count points.
+/// @param hullCount receives the number of hull vertices.
+/// @param points the input points in any order.
+/// @param count the number of input points.
+b2HullResult b2ComputeHull(b2Vec2* hull, int32* hullCount, const b2Vec2* points, int32 count);
+
+/// Split the convex hull of a point set into convex polygons of at most
+/// b2_maxPolygonVertices vertices. The hull is halved along diagonals, which keeps the
+/// pieces round instead of making a fan of slivers.
+/// @param polygons receives the pieces. A hull of n vertices needs at most n - 2 pieces.
+/// @param polygonCount receives the number of pieces.
+/// @param capacity the size of the polygons array.
+/// @return b2_hullTooManyVertices if the polygons array is too small.
+b2HullResult b2DecomposeHull(b2PolygonShape* polygons, int32* polygonCount, int32 capacity, const b2Vec2* points, int32 count);
+
+#endif
@@ -102,6 +102,62 @@ struct b2JointDef
 	bool collideConnected;
 };
 
+/// Solver functions for a run of joints that share a type. These let the island
+/// solve each run with direct calls instead of a virtual call per joint.
+typedef void b2JointBatchFcn(b2Joint** joints, int32 count, const b2SolverData& data);
+typedef bool b2JointPositionBatchFcn(b2Joint** joints, int32 count, const b2SolverData& data);
+
+struct b2JointBatchRegister
+{
+	b2JointBatchFcn* initVelocityFcn;
+	b2JointBatchFcn* solveVelocityFcn;
+	b2JointPositionBatchFcn* solvePositionFcn;
+};
+
+/// Measures, writes or reads the state of a joint for world snapshots. A joint passes
+/// each of its fields through Serialize, so the three modes share one field list.
+/// Values are packed without padding.
+class b2JointStateStream
+{
+public:
+	enum Mode
+	{
+		e_measure,
+		e_write,
+		e_read
+	};
+
+	b2JointStateStream(Mode mode, void* data);
+
+	void Serialize(float& value);
+	void Serialize(int32& value);
+	void Serialize(bool& value);
+	void Serialize(b2Vec2& value);
+	void Serialize(b2Vec3& value);
+
+	/// Enumerations are stored as int32.
+	template <typename T>
+	void SerializeEnum(T& value)
+	{
+		int32 i = int32(value);
+		Serialize(i);
+		value = T(i);
+	}
+
+	/// Get the number of bytes processed so far.
+	int32 GetSize() const
+	{
+		return m_size;
+	}
+
+private:
+	void SerializeBytes(void* value, int32 size);
+
+	Mode m_mode;
+	char* m_data;
+	int32 m_size;
+};
+
 /// The base joint class. Joints are used to constraint two bodies together in
 /// various fashions. Some joints also feature limits and motors.
 class b2Joint
@@ -162,6 +218,26 @@ protected:
 	static b2Joint* Create(const b2JointDef* def, b2BlockAllocator* allocator);
 	static void Destroy(b2Joint* joint, b2BlockAllocator* allocator);
 
+	enum
+	{
+		e_jointTypeCount = e_motorJoint + 1
+	};
+
+	// Each joint type provides batch functions built from these templates in its own
+	// source file, where the solver calls can be inlined.
+	template <typename T>
+	static void InitVelocityBatch(b2Joint** joints, int32 count, const b2SolverData& data);
+	template <typename T>
+	static void SolveVelocityBatch(b2Joint** joints, int32 count, const b2SolverData& data);
+	template <typename T>
+	static bool SolvePositionBatch(b2Joint** joints, int32 count, const b2SolverData& data);
+	template <typename T>
+	static b2JointBatchRegister CreateBatchRegister();
+
+	static void InitializeBatchRegisters();
+
+	static b2JointBatchRegister s_batchRegisters[e_jointTypeCount];
+
 	b2Joint(const b2JointDef* def);
 	virtual ~b2Joint() {}
 
@@ -171,6 +247,10 @@ protected:
 	// This returns true if the position errors are within tolerance.
 	virtual bool SolvePositionConstraints(const b2SolverData& data) = 0;
 
+	// Pass the state that persists between steps through the stream. Solver temporaries are
+	// rebuilt by InitVelocityConstraints and the world structure is not stored.
+	virtual void SerializeState(b2JointStateStream& stream) = 0;
+
 	b2JointType m_type;
 	b2Joint* m_prev;
 	b2Joint* m_next;
@@ -227,4 +307,44 @@ inline bool b2Joint::GetCollideConnected() const
 	return m_collideConnected;
 }
 
+template <typename T>
+inline void b2Joint::InitVelocityBatch(b2Joint** joints, int32 count, const b2SolverData& data)
+{
+	for (int32 i = 0; i < count; ++i)
+	{
+		static_cast<T*>(joints[i])->T::InitVelocityConstraints(data);
+	}
+}
+
+template <typename T>
+inline void b2Joint::SolveVelocityBatch(b2Joint** joints, int32 count, const b2SolverData& data)
+{
+	for (int32 i = 0; i < count; ++i)
+	{
+		static_cast<T*>(joints[i])->T::SolveVelocityConstraints(data);
+	}
+}
+
+template <typename T>
+inline bool b2Joint::SolvePositionBatch(b2Joint** joints, int32 count, const b2SolverData& data)
+{
+	bool jointsOkay = true;
+	for (int32 i = 0; i < count; ++i)
+	{
+		bool jointOkay = static_cast<T*>(joints[i])->T::SolvePositionConstraints(data);
+		jointsOkay = jointsOkay && jointOkay;
+	}
+	return jointsOkay;
+}
+
+template <typename T>
+inline b2JointBatchRegister b2Joint::CreateBatchRegister()
+{
+	b2JointBatchRegister reg;
+	reg.initVelocityFcn = InitVelocityBatch<T>;
+	reg.solveVelocityFcn = SolveVelocityBatch<T>;
+	reg.solvePositionFcn = SolvePositionBatch<T>;
+	return reg;
+}
+
 #endif
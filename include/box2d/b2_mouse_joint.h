@@ -77,6 +77,9 @@ public:
 	/// Implements b2Joint.
 	float GetReactionTorque(float inv_dt) const override;
 
+	/// The local anchor point relative to bodyB's origin.
+	const b2Vec2& GetLocalAnchorB() const { return m_localAnchorB; }
+
 	/// Use this to update the target point.
 	void SetTarget(const b2Vec2& target);
 	const b2Vec2& GetTarget() const;
@@ -107,6 +110,8 @@ protected:
 	void InitVelocityConstraints(const b2SolverData& data) override;
 	void SolveVelocityConstraints(const b2SolverData& data) override;
 	bool SolvePositionConstraints(const b2SolverData& data) override;
+	void SerializeState(b2JointStateStream& stream) override;
+	static b2JointBatchRegister GetBatchRegister();
 
 	b2Vec2 m_localAnchorB;
 	b2Vec2 m_targetA;
@@ -22,6 +22,7 @@
 #ifndef B2_POLYGON_SHAPE_H
 #define B2_POLYGON_SHAPE_H
 
+#include "b2_hull.h"
 #include "b2_shape.h"
 
 /// A convex polygon. It is assumed that the interior of the polygon is to
@@ -46,6 +47,18 @@ public:
 	/// may lead to poor stacking behavior.
 	void Set(const b2Vec2* points, int32 count);
 
+	/// Create a convex hull from any number of points using b2ComputeHull. Unlike Set this
+	/// does not assert on degenerate input and removes collinear points. The polygon is
+	/// not changed if the result is not b2_hullOk.
+	/// @return b2_hullTooManyVertices if the hull has more than b2_maxPolygonVertices vertices.
+	/// Use b2DecomposeHull to split such a hull.
+	b2HullResult SetHull(const b2Vec2* points, int32 count);
+
+	/// Set the polygon from the vertices of a counter-clockwise convex hull, such as the output
+	/// of b2ComputeHull. The hull is not computed again.
+	/// The count must be in the range [3, b2_maxPolygonVertices].
+	void SetConvex(const b2Vec2* vertices, int32 count);
+
 	/// Build vertices to represent an axis-aligned box centered on the local origin.
 	/// @param hx the half-width.
 	/// @param hy the half-height.
@@ -26,6 +26,7 @@
 #include "b2_math.h"
 
 class b2Draw;
+struct b2RopeData;
 
 enum b2BendingModel
 {
@@ -65,6 +66,10 @@ struct b2RopeDef
 		count = 0;
 		masses = nullptr;
 		gravity.SetZero();
+		radius = 0.0f;
+		friction = 0.6f;
+		categoryBits = 0x0001;
+		maskBits = 0xFFFF;
 	}
 
 	///
@@ -80,6 +85,19 @@ struct b2RopeDef
 	b2Vec2 gravity;
 
 	b2RopeTuning tuning;
+
+	/// The collision radius of the vertices. A rope in a b2RopeSystem stepped by a world
+	/// collides with fixtures when this is positive.
+	float radius;
+
+	/// The friction coefficient used against fixtures, usually in the range [0,1].
+	float friction;
+
+	/// The collision category bits, tested against the fixture filters like b2Filter.
+	uint16 categoryBits;
+
+	/// The collision mask bits.
+	uint16 maskBits;
 };
 
 /// 
@@ -118,11 +136,8 @@ public:
 
 private:
 
-	void SolveStretch();
-	//void SolveBend_PBD_Distance();
-	void SolveBend_PBD_Angle();
-	void SolveBend_XPBD_Angle(float dt);
-	void ApplyBendForces(float dt);
+	// View the rope arrays for the shared rope solver.
+	b2RopeData GetData() const;
 
 	int32 m_count;
 	int32 m_stretchCount;
@@ -0,0 +1,167 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef B2_ROPE_SYSTEM_H
+#define B2_ROPE_SYSTEM_H
+
+#include "b2_rope.h"
+
+struct b2AABB;
+class b2Body;
+class b2Draw;
+class b2Fixture;
+class b2TaskExecutor;
+class b2World;
+struct b2RopeAttachment;
+struct b2RopeContact;
+struct b2RopeSlot;
+
+/// Steps many ropes together. The vertex and constraint state of all ropes lives in shared
+/// pooled arrays, so a large set of short ropes does not need seven allocations per rope.
+/// Ropes are independent and are split across the task executor when one is set. A rope
+/// in a system behaves exactly like a b2Rope created from the same definition.
+///
+/// A system can also be registered with a world using b2World::SetRopeSystem. The world
+/// then steps the ropes after the rigid bodies in each b2World::Step, the ropes collide with
+/// fixtures and attached vertices pull on their bodies.
+class b2RopeSystem
+{
+public:
+	b2RopeSystem();
+	~b2RopeSystem();
+
+	/// Create a rope.
+	/// @return a rope id that stays valid until the rope is destroyed.
+	int32 CreateRope(const b2RopeDef* def);
+
+	/// Destroy a rope and its attachments. The storage of the remaining ropes is compacted,
+	/// so vertex pointers returned by GetVertices are invalidated.
+	void DestroyRope(int32 ropeId);
+
+	/// Attach a rope vertex to a point on a body. The vertex follows the anchor and the body
+	/// feels the pull of the rope. This only has an effect when a world steps the system.
+	/// The attachment is destroyed with the body or the rope.
+	/// @param vertexIndex the vertex, this should have a positive mass.
+	/// @param localAnchor the anchor point relative to the body origin.
+	/// @return an attachment id.
+	int32 CreateAttachment(int32 ropeId, int32 vertexIndex, b2Body* body, const b2Vec2& localAnchor);
+
+	///
+	void DestroyAttachment(int32 attachmentId);
+
+	///
+	void SetTuning(int32 ropeId, const b2RopeTuning& tuning);
+
+	/// Set the offset applied to the bind positions of the zero mass vertices. This is the
+	/// position passed to b2Rope::Step.
+	void SetPosition(int32 ropeId, const b2Vec2& position);
+
+	///
+	void SetAngle(int32 ropeId, float angle);
+
+	///
+	int32 GetVertexCount(int32 ropeId) const;
+
+	/// The vertices are valid until a rope is created or destroyed.
+	const b2Vec2* GetVertices(int32 ropeId) const;
+
+	/// Get the number of ropes.
+	int32 GetRopeCount() const
+	{
+		return m_ropeCount;
+	}
+
+	/// Set a task executor used to step the ropes in parallel. Pass null to step on the
+	/// calling thread.
+	void SetTaskExecutor(b2TaskExecutor* executor)
+	{
+		m_executor = executor;
+	}
+
+	/// Step all ropes without a world.
+	void Step(float timeStep, int32 iterations);
+
+	/// Get the number of vertex-fixture contacts found in the last world step.
+	int32 GetContactCount() const
+	{
+		return m_contactCount;
+	}
+
+	///
+	void Draw(b2Draw* draw) const;
+
+private:
+
+	friend class b2World;
+
+	static void StepTask(int32 startIndex, int32 endIndex, int32 workerIndex, void* context);
+	static void IntegrateTask(int32 startIndex, int32 endIndex, int32 workerIndex, void* context);
+	static void SolveTask(int32 startIndex, int32 endIndex, int32 workerIndex, void* context);
+
+	b2RopeData GetData(int32 ropeId) const;
+	void ReserveVertices(int32 capacity);
+
+	// Coupled step used by b2World::Step.
+	void StepCoupled(b2World* world, float timeStep, int32 iterations);
+	void FindContacts(b2World* world, int32 ropeId);
+	void AddContacts(int32 ropeId, b2Fixture* fixture, int32 childIndex, const b2AABB& childAABB);
+	void PrepareAttachments();
+	void SolveConstraints(int32 ropeId);
+	void ApplyImpulses();
+	void DestroyAttachments(b2Body* body);
+
+	b2RopeSlot* m_slots;
+	int32 m_slotCapacity;
+	int32 m_freeSlot;
+	int32 m_ropeCount;
+
+	// Pooled per vertex state. The constraint arrays are indexed by their first vertex.
+	b2Vec2* m_bindPositions;
+	b2Vec2* m_ps;
+	b2Vec2* m_p0s;
+	b2Vec2* m_vs;
+	float* m_ims;
+	float* m_Ls;
+	float* m_as;
+	float* m_bendingLambdas;
+	int32 m_vertexCount;
+	int32 m_vertexCapacity;
+
+	b2RopeAttachment* m_attachments;
+	int32 m_attachmentCapacity;
+	int32 m_freeAttachment;
+
+	// Attachment ids grouped by rope for the coupled step.
+	int32* m_attachmentOrder;
+	int32 m_attachmentOrderCapacity;
+
+	b2RopeContact* m_contacts;
+	int32 m_contactCount;
+	int32 m_contactCapacity;
+
+	b2TaskExecutor* m_executor;
+
+	float m_stepTime;
+	int32 m_stepIterations;
+};
+
+#endif
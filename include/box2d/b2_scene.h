@@ -0,0 +1,177 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef B2_SCENE_H
+#define B2_SCENE_H
+
+#include "b2_math.h"
+
+class b2Body;
+class b2Joint;
+class b2World;
+
+/// A scene is a compact binary image of the world structure: bodies, fixtures, shapes and
+/// joints. It holds no pointers, only indices and byte offsets from the start of the buffer,
+/// so it can be loaded straight from a memory mapped file. All records are 4 byte aligned.
+/// User data and simulation state such as contacts are not saved. Use b2World::SaveSnapshot
+/// for the simulation state.
+
+/// The scene file header. All offsets are in bytes from the start of the header.
+struct b2SceneHeader
+{
+	uint32 magic;
+	uint32 version;
+	int32 size;
+	b2Vec2 gravity;
+	int32 bodyCount;
+	int32 bodyOffset;
+	int32 fixtureCount;
+	int32 fixtureOffset;
+	int32 jointCount;
+	int32 jointOffset;
+	int32 vertexCount;
+	int32 vertexOffset;
+};
+
+/// A body record. The fixtures of a body are contiguous.
+struct b2SceneBody
+{
+	enum
+	{
+		e_allowSleep = 0x0001,
+		e_awake = 0x0002,
+		e_fixedRotation = 0x0004,
+		e_bullet = 0x0008,
+		e_active = 0x0010
+	};
+
+	int32 type;
+	uint32 flags;
+	b2Vec2 position;
+	float angle;
+	b2Vec2 linearVelocity;
+	float angularVelocity;
+	float linearDamping;
+	float angularDamping;
+	float gravityScale;
+	float sleepThreshold;
+	int32 fixtureIndex;
+	int32 fixtureCount;
+};
+
+/// A fixture record. The shape geometry lives in the vertex pool:
+/// - circle: the center
+/// - edge: vertex0, vertex1, vertex2, vertex3
+/// - polygon: the centroid, then vertexCount vertices, then vertexCount normals
+/// - chain: the previous vertex, the next vertex, then vertexCount vertices
+/// - heightfield: (spacing, heightScale), then the vertexCount samples packed two per vertex
+/// - capsule: vertex1, vertex2
+/// - compound: for each of the vertexCount children (type, radius), then the circle center, the
+///   capsule vertices or the polygon (count, 0), centroid, vertices and normals
+struct b2SceneFixture
+{
+	enum
+	{
+		e_sensor = 0x0001,
+		e_hasVertex0 = 0x0002,
+		e_hasVertex3 = 0x0004,
+		e_chainTree = 0x0008
+	};
+
+	int32 shapeType;
+	float radius;
+	int32 vertexIndex;
+	int32 vertexCount;
+	float friction;
+	float restitution;
+	float density;
+	uint16 categoryBits;
+	uint16 maskBits;
+	int16 groupIndex;
+	uint16 flags;
+};
+
+/// A joint record. The fields are shared between joint types:
+/// - referenceAngle: revolute, prismatic and weld reference angle, motor angular offset
+/// - lower, upper: revolute and prismatic limits, distance length, rope max length, pulley lengths
+/// - axis: prismatic and wheel local axis, motor linear offset, mouse target
+/// - localAnchorB: the mouse joint anchor on bodyB, which may lag behind the target
+/// - maxMotorForce: motor force or torque, friction, motor and mouse max force
+/// - maxTorque: friction and motor max torque
+/// - ratio: gear and pulley ratio, motor correction factor
+/// - jointA, jointB: gear joint indices
+struct b2SceneJoint
+{
+	enum
+	{
+		e_collideConnected = 0x0001,
+		e_enableLimit = 0x0002,
+		e_enableMotor = 0x0004
+	};
+
+	int32 type;
+	int32 bodyA;
+	int32 bodyB;
+	uint32 flags;
+	b2Vec2 localAnchorA;
+	b2Vec2 localAnchorB;
+	b2Vec2 axis;
+	b2Vec2 groundAnchorA;
+	b2Vec2 groundAnchorB;
+	float referenceAngle;
+	float lower;
+	float upper;
+	float motorSpeed;
+	float maxMotorForce;
+	float maxTorque;
+	float frequencyHz;
+	float dampingRatio;
+	float ratio;
+	int32 jointA;
+	int32 jointB;
+};
+
+/// Get the number of bytes needed to save the world as a scene.
+int32 b2GetSceneSize(const b2World* world);
+
+/// Save the world structure as a scene. Bodies, fixtures and joints are stored in world
+/// list order.
+/// @return the number of bytes written or zero if the buffer is too small.
+int32 b2SaveScene(const b2World* world, void* buffer, int32 capacity);
+
+/// Validate a scene and get its header.
+/// @return nullptr if the buffer does not hold a valid scene.
+const b2SceneHeader* b2GetSceneHeader(const void* buffer, int32 size);
+
+/// Add the contents of a scene to a world. The buffer is only read. Polygons are copied
+/// as saved, without computing their convex hull again, and each body computes its mass
+/// once. A reloaded scene keeps the list order of the saved world.
+/// @param world the world to fill. The world gravity is set from the scene.
+/// @param buffer the scene data. It must be 4 byte aligned.
+/// @param size the size of the buffer in bytes.
+/// @param bodies optional array of header bodyCount entries that receives the created bodies.
+/// @param joints optional array of header jointCount entries that receives the created joints.
+/// @return false if the scene is invalid, in which case the world is not changed.
+bool b2LoadScene(b2World* world, const void* buffer, int32 size, b2Body** bodies = nullptr, b2Joint** joints = nullptr);
+
+#endif
@@ -85,6 +85,12 @@ typedef unsigned int uint32;
 /// Maximum number of sub-steps per contact in continuous physics simulation.
 #define b2_maxSubSteps			8
 
+/// Maximum number of separating axes tried by one time of impact query.
+#define b2_maxTOIIterations		20
+
+/// Maximum number of root finder iterations per separating axis in a time of impact query.
+#define b2_maxTOIRootIterations	50
+
 
 // Dynamics
 
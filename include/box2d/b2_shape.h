@@ -54,7 +54,10 @@ public:
 		e_edge = 1,
 		e_polygon = 2,
 		e_chain = 3,
-		e_typeCount = 4
+		e_heightfield = 4,
+		e_capsule = 5,
+		e_compound = 6,
+		e_typeCount = 7
 	};
 
 	virtual ~b2Shape() {}
@@ -94,6 +97,10 @@ public:
 	/// @param density the density in kilograms per meter squared.
 	virtual void ComputeMass(b2MassData* massData, float density) const = 0;
 
+	/// Get the radius of a child primitive. This is m_radius except for compound shapes,
+	/// whose children keep their own radius.
+	virtual float GetChildRadius(int32 childIndex) const;
+
 	Type m_type;
 
 	/// Radius of a shape. For polygonal shapes this must be b2_polygonRadius. There is no support for
@@ -106,4 +113,10 @@ inline b2Shape::Type b2Shape::GetType() const
 	return m_type;
 }
 
+inline float b2Shape::GetChildRadius(int32 childIndex) const
+{
+	B2_NOT_USED(childIndex);
+	return m_radius;
+}
+
 #endif
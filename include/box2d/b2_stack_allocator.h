@@ -38,6 +38,7 @@ struct b2StackEntry
 // This is a stack allocator used for fast per step allocations.
 // You must nest allocate/free pairs. The code will assert
 // if you try to interleave multiple allocate/free pairs.
+// The stack memory is allocated on first use.
 class b2StackAllocator
 {
 public:
@@ -51,7 +52,7 @@ public:
 
 private:
 
-	char m_data[b2_stackSize];
+	char* m_data;
 	int32 m_index;
 
 	int32 m_allocation;
@@ -0,0 +1,143 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef B2_STATE_DELTA_H
+#define B2_STATE_DELTA_H
+
+#include "b2_settings.h"
+
+class b2World;
+
+/// Quantization used by the state delta stream. Each value is stored as
+/// an integer multiple of its precision. The encoder and decoder must agree.
+struct b2StateDeltaPrecision
+{
+	b2StateDeltaPrecision()
+	{
+		position = 0.001f;
+		angle = 0.001f;
+		linearVelocity = 0.01f;
+		angularVelocity = 0.01f;
+	}
+
+	/// Position resolution in meters.
+	float position;
+
+	/// Angle resolution in radians.
+	float angle;
+
+	/// Linear velocity resolution in meters per second.
+	float linearVelocity;
+
+	/// Angular velocity resolution in radians per second.
+	float angularVelocity;
+};
+
+/// The quantized state of a body. Used as the baseline of the delta stream.
+struct b2QuantizedBodyState
+{
+	int32 x, y;
+	int32 angle;
+	int32 vx, vy;
+	int32 w;
+	bool awake;
+};
+
+/// Writes the body transforms, velocities and sleep state of a world as a compact
+/// delta stream against the previously encoded frame. Bodies that did not change
+/// after quantization are skipped, which covers sleeping bodies. Bodies are
+/// identified by their position in the world body list, so the mirror world must
+/// create its bodies in the same order. The stream assumes in order delivery. Call
+/// Reset to write a full frame, for example when a client joins or lost a frame.
+class b2StateDeltaEncoder
+{
+public:
+	b2StateDeltaEncoder();
+	~b2StateDeltaEncoder();
+
+	/// Set the quantization. This forces a full frame.
+	void SetPrecision(const b2StateDeltaPrecision& precision);
+	const b2StateDeltaPrecision& GetPrecision() const { return m_precision; }
+
+	/// Forget the baseline so the next frame holds every body.
+	void Reset();
+
+	/// Encode the world state against the previous frame. A full frame is written
+	/// after Reset or if the body count changed.
+	/// @param world the world to encode.
+	/// @param buffer the destination, owned by you.
+	/// @param capacity the size of the buffer in bytes.
+	/// @return the number of bytes written or zero if the buffer is too small. The
+	/// baseline is only advanced if the frame was written.
+	int32 Encode(const b2World* world, void* buffer, int32 capacity);
+
+	/// Get the sequence number of the last written frame.
+	uint32 GetSequence() const { return m_sequence; }
+
+	/// Get the number of bodies written in the last frame.
+	int32 GetChangedCount() const { return m_changedCount; }
+
+private:
+
+	b2StateDeltaPrecision m_precision;
+	b2QuantizedBodyState* m_baseline;
+	b2QuantizedBodyState* m_current;
+	int32 m_count;
+	int32 m_capacity;
+	uint32 m_sequence;
+	int32 m_changedCount;
+	bool m_fullFrame;
+};
+
+/// Applies a delta stream written by b2StateDeltaEncoder to a mirror world.
+class b2StateDeltaDecoder
+{
+public:
+	b2StateDeltaDecoder();
+	~b2StateDeltaDecoder();
+
+	/// Set the quantization. This must match the encoder.
+	void SetPrecision(const b2StateDeltaPrecision& precision) { m_precision = precision; }
+	const b2StateDeltaPrecision& GetPrecision() const { return m_precision; }
+
+	/// Apply a frame to the world. Changed bodies are moved with b2Body::SetTransform and
+	/// their velocities and sleep state are set.
+	/// @return false if the frame is malformed, out of sequence, or does not match the
+	/// world body count. Request a full frame from the encoder in that case.
+	bool Decode(b2World* world, const void* buffer, int32 size);
+
+	/// Get the sequence number of the last applied frame.
+	uint32 GetSequence() const { return m_sequence; }
+
+private:
+
+	b2StateDeltaPrecision m_precision;
+	b2QuantizedBodyState* m_baseline;
+	b2QuantizedBodyState* m_current;
+	int32 m_count;
+	int32 m_capacity;
+	uint32 m_sequence;
+	bool m_hasBaseline;
+};
+
+#endif
@@ -0,0 +1,66 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef B2_TASK_H
+#define B2_TASK_H
+
+#include "b2_settings.h"
+
+/// A task processes the items in [startIndex, endIndex). The worker index is in
+/// [0, b2TaskExecutor::GetWorkerCount()) and may be used to select per thread storage.
+typedef void b2TaskFcn(int32 startIndex, int32 endIndex, int32 workerIndex, void* context);
+
+/// Implement this to run Box2D work on your own thread pool. The executor is owned by
+/// you and must remain in scope while Box2D uses it.
+class b2TaskExecutor
+{
+public:
+	virtual ~b2TaskExecutor() {}
+
+	/// Get the number of workers, including the calling thread if it takes part.
+	virtual int32 GetWorkerCount() const = 0;
+
+	/// Split [0, itemCount) into ranges of at least minRange items, run the task on
+	/// each range and return once all ranges are done. A worker index must not be
+	/// used by two threads at the same time.
+	virtual void ParallelFor(b2TaskFcn* task, void* context, int32 itemCount, int32 minRange) = 0;
+};
+
+/// Run a task on an executor, or on the calling thread if the executor is null.
+inline void b2ParallelFor(b2TaskExecutor* executor, b2TaskFcn* task, void* context, int32 itemCount, int32 minRange)
+{
+	if (itemCount <= 0)
+	{
+		return;
+	}
+
+	if (executor == nullptr || itemCount <= minRange)
+	{
+		task(0, itemCount, 0, context);
+		return;
+	}
+
+	executor->ParallelFor(task, context, itemCount, minRange);
+}
+
+#endif
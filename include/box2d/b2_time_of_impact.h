@@ -52,6 +52,36 @@ struct b2TOIOutput
 	float t;
 };
 
+/// Number of buckets in the b2TOIStats histograms. The last bucket also counts larger values.
+const int32 b2_toiHistogramCount = 24;
+
+/// Iteration statistics for time of impact queries and the distance queries they run.
+/// Each caller owns its statistics, so queries on different threads do not share state.
+struct b2TOIStats
+{
+	/// Set all counters to zero.
+	void SetZero();
+
+	/// Add the counters from another set of statistics.
+	void Combine(const b2TOIStats& stats);
+
+	int32 toiCalls;
+	int32 toiIters;
+	int32 toiMaxIters;
+	int32 toiRootIters;
+	int32 toiMaxRootIters;
+	float toiTime;		///< milliseconds
+	float toiMaxTime;	///< milliseconds
+
+	int32 gjkCalls;
+	int32 gjkIters;
+	int32 gjkMaxIters;
+
+	int32 toiIterHistogram[b2_toiHistogramCount];		///< queries by separating axis count
+	int32 toiRootIterHistogram[b2_toiHistogramCount];	///< axes by root finder iterations
+	int32 gjkIterHistogram[b2_toiHistogramCount];		///< distance queries by iterations
+};
+
 /// Compute the upper bound on time before two shapes penetrate. Time is represented as
 /// a fraction between [0,tMax]. This uses a swept separating axis and may miss some intermediate,
 /// non-tunneling collisions. If you change the time interval, you should call this function
@@ -59,4 +89,10 @@ struct b2TOIOutput
 /// Note: use b2Distance to compute the contact point and normal at the time of impact.
 void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input);
 
+/// Compute the time of impact, starting the first distance query from a simplex cache.
+/// The cache is updated with the final simplex so it can warm start the next query on the
+/// same pair of shapes. Set cache->count to zero on the first call.
+/// @param stats optional statistics that this query is added to, may be null.
+void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input, b2SimplexCache* cache, b2TOIStats* stats);
+
 #endif
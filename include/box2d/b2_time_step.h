@@ -35,8 +35,60 @@ struct b2Profile
 	float solvePosition;
 	float broadphase;
 	float solveTOI;
+	float solveRope;
+
+	// Solver statistics, these are counts rather than times.
+	int32 islandCount;				// islands solved this step
+	int32 velocityIterations;		// velocity iterations summed over islands
+	int32 maxVelocityIterations;	// most velocity iterations used by one island
+	int32 contactCacheHits;			// contacts that reused their manifold
+	int32 contactCacheMisses;		// contacts that computed a new manifold
+};
+
+/// The constraint solver used by the world.
+enum b2SolverType
+{
+	/// Sequential impulses followed by non-linear Gauss-Seidel position iterations.
+	b2_ngsSolver,
+
+	/// Sub-stepping with soft constraints. Each sub-step solves the constraints with a
+	/// soft position bias and then relaxes the bias away. The velocity iterations are
+	/// used as the sub-step count and the position iterations are ignored. Joints that
+	/// do not support soft constraints get one position correction pass per sub-step.
+	b2_softStepSolver
+};
+
+/// This is an internal structure. Soft constraint coefficients for a given time step.
+struct b2Softness
+{
+	float biasRate;
+	float massScale;
+	float impulseScale;
 };
 
+/// This is an internal function. Compute the soft constraint coefficients for a spring
+/// with the given frequency (Hz) and damping ratio over the time step h.
+inline b2Softness b2MakeSoft(float hertz, float dampingRatio, float h)
+{
+	b2Softness soft;
+	if (hertz == 0.0f)
+	{
+		soft.biasRate = 0.0f;
+		soft.massScale = 1.0f;
+		soft.impulseScale = 0.0f;
+		return soft;
+	}
+
+	float omega = 2.0f * b2_pi * hertz;
+	float a1 = 2.0f * dampingRatio + h * omega;
+	float a2 = h * omega * a1;
+	float a3 = 1.0f / (1.0f + a2);
+	soft.biasRate = omega / a1;
+	soft.massScale = a2 * a3;
+	soft.impulseScale = a3;
+	return soft;
+}
+
 /// This is an internal structure.
 struct b2TimeStep
 {
@@ -46,6 +98,18 @@ struct b2TimeStep
 	int32 velocityIterations;
 	int32 positionIterations;
 	bool warmStarting;
+
+	// Adaptive velocity iterations. Disabled if the linear tolerance is zero.
+	float linearIterationTolerance;
+	float angularIterationTolerance;
+	int32 minVelocityIterations;
+
+	// Soft step solver settings. The softness is for one sub-step.
+	b2SolverType solverType;
+	b2Softness contactSoftness;
+	b2Softness staticSoftness;
+	b2Softness jointSoftness;
+	float contactPushVelocity;
 };
 
 /// This is an internal structure.
@@ -68,6 +132,9 @@ struct b2SolverData
 	b2TimeStep step;
 	b2Position* positions;
 	b2Velocity* velocities;
+
+	// Soft step solver: apply the soft position bias, false while relaxing.
+	bool useBias;
 };
 
 #endif
@@ -25,8 +25,10 @@
 
 #include "b2_block_allocator.h"
 #include "b2_contact_manager.h"
+#include "b2_fixture.h"
 #include "b2_math.h"
 #include "b2_stack_allocator.h"
+#include "b2_time_of_impact.h"
 #include "b2_time_step.h"
 #include "b2_world_callbacks.h"
 
@@ -34,10 +36,54 @@ struct b2AABB;
 struct b2BodyDef;
 struct b2Color;
 struct b2JointDef;
+struct b2SleepingIsland;
 class b2Body;
 class b2Draw;
 class b2Fixture;
+class b2Island;
 class b2Joint;
+class b2RopeSystem;
+class b2Shape;
+class b2TaskExecutor;
+
+/// A closest hit shape cast for b2World::ShapeCastBatch.
+struct b2ShapeCastQuery
+{
+	b2ShapeCastQuery()
+	{
+		shape = nullptr;
+		transform.SetIdentity();
+		translation.SetZero();
+		ignoreBody = nullptr;
+	}
+
+	/// The moving shape. This must be a circle, polygon, edge or capsule.
+	const b2Shape* shape;
+
+	/// The transform of the shape at the start.
+	b2Transform transform;
+
+	/// The shape moves from transform.p to transform.p + translation.
+	b2Vec2 translation;
+
+	/// Fixtures that would not collide with a fixture with this filter are skipped.
+	b2Filter filter;
+
+	/// Fixtures of this body are skipped, usually the body that owns the shape.
+	const b2Body* ignoreBody;
+};
+
+/// The closest hit of a b2ShapeCastQuery.
+struct b2ShapeCastResult
+{
+	/// The fixture hit or nullptr if the shape moves freely.
+	b2Fixture* fixture;
+	b2Vec2 point;
+	b2Vec2 normal;
+
+	/// The fraction of the translation that is free, one if nothing was hit.
+	float fraction;
+};
 
 /// The world class manages all physics entities, dynamic simulation,
 /// and asynchronous queries. The world also contains efficient memory
@@ -120,11 +166,40 @@ public:
 	/// Ray-cast the world for all fixtures in the path of the ray. Your callback
 	/// controls whether you get the closest point, any point, or n-points.
 	/// The ray-cast ignores shapes that contain the starting point.
+	/// Chains with a segment tree, heightfields and compounds report every child the ray hits,
+	/// like fixtures with one proxy per child.
 	/// @param callback a user implemented callback class.
 	/// @param point1 the ray starting point
 	/// @param point2 the ray ending point
 	void RayCast(b2RayCastCallback* callback, const b2Vec2& point1, const b2Vec2& point2) const;
 
+	/// Query the world for all fixtures that overlap a shape. The broad-phase finds the
+	/// candidates and each is tested with GJK. A fixture is reported once per overlapping
+	/// proxy, so chains without a segment tree may be reported more than once.
+	/// @param callback a user implemented callback class.
+	/// @param shape a circle, polygon, edge or capsule.
+	/// @param transform the transform of the shape.
+	void QueryShape(b2QueryCallback* callback, const b2Shape* shape, const b2Transform& transform) const;
+
+	/// Sweep a shape through the world for all fixtures in its path. This works like RayCast:
+	/// the broad-phase is traversed with the swept bounds, each candidate is shape cast with
+	/// GJK and a clipped fraction prunes the rest of the traversal. Fixtures that overlap the
+	/// shape at the start are ignored. Chains with a segment tree, heightfields and compounds
+	/// report only their closest child.
+	/// @param callback a user implemented callback class.
+	/// @param shape a circle, polygon, edge or capsule.
+	/// @param transform the transform of the shape at the start.
+	/// @param translation the shape moves from transform.p to transform.p + translation.
+	void ShapeCast(b2ShapeCastCallback* callback, const b2Shape* shape, const b2Transform& transform,
+					const b2Vec2& translation) const;
+
+	/// Find the closest hit of many shape casts, for example one per character each step.
+	/// Sensors are skipped. The casts run on the task executor when one is set.
+	/// @param queries the shape casts.
+	/// @param results receives one result per query.
+	/// @param count the number of queries.
+	void ShapeCastBatch(const b2ShapeCastQuery* queries, b2ShapeCastResult* results, int32 count) const;
+
 	/// Get the world body list. With the returned body, use b2Body::GetNext to get
 	/// the next body in the world list. A nullptr body indicates the end of the list.
 	/// @return the head of the world body list.
@@ -149,6 +224,15 @@ public:
 	void SetAllowSleeping(bool flag);
 	bool GetAllowSleeping() const { return m_allowSleep; }
 
+	/// Enable/disable energy based sleep. When enabled an island falls asleep once its mass
+	/// weighted speed is below the mass weighted body sleep thresholds, so a single jittering
+	/// body cannot keep a resting pile awake. Otherwise every body must rest on its own.
+	void SetEnergySleep(bool flag) { m_energySleep = flag; }
+	bool GetEnergySleep() const { return m_energySleep; }
+
+	/// Get the number of sleeping islands. Bodies that fell asleep together are woken together.
+	int32 GetSleepingIslandCount() const { return m_sleepingIslandCount; }
+
 	/// Enable/disable warm starting. For testing.
 	void SetWarmStarting(bool flag) { m_warmStarting = flag; }
 	bool GetWarmStarting() const { return m_warmStarting; }
@@ -161,6 +245,49 @@ public:
 	void SetSubStepping(bool flag) { m_subStepping = flag; }
 	bool GetSubStepping() const { return m_subStepping; }
 
+	/// Set a task executor used to solve large islands in parallel. Pass null to solve on
+	/// the calling thread. The executor must outlive the world or be cleared first. If the
+	/// world is stepped by a b2WorldGroup the executor must allow nested ParallelFor calls.
+	void SetTaskExecutor(b2TaskExecutor* executor) { m_executor = executor; }
+	b2TaskExecutor* GetTaskExecutor() { return m_executor; }
+
+	/// Register a rope system with the world. The ropes are stepped after the rigid bodies in
+	/// each Step, collide with fixtures and pull on the bodies they are attached to. The
+	/// system must outlive the world or be cleared first. Pass null to detach it.
+	void SetRopeSystem(b2RopeSystem* ropeSystem) { m_ropeSystem = ropeSystem; }
+	b2RopeSystem* GetRopeSystem() { return m_ropeSystem; }
+
+	/// Select the constraint solver. See b2SolverType.
+	void SetSolverType(b2SolverType type) { m_solverType = type; }
+	b2SolverType GetSolverType() const { return m_solverType; }
+
+	/// Adjust the contact stiffness of the soft step solver.
+	/// @param hertz the contact stiffness, this is capped at a quarter of the sub-step rate.
+	/// @param dampingRatio the contact damping ratio, non-dimensional.
+	/// @param pushVelocity the maximum speed used to push overlapping bodies apart (m/s).
+	void SetContactTuning(float hertz, float dampingRatio, float pushVelocity);
+
+	/// Adjust the joint stiffness of the soft step solver.
+	/// @param hertz the joint stiffness, this is capped at a quarter of the sub-step rate.
+	/// @param dampingRatio the joint damping ratio, non-dimensional.
+	void SetJointTuning(float hertz, float dampingRatio);
+
+	/// Enable adaptive velocity iterations for the NGS solver. Each island stops iterating once
+	/// no body velocity changes by more than the tolerances during an iteration. The velocity
+	/// iteration count passed to Step becomes the per-island maximum.
+	/// @param linearTolerance the linear velocity change considered converged (m/s). Zero disables.
+	/// @param angularTolerance the angular velocity change considered converged (radians/s).
+	/// @param minIterations the number of iterations always performed.
+	void SetAdaptiveIterations(float linearTolerance, float angularTolerance, int32 minIterations);
+
+	/// Enable manifold reuse for touching contacts. A contact keeps its manifold while the
+	/// transform of one body relative to the other stays within the tolerances of the
+	/// transform used to compute the manifold. The solver still computes separations from
+	/// the current transforms. Hits and misses are reported in the profile.
+	/// @param linearTolerance the relative translation allowed (m). Zero disables.
+	/// @param angularTolerance the relative rotation allowed (radians).
+	void SetContactCaching(float linearTolerance, float angularTolerance);
+
 	/// Get the number of broad-phase proxies.
 	int32 GetProxyCount() const;
 
@@ -209,10 +336,36 @@ public:
 	/// Get the current profile.
 	const b2Profile& GetProfile() const;
 
+	/// Get the time of impact statistics for the last step.
+	const b2TOIStats& GetTOIStats() const;
+
 	/// Dump the world into the log file.
 	/// @warning this should be called outside of a time step.
 	void Dump();
 
+	/// Get the number of bytes needed to save a snapshot of the current world state.
+	/// This changes as contacts begin and end.
+	int32 GetSnapshotSize() const;
+
+	/// Save the simulation state into a buffer. This holds body, fixture, joint and contact
+	/// state, including warm starting impulses, sleep timers and the broad-phase tree.
+	/// It does not hold the world structure, so restoring requires the same bodies, fixtures
+	/// and joints that existed when the snapshot was saved.
+	/// @param buffer the destination, owned by you.
+	/// @param capacity the size of the buffer in bytes.
+	/// @return the number of bytes written or zero if the buffer is too small.
+	/// @warning this should be called outside of a time step.
+	int32 SaveSnapshot(void* buffer, int32 capacity) const;
+
+	/// Restore a snapshot in place. Bodies, fixtures and joints are not reallocated. Contacts
+	/// are only re-created if the contact list changed since the snapshot was saved. No contact
+	/// callbacks are issued.
+	/// @param buffer the data written by SaveSnapshot.
+	/// @param size the number of bytes returned by SaveSnapshot.
+	/// @return false if the snapshot does not match the world, in which case nothing is changed.
+	/// @warning This function is locked during callbacks.
+	bool RestoreSnapshot(const void* buffer, int32 size);
+
 private:
 
 	// m_flags
@@ -224,19 +377,38 @@ private:
 	};
 
 	friend class b2Body;
+	friend class b2CharacterMover;
 	friend class b2Fixture;
 	friend class b2ContactManager;
 	friend class b2Controller;
+	friend class b2WorldGroup;
 
 	void Solve(const b2TimeStep& step);
 	void SolveTOI(const b2TimeStep& step);
 
+	void AddKinematicBody(b2Body* body);
+	void RemoveKinematicBody(b2Body* body);
+	void SolveKinematic(const b2TimeStep& step);
+	static void SynchronizeTask(int32 startIndex, int32 endIndex, int32 workerIndex, void* context);
+
+	void ReserveSleepingIslands(int32 capacity);
+	void AddSleepingIsland(const b2Island& island);
+	void WakeSleepingIsland(int32 id);
+
 	void DrawJoint(b2Joint* joint);
-	void DrawShape(b2Fixture* shape, const b2Transform& xf, const b2Color& color);
+	void DrawShape(const b2Shape* shape, const b2Transform& xf, const b2Color& color);
 
 	b2BlockAllocator m_blockAllocator;
 	b2StackAllocator m_stackAllocator;
 
+	// Per step scratch memory. This is m_stackAllocator unless a world group lends
+	// the world a per thread allocator.
+	b2StackAllocator* m_scratchAllocator;
+
+	b2TaskExecutor* m_executor;
+
+	b2RopeSystem* m_ropeSystem;
+
 	int32 m_flags;
 
 	b2ContactManager m_contactManager;
@@ -247,8 +419,20 @@ private:
 	int32 m_bodyCount;
 	int32 m_jointCount;
 
+	// Compact array of the kinematic bodies so they can be moved without an island search.
+	b2Body** m_kinematicBodies;
+	int32 m_kinematicCount;
+	int32 m_kinematicCapacity;
+
 	b2Vec2 m_gravity;
 	bool m_allowSleep;
+	bool m_energySleep;
+
+	// Sleeping island records with a free list threaded through b2SleepingIsland::next.
+	b2SleepingIsland* m_sleepingIslands;
+	int32 m_sleepingIslandCapacity;
+	int32 m_sleepingIslandCount;
+	int32 m_freeSleepingIsland;
 
 	b2DestructionListener* m_destructionListener;
 	b2Draw* m_debugDraw;
@@ -262,9 +446,21 @@ private:
 	bool m_continuousPhysics;
 	bool m_subStepping;
 
+	b2SolverType m_solverType;
+	float m_contactHertz;
+	float m_contactDampingRatio;
+	float m_contactPushVelocity;
+	float m_jointHertz;
+	float m_jointDampingRatio;
+
+	float m_linearIterationTolerance;
+	float m_angularIterationTolerance;
+	int32 m_minVelocityIterations;
+
 	bool m_stepComplete;
 
 	b2Profile m_profile;
+	b2TOIStats m_toiStats;
 };
 
 inline b2Body* b2World::GetBodyList()
@@ -355,4 +551,9 @@ inline const b2Profile& b2World::GetProfile() const
 	return m_profile;
 }
 
+inline const b2TOIStats& b2World::GetTOIStats() const
+{
+	return m_toiStats;
+}
+
 #endif
@@ -156,4 +156,23 @@ public:
 									const b2Vec2& normal, float fraction) = 0;
 };
 
+/// Callback class for shape casts.
+/// See b2World::ShapeCast
+class b2ShapeCastCallback
+{
+public:
+	virtual ~b2ShapeCastCallback() {}
+
+	/// Called for each fixture hit by the moving shape. The return value controls the cast
+	/// like b2RayCastCallback::ReportFixture.
+	/// @param fixture the fixture hit by the shape
+	/// @param point the point of first contact
+	/// @param normal the surface normal of the fixture at the point
+	/// @param fraction the fraction of the translation at which the shape touches the fixture
+	/// @return -1 to filter, 0 to terminate, fraction to clip the cast for
+	/// closest hit, 1 to continue
+	virtual float ReportFixture(	b2Fixture* fixture, const b2Vec2& point,
+									const b2Vec2& normal, float fraction) = 0;
+};
+
 #endif
@@ -0,0 +1,149 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef B2_WORLD_GROUP_H
+#define B2_WORLD_GROUP_H
+
+#include "b2_settings.h"
+#include "b2_time_of_impact.h"
+#include "b2_time_step.h"
+
+class b2StackAllocator;
+class b2TaskExecutor;
+class b2World;
+
+/// A world group steps many independent worlds together. The worlds are distributed
+/// over the workers of a task executor and each worker lends its scratch stack to the
+/// world it is stepping, so per step memory scales with the worker count rather than
+/// the world count. The group does not own the worlds.
+class b2WorldGroup
+{
+public:
+	b2WorldGroup();
+	~b2WorldGroup();
+
+	/// Set the executor used to step worlds in parallel. Pass null to step on the
+	/// calling thread. The executor must outlive the group or be cleared first.
+	/// @warning this should be called outside of Step.
+	void SetTaskExecutor(b2TaskExecutor* executor);
+
+	/// Get the task executor, may be null.
+	b2TaskExecutor* GetTaskExecutor();
+
+	/// Add a world. A world may belong to one group at a time.
+	/// @warning this should be called outside of Step.
+	void AddWorld(b2World* world);
+
+	/// Remove a world. The order of the remaining worlds may change.
+	/// @warning this should be called outside of Step.
+	void RemoveWorld(b2World* world);
+
+	/// Get the number of worlds in the group.
+	int32 GetWorldCount() const;
+
+	/// Get a world by index.
+	b2World* GetWorld(int32 index);
+
+	/// Step every world by the same time step. Worlds are stepped concurrently, so
+	/// callbacks from different worlds may run on different threads at the same time.
+	/// @param timeStep the amount of time to simulate, this should not vary.
+	/// @param velocityIterations for the velocity constraint solver.
+	/// @param positionIterations for the position constraint solver.
+	void Step(float timeStep, int32 velocityIterations, int32 positionIterations);
+
+	/// Get the profile summed over all worlds for the last step.
+	const b2Profile& GetProfile() const;
+
+	/// Get the per field maximum over all worlds for the last step.
+	const b2Profile& GetMaxProfile() const;
+
+	/// Get the time of impact statistics combined over all worlds for the last step.
+	const b2TOIStats& GetTOIStats() const;
+
+	/// Get the wall clock time of the last step in milliseconds.
+	float GetStepTime() const;
+
+private:
+
+	void CreateAllocators(int32 count);
+	void DestroyAllocators();
+
+	static void StepTask(int32 startIndex, int32 endIndex, int32 workerIndex, void* context);
+
+	b2TaskExecutor* m_executor;
+
+	b2StackAllocator* m_allocators;
+	int32 m_allocatorCount;
+
+	b2World** m_worlds;
+	int32 m_worldCount;
+	int32 m_worldCapacity;
+
+	float m_timeStep;
+	int32 m_velocityIterations;
+	int32 m_positionIterations;
+	bool m_locked;
+
+	b2Profile m_profile;
+	b2Profile m_maxProfile;
+	b2TOIStats m_toiStats;
+	float m_stepTime;
+};
+
+inline b2TaskExecutor* b2WorldGroup::GetTaskExecutor()
+{
+	return m_executor;
+}
+
+inline int32 b2WorldGroup::GetWorldCount() const
+{
+	return m_worldCount;
+}
+
+inline b2World* b2WorldGroup::GetWorld(int32 index)
+{
+	b2Assert(0 <= index && index < m_worldCount);
+	return m_worlds[index];
+}
+
+inline const b2Profile& b2WorldGroup::GetProfile() const
+{
+	return m_profile;
+}
+
+inline const b2Profile& b2WorldGroup::GetMaxProfile() const
+{
+	return m_maxProfile;
+}
+
+inline const b2TOIStats& b2WorldGroup::GetTOIStats() const
+{
+	return m_toiStats;
+}
+
+inline float b2WorldGroup::GetStepTime() const
+{
+	return m_stepTime;
+}
+
+#endif
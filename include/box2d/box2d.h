@@ -38,21 +38,31 @@ For discussion please visit http://box2d.org/forum
 #include "b2_settings.h"
 #include "b2_draw.h"
 #include "b2_timer.h"
+#include "b2_task.h"
 
+#include "b2_capsule_shape.h"
 #include "b2_chain_shape.h"
 #include "b2_circle_shape.h"
+#include "b2_compound_shape.h"
 #include "b2_edge_shape.h"
+#include "b2_heightfield_shape.h"
+#include "b2_hull.h"
 #include "b2_polygon_shape.h"
 
 #include "b2_broad_phase.h"
 #include "b2_dynamic_tree.h"
 
 #include "b2_body.h"
+#include "b2_character_mover.h"
 #include "b2_contact.h"
 #include "b2_fixture.h"
+#include "b2_fracture.h"
+#include "b2_scene.h"
+#include "b2_state_delta.h"
 #include "b2_time_step.h"
 #include "b2_world.h"
 #include "b2_world_callbacks.h"
+#include "b2_world_group.h"
 
 #include "b2_distance_joint.h"
 #include "b2_friction_joint.h"
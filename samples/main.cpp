@@ -351,9 +351,13 @@ static void UpdateUI()
 				ImGui::Separator();
 
 				ImGui::Checkbox("Sleep", &s_settings.m_enableSleep);
+				ImGui::Checkbox("Energy Sleep", &s_settings.m_enableEnergySleep);
 				ImGui::Checkbox("Warm Starting", &s_settings.m_enableWarmStarting);
 				ImGui::Checkbox("Time of Impact", &s_settings.m_enableContinuous);
 				ImGui::Checkbox("Sub-Stepping", &s_settings.m_enableSubStepping);
+				ImGui::Checkbox("Soft Step", &s_settings.m_enableSoftStep);
+				ImGui::Checkbox("Adaptive Iterations", &s_settings.m_enableAdaptiveIterations);
+				ImGui::Checkbox("Contact Caching", &s_settings.m_enableContactCaching);
 
 				ImGui::Separator();
 
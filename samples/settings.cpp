@@ -76,6 +76,10 @@ void Settings::Save()
 	fprintf(file, "  \"enableWarmStarting\": %s,\n", m_enableWarmStarting ? "true" : "false");
 	fprintf(file, "  \"enableContinuous\": %s,\n", m_enableContinuous ? "true" : "false");
 	fprintf(file, "  \"enableSubStepping\": %s,\n", m_enableSubStepping ? "true" : "false");
+	fprintf(file, "  \"enableSoftStep\": %s,\n", m_enableSoftStep ? "true" : "false");
+	fprintf(file, "  \"enableAdaptiveIterations\": %s,\n", m_enableAdaptiveIterations ? "true" : "false");
+	fprintf(file, "  \"enableContactCaching\": %s,\n", m_enableContactCaching ? "true" : "false");
+	fprintf(file, "  \"enableEnergySleep\": %s,\n", m_enableEnergySleep ? "true" : "false");
 	fprintf(file, "  \"enableSleep\": %s\n", m_enableSleep ? "true" : "false");
 	fprintf(file, "}\n");
 	fclose(file);
@@ -50,6 +50,10 @@ struct Settings
 		m_enableWarmStarting = true;
 		m_enableContinuous = true;
 		m_enableSubStepping = false;
+		m_enableSoftStep = false;
+		m_enableAdaptiveIterations = false;
+		m_enableContactCaching = false;
+		m_enableEnergySleep = false;
 		m_enableSleep = true;
 		m_pause = false;
 		m_singleStep = false;
@@ -77,6 +81,10 @@ struct Settings
 	bool m_enableWarmStarting;
 	bool m_enableContinuous;
 	bool m_enableSubStepping;
+	bool m_enableSoftStep;
+	bool m_enableAdaptiveIterations;
+	bool m_enableContactCaching;
+	bool m_enableEnergySleep;
 	bool m_enableSleep;
 	bool m_pause;
 	bool m_singleStep;
@@ -304,9 +304,13 @@ void Test::Step(Settings& settings)
 	g_debugDraw.SetFlags(flags);
 
 	m_world->SetAllowSleeping(settings.m_enableSleep);
+	m_world->SetEnergySleep(settings.m_enableEnergySleep);
 	m_world->SetWarmStarting(settings.m_enableWarmStarting);
 	m_world->SetContinuousPhysics(settings.m_enableContinuous);
 	m_world->SetSubStepping(settings.m_enableSubStepping);
+	m_world->SetSolverType(settings.m_enableSoftStep ? b2_softStepSolver : b2_ngsSolver);
+	m_world->SetAdaptiveIterations(settings.m_enableAdaptiveIterations ? 0.01f : 0.0f, 0.01f, 2);
+	m_world->SetContactCaching(settings.m_enableContactCaching ? 0.1f * b2_linearSlop : 0.0f, 0.1f * b2_angularSlop);
 
 	m_pointCount = 0;
 
@@ -346,6 +350,7 @@ void Test::Step(Settings& settings)
 		m_maxProfile.solveVelocity = b2Max(m_maxProfile.solveVelocity, p.solveVelocity);
 		m_maxProfile.solvePosition = b2Max(m_maxProfile.solvePosition, p.solvePosition);
 		m_maxProfile.solveTOI = b2Max(m_maxProfile.solveTOI, p.solveTOI);
+		m_maxProfile.solveRope = b2Max(m_maxProfile.solveRope, p.solveRope);
 		m_maxProfile.broadphase = b2Max(m_maxProfile.broadphase, p.broadphase);
 
 		m_totalProfile.step += p.step;
@@ -355,6 +360,7 @@ void Test::Step(Settings& settings)
 		m_totalProfile.solveVelocity += p.solveVelocity;
 		m_totalProfile.solvePosition += p.solvePosition;
 		m_totalProfile.solveTOI += p.solveTOI;
+		m_totalProfile.solveRope += p.solveRope;
 		m_totalProfile.broadphase += p.broadphase;
 	}
 
@@ -374,6 +380,7 @@ void Test::Step(Settings& settings)
 			aveProfile.solveVelocity = scale * m_totalProfile.solveVelocity;
 			aveProfile.solvePosition = scale * m_totalProfile.solvePosition;
 			aveProfile.solveTOI = scale * m_totalProfile.solveTOI;
+			aveProfile.solveRope = scale * m_totalProfile.solveRope;
 			aveProfile.broadphase = scale * m_totalProfile.broadphase;
 		}
 
@@ -391,8 +398,14 @@ void Test::Step(Settings& settings)
 		m_textLine += m_textIncrement;
 		g_debugDraw.DrawString(5, m_textLine, "solveTOI [ave] (max) = %5.2f [%6.2f] (%6.2f)", p.solveTOI, aveProfile.solveTOI, m_maxProfile.solveTOI);
 		m_textLine += m_textIncrement;
+		g_debugDraw.DrawString(5, m_textLine, "solveRope [ave] (max) = %5.2f [%6.2f] (%6.2f)", p.solveRope, aveProfile.solveRope, m_maxProfile.solveRope);
+		m_textLine += m_textIncrement;
 		g_debugDraw.DrawString(5, m_textLine, "broad-phase [ave] (max) = %5.2f [%6.2f] (%6.2f)", p.broadphase, aveProfile.broadphase, m_maxProfile.broadphase);
 		m_textLine += m_textIncrement;
+		g_debugDraw.DrawString(5, m_textLine, "islands/velocity iterations (max per island) = %d/%d (%d)", p.islandCount, p.velocityIterations, p.maxVelocityIterations);
+		m_textLine += m_textIncrement;
+		g_debugDraw.DrawString(5, m_textLine, "contact cache hits/misses = %d/%d", p.contactCacheHits, p.contactCacheMisses);
+		m_textLine += m_textIncrement;
 	}
 
 	if (m_bombSpawning)
@@ -66,6 +66,8 @@ public:
 
 			m_bullet->SetLinearVelocity(b2Vec2(0.0f, -50.0f));
 		}
+
+		m_toiStats.SetZero();
 	}
 
 	void Launch()
@@ -79,44 +81,31 @@ public:
 		m_bullet->SetLinearVelocity(b2Vec2(0.0f, -50.0f));
 		m_bullet->SetAngularVelocity(0.0f);
 
-		extern int32 b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
-		extern int32 b2_toiCalls, b2_toiIters, b2_toiMaxIters;
-		extern int32 b2_toiRootIters, b2_toiMaxRootIters;
-
-		b2_gjkCalls = 0;
-		b2_gjkIters = 0;
-		b2_gjkMaxIters = 0;
-
-		b2_toiCalls = 0;
-		b2_toiIters = 0;
-		b2_toiMaxIters = 0;
-		b2_toiRootIters = 0;
-		b2_toiMaxRootIters = 0;
+		m_toiStats.SetZero();
 	}
 
 	void Step(Settings& settings) override
 	{
 		Test::Step(settings);
 
-		extern int32 b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
-		extern int32 b2_toiCalls, b2_toiIters;
-		extern int32 b2_toiRootIters, b2_toiMaxRootIters;
+		m_toiStats.Combine(m_world->GetTOIStats());
+		const b2TOIStats& stats = m_toiStats;
 
-		if (b2_gjkCalls > 0)
+		if (stats.gjkCalls > 0)
 		{
 			g_debugDraw.DrawString(5, m_textLine, "gjk calls = %d, ave gjk iters = %3.1f, max gjk iters = %d",
-				b2_gjkCalls, b2_gjkIters / float(b2_gjkCalls), b2_gjkMaxIters);
+				stats.gjkCalls, stats.gjkIters / float(stats.gjkCalls), stats.gjkMaxIters);
 			m_textLine += m_textIncrement;
 		}
 
-		if (b2_toiCalls > 0)
+		if (stats.toiCalls > 0)
 		{
 			g_debugDraw.DrawString(5, m_textLine, "toi calls = %d, ave toi iters = %3.1f, max toi iters = %d",
-				b2_toiCalls, b2_toiIters / float(b2_toiCalls), b2_toiMaxRootIters);
+				stats.toiCalls, stats.toiIters / float(stats.toiCalls), stats.toiMaxIters);
 			m_textLine += m_textIncrement;
 
 			g_debugDraw.DrawString(5, m_textLine, "ave toi root iters = %3.1f, max toi root iters = %d",
-				b2_toiRootIters / float(b2_toiCalls), b2_toiMaxRootIters);
+				stats.toiRootIters / float(stats.toiCalls), stats.toiMaxRootIters);
 			m_textLine += m_textIncrement;
 		}
 
@@ -134,6 +123,7 @@ public:
 	b2Body* m_body;
 	b2Body* m_bullet;
 	float m_x;
+	b2TOIStats m_toiStats;
 };
 
 static int testIndex = RegisterTest("Continuous", "Bullet Test", BulletTest::Create);
@@ -0,0 +1,199 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "settings.h"
+#include "test.h"
+
+// Kinematic characters moved with b2CharacterMover. They walk onto steps, up and down
+// walkable slopes and are stopped by steep slopes, walls and dynamic bodies.
+class CharacterMover : public Test
+{
+public:
+
+	enum
+	{
+		e_walkerCount = 8
+	};
+
+	CharacterMover()
+	{
+		{
+			b2BodyDef bd;
+			b2Body* ground = m_world->CreateBody(&bd);
+
+			b2Vec2 vs[10];
+			vs[0].Set(-30.0f, 10.0f);
+			vs[1].Set(-30.0f, 0.0f);
+			vs[2].Set(-12.0f, 0.0f);
+			vs[3].Set(-12.0f, 0.25f);
+			vs[4].Set(-8.0f, 0.25f);
+			vs[5].Set(-8.0f, 0.0f);
+			vs[6].Set(0.0f, 0.0f);
+			vs[7].Set(6.0f, 3.0f);
+			vs[8].Set(14.0f, 3.0f);
+			vs[9].Set(16.0f, 7.0f);
+
+			b2ChainShape shape;
+			shape.CreateChain(vs, 10);
+			ground->CreateFixture(&shape, 0.0f);
+		}
+
+		for (int32 i = 0; i < 3; ++i)
+		{
+			b2BodyDef bd;
+			bd.type = b2_dynamicBody;
+			bd.position.Set(-20.0f + 3.0f * i, 0.5f);
+			b2Body* body = m_world->CreateBody(&bd);
+
+			b2PolygonShape box;
+			box.SetAsBox(0.5f, 0.5f);
+			body->CreateFixture(&box, 1.0f);
+		}
+
+		m_circle.m_radius = 0.5f;
+
+		b2CharacterMoverDef md;
+		md.shape = &m_circle;
+		md.stepHeight = 0.3f;
+
+		md.position.Set(-4.0f, 0.5f);
+		m_player = new b2CharacterMover(m_world, &md);
+		m_playerVelocity.SetZero();
+
+		for (int32 i = 0; i < e_walkerCount; ++i)
+		{
+			md.position.Set(-28.0f + 5.0f * i, 2.0f);
+			m_walkers[i] = new b2CharacterMover(m_world, &md);
+			m_walkerVelocity[i].Set(i % 2 == 0 ? 3.0f : -3.0f, 0.0f);
+		}
+	}
+
+	~CharacterMover()
+	{
+		delete m_player;
+		for (int32 i = 0; i < e_walkerCount; ++i)
+		{
+			delete m_walkers[i];
+		}
+	}
+
+	// Move a character with gravity. The vertical velocity is reset on the ground and when
+	// the character bumps its head.
+	static void MoveCharacter(b2CharacterMover* mover, b2Vec2* velocity, float dt)
+	{
+		velocity->y -= 10.0f * dt;
+
+		b2Vec2 displacement = dt * *velocity;
+		b2Vec2 done = mover->Move(displacement);
+
+		if (mover->IsGrounded() || (velocity->y > 0.0f && done.y < 0.5f * displacement.y))
+		{
+			velocity->y = 0.0f;
+		}
+	}
+
+	static void DrawCharacter(const b2CharacterMover* mover, float radius, const b2Color& color)
+	{
+		g_debugDraw.DrawSolidCircle(mover->GetPosition(), radius, b2Vec2(1.0f, 0.0f), color);
+
+		const b2CharacterPlane* planes = mover->GetPlanes();
+		for (int32 i = 0; i < mover->GetPlaneCount(); ++i)
+		{
+			b2Color planeColor = planes[i].walkable ? b2Color(0.3f, 0.9f, 0.3f) : b2Color(0.9f, 0.3f, 0.3f);
+			g_debugDraw.DrawPoint(planes[i].point, 5.0f, planeColor);
+			g_debugDraw.DrawSegment(planes[i].point, planes[i].point + 0.5f * planes[i].normal, planeColor);
+		}
+	}
+
+	void Step(Settings& settings) override
+	{
+		Test::Step(settings);
+
+		float dt = settings.m_hertz > 0.0f ? 1.0f / settings.m_hertz : 0.0f;
+		if (settings.m_pause == 1 && settings.m_singleStep == 0)
+		{
+			dt = 0.0f;
+		}
+
+		if (dt > 0.0f)
+		{
+			m_playerVelocity.x = 0.0f;
+			if (glfwGetKey(g_mainWindow, GLFW_KEY_A) == GLFW_PRESS)
+			{
+				m_playerVelocity.x -= 5.0f;
+			}
+
+			if (glfwGetKey(g_mainWindow, GLFW_KEY_D) == GLFW_PRESS)
+			{
+				m_playerVelocity.x += 5.0f;
+			}
+
+			if (glfwGetKey(g_mainWindow, GLFW_KEY_W) == GLFW_PRESS && m_player->IsGrounded())
+			{
+				m_playerVelocity.y = 7.0f;
+			}
+
+			MoveCharacter(m_player, &m_playerVelocity, dt);
+
+			// The walkers turn around when they are blocked.
+			for (int32 i = 0; i < e_walkerCount; ++i)
+			{
+				b2Vec2 start = m_walkers[i]->GetPosition();
+				MoveCharacter(m_walkers[i], m_walkerVelocity + i, dt);
+
+				float progress = m_walkers[i]->GetPosition().x - start.x;
+				if (b2Abs(progress) < 0.1f * dt * b2Abs(m_walkerVelocity[i].x))
+				{
+					m_walkerVelocity[i].x = -m_walkerVelocity[i].x;
+				}
+			}
+		}
+
+		DrawCharacter(m_player, m_circle.m_radius, b2Color(0.9f, 0.9f, 0.4f));
+
+		int32 queryCount = m_player->GetQueryCount();
+		for (int32 i = 0; i < e_walkerCount; ++i)
+		{
+			DrawCharacter(m_walkers[i], m_circle.m_radius, b2Color(0.4f, 0.7f, 0.9f));
+			queryCount += m_walkers[i]->GetQueryCount();
+		}
+
+		g_debugDraw.DrawString(5, m_textLine, "Keys: left = a, right = d, jump = w");
+		m_textLine += m_textIncrement;
+		g_debugDraw.DrawString(5, m_textLine, "grounded = %d, broad-phase queries = %d", m_player->IsGrounded(), queryCount);
+		m_textLine += m_textIncrement;
+	}
+
+	static Test* Create()
+	{
+		return new CharacterMover;
+	}
+
+	b2CircleShape m_circle;
+	b2CharacterMover* m_player;
+	b2Vec2 m_playerVelocity;
+	b2CharacterMover* m_walkers[e_walkerCount];
+	b2Vec2 m_walkerVelocity[e_walkerCount];
+};
+
+static int testIndex = RegisterTest("Examples", "Character Mover", CharacterMover::Create);
@@ -127,13 +127,16 @@ public:
 			b2PolygonShape right;
 			right.SetAsBox(0.15f, 2.7f, b2Vec2(1.45f, 2.35f), -0.2f);
 
+			// The basket is one compound fixture with a single broad-phase proxy.
+			const b2Shape* children[3] = { &bottom, &left, &right };
+			b2CompoundShape basket;
+			basket.Create(children, 3);
+
 			b2BodyDef bd;
 			bd.type = b2_dynamicBody;
 			bd.position.Set( 0.0f, 2.0f );
 			b2Body* body = m_world->CreateBody(&bd);
-			body->CreateFixture(&bottom, 4.0f);
-			body->CreateFixture(&left, 4.0f);
-			body->CreateFixture(&right, 4.0f);
+			body->CreateFixture(&basket, 4.0f);
 		}
 	}
 
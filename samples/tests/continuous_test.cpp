@@ -81,28 +81,12 @@ public:
 		}
 #endif
 
-		extern int32 b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
-		extern int32 b2_toiCalls, b2_toiIters;
-		extern int32 b2_toiRootIters, b2_toiMaxRootIters;
-		extern float b2_toiTime, b2_toiMaxTime;
-
-		b2_gjkCalls = 0; b2_gjkIters = 0; b2_gjkMaxIters = 0;
-		b2_toiCalls = 0; b2_toiIters = 0;
-		b2_toiRootIters = 0; b2_toiMaxRootIters = 0;
-		b2_toiTime = 0.0f; b2_toiMaxTime = 0.0f;
+		m_toiStats.SetZero();
 	}
 
 	void Launch()
 	{
-		extern int32 b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
-		extern int32 b2_toiCalls, b2_toiIters;
-		extern int32 b2_toiRootIters, b2_toiMaxRootIters;
-		extern float b2_toiTime, b2_toiMaxTime;
-
-		b2_gjkCalls = 0; b2_gjkIters = 0; b2_gjkMaxIters = 0;
-		b2_toiCalls = 0; b2_toiIters = 0;
-		b2_toiRootIters = 0; b2_toiMaxRootIters = 0;
-		b2_toiTime = 0.0f; b2_toiMaxTime = 0.0f;
+		m_toiStats.SetZero();
 
 		m_body->SetTransform(b2Vec2(0.0f, 20.0f), 0.0f);
 		m_angularVelocity = RandomFloat(-50.0f, 50.0f);
@@ -114,31 +98,28 @@ public:
 	{
 		Test::Step(settings);
 
-		extern int32 b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
+		m_toiStats.Combine(m_world->GetTOIStats());
+		const b2TOIStats& stats = m_toiStats;
 
-		if (b2_gjkCalls > 0)
+		if (stats.gjkCalls > 0)
 		{
 			g_debugDraw.DrawString(5, m_textLine, "gjk calls = %d, ave gjk iters = %3.1f, max gjk iters = %d",
-				b2_gjkCalls, b2_gjkIters / float(b2_gjkCalls), b2_gjkMaxIters);
+				stats.gjkCalls, stats.gjkIters / float(stats.gjkCalls), stats.gjkMaxIters);
 			m_textLine += m_textIncrement;
 		}
 
-		extern int32 b2_toiCalls, b2_toiIters;
-		extern int32 b2_toiRootIters, b2_toiMaxRootIters;
-		extern float b2_toiTime, b2_toiMaxTime;
-
-		if (b2_toiCalls > 0)
+		if (stats.toiCalls > 0)
 		{
 			g_debugDraw.DrawString(5, m_textLine, "toi calls = %d, ave [max] toi iters = %3.1f [%d]",
-								b2_toiCalls, b2_toiIters / float(b2_toiCalls), b2_toiMaxRootIters);
+								stats.toiCalls, stats.toiIters / float(stats.toiCalls), stats.toiMaxIters);
 			m_textLine += m_textIncrement;
 			
 			g_debugDraw.DrawString(5, m_textLine, "ave [max] toi root iters = %3.1f [%d]",
-				b2_toiRootIters / float(b2_toiCalls), b2_toiMaxRootIters);
+				stats.toiRootIters / float(stats.toiCalls), stats.toiMaxRootIters);
 			m_textLine += m_textIncrement;
 
 			g_debugDraw.DrawString(5, m_textLine, "ave [max] toi time = %.1f [%.1f] (microseconds)",
-				1000.0f * b2_toiTime / float(b2_toiCalls), 1000.0f * b2_toiMaxTime);
+				1000.0f * stats.toiTime / float(stats.toiCalls), 1000.0f * stats.toiMaxTime);
 			m_textLine += m_textIncrement;
 		}
 
@@ -155,6 +136,7 @@ public:
 
 	b2Body* m_body;
 	float m_angularVelocity;
+	b2TOIStats m_toiStats;
 };
 
 static int testIndex = RegisterTest("Continuous", "Continuous Test", ContinuousTest::Create);
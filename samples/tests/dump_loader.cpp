@@ -22,7 +22,8 @@
 
 #include "test.h"
 
-// This test holds worlds dumped using b2World::Dump.
+// This test holds worlds dumped using b2World::Dump. The world is then
+// saved and reloaded using the binary scene format.
 class DumpLoader : public Test
 {
 public:
@@ -167,6 +168,33 @@ public:
 		joints = NULL;
 		bodies = NULL;
 
+		// Reload the dumped world through the binary scene format.
+		int32 sceneSize = b2GetSceneSize(m_world);
+		void* scene = b2Alloc(sceneSize);
+		b2SaveScene(m_world, scene, sceneSize);
+
+		// The scene keeps the body list order, so the ground body can be found again.
+		int32 groundIndex = 0;
+		int32 bodyCount = m_world->GetBodyCount();
+		b2Body* body = m_world->GetBodyList();
+		for (int32 i = 0; body; ++i)
+		{
+			b2Body* next = body->GetNext();
+			if (body == m_groundBody)
+			{
+				groundIndex = i;
+			}
+			m_world->DestroyBody(body);
+			body = next;
+		}
+
+		bodies = (b2Body**)b2Alloc(bodyCount * sizeof(b2Body*));
+		bool loaded = b2LoadScene(m_world, scene, sceneSize, bodies);
+		b2Assert(loaded);
+		B2_NOT_USED(loaded);
+		m_groundBody = bodies[groundIndex];
+		b2Free(bodies);
+		b2Free(scene);
 	}
 
 	static Test* Create()
@@ -0,0 +1,120 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "test.h"
+
+// Slabs that shatter into Voronoi fragments when they hit hard enough.
+class Fracture : public Test
+{
+public:
+
+	enum
+	{
+		e_count = 6
+	};
+
+	Fracture()
+	{
+		{
+			b2BodyDef bd;
+			b2Body* ground = m_world->CreateBody(&bd);
+
+			b2EdgeShape shape;
+			shape.Set(b2Vec2(-40.0f, 0.0f), b2Vec2(40.0f, 0.0f));
+			ground->CreateFixture(&shape, 0.0f);
+		}
+
+		m_pattern.CreateRadial(3, 7);
+
+		// The slabs are marked with user data, so the fragments do not break again.
+		for (int32 i = 0; i < e_count; ++i)
+		{
+			b2BodyDef bd;
+			bd.type = b2_dynamicBody;
+			bd.position.Set(-15.0f + 6.0f * i, 10.0f + 4.0f * i);
+			bd.angle = 0.1f * i;
+			bd.userData = this;
+			b2Body* body = m_world->CreateBody(&bd);
+
+			b2PolygonShape slab;
+			slab.SetAsBox(2.0f, 0.5f);
+			body->CreateFixture(&slab, 1.0f);
+
+			b2PolygonShape post;
+			post.SetAsBox(0.4f, 1.0f, b2Vec2(0.0f, 1.5f), 0.0f);
+			body->CreateFixture(&post, 1.0f);
+		}
+
+		m_fragmentCount = 0;
+	}
+
+	void PostSolve(b2Contact* contact, const b2ContactImpulse* impulse) override
+	{
+		int32 count = contact->GetManifold()->pointCount;
+
+		float maxImpulse = 0.0f;
+		for (int32 i = 0; i < count; ++i)
+		{
+			maxImpulse = b2Max(maxImpulse, impulse->normalImpulses[i]);
+		}
+
+		if (count == 0 || maxImpulse < 30.0f)
+		{
+			return;
+		}
+
+		b2WorldManifold worldManifold;
+		contact->GetWorldManifold(&worldManifold);
+
+		// The world is locked, so the break is queued.
+		b2Body* bodies[2] = { contact->GetFixtureA()->GetBody(), contact->GetFixtureB()->GetBody() };
+		for (int32 i = 0; i < 2; ++i)
+		{
+			if (bodies[i]->GetUserData() == this)
+			{
+				float sign = i == 0 ? -1.0f : 1.0f;
+				m_queue.Add(bodies[i], &m_pattern, worldManifold.points[0], sign * maxImpulse * worldManifold.normal);
+			}
+		}
+	}
+
+	void Step(Settings& settings) override
+	{
+		Test::Step(settings);
+
+		m_fragmentCount += m_queue.Process(2 * m_pattern.GetCellCount());
+
+		g_debugDraw.DrawString(5, m_textLine, "fragments = %d", m_fragmentCount);
+		m_textLine += m_textIncrement;
+	}
+
+	static Test* Create()
+	{
+		return new Fracture;
+	}
+
+	b2FracturePattern m_pattern;
+	b2FractureQueue m_queue;
+	int32 m_fragmentCount;
+};
+
+static int testIndex = RegisterTest("Examples", "Fracture", Fracture::Create);
@@ -75,6 +75,22 @@ public:
 				g_debugDraw->DrawPolygon(vertices, vertexCount, color);
 			}
 			break;
+
+		case b2Shape::e_capsule:
+			{
+				b2CapsuleShape* capsule = (b2CapsuleShape*)fixture->GetShape();
+				b2Vec2 v1 = b2Mul(xf, capsule->m_vertex1);
+				b2Vec2 v2 = b2Mul(xf, capsule->m_vertex2);
+				b2Vec2 offset = b2Cross(1.0f, v2 - v1);
+				offset.Normalize();
+				offset *= capsule->m_radius;
+
+				g_debugDraw->DrawCircle(v1, capsule->m_radius, color);
+				g_debugDraw->DrawCircle(v2, capsule->m_radius, color);
+				g_debugDraw->DrawSegment(v1 + offset, v2 + offset, color);
+				g_debugDraw->DrawSegment(v1 - offset, v2 - offset, color);
+			}
+			break;
 				
 		default:
 			break;
@@ -173,6 +189,10 @@ public:
 			m_circle.m_radius = 0.5f;
 		}
 
+		{
+			m_capsule.Set(b2Vec2(-0.5f, 0.0f), b2Vec2(0.5f, 0.0f), 0.25f);
+		}
+
 		m_bodyIndex = 0;
 		memset(m_bodies, 0, sizeof(m_bodies));
 	}
@@ -207,7 +227,7 @@ public:
 			fd.friction = 0.3f;
 			m_bodies[m_bodyIndex]->CreateFixture(&fd);
 		}
-		else
+		else if (index == 4)
 		{
 			b2FixtureDef fd;
 			fd.shape = &m_circle;
@@ -216,6 +236,15 @@ public:
 
 			m_bodies[m_bodyIndex]->CreateFixture(&fd);
 		}
+		else
+		{
+			b2FixtureDef fd;
+			fd.shape = &m_capsule;
+			fd.density = 1.0f;
+			fd.friction = 0.3f;
+
+			m_bodies[m_bodyIndex]->CreateFixture(&fd);
+		}
 
 		m_bodyIndex = (m_bodyIndex + 1) % e_maxBodies;
 	}
@@ -242,6 +271,7 @@ public:
 		case GLFW_KEY_3:
 		case GLFW_KEY_4:
 		case GLFW_KEY_5:
+		case GLFW_KEY_6:
 			Create(key - GLFW_KEY_1);
 			break;
 
@@ -280,7 +310,7 @@ public:
 		b2Color color(0.4f, 0.7f, 0.8f);
 		g_debugDraw.DrawCircle(callback.m_circle.m_p, callback.m_circle.m_radius, color);
 
-		g_debugDraw.DrawString(5, m_textLine, "Press 1-5 to drop stuff");
+		g_debugDraw.DrawString(5, m_textLine, "Press 1-6 to drop stuff");
 		m_textLine += m_textIncrement;
 		g_debugDraw.DrawString(5, m_textLine, "Press 'a' to (de)activate some bodies");
 		m_textLine += m_textIncrement;
@@ -297,6 +327,7 @@ public:
 	b2Body* m_bodies[e_maxBodies];
 	b2PolygonShape m_polygons[4];
 	b2CircleShape m_circle;
+	b2CapsuleShape m_capsule;
 };
 
 static int testIndex = RegisterTest("Geometry", "Polygon Shapes", PolygonShapes::Create);
@@ -24,6 +24,8 @@
 
 /// This stress tests the dynamic tree broad-phase. This also shows that tile
 /// based collision is _not_ smooth due to Box2D not knowing about adjacency.
+/// The heightfield variant replaces the tiles with a single heightfield fixture
+/// that knows its neighbors and uses one broad-phase proxy.
 class Tiles : public Test
 {
 public:
@@ -32,11 +34,32 @@ public:
 		e_count = 20
 	};
 
-	Tiles()
+	Tiles(bool heightfield)
 	{
 		m_fixtureCount = 0;
 		b2Timer timer;
 
+		if (heightfield)
+		{
+			float a = 0.5f;
+			const int32 N = 200;
+
+			b2BodyDef bd;
+			bd.position.Set(-N * a - a, 0.0f);
+			b2Body* ground = m_world->CreateBody(&bd);
+
+			int16 heights[N + 1];
+			for (int32 i = 0; i <= N; ++i)
+			{
+				heights[i] = 0;
+			}
+
+			b2HeightfieldShape shape;
+			shape.Create(heights, N + 1, 2.0f * a, a);
+			ground->CreateFixture(&shape, 0.0f);
+			++m_fixtureCount;
+		}
+		else
 		{
 			float a = 0.5f;
 			b2BodyDef bd;
@@ -149,7 +172,12 @@ public:
 
 	static Test* Create()
 	{
-		return new Tiles;
+		return new Tiles(false);
+	}
+
+	static Test* CreateHeightfield()
+	{
+		return new Tiles(true);
 	}
 
 	int32 m_fixtureCount;
@@ -157,3 +185,4 @@ public:
 };
 
 static int testIndex = RegisterTest("Benchmark", "Tiles", Tiles::Create);
+static int testIndex2 = RegisterTest("Benchmark", "Tiles Heightfield", Tiles::CreateHeightfield);
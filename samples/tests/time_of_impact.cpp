@@ -66,14 +66,17 @@ public:
 		input.tMax = 1.0f;
 
 		b2TOIOutput output;
+		b2SimplexCache cache;
+		cache.count = 0;
+		b2TOIStats stats;
+		stats.SetZero();
 
-		b2TimeOfImpact(&output, &input);
+		b2TimeOfImpact(&output, &input, &cache, &stats);
 
 		g_debugDraw.DrawString(5, m_textLine, "toi = %g", output.t);
 		m_textLine += m_textIncrement;
 
-		extern int32 b2_toiMaxIters, b2_toiMaxRootIters;
-		g_debugDraw.DrawString(5, m_textLine, "max toi iters = %d, max root iters = %d", b2_toiMaxIters, b2_toiMaxRootIters);
+		g_debugDraw.DrawString(5, m_textLine, "max toi iters = %d, max root iters = %d", stats.toiMaxIters, stats.toiMaxRootIters);
 		m_textLine += m_textIncrement;
 
 		b2Vec2 vertices[b2_maxPolygonVertices];
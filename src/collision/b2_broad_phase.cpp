@@ -25,6 +25,8 @@
 b2BroadPhase::b2BroadPhase()
 {
 	m_proxyCount = 0;
+	m_revision = 0;
+	m_changeFloor = 0;
 
 	m_pairCapacity = 16;
 	m_pairCount = 0;
@@ -45,6 +47,7 @@ int32 b2BroadPhase::CreateProxy(const b2AABB& aabb, void* userData)
 {
 	int32 proxyId = m_tree.CreateProxy(aabb, userData);
 	++m_proxyCount;
+	RecordChange(m_tree.GetFatAABB(proxyId));
 	BufferMove(proxyId);
 	return proxyId;
 }
@@ -53,6 +56,7 @@ void b2BroadPhase::DestroyProxy(int32 proxyId)
 {
 	UnBufferMove(proxyId);
 	--m_proxyCount;
+	RecordChange(m_tree.GetFatAABB(proxyId));
 	m_tree.DestroyProxy(proxyId);
 }
 
@@ -61,10 +65,37 @@ void b2BroadPhase::MoveProxy(int32 proxyId, const b2AABB& aabb, const b2Vec2& di
 	bool buffer = m_tree.MoveProxy(proxyId, aabb, displacement);
 	if (buffer)
 	{
+		RecordChange(m_tree.GetFatAABB(proxyId));
 		BufferMove(proxyId);
 	}
 }
 
+void b2BroadPhase::RecordChange(const b2AABB& aabb)
+{
+	++m_revision;
+	m_changes[m_revision & (e_changeCapacity - 1)] = aabb;
+}
+
+bool b2BroadPhase::TestChanges(uint32 revision, const b2AABB& aabb) const
+{
+	// Unsigned differences stay correct when the revision wraps around.
+	uint32 count = m_revision - revision;
+	if (count > m_revision - m_changeFloor || count > e_changeCapacity)
+	{
+		return true;
+	}
+
+	for (uint32 i = 1; i <= count; ++i)
+	{
+		if (b2TestOverlap(m_changes[(revision + i) & (e_changeCapacity - 1)], aabb))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
 void b2BroadPhase::TouchProxy(int32 proxyId)
 {
 	BufferMove(proxyId);
@@ -121,3 +152,47 @@ bool b2BroadPhase::QueryCallback(int32 proxyId)
 
 	return true;
 }
+
+int32 b2BroadPhase::GetStateSize() const
+{
+	return int32(2 * sizeof(int32) + m_moveCount * sizeof(int32)) + m_tree.GetStateSize();
+}
+
+int32 b2BroadPhase::SaveState(void* buffer) const
+{
+	char* data = (char*)buffer;
+	memcpy(data, &m_proxyCount, sizeof(int32));
+	memcpy(data + sizeof(int32), &m_moveCount, sizeof(int32));
+	data += 2 * sizeof(int32);
+	memcpy(data, m_moveBuffer, m_moveCount * sizeof(int32));
+	data += m_moveCount * sizeof(int32);
+	data += m_tree.SaveState(data);
+	return int32(data - (char*)buffer);
+}
+
+int32 b2BroadPhase::RestoreState(const void* buffer)
+{
+	const char* data = (const char*)buffer;
+
+	int32 proxyCount, moveCount;
+	memcpy(&proxyCount, data, sizeof(int32));
+	memcpy(&moveCount, data + sizeof(int32), sizeof(int32));
+	data += 2 * sizeof(int32);
+
+	b2Assert(proxyCount == m_proxyCount);
+
+	if (moveCount > m_moveCapacity)
+	{
+		b2Free(m_moveBuffer);
+		m_moveCapacity = moveCount;
+		m_moveBuffer = (int32*)b2Alloc(m_moveCapacity * sizeof(int32));
+	}
+
+	m_moveCount = moveCount;
+	memcpy(m_moveBuffer, data, m_moveCount * sizeof(int32));
+	data += m_moveCount * sizeof(int32);
+	data += m_tree.RestoreState(data);
+	++m_revision;
+	m_changeFloor = m_revision;
+	return int32(data - (const char*)buffer);
+}
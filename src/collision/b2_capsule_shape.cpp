@@ -0,0 +1,190 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "box2d/b2_capsule_shape.h"
+#include "box2d/b2_block_allocator.h"
+
+#include <new>
+
+void b2CapsuleShape::Set(const b2Vec2& v1, const b2Vec2& v2, float radius)
+{
+	b2Assert(b2DistanceSquared(v1, v2) > b2_linearSlop * b2_linearSlop);
+	b2Assert(radius > 0.0f);
+	m_vertex1 = v1;
+	m_vertex2 = v2;
+	m_radius = radius;
+}
+
+b2Shape* b2CapsuleShape::Clone(b2BlockAllocator* allocator) const
+{
+	void* mem = allocator->Allocate(sizeof(b2CapsuleShape));
+	b2CapsuleShape* clone = new (mem) b2CapsuleShape;
+	*clone = *this;
+	return clone;
+}
+
+int32 b2CapsuleShape::GetChildCount() const
+{
+	return 1;
+}
+
+bool b2CapsuleShape::TestPoint(const b2Transform& transform, const b2Vec2& p) const
+{
+	b2Vec2 q = b2MulT(transform, p);
+	b2Vec2 e = m_vertex2 - m_vertex1;
+	float s = b2Clamp(b2Dot(q - m_vertex1, e) / b2Dot(e, e), 0.0f, 1.0f);
+	b2Vec2 d = q - (m_vertex1 + s * e);
+	return b2Dot(d, d) <= m_radius * m_radius;
+}
+
+// Ray versus one of the end circles. Same as b2CircleShape::RayCast.
+static bool b2RayCastCap(float* fraction, b2Vec2* normal, const b2Vec2& p1, const b2Vec2& r,
+						 float maxFraction, const b2Vec2& center, float radius)
+{
+	b2Vec2 s = p1 - center;
+	float b = b2Dot(s, s) - radius * radius;
+	float c = b2Dot(s, r);
+	float rr = b2Dot(r, r);
+	float sigma = c * c - rr * b;
+	if (sigma < 0.0f || rr < b2_epsilon)
+	{
+		return false;
+	}
+
+	float a = -(c + b2Sqrt(sigma));
+	if (0.0f <= a && a <= maxFraction * rr)
+	{
+		a /= rr;
+		*fraction = a;
+		*normal = s + a * r;
+		normal->Normalize();
+		return true;
+	}
+
+	return false;
+}
+
+// The capsule is the union of a rectangle and two circles. The ray enters the capsule
+// where it first enters one of these. A ray entering the rectangle through a short end
+// is already inside a circle, so only the long side facing the ray is tested.
+bool b2CapsuleShape::RayCast(b2RayCastOutput* output, const b2RayCastInput& input,
+							const b2Transform& xf, int32 childIndex) const
+{
+	B2_NOT_USED(childIndex);
+
+	// Put the ray into the capsule's frame of reference.
+	b2Vec2 p1 = b2MulT(xf.q, input.p1 - xf.p);
+	b2Vec2 p2 = b2MulT(xf.q, input.p2 - xf.p);
+	b2Vec2 d = p2 - p1;
+
+	b2Vec2 axis = m_vertex2 - m_vertex1;
+	float length = axis.Normalize();
+	b2Vec2 normal(-axis.y, axis.x);
+
+	// Rays starting inside do not hit, like polygons.
+	float s1 = b2Clamp(b2Dot(p1 - m_vertex1, axis), 0.0f, length);
+	if (b2DistanceSquared(p1, m_vertex1 + s1 * axis) <= m_radius * m_radius)
+	{
+		return false;
+	}
+
+	float fraction = input.maxFraction;
+	b2Vec2 hitNormal;
+	bool hit = false;
+
+	// Long side facing the ray origin
+	float offset = b2Dot(p1 - m_vertex1, normal);
+	float speed = b2Dot(d, normal);
+	if (b2Abs(offset) > m_radius && offset * speed < 0.0f)
+	{
+		float side = offset > 0.0f ? 1.0f : -1.0f;
+		float t = (side * m_radius - offset) / speed;
+		float s = b2Dot(p1 + t * d - m_vertex1, axis);
+		if (0.0f <= t && t <= fraction && 0.0f <= s && s <= length)
+		{
+			fraction = t;
+			hitNormal = side * normal;
+			hit = true;
+		}
+	}
+
+	// End circles
+	float t;
+	b2Vec2 n;
+	if (b2RayCastCap(&t, &n, p1, d, fraction, m_vertex1, m_radius))
+	{
+		fraction = t;
+		hitNormal = n;
+		hit = true;
+	}
+
+	if (b2RayCastCap(&t, &n, p1, d, fraction, m_vertex2, m_radius))
+	{
+		fraction = t;
+		hitNormal = n;
+		hit = true;
+	}
+
+	if (hit == false)
+	{
+		return false;
+	}
+
+	output->fraction = fraction;
+	output->normal = b2Mul(xf.q, hitNormal);
+	return true;
+}
+
+void b2CapsuleShape::ComputeAABB(b2AABB* aabb, const b2Transform& xf, int32 childIndex) const
+{
+	B2_NOT_USED(childIndex);
+
+	b2Vec2 v1 = b2Mul(xf, m_vertex1);
+	b2Vec2 v2 = b2Mul(xf, m_vertex2);
+
+	b2Vec2 r(m_radius, m_radius);
+	aabb->lowerBound = b2Min(v1, v2) - r;
+	aabb->upperBound = b2Max(v1, v2) + r;
+}
+
+// The mass is a rectangle plus two half circles. Each half circle is moved to its end of
+// the rectangle with the parallel axis theorem, via the half circle centroid 4r/(3pi).
+void b2CapsuleShape::ComputeMass(b2MassData* massData, float density) const
+{
+	float rr = m_radius * m_radius;
+	float length = b2Distance(m_vertex1, m_vertex2);
+	float ll = length * length;
+
+	float circleMass = density * b2_pi * rr;
+	float boxMass = density * 2.0f * m_radius * length;
+
+	massData->mass = circleMass + boxMass;
+	massData->center = 0.5f * (m_vertex1 + m_vertex2);
+
+	float lc = 4.0f * m_radius / (3.0f * b2_pi);
+	float h = 0.5f * length;
+	float circleInertia = circleMass * (0.5f * rr + h * h + 2.0f * h * lc);
+	float boxInertia = boxMass * (4.0f * rr + ll) / 12.0f;
+
+	// inertia about the local origin
+	massData->I = circleInertia + boxInertia + massData->mass * b2Dot(massData->center, massData->center);
+}
@@ -38,6 +38,10 @@ void b2ChainShape::Clear()
 	b2Free(m_vertices);
 	m_vertices = nullptr;
 	m_count = 0;
+
+	b2Free(m_nodes);
+	m_nodes = nullptr;
+	m_nodeCount = 0;
 }
 
 void b2ChainShape::CreateLoop(const b2Vec2* vertices, int32 count)
@@ -109,9 +113,37 @@ b2Shape* b2ChainShape::Clone(b2BlockAllocator* allocator) const
 	clone->m_nextVertex = m_nextVertex;
 	clone->m_hasPrevVertex = m_hasPrevVertex;
 	clone->m_hasNextVertex = m_hasNextVertex;
+	if (m_nodes != nullptr)
+	{
+		clone->m_nodeCount = m_nodeCount;
+		clone->m_nodes = (b2StaticTreeNode*)b2Alloc(m_nodeCount * sizeof(b2StaticTreeNode));
+		memcpy(clone->m_nodes, m_nodes, m_nodeCount * sizeof(b2StaticTreeNode));
+	}
 	return clone;
 }
 
+void b2ChainShape::CreateTree()
+{
+	b2Assert(m_count >= 2);
+
+	b2Free(m_nodes);
+
+	// The leaves use the segment AABBs of ComputeAABB.
+	int32 segmentCount = m_count - 1;
+	b2AABB* boxes = (b2AABB*)b2Alloc(segmentCount * sizeof(b2AABB));
+	for (int32 i = 0; i < segmentCount; ++i)
+	{
+		boxes[i].lowerBound = b2Min(m_vertices[i], m_vertices[i + 1]);
+		boxes[i].upperBound = b2Max(m_vertices[i], m_vertices[i + 1]);
+	}
+
+	m_nodeCount = 2 * segmentCount - 1;
+	m_nodes = (b2StaticTreeNode*)b2Alloc(m_nodeCount * sizeof(b2StaticTreeNode));
+	b2BuildStaticTree(m_nodes, boxes, segmentCount);
+
+	b2Free(boxes);
+}
+
 int32 b2ChainShape::GetChildCount() const
 {
 	// edge count = vertex count - 1
@@ -177,6 +209,12 @@ bool b2ChainShape::RayCast(b2RayCastOutput* output, const b2RayCastInput& input,
 	return edgeShape.RayCast(output, input, xf, 0);
 }
 
+bool b2ChainShape::RayCastTree(b2RayCastOutput* output, const b2RayCastInput& input, const b2Transform& xf) const
+{
+	b2Assert(m_nodes != nullptr);
+	return b2RayCastStaticTree(m_nodes, m_nodeCount, this, output, input, xf);
+}
+
 void b2ChainShape::ComputeAABB(b2AABB* aabb, const b2Transform& xf, int32 childIndex) const
 {
 	b2Assert(childIndex < m_count);
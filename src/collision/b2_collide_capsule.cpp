@@ -0,0 +1,221 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "box2d/b2_collision.h"
+#include "box2d/b2_capsule_shape.h"
+
+// Clip the incident segment to the extent of the reference segment and keep the points
+// within the total radius. Everything is in the reference frame and xf takes incident
+// local coordinates to the reference frame. The reference normal faces the direction.
+static void b2ClipCapsules(b2Manifold* manifold, const b2CapsuleShape* reference, const b2CapsuleShape* incident,
+						   const b2Transform& xf, const b2Vec2& direction, bool flip)
+{
+	b2Vec2 r1 = reference->m_vertex1;
+	b2Vec2 axis = reference->m_vertex2 - r1;
+	float length = axis.Normalize();
+	b2Vec2 normal(-axis.y, axis.x);
+	if (b2Dot(normal, direction) < 0.0f)
+	{
+		normal = -normal;
+	}
+
+	b2Vec2 i1 = b2Mul(xf, incident->m_vertex1);
+	b2Vec2 i2 = b2Mul(xf, incident->m_vertex2);
+
+	// Find the part of the incident segment that projects onto the reference segment.
+	float p1 = b2Dot(i1 - r1, axis);
+	float p2 = b2Dot(i2 - r1, axis);
+	float dp = p2 - p1;
+	float lower = 0.0f, upper = 1.0f;
+	int32 lowerClip = -1, upperClip = -1;
+	if (b2Abs(dp) > b2_epsilon)
+	{
+		float t0 = -p1 / dp;
+		float t1 = (length - p1) / dp;
+		int32 c0 = 0, c1 = 1;
+		if (dp < 0.0f)
+		{
+			b2Swap(t0, t1);
+			b2Swap(c0, c1);
+		}
+
+		if (t0 > lower)
+		{
+			lower = t0;
+			lowerClip = c0;
+		}
+
+		if (t1 < upper)
+		{
+			upper = t1;
+			upperClip = c1;
+		}
+	}
+	else if (p1 < 0.0f || length < p1)
+	{
+		return;
+	}
+
+	if (lower > upper)
+	{
+		return;
+	}
+
+	float totalRadius = reference->m_radius + incident->m_radius;
+	float fractions[2] = { lower, upper };
+	int32 clips[2] = { lowerClip, upperClip };
+	int32 pointCount = 0;
+	for (int32 i = 0; i < 2; ++i)
+	{
+		b2Vec2 v = i1 + fractions[i] * (i2 - i1);
+		float separation = b2Dot(v - r1, normal);
+		if (separation > totalRadius)
+		{
+			continue;
+		}
+
+		b2ContactFeature cf;
+		if (clips[i] < 0)
+		{
+			cf.indexA = 0;
+			cf.typeA = b2ContactFeature::e_face;
+			cf.indexB = static_cast<uint8>(i);
+			cf.typeB = b2ContactFeature::e_vertex;
+		}
+		else
+		{
+			cf.indexA = static_cast<uint8>(clips[i]);
+			cf.typeA = b2ContactFeature::e_vertex;
+			cf.indexB = 0;
+			cf.typeB = b2ContactFeature::e_face;
+		}
+
+		b2ManifoldPoint* mp = manifold->points + pointCount;
+		mp->localPoint = incident->m_vertex1 + fractions[i] * (incident->m_vertex2 - incident->m_vertex1);
+		if (flip)
+		{
+			mp->id.cf.indexA = cf.indexB;
+			mp->id.cf.indexB = cf.indexA;
+			mp->id.cf.typeA = cf.typeB;
+			mp->id.cf.typeB = cf.typeA;
+		}
+		else
+		{
+			mp->id.cf = cf;
+		}
+		++pointCount;
+	}
+
+	manifold->type = flip ? b2Manifold::e_faceB : b2Manifold::e_faceA;
+	manifold->localNormal = normal;
+	manifold->localPoint = r1;
+	manifold->pointCount = pointCount;
+}
+
+// Closest points of two segments from Real-Time Collision Detection by Christer Ericson,
+// section 5.1.9. When the closest point on a segment is inside that segment, or the
+// segments are parallel, the segment is used as a face and the other is clipped to it,
+// giving up to two points. Otherwise the closest points are both end points and act as
+// circles.
+void b2CollideCapsules(b2Manifold* manifold,
+					   const b2CapsuleShape* capsuleA, const b2Transform& xfA,
+					   const b2CapsuleShape* capsuleB, const b2Transform& xfB)
+{
+	manifold->pointCount = 0;
+
+	// Work in the frame of A.
+	b2Transform xf = b2MulT(xfA, xfB);
+	b2Vec2 a1 = capsuleA->m_vertex1;
+	b2Vec2 a2 = capsuleA->m_vertex2;
+	b2Vec2 b1 = b2Mul(xf, capsuleB->m_vertex1);
+	b2Vec2 b2 = b2Mul(xf, capsuleB->m_vertex2);
+
+	b2Vec2 d1 = a2 - a1;
+	b2Vec2 d2 = b2 - b1;
+	b2Vec2 r = a1 - b1;
+	float dd1 = b2Dot(d1, d1);
+	float dd2 = b2Dot(d2, d2);
+	float rd1 = b2Dot(r, d1);
+	float rd2 = b2Dot(r, d2);
+	float d12 = b2Dot(d1, d2);
+
+	// Both segments are non-degenerate, see b2CapsuleShape::Set.
+	float denominator = dd1 * dd2 - d12 * d12;
+	bool parallel = denominator <= b2_epsilon * dd1 * dd2;
+
+	float s = parallel ? 0.0f : b2Clamp((d12 * rd2 - rd1 * dd2) / denominator, 0.0f, 1.0f);
+	float t = (d12 * s + rd2) / dd2;
+	if (t < 0.0f)
+	{
+		t = 0.0f;
+		s = b2Clamp(-rd1 / dd1, 0.0f, 1.0f);
+	}
+	else if (t > 1.0f)
+	{
+		t = 1.0f;
+		s = b2Clamp((d12 - rd1) / dd1, 0.0f, 1.0f);
+	}
+
+	b2Vec2 cA = a1 + s * d1;
+	b2Vec2 cB = b1 + t * d2;
+	b2Vec2 d = cB - cA;
+	float distanceSquared = b2Dot(d, d);
+	float totalRadius = capsuleA->m_radius + capsuleB->m_radius;
+	if (distanceSquared > totalRadius * totalRadius)
+	{
+		return;
+	}
+
+	// Crossing segments have no closest point direction, so use the side of B's center.
+	b2Vec2 direction = d;
+	if (distanceSquared < b2_epsilon * b2_epsilon)
+	{
+		direction = 0.5f * (b1 + b2) - 0.5f * (a1 + a2);
+	}
+
+	if ((0.0f < s && s < 1.0f) || parallel)
+	{
+		b2ClipCapsules(manifold, capsuleA, capsuleB, xf, direction, false);
+	}
+	else if (0.0f < t && t < 1.0f)
+	{
+		b2ClipCapsules(manifold, capsuleB, capsuleA, b2MulT(xfB, xfA), b2MulT(xf.q, -direction), true);
+	}
+
+	if (manifold->pointCount > 0)
+	{
+		return;
+	}
+
+	b2ContactFeature cf;
+	cf.indexA = static_cast<uint8>(s < 0.5f ? 0 : 1);
+	cf.typeA = b2ContactFeature::e_vertex;
+	cf.indexB = static_cast<uint8>(t < 0.5f ? 0 : 1);
+	cf.typeB = b2ContactFeature::e_vertex;
+
+	manifold->type = b2Manifold::e_circles;
+	manifold->localNormal.SetZero();
+	manifold->localPoint = cA;
+	manifold->pointCount = 1;
+	manifold->points[0].localPoint = capsuleB->m_vertex1 + t * (capsuleB->m_vertex2 - capsuleB->m_vertex1);
+	manifold->points[0].id.cf = cf;
+}
@@ -21,15 +21,115 @@
 // SOFTWARE.
 
 #include "box2d/b2_collision.h"
+#include "box2d/b2_capsule_shape.h"
+#include "box2d/b2_chain_shape.h"
 #include "box2d/b2_circle_shape.h"
 #include "box2d/b2_edge_shape.h"
+#include "box2d/b2_heightfield_shape.h"
 #include "box2d/b2_polygon_shape.h"
 
+// An edge with its connectivity. This points into the vertices of an edge shape or a chain,
+// so chain segments are collided without building a temporary edge shape.
+struct b2EdgeRef
+{
+	const b2Vec2* vertex0;
+	const b2Vec2* vertex1;
+	const b2Vec2* vertex2;
+	const b2Vec2* vertex3;
+	bool hasVertex0;
+	bool hasVertex3;
+	float radius;
+};
+
+static b2EdgeRef b2MakeEdgeRef(const b2EdgeShape* edge)
+{
+	b2EdgeRef ref;
+	ref.vertex0 = &edge->m_vertex0;
+	ref.vertex1 = &edge->m_vertex1;
+	ref.vertex2 = &edge->m_vertex2;
+	ref.vertex3 = &edge->m_vertex3;
+	ref.hasVertex0 = edge->m_hasVertex0;
+	ref.hasVertex3 = edge->m_hasVertex3;
+	ref.radius = edge->m_radius;
+	return ref;
+}
+
+// A capsule is an isolated edge with the capsule radius.
+static b2EdgeRef b2MakeEdgeRef(const b2CapsuleShape* capsule)
+{
+	b2EdgeRef ref;
+	ref.vertex0 = &capsule->m_vertex1;
+	ref.vertex1 = &capsule->m_vertex1;
+	ref.vertex2 = &capsule->m_vertex2;
+	ref.vertex3 = &capsule->m_vertex2;
+	ref.hasVertex0 = false;
+	ref.hasVertex3 = false;
+	ref.radius = capsule->m_radius;
+	return ref;
+}
+
+// Same connectivity as b2ChainShape::GetChildEdge.
+static b2EdgeRef b2MakeEdgeRef(const b2ChainShape* chain, int32 index)
+{
+	b2Assert(0 <= index && index < chain->m_count - 1);
+
+	b2EdgeRef ref;
+	ref.vertex1 = chain->m_vertices + index;
+	ref.vertex2 = chain->m_vertices + index + 1;
+
+	if (index > 0)
+	{
+		ref.vertex0 = chain->m_vertices + index - 1;
+		ref.hasVertex0 = true;
+	}
+	else
+	{
+		ref.vertex0 = &chain->m_prevVertex;
+		ref.hasVertex0 = chain->m_hasPrevVertex;
+	}
+
+	if (index < chain->m_count - 2)
+	{
+		ref.vertex3 = chain->m_vertices + index + 2;
+		ref.hasVertex3 = true;
+	}
+	else
+	{
+		ref.vertex3 = &chain->m_nextVertex;
+		ref.hasVertex3 = chain->m_hasNextVertex;
+	}
+
+	ref.radius = chain->m_radius;
+	return ref;
+}
+
+// Heightfield samples are not stored as vertices, so the cell and its neighbors are expanded
+// into a four vertex buffer owned by the caller.
+static b2EdgeRef b2MakeEdgeRef(const b2HeightfieldShape* heightfield, int32 index, b2Vec2 buffer[4])
+{
+	b2Assert(0 <= index && index < heightfield->m_count - 1);
+
+	b2EdgeRef ref;
+	ref.hasVertex0 = index > 0 && heightfield->m_heights[index - 1] != b2_heightfieldHole;
+	ref.hasVertex3 = index + 2 < heightfield->m_count && heightfield->m_heights[index + 2] != b2_heightfieldHole;
+
+	buffer[0] = ref.hasVertex0 ? heightfield->GetVertex(index - 1) : b2Vec2_zero;
+	buffer[1] = heightfield->GetVertex(index);
+	buffer[2] = heightfield->GetVertex(index + 1);
+	buffer[3] = ref.hasVertex3 ? heightfield->GetVertex(index + 2) : b2Vec2_zero;
+
+	ref.vertex0 = buffer + 0;
+	ref.vertex1 = buffer + 1;
+	ref.vertex2 = buffer + 2;
+	ref.vertex3 = buffer + 3;
+	ref.radius = heightfield->m_radius;
+	return ref;
+}
 
 // Compute contact points for edge versus circle.
 // This accounts for edge connectivity.
-void b2CollideEdgeAndCircle(b2Manifold* manifold,
-							const b2EdgeShape* edgeA, const b2Transform& xfA,
+static void b2CollideEdgeRefAndCircle(b2Manifold* manifold,
+							const b2EdgeRef& edgeA, const b2Transform& xfA,
 							const b2CircleShape* circleB, const b2Transform& xfB)
 {
 	manifold->pointCount = 0;
@@ -37,14 +137,14 @@ void b2CollideEdgeAndCircle(b2Manifold* manifold,
 	// Compute circle in frame of edge
 	b2Vec2 Q = b2MulT(xfA, b2Mul(xfB, circleB->m_p));
 	
-	b2Vec2 A = edgeA->m_vertex1, B = edgeA->m_vertex2;
+	b2Vec2 A = *edgeA.vertex1, B = *edgeA.vertex2;
 	b2Vec2 e = B - A;
 	
 	// Barycentric coordinates
 	float u = b2Dot(e, B - Q);
 	float v = b2Dot(e, Q - A);
 	
-	float radius = edgeA->m_radius + circleB->m_radius;
+	float radius = edgeA.radius + circleB->m_radius;
 	
 	b2ContactFeature cf;
 	cf.indexB = 0;
@@ -62,9 +162,9 @@ void b2CollideEdgeAndCircle(b2Manifold* manifold,
 		}
 		
 		// Is there an edge connected to A?
-		if (edgeA->m_hasVertex0)
+		if (edgeA.hasVertex0)
 		{
-			b2Vec2 A1 = edgeA->m_vertex0;
+			b2Vec2 A1 = *edgeA.vertex0;
 			b2Vec2 B1 = A;
 			b2Vec2 e1 = B1 - A1;
 			float u1 = b2Dot(e1, B1 - Q);
@@ -100,9 +200,9 @@ void b2CollideEdgeAndCircle(b2Manifold* manifold,
 		}
 		
 		// Is there an edge connected to B?
-		if (edgeA->m_hasVertex3)
+		if (edgeA.hasVertex3)
 		{
-			b2Vec2 B2 = edgeA->m_vertex3;
+			b2Vec2 B2 = *edgeA.vertex3;
 			b2Vec2 A2 = B;
 			b2Vec2 e2 = B2 - A2;
 			float v2 = b2Dot(e2, Q - A2);
@@ -155,6 +255,73 @@ void b2CollideEdgeAndCircle(b2Manifold* manifold,
 	manifold->points[0].localPoint = circleB->m_p;
 }
 
+void b2CollideEdgeAndCircle(b2Manifold* manifold,
+							const b2EdgeShape* edgeA, const b2Transform& xfA,
+							const b2CircleShape* circleB, const b2Transform& xfB)
+{
+	b2CollideEdgeRefAndCircle(manifold, b2MakeEdgeRef(edgeA), xfA, circleB, xfB);
+}
+
+void b2CollideChainAndCircle(b2Manifold* manifold,
+							const b2ChainShape* chainA, int32 indexA, const b2Transform& xfA,
+							const b2CircleShape* circleB, const b2Transform& xfB)
+{
+	b2CollideEdgeRefAndCircle(manifold, b2MakeEdgeRef(chainA, indexA), xfA, circleB, xfB);
+}
+
+void b2CollideHeightfieldAndCircle(b2Manifold* manifold,
+							const b2HeightfieldShape* heightfieldA, int32 indexA, const b2Transform& xfA,
+							const b2CircleShape* circleB, const b2Transform& xfB)
+{
+	b2Vec2 buffer[4];
+	b2CollideEdgeRefAndCircle(manifold, b2MakeEdgeRef(heightfieldA, indexA, buffer), xfA, circleB, xfB);
+}
+
+void b2CollideCapsuleAndCircle(b2Manifold* manifold,
+							const b2CapsuleShape* capsuleA, const b2Transform& xfA,
+							const b2CircleShape* circleB, const b2Transform& xfB)
+{
+	b2CollideEdgeRefAndCircle(manifold, b2MakeEdgeRef(capsuleA), xfA, circleB, xfB);
+}
+
+// A convex polygon with a radius. This points into a polygon shape, or views a capsule
+// as a polygon with two vertices and two opposite normals.
+struct b2PolygonRef
+{
+	const b2Vec2* vertices;
+	const b2Vec2* normals;
+	int32 count;
+	b2Vec2 centroid;
+	float radius;
+};
+
+static b2PolygonRef b2MakePolygonRef(const b2PolygonShape* polygon)
+{
+	b2PolygonRef ref;
+	ref.vertices = polygon->m_vertices;
+	ref.normals = polygon->m_normals;
+	ref.count = polygon->m_count;
+	ref.centroid = polygon->m_centroid;
+	ref.radius = polygon->m_radius;
+	return ref;
+}
+
+static b2PolygonRef b2MakePolygonRef(const b2CapsuleShape* capsule, b2Vec2 normals[2])
+{
+	b2Vec2 e = capsule->m_vertex2 - capsule->m_vertex1;
+	normals[0].Set(e.y, -e.x);
+	normals[0].Normalize();
+	normals[1] = -normals[0];
+
+	b2PolygonRef ref;
+	ref.vertices = &capsule->m_vertex1;
+	ref.normals = normals;
+	ref.count = 2;
+	ref.centroid = 0.5f * (capsule->m_vertex1 + capsule->m_vertex2);
+	ref.radius = capsule->m_radius;
+	return ref;
+}
+
 // This structure is used to keep track of the best separating axis.
 struct b2EPAxis
 {
@@ -197,8 +364,8 @@ struct b2ReferenceFace
 // This class collides and edge and a polygon, taking into account edge adjacency.
 struct b2EPCollider
 {
-	void Collide(b2Manifold* manifold, const b2EdgeShape* edgeA, const b2Transform& xfA,
-				 const b2PolygonShape* polygonB, const b2Transform& xfB);
+	void Collide(b2Manifold* manifold, const b2EdgeRef& edgeA, const b2Transform& xfA,
+				 const b2PolygonRef& polygonB, const b2Transform& xfB);
 	b2EPAxis ComputeEdgeSeparation();
 	b2EPAxis ComputePolygonSeparation();
 	
@@ -231,20 +398,20 @@ struct b2EPCollider
 // 6. Visit each separating axes, only accept axes within the range
 // 7. Return if _any_ axis indicates separation
 // 8. Clip
-void b2EPCollider::Collide(b2Manifold* manifold, const b2EdgeShape* edgeA, const b2Transform& xfA,
-						   const b2PolygonShape* polygonB, const b2Transform& xfB)
+void b2EPCollider::Collide(b2Manifold* manifold, const b2EdgeRef& edgeA, const b2Transform& xfA,
+						   const b2PolygonRef& polygonB, const b2Transform& xfB)
 {
 	m_xf = b2MulT(xfA, xfB);
 	
-	m_centroidB = b2Mul(m_xf, polygonB->m_centroid);
+	m_centroidB = b2Mul(m_xf, polygonB.centroid);
 	
-	m_v0 = edgeA->m_vertex0;
-	m_v1 = edgeA->m_vertex1;
-	m_v2 = edgeA->m_vertex2;
-	m_v3 = edgeA->m_vertex3;
+	m_v0 = *edgeA.vertex0;
+	m_v1 = *edgeA.vertex1;
+	m_v2 = *edgeA.vertex2;
+	m_v3 = *edgeA.vertex3;
 	
-	bool hasVertex0 = edgeA->m_hasVertex0;
-	bool hasVertex3 = edgeA->m_hasVertex3;
+	bool hasVertex0 = edgeA.hasVertex0;
+	bool hasVertex3 = edgeA.hasVertex3;
 	
 	b2Vec2 edge1 = m_v2 - m_v1;
 	edge1.Normalize();
@@ -429,14 +596,14 @@ void b2EPCollider::Collide(b2Manifold* manifold, const b2EdgeShape* edgeA, const
 	}
 	
 	// Get polygonB in frameA
-	m_polygonB.count = polygonB->m_count;
-	for (int32 i = 0; i < polygonB->m_count; ++i)
+	m_polygonB.count = polygonB.count;
+	for (int32 i = 0; i < polygonB.count; ++i)
 	{
-		m_polygonB.vertices[i] = b2Mul(m_xf, polygonB->m_vertices[i]);
-		m_polygonB.normals[i] = b2Mul(m_xf.q, polygonB->m_normals[i]);
+		m_polygonB.vertices[i] = b2Mul(m_xf, polygonB.vertices[i]);
+		m_polygonB.normals[i] = b2Mul(m_xf.q, polygonB.normals[i]);
 	}
 	
-	m_radius = polygonB->m_radius + edgeA->m_radius;
+	m_radius = polygonB.radius + edgeA.radius;
 	
 	manifold->pointCount = 0;
 	
@@ -585,8 +752,8 @@ void b2EPCollider::Collide(b2Manifold* manifold, const b2EdgeShape* edgeA, const
 	}
 	else
 	{
-		manifold->localNormal = polygonB->m_normals[rf.i1];
-		manifold->localPoint = polygonB->m_vertices[rf.i1];
+		manifold->localNormal = polygonB.normals[rf.i1];
+		manifold->localPoint = polygonB.vertices[rf.i1];
 	}
 	
 	int32 pointCount = 0;
@@ -698,5 +865,58 @@ void b2CollideEdgeAndPolygon(	b2Manifold* manifold,
 							 const b2PolygonShape* polygonB, const b2Transform& xfB)
 {
 	b2EPCollider collider;
-	collider.Collide(manifold, edgeA, xfA, polygonB, xfB);
+	collider.Collide(manifold, b2MakeEdgeRef(edgeA), xfA, b2MakePolygonRef(polygonB), xfB);
+}
+
+void b2CollideChainAndPolygon(b2Manifold* manifold,
+							 const b2ChainShape* chainA, int32 indexA, const b2Transform& xfA,
+							 const b2PolygonShape* polygonB, const b2Transform& xfB)
+{
+	b2EPCollider collider;
+	collider.Collide(manifold, b2MakeEdgeRef(chainA, indexA), xfA, b2MakePolygonRef(polygonB), xfB);
+}
+
+void b2CollideHeightfieldAndPolygon(b2Manifold* manifold,
+							 const b2HeightfieldShape* heightfieldA, int32 indexA, const b2Transform& xfA,
+							 const b2PolygonShape* polygonB, const b2Transform& xfB)
+{
+	b2Vec2 buffer[4];
+	b2EPCollider collider;
+	collider.Collide(manifold, b2MakeEdgeRef(heightfieldA, indexA, buffer), xfA, b2MakePolygonRef(polygonB), xfB);
+}
+
+void b2CollideCapsuleAndPolygon(b2Manifold* manifold,
+							 const b2CapsuleShape* capsuleA, const b2Transform& xfA,
+							 const b2PolygonShape* polygonB, const b2Transform& xfB)
+{
+	b2EPCollider collider;
+	collider.Collide(manifold, b2MakeEdgeRef(capsuleA), xfA, b2MakePolygonRef(polygonB), xfB);
+}
+
+void b2CollideEdgeAndCapsule(b2Manifold* manifold,
+							 const b2EdgeShape* edgeA, const b2Transform& xfA,
+							 const b2CapsuleShape* capsuleB, const b2Transform& xfB)
+{
+	b2Vec2 normals[2];
+	b2EPCollider collider;
+	collider.Collide(manifold, b2MakeEdgeRef(edgeA), xfA, b2MakePolygonRef(capsuleB, normals), xfB);
+}
+
+void b2CollideChainAndCapsule(b2Manifold* manifold,
+							 const b2ChainShape* chainA, int32 indexA, const b2Transform& xfA,
+							 const b2CapsuleShape* capsuleB, const b2Transform& xfB)
+{
+	b2Vec2 normals[2];
+	b2EPCollider collider;
+	collider.Collide(manifold, b2MakeEdgeRef(chainA, indexA), xfA, b2MakePolygonRef(capsuleB, normals), xfB);
+}
+
+void b2CollideHeightfieldAndCapsule(b2Manifold* manifold,
+							 const b2HeightfieldShape* heightfieldA, int32 indexA, const b2Transform& xfA,
+							 const b2CapsuleShape* capsuleB, const b2Transform& xfB)
+{
+	b2Vec2 buffer[4];
+	b2Vec2 normals[2];
+	b2EPCollider collider;
+	collider.Collide(manifold, b2MakeEdgeRef(heightfieldA, indexA, buffer), xfA, b2MakePolygonRef(capsuleB, normals), xfB);
 }
@@ -23,8 +23,32 @@
 #include "box2d/b2_collision.h"
 #include "box2d/b2_polygon_shape.h"
 
+// Separation of poly2 along the edge normal of poly1, computed in frame2. The search stops
+// as soon as the separation is known to be less than the bound.
+static float b2EdgeSeparation(const b2Vec2& n, const b2Vec2& v1, const b2Vec2* v2s, int32 count2, float bound)
+{
+	float si = b2_maxFloat;
+	for (int32 j = 0; j < count2; ++j)
+	{
+		float sij = b2Dot(n, v2s[j] - v1);
+		if (sij < si)
+		{
+			si = sij;
+			if (si < bound)
+			{
+				break;
+			}
+		}
+	}
+
+	return si;
+}
+
 // Find the max separation between poly1 and poly2 using edge normals from poly1.
-static float b2FindMaxSeparation(int32* edgeIndex,
+// The cached edge from the previous call is tested first. If it still separates the
+// polygons by more than the radius the search ends. Otherwise its separation bounds
+// the other edges so they can stop early. The result matches a full search.
+static float b2FindMaxSeparation(int32* edgeIndex, int32 cachedEdge, float radius,
 								 const b2PolygonShape* poly1, const b2Transform& xf1,
 								 const b2PolygonShape* poly2, const b2Transform& xf2)
 {
@@ -35,29 +59,47 @@ static float b2FindMaxSeparation(int32* edgeIndex,
 	const b2Vec2* v2s = poly2->m_vertices;
 	b2Transform xf = b2MulT(xf2, xf1);
 
+	if (cachedEdge >= count1)
+	{
+		cachedEdge = 0;
+	}
+
+	float cachedSeparation = b2EdgeSeparation(b2Mul(xf.q, n1s[cachedEdge]), b2Mul(xf, v1s[cachedEdge]), v2s, count2, -b2_maxFloat);
+	if (cachedSeparation > radius)
+	{
+		*edgeIndex = cachedEdge;
+		return cachedSeparation;
+	}
+
+	// Edges are visited in order so ties resolve to the lowest index, as in a full search.
 	int32 bestIndex = 0;
 	float maxSeparation = -b2_maxFloat;
 	for (int32 i = 0; i < count1; ++i)
 	{
-		// Get poly1 normal in frame2.
-		b2Vec2 n = b2Mul(xf.q, n1s[i]);
-		b2Vec2 v1 = b2Mul(xf, v1s[i]);
-
-		// Find deepest point for normal i.
-		float si = b2_maxFloat;
-		for (int32 j = 0; j < count2; ++j)
+		float si;
+		if (i == cachedEdge)
 		{
-			float sij = b2Dot(n, v2s[j] - v1);
-			if (sij < si)
-			{
-				si = sij;
-			}
+			si = cachedSeparation;
+		}
+		else
+		{
+			// Get poly1 normal in frame2.
+			b2Vec2 n = b2Mul(xf.q, n1s[i]);
+			b2Vec2 v1 = b2Mul(xf, v1s[i]);
+
+			// An edge below the cached separation or the best so far cannot be selected.
+			si = b2EdgeSeparation(n, v1, v2s, count2, b2Max(cachedSeparation, maxSeparation));
 		}
 
 		if (si > maxSeparation)
 		{
 			maxSeparation = si;
 			bestIndex = i;
+
+			if (maxSeparation > radius)
+			{
+				break;
+			}
 		}
 	}
 
@@ -120,17 +162,30 @@ static void b2FindIncidentEdge(b2ClipVertex c[2],
 void b2CollidePolygons(b2Manifold* manifold,
 					  const b2PolygonShape* polyA, const b2Transform& xfA,
 					  const b2PolygonShape* polyB, const b2Transform& xfB)
+{
+	b2SeparationCache cache;
+	cache.edgeA = 0;
+	cache.edgeB = 0;
+	b2CollidePolygons(manifold, polyA, xfA, polyB, xfB, &cache);
+}
+
+void b2CollidePolygons(b2Manifold* manifold,
+					  const b2PolygonShape* polyA, const b2Transform& xfA,
+					  const b2PolygonShape* polyB, const b2Transform& xfB,
+					  b2SeparationCache* cache)
 {
 	manifold->pointCount = 0;
 	float totalRadius = polyA->m_radius + polyB->m_radius;
 
 	int32 edgeA = 0;
-	float separationA = b2FindMaxSeparation(&edgeA, polyA, xfA, polyB, xfB);
+	float separationA = b2FindMaxSeparation(&edgeA, cache->edgeA, totalRadius, polyA, xfA, polyB, xfB);
+	cache->edgeA = (uint8)edgeA;
 	if (separationA > totalRadius)
 		return;
 
 	int32 edgeB = 0;
-	float separationB = b2FindMaxSeparation(&edgeB, polyB, xfB, polyA, xfA);
+	float separationB = b2FindMaxSeparation(&edgeB, cache->edgeB, totalRadius, polyB, xfB, polyA, xfA);
+	cache->edgeB = (uint8)edgeB;
 	if (separationB > totalRadius)
 		return;
 
@@ -234,6 +234,99 @@ int32 b2ClipSegmentToLine(b2ClipVertex vOut[2], const b2ClipVertex vIn[2],
 	return numOut;
 }
 
+// Build the subtree over leaves[0, count) at node index.
+static int32 b2BuildStaticTreeNode(b2StaticTreeNode* nodes, int32 index, const b2AABB* boxes, const b2Vec2* centers, int32* leaves, int32 count)
+{
+	b2StaticTreeNode* node = nodes + index;
+
+	if (count == 1)
+	{
+		node->aabb = boxes[leaves[0]];
+		node->child = leaves[0];
+		node->skip = index + 1;
+		return node->skip;
+	}
+
+	b2Vec2 lower = centers[leaves[0]];
+	b2Vec2 upper = lower;
+	for (int32 i = 1; i < count; ++i)
+	{
+		lower = b2Min(lower, centers[leaves[i]]);
+		upper = b2Max(upper, centers[leaves[i]]);
+	}
+
+	int32 axis = upper.x - lower.x >= upper.y - lower.y ? 0 : 1;
+	int32 half = count / 2;
+
+	// Quickselect the median so the left half holds the smaller centers.
+	int32 left = 0;
+	int32 right = count - 1;
+	while (left < right)
+	{
+		float pivot = centers[leaves[(left + right) / 2]](axis);
+		int32 i = left;
+		int32 j = right;
+		while (i <= j)
+		{
+			while (centers[leaves[i]](axis) < pivot)
+			{
+				++i;
+			}
+
+			while (centers[leaves[j]](axis) > pivot)
+			{
+				--j;
+			}
+
+			if (i <= j)
+			{
+				b2Swap(leaves[i], leaves[j]);
+				++i;
+				--j;
+			}
+		}
+
+		if (half <= j)
+		{
+			right = j;
+		}
+		else if (half >= i)
+		{
+			left = i;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	int32 child2 = b2BuildStaticTreeNode(nodes, index + 1, boxes, centers, leaves, half);
+	int32 end = b2BuildStaticTreeNode(nodes, child2, boxes, centers, leaves + half, count - half);
+
+	node->aabb.Combine(nodes[index + 1].aabb, nodes[child2].aabb);
+	node->child = -1;
+	node->skip = end;
+	return end;
+}
+
+void b2BuildStaticTree(b2StaticTreeNode* nodes, const b2AABB* boxes, int32 count)
+{
+	b2Assert(count > 0);
+
+	b2Vec2* centers = (b2Vec2*)b2Alloc(count * sizeof(b2Vec2));
+	int32* leaves = (int32*)b2Alloc(count * sizeof(int32));
+	for (int32 i = 0; i < count; ++i)
+	{
+		centers[i] = boxes[i].GetCenter();
+		leaves[i] = i;
+	}
+
+	b2BuildStaticTreeNode(nodes, 0, boxes, centers, leaves, count);
+
+	b2Free(leaves);
+	b2Free(centers);
+}
+
 bool b2TestOverlap(	const b2Shape* shapeA, int32 indexA,
 					const b2Shape* shapeB, int32 indexB,
 					const b2Transform& xfA, const b2Transform& xfB)
@@ -0,0 +1,196 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "box2d/b2_compound_shape.h"
+#include "box2d/b2_capsule_shape.h"
+#include "box2d/b2_circle_shape.h"
+#include "box2d/b2_polygon_shape.h"
+
+#include "box2d/b2_block_allocator.h"
+
+#include <new>
+
+// Copy a convex shape into memory of its own.
+static b2Shape* b2CloneChild(const b2Shape* shape)
+{
+	switch (shape->m_type)
+	{
+	case b2Shape::e_circle:
+		{
+			void* mem = b2Alloc(sizeof(b2CircleShape));
+			return new (mem) b2CircleShape(*(const b2CircleShape*)shape);
+		}
+
+	case b2Shape::e_polygon:
+		{
+			void* mem = b2Alloc(sizeof(b2PolygonShape));
+			return new (mem) b2PolygonShape(*(const b2PolygonShape*)shape);
+		}
+
+	case b2Shape::e_capsule:
+		{
+			void* mem = b2Alloc(sizeof(b2CapsuleShape));
+			return new (mem) b2CapsuleShape(*(const b2CapsuleShape*)shape);
+		}
+
+	default:
+		b2Assert(false);
+		return nullptr;
+	}
+}
+
+b2CompoundShape::~b2CompoundShape()
+{
+	Clear();
+}
+
+void b2CompoundShape::Clear()
+{
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		m_children[i]->~b2Shape();
+		b2Free(m_children[i]);
+	}
+
+	b2Free(m_children);
+	b2Free(m_nodes);
+	m_children = nullptr;
+	m_count = 0;
+	m_nodes = nullptr;
+	m_nodeCount = 0;
+}
+
+void b2CompoundShape::Create(const b2Shape* const* shapes, int32 count)
+{
+	b2Assert(m_children == nullptr && m_count == 0);
+	b2Assert(count >= 1);
+
+	m_count = count;
+	m_children = (b2Shape**)b2Alloc(count * sizeof(b2Shape*));
+
+	b2Transform identity;
+	identity.SetIdentity();
+
+	// The leaves use the child AABBs of ComputeAABB.
+	b2AABB* boxes = (b2AABB*)b2Alloc(count * sizeof(b2AABB));
+	for (int32 i = 0; i < count; ++i)
+	{
+		m_children[i] = b2CloneChild(shapes[i]);
+		m_children[i]->ComputeAABB(boxes + i, identity, 0);
+	}
+
+	m_nodeCount = 2 * count - 1;
+	m_nodes = (b2StaticTreeNode*)b2Alloc(m_nodeCount * sizeof(b2StaticTreeNode));
+	b2BuildStaticTree(m_nodes, boxes, count);
+
+	b2Free(boxes);
+}
+
+b2Shape* b2CompoundShape::Clone(b2BlockAllocator* allocator) const
+{
+	void* mem = allocator->Allocate(sizeof(b2CompoundShape));
+	b2CompoundShape* clone = new (mem) b2CompoundShape;
+	clone->Create(m_children, m_count);
+	return clone;
+}
+
+int32 b2CompoundShape::GetChildCount() const
+{
+	return m_count;
+}
+
+float b2CompoundShape::GetChildRadius(int32 childIndex) const
+{
+	b2Assert(0 <= childIndex && childIndex < m_count);
+	return m_children[childIndex]->m_radius;
+}
+
+// Reports whether a point is inside any child near it.
+struct b2CompoundPointCallback
+{
+	bool QueryCallback(int32 childIndex)
+	{
+		inside = compound->m_children[childIndex]->TestPoint(identity, point);
+		return inside == false;
+	}
+
+	const b2CompoundShape* compound;
+	b2Transform identity;
+	b2Vec2 point;
+	bool inside;
+};
+
+bool b2CompoundShape::TestPoint(const b2Transform& xf, const b2Vec2& p) const
+{
+	b2CompoundPointCallback callback;
+	callback.compound = this;
+	callback.identity.SetIdentity();
+	callback.point = b2MulT(xf, p);
+	callback.inside = false;
+
+	b2AABB aabb;
+	aabb.lowerBound = callback.point;
+	aabb.upperBound = callback.point;
+	QueryTree(&callback, aabb);
+
+	return callback.inside;
+}
+
+bool b2CompoundShape::RayCast(b2RayCastOutput* output, const b2RayCastInput& input,
+							const b2Transform& xf, int32 childIndex) const
+{
+	b2Assert(0 <= childIndex && childIndex < m_count);
+	return m_children[childIndex]->RayCast(output, input, xf, 0);
+}
+
+bool b2CompoundShape::RayCastTree(b2RayCastOutput* output, const b2RayCastInput& input, const b2Transform& xf) const
+{
+	return b2RayCastStaticTree(m_nodes, m_nodeCount, this, output, input, xf);
+}
+
+void b2CompoundShape::ComputeAABB(b2AABB* aabb, const b2Transform& xf, int32 childIndex) const
+{
+	b2Assert(0 <= childIndex && childIndex < m_count);
+	m_children[childIndex]->ComputeAABB(aabb, xf, 0);
+}
+
+void b2CompoundShape::ComputeMass(b2MassData* massData, float density) const
+{
+	// The children are in the body frame, so their inertias about the origin add up.
+	massData->mass = 0.0f;
+	massData->center.SetZero();
+	massData->I = 0.0f;
+
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2MassData childData;
+		m_children[i]->ComputeMass(&childData, density);
+		massData->mass += childData.mass;
+		massData->center += childData.mass * childData.center;
+		massData->I += childData.I;
+	}
+
+	if (massData->mass > 0.0f)
+	{
+		massData->center *= 1.0f / massData->mass;
+	}
+}
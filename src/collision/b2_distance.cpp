@@ -20,14 +20,16 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include "box2d/b2_capsule_shape.h"
 #include "box2d/b2_circle_shape.h"
+#include "box2d/b2_compound_shape.h"
 #include "box2d/b2_distance.h"
 #include "box2d/b2_edge_shape.h"
 #include "box2d/b2_chain_shape.h"
+#include "box2d/b2_heightfield_shape.h"
 #include "box2d/b2_polygon_shape.h"
 
 // GJK using Voronoi regions (Christer Ericson) and Barycentric coordinates.
-int32 b2_gjkCalls, b2_gjkIters, b2_gjkMaxIters;
 
 void b2DistanceProxy::Set(const b2Shape* shape, int32 index)
 {
@@ -81,6 +83,33 @@ void b2DistanceProxy::Set(const b2Shape* shape, int32 index)
 		}
 		break;
 
+	case b2Shape::e_capsule:
+		{
+			const b2CapsuleShape* capsule = static_cast<const b2CapsuleShape*>(shape);
+			m_vertices = &capsule->m_vertex1;
+			m_count = 2;
+			m_radius = capsule->m_radius;
+		}
+		break;
+
+	case b2Shape::e_heightfield:
+		{
+			const b2HeightfieldShape* heightfield = static_cast<const b2HeightfieldShape*>(shape);
+			m_buffer[0] = heightfield->GetVertex(index);
+			m_buffer[1] = heightfield->GetVertex(index + 1);
+			m_vertices = m_buffer;
+			m_count = 2;
+			m_radius = heightfield->m_radius;
+		}
+		break;
+
+	case b2Shape::e_compound:
+		{
+			const b2CompoundShape* compound = static_cast<const b2CompoundShape*>(shape);
+			Set(compound->GetChild(index), 0);
+		}
+		break;
+
 	default:
 		b2Assert(false);
 	}
@@ -455,8 +484,6 @@ void b2Distance(b2DistanceOutput* output,
 				b2SimplexCache* cache,
 				const b2DistanceInput* input)
 {
-	++b2_gjkCalls;
-
 	const b2DistanceProxy* proxyA = &input->proxyA;
 	const b2DistanceProxy* proxyB = &input->proxyB;
 
@@ -537,7 +564,6 @@ void b2Distance(b2DistanceOutput* output,
 
 		// Iteration count is equated to the number of support point calls.
 		++iter;
-		++b2_gjkIters;
 
 		// Check for duplicate support points. This is the main termination criteria.
 		bool duplicate = false;
@@ -560,8 +586,6 @@ void b2Distance(b2DistanceOutput* output,
 		++simplex.m_count;
 	}
 
-	b2_gjkMaxIters = b2Max(b2_gjkMaxIters, iter);
-
 	// Prepare output.
 	simplex.GetWitnessPoints(&output->pointA, &output->pointB);
 	output->distance = b2Distance(output->pointA, output->pointB);
@@ -725,7 +749,16 @@ bool b2ShapeCast(b2ShapeCastOutput * output, const b2ShapeCastInput * input)
 
 	// Prepare output.
 	b2Vec2 pointA, pointB;
-	simplex.GetWitnessPoints(&pointB, &pointA);
+	if (simplex.m_count == 0)
+	{
+		// The shapes start at the target distance, so the initial support points are the witnesses.
+		pointA = wA;
+		pointB = wB;
+	}
+	else
+	{
+		simplex.GetWitnessPoints(&pointB, &pointA);
+	}
 
 	if (v.LengthSquared() > 0.0f)
 	{
@@ -781,3 +781,58 @@ void b2DynamicTree::ShiftOrigin(const b2Vec2& newOrigin)
 		m_nodes[i].aabb.upperBound -= newOrigin;
 	}
 }
+
+struct b2TreeState
+{
+	int32 root;
+	int32 nodeCount;
+	int32 nodeCapacity;
+	int32 freeList;
+	uint32 path;
+	int32 insertionCount;
+};
+
+int32 b2DynamicTree::GetStateSize() const
+{
+	return int32(sizeof(b2TreeState) + m_nodeCapacity * sizeof(b2TreeNode));
+}
+
+int32 b2DynamicTree::SaveState(void* buffer) const
+{
+	b2TreeState state;
+	state.root = m_root;
+	state.nodeCount = m_nodeCount;
+	state.nodeCapacity = m_nodeCapacity;
+	state.freeList = m_freeList;
+	state.path = m_path;
+	state.insertionCount = m_insertionCount;
+
+	char* data = (char*)buffer;
+	memcpy(data, &state, sizeof(b2TreeState));
+	memcpy(data + sizeof(b2TreeState), m_nodes, m_nodeCapacity * sizeof(b2TreeNode));
+	return GetStateSize();
+}
+
+int32 b2DynamicTree::RestoreState(const void* buffer)
+{
+	const char* data = (const char*)buffer;
+
+	b2TreeState state;
+	memcpy(&state, data, sizeof(b2TreeState));
+
+	if (state.nodeCapacity != m_nodeCapacity)
+	{
+		b2Free(m_nodes);
+		m_nodeCapacity = state.nodeCapacity;
+		m_nodes = (b2TreeNode*)b2Alloc(m_nodeCapacity * sizeof(b2TreeNode));
+	}
+
+	m_root = state.root;
+	m_nodeCount = state.nodeCount;
+	m_freeList = state.freeList;
+	m_path = state.path;
+	m_insertionCount = state.insertionCount;
+
+	memcpy(m_nodes, data + sizeof(b2TreeState), m_nodeCapacity * sizeof(b2TreeNode));
+	return GetStateSize();
+}
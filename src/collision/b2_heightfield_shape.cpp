@@ -0,0 +1,179 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "box2d/b2_heightfield_shape.h"
+#include "box2d/b2_edge_shape.h"
+
+#include "box2d/b2_block_allocator.h"
+
+#include <new>
+#include <string.h>
+
+b2HeightfieldShape::~b2HeightfieldShape()
+{
+	Clear();
+}
+
+void b2HeightfieldShape::Clear()
+{
+	b2Free(m_heights);
+	m_heights = nullptr;
+	m_count = 0;
+}
+
+void b2HeightfieldShape::Create(const int16* heights, int32 count, float spacing, float heightScale)
+{
+	b2Assert(m_heights == nullptr && m_count == 0);
+	b2Assert(count >= 2);
+	b2Assert(spacing > b2_linearSlop && heightScale > 0.0f);
+
+	m_count = count;
+	m_spacing = spacing;
+	m_heightScale = heightScale;
+	m_heights = (int16*)b2Alloc(count * sizeof(int16));
+	memcpy(m_heights, heights, count * sizeof(int16));
+
+	int32 lower = 32767;
+	int32 upper = -32767;
+	for (int32 i = 0; i < count; ++i)
+	{
+		if (heights[i] != b2_heightfieldHole)
+		{
+			lower = b2Min(lower, int32(heights[i]));
+			upper = b2Max(upper, int32(heights[i]));
+		}
+	}
+
+	if (lower > upper)
+	{
+		lower = 0;
+		upper = 0;
+	}
+
+	m_bounds.lowerBound.Set(0.0f, lower * heightScale);
+	m_bounds.upperBound.Set((count - 1) * spacing, upper * heightScale);
+}
+
+b2Shape* b2HeightfieldShape::Clone(b2BlockAllocator* allocator) const
+{
+	void* mem = allocator->Allocate(sizeof(b2HeightfieldShape));
+	b2HeightfieldShape* clone = new (mem) b2HeightfieldShape;
+	clone->Create(m_heights, m_count, m_spacing, m_heightScale);
+	clone->m_radius = m_radius;
+	return clone;
+}
+
+int32 b2HeightfieldShape::GetChildCount() const
+{
+	return m_count - 1;
+}
+
+void b2HeightfieldShape::GetChildEdge(b2EdgeShape* edge, int32 index) const
+{
+	b2Assert(0 <= index && index < m_count - 1);
+	edge->m_type = b2Shape::e_edge;
+	edge->m_radius = m_radius;
+
+	edge->m_vertex1 = GetVertex(index);
+	edge->m_vertex2 = GetVertex(index + 1);
+
+	edge->m_hasVertex0 = index > 0 && m_heights[index - 1] != b2_heightfieldHole;
+	edge->m_vertex0 = edge->m_hasVertex0 ? GetVertex(index - 1) : b2Vec2_zero;
+
+	edge->m_hasVertex3 = index + 2 < m_count && m_heights[index + 2] != b2_heightfieldHole;
+	edge->m_vertex3 = edge->m_hasVertex3 ? GetVertex(index + 2) : b2Vec2_zero;
+}
+
+bool b2HeightfieldShape::TestPoint(const b2Transform& xf, const b2Vec2& p) const
+{
+	B2_NOT_USED(xf);
+	B2_NOT_USED(p);
+	return false;
+}
+
+bool b2HeightfieldShape::RayCast(b2RayCastOutput* output, const b2RayCastInput& input,
+							const b2Transform& xf, int32 childIndex) const
+{
+	b2Assert(0 <= childIndex && childIndex < m_count - 1);
+
+	if (IsHole(childIndex))
+	{
+		return false;
+	}
+
+	b2EdgeShape edgeShape;
+	edgeShape.m_vertex1 = GetVertex(childIndex);
+	edgeShape.m_vertex2 = GetVertex(childIndex + 1);
+
+	return edgeShape.RayCast(output, input, xf, 0);
+}
+
+// The cells are visited in the order the ray crosses them, so the first hit is the closest.
+struct b2HeightfieldFirstHit
+{
+	float RayCastCallback(const b2RayCastInput& input, int32 childIndex)
+	{
+		if (shape->RayCast(output, input, xf, childIndex))
+		{
+			hit = true;
+			return 0.0f;
+		}
+
+		return -1.0f;
+	}
+
+	const b2HeightfieldShape* shape;
+	b2Transform xf;
+	b2RayCastOutput* output;
+	bool hit;
+};
+
+bool b2HeightfieldShape::RayCastCells(b2RayCastOutput* output, const b2RayCastInput& input, const b2Transform& xf) const
+{
+	b2HeightfieldFirstHit firstHit;
+	firstHit.shape = this;
+	firstHit.xf = xf;
+	firstHit.output = output;
+	firstHit.hit = false;
+	RayCastCells(&firstHit, input, xf);
+	return firstHit.hit;
+}
+
+void b2HeightfieldShape::ComputeAABB(b2AABB* aabb, const b2Transform& xf, int32 childIndex) const
+{
+	b2Assert(0 <= childIndex && childIndex < m_count - 1);
+
+	b2Vec2 v1 = b2Mul(xf, GetVertex(childIndex));
+	b2Vec2 v2 = b2Mul(xf, GetVertex(childIndex + 1));
+
+	aabb->lowerBound = b2Min(v1, v2);
+	aabb->upperBound = b2Max(v1, v2);
+}
+
+void b2HeightfieldShape::ComputeMass(b2MassData* massData, float density) const
+{
+	B2_NOT_USED(density);
+
+	massData->mass = 0.0f;
+	massData->center.SetZero();
+	massData->I = 0.0f;
+}
@@ -0,0 +1,305 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "box2d/b2_hull.h"
+#include "box2d/b2_polygon_shape.h"
+
+// Most fracture pieces fit on the stack.
+#define b2_hullStackPoints 64
+
+// Write the hull vertices strictly between p1 and p2 for the points to the right of p1 -> p2.
+// The points are partitioned in place.
+static int32 b2RecurseHull(b2Vec2* hull, const b2Vec2& p1, const b2Vec2& p2, b2Vec2* ps, int32 count)
+{
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	// The farthest point from the line is on the hull.
+	b2Vec2 e = p2 - p1;
+	int32 bestIndex = 0;
+	float bestDistance = b2Cross(ps[0] - p1, e);
+	for (int32 i = 1; i < count; ++i)
+	{
+		float distance = b2Cross(ps[i] - p1, e);
+		if (distance > bestDistance)
+		{
+			bestIndex = i;
+			bestDistance = distance;
+		}
+	}
+
+	b2Vec2 c = ps[bestIndex];
+
+	// Points right of p1 -> c go first, then points right of c -> p2. The rest are inside.
+	// No point is right of both.
+	int32 count1 = 0;
+	for (int32 i = 0; i < count; ++i)
+	{
+		if (b2Cross(ps[i] - p1, c - p1) > 0.0f)
+		{
+			b2Swap(ps[i], ps[count1++]);
+		}
+	}
+
+	int32 count2 = 0;
+	for (int32 i = count1; i < count; ++i)
+	{
+		if (b2Cross(ps[i] - c, p2 - c) > 0.0f)
+		{
+			b2Swap(ps[i], ps[count1 + count2++]);
+		}
+	}
+
+	int32 n = b2RecurseHull(hull, p1, c, ps, count1);
+	hull[n++] = c;
+	n += b2RecurseHull(hull + n, c, p2, ps + count1, count2);
+	return n;
+}
+
+// Quickhull over a scratch copy of the points.
+static int32 b2QuickHull(b2Vec2* hull, b2Vec2* ps, int32 count)
+{
+	// The extreme points in x are on the hull. Ties are broken with y.
+	int32 i1 = 0;
+	int32 i2 = 0;
+	for (int32 i = 1; i < count; ++i)
+	{
+		if (ps[i].x < ps[i1].x || (ps[i].x == ps[i1].x && ps[i].y < ps[i1].y))
+		{
+			i1 = i;
+		}
+
+		if (ps[i].x > ps[i2].x || (ps[i].x == ps[i2].x && ps[i].y > ps[i2].y))
+		{
+			i2 = i;
+		}
+	}
+
+	b2Vec2 p1 = ps[i1];
+	b2Vec2 p2 = ps[i2];
+	if (p1 == p2)
+	{
+		hull[0] = p1;
+		return 1;
+	}
+
+	// Split the points into the lower side and the upper side of p1 -> p2.
+	int32 lowerCount = 0;
+	for (int32 i = 0; i < count; ++i)
+	{
+		if (b2Cross(ps[i] - p1, p2 - p1) > 0.0f)
+		{
+			b2Swap(ps[i], ps[lowerCount++]);
+		}
+	}
+
+	int32 upperCount = 0;
+	for (int32 i = lowerCount; i < count; ++i)
+	{
+		if (b2Cross(ps[i] - p2, p1 - p2) > 0.0f)
+		{
+			b2Swap(ps[i], ps[lowerCount + upperCount++]);
+		}
+	}
+
+	// Counter-clockwise: the lower chain from p1 to p2, then the upper chain back.
+	int32 n = 0;
+	hull[n++] = p1;
+	n += b2RecurseHull(hull + n, p1, p2, ps, lowerCount);
+	hull[n++] = p2;
+	n += b2RecurseHull(hull + n, p2, p1, ps + lowerCount, upperCount);
+	return n;
+}
+
+b2HullResult b2ComputeHull(b2Vec2* hull, int32* hullCount, const b2Vec2* points, int32 count)
+{
+	*hullCount = 0;
+	if (count < 3)
+	{
+		return b2_hullTooFewPoints;
+	}
+
+	b2Vec2 stackPoints[b2_hullStackPoints];
+	b2Vec2* ps = stackPoints;
+	if (count > b2_hullStackPoints)
+	{
+		ps = (b2Vec2*)b2Alloc(count * sizeof(b2Vec2));
+	}
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		ps[i] = points[i];
+	}
+
+	int32 n = b2QuickHull(hull, ps, count);
+
+	if (ps != stackPoints)
+	{
+		b2Free(ps);
+	}
+
+	// Weld close neighbors. The hull is small, so this is cheap compared to welding the input.
+	const float weldSquared = (0.5f * b2_linearSlop) * (0.5f * b2_linearSlop);
+	int32 m = 0;
+	for (int32 i = 0; i < n; ++i)
+	{
+		if (m == 0 || b2DistanceSquared(hull[i], hull[m - 1]) >= weldSquared)
+		{
+			hull[m++] = hull[i];
+		}
+	}
+
+	while (m > 1 && b2DistanceSquared(hull[m - 1], hull[0]) < weldSquared)
+	{
+		--m;
+	}
+
+	if (m < 3)
+	{
+		return b2_hullTooFewPoints;
+	}
+
+	// Remove vertices that are nearly on the line through their neighbors until none are left.
+	bool searching = true;
+	while (searching && m >= 3)
+	{
+		searching = false;
+
+		for (int32 i = 0; i < m; ++i)
+		{
+			b2Vec2 prev = hull[i > 0 ? i - 1 : m - 1];
+			b2Vec2 next = hull[i + 1 < m ? i + 1 : 0];
+			b2Vec2 e = next - prev;
+			float length = e.Length();
+
+			float distance = b2Cross(hull[i] - prev, e);
+			if (distance <= b2_linearSlop * length)
+			{
+				for (int32 j = i; j < m - 1; ++j)
+				{
+					hull[j] = hull[j + 1];
+				}
+				--m;
+				searching = true;
+				break;
+			}
+		}
+	}
+
+	if (m < 3)
+	{
+		return b2_hullCollinear;
+	}
+
+	*hullCount = m;
+	return b2_hullOk;
+}
+
+// Split the convex polygon hull[indices[0..count)] into pieces that fit in a polygon.
+static bool b2SplitHull(b2PolygonShape* polygons, int32* polygonCount, int32 capacity,
+						const b2Vec2* hull, const int32* indices, int32 count)
+{
+	if (count <= b2_maxPolygonVertices)
+	{
+		if (*polygonCount == capacity)
+		{
+			return false;
+		}
+
+		b2Vec2 vertices[b2_maxPolygonVertices];
+		for (int32 i = 0; i < count; ++i)
+		{
+			vertices[i] = hull[indices[i]];
+		}
+
+		polygons[*polygonCount].SetConvex(vertices, count);
+		*polygonCount += 1;
+		return true;
+	}
+
+	// The diagonal from the first vertex to the middle one gives two convex halves that share it.
+	int32 half = count / 2;
+
+	int32 stackIndices[b2_hullStackPoints];
+	int32* upper = stackIndices;
+	int32 upperCount = count - half + 1;
+	if (upperCount > b2_hullStackPoints)
+	{
+		upper = (int32*)b2Alloc(upperCount * sizeof(int32));
+	}
+
+	for (int32 i = half; i < count; ++i)
+	{
+		upper[i - half] = indices[i];
+	}
+	upper[upperCount - 1] = indices[0];
+
+	bool ok = b2SplitHull(polygons, polygonCount, capacity, hull, indices, half + 1) &&
+		b2SplitHull(polygons, polygonCount, capacity, hull, upper, upperCount);
+
+	if (upper != stackIndices)
+	{
+		b2Free(upper);
+	}
+
+	return ok;
+}
+
+b2HullResult b2DecomposeHull(b2PolygonShape* polygons, int32* polygonCount, int32 capacity, const b2Vec2* points, int32 count)
+{
+	*polygonCount = 0;
+
+	b2Vec2 stackHull[b2_hullStackPoints];
+	int32 stackIndices[b2_hullStackPoints];
+	b2Vec2* hull = stackHull;
+	int32* indices = stackIndices;
+	if (count > b2_hullStackPoints)
+	{
+		hull = (b2Vec2*)b2Alloc(count * sizeof(b2Vec2));
+		indices = (int32*)b2Alloc(count * sizeof(int32));
+	}
+
+	int32 hullCount;
+	b2HullResult result = b2ComputeHull(hull, &hullCount, points, count);
+	if (result == b2_hullOk)
+	{
+		for (int32 i = 0; i < hullCount; ++i)
+		{
+			indices[i] = i;
+		}
+
+		if (b2SplitHull(polygons, polygonCount, capacity, hull, indices, hullCount) == false)
+		{
+			result = b2_hullTooManyVertices;
+		}
+	}
+
+	if (hull != stackHull)
+	{
+		b2Free(indices);
+		b2Free(hull);
+	}
+
+	return result;
+}
@@ -255,6 +255,56 @@ void b2PolygonShape::Set(const b2Vec2* vertices, int32 count)
 	m_centroid = ComputeCentroid(m_vertices, m);
 }
 
+b2HullResult b2PolygonShape::SetHull(const b2Vec2* points, int32 count)
+{
+	b2Vec2 stackHull[b2_maxPolygonVertices];
+	b2Vec2* hull = stackHull;
+	if (count > b2_maxPolygonVertices)
+	{
+		hull = (b2Vec2*)b2Alloc(count * sizeof(b2Vec2));
+	}
+
+	int32 hullCount;
+	b2HullResult result = b2ComputeHull(hull, &hullCount, points, count);
+	if (result == b2_hullOk && hullCount > b2_maxPolygonVertices)
+	{
+		result = b2_hullTooManyVertices;
+	}
+
+	if (result == b2_hullOk)
+	{
+		SetConvex(hull, hullCount);
+	}
+
+	if (hull != stackHull)
+	{
+		b2Free(hull);
+	}
+
+	return result;
+}
+
+void b2PolygonShape::SetConvex(const b2Vec2* vertices, int32 count)
+{
+	b2Assert(3 <= count && count <= b2_maxPolygonVertices);
+
+	m_count = count;
+	for (int32 i = 0; i < count; ++i)
+	{
+		m_vertices[i] = vertices[i];
+	}
+
+	for (int32 i = 0; i < count; ++i)
+	{
+		int32 i2 = i + 1 < count ? i + 1 : 0;
+		b2Vec2 edge = m_vertices[i2] - m_vertices[i];
+		m_normals[i] = b2Cross(edge, 1.0f);
+		m_normals[i].Normalize();
+	}
+
+	m_centroid = ComputeCentroid(m_vertices, count);
+}
+
 bool b2PolygonShape::TestPoint(const b2Transform& xf, const b2Vec2& p) const
 {
 	b2Vec2 pLocal = b2MulT(xf.q, p - xf.p);
@@ -28,10 +28,39 @@
 #include "box2d/b2_timer.h"
 
 #include <stdio.h>
+#include <string.h>
 
-float b2_toiTime, b2_toiMaxTime;
-int32 b2_toiCalls, b2_toiIters, b2_toiMaxIters;
-int32 b2_toiRootIters, b2_toiMaxRootIters;
+void b2TOIStats::SetZero()
+{
+	memset(this, 0, sizeof(b2TOIStats));
+}
+
+void b2TOIStats::Combine(const b2TOIStats& stats)
+{
+	toiCalls += stats.toiCalls;
+	toiIters += stats.toiIters;
+	toiMaxIters = b2Max(toiMaxIters, stats.toiMaxIters);
+	toiRootIters += stats.toiRootIters;
+	toiMaxRootIters = b2Max(toiMaxRootIters, stats.toiMaxRootIters);
+	toiTime += stats.toiTime;
+	toiMaxTime = b2Max(toiMaxTime, stats.toiMaxTime);
+
+	gjkCalls += stats.gjkCalls;
+	gjkIters += stats.gjkIters;
+	gjkMaxIters = b2Max(gjkMaxIters, stats.gjkMaxIters);
+
+	for (int32 i = 0; i < b2_toiHistogramCount; ++i)
+	{
+		toiIterHistogram[i] += stats.toiIterHistogram[i];
+		toiRootIterHistogram[i] += stats.toiRootIterHistogram[i];
+		gjkIterHistogram[i] += stats.gjkIterHistogram[i];
+	}
+}
+
+static inline void b2AddToHistogram(int32* histogram, int32 value)
+{
+	histogram[b2Min(value, b2_toiHistogramCount - 1)] += 1;
+}
 
 //
 struct b2SeparationFunction
@@ -257,9 +286,14 @@ struct b2SeparationFunction
 // by computing the largest time at which separation is maintained.
 void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 {
-	b2Timer timer;
+	b2SimplexCache cache;
+	cache.count = 0;
+	b2TimeOfImpact(output, input, &cache, nullptr);
+}
 
-	++b2_toiCalls;
+void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input, b2SimplexCache* cache, b2TOIStats* stats)
+{
+	b2Timer timer;
 
 	output->state = b2TOIOutput::e_unknown;
 	output->t = input->tMax;
@@ -283,12 +317,11 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 	b2Assert(target > tolerance);
 
 	float t1 = 0.0f;
-	const int32 k_maxIterations = 20;	// TODO_ERIN b2Settings
 	int32 iter = 0;
+	int32 rootIters = 0;
+	int32 maxRootIters = 0;
 
-	// Prepare input for distance query.
-	b2SimplexCache cache;
-	cache.count = 0;
+	// Prepare input for distance query. The cache warm starts the first query.
 	b2DistanceInput distanceInput;
 	distanceInput.proxyA = input->proxyA;
 	distanceInput.proxyB = input->proxyB;
@@ -307,7 +340,15 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 		distanceInput.transformA = xfA;
 		distanceInput.transformB = xfB;
 		b2DistanceOutput distanceOutput;
-		b2Distance(&distanceOutput, &cache, &distanceInput);
+		b2Distance(&distanceOutput, cache, &distanceInput);
+
+		if (stats)
+		{
+			++stats->gjkCalls;
+			stats->gjkIters += distanceOutput.iterations;
+			stats->gjkMaxIters = b2Max(stats->gjkMaxIters, distanceOutput.iterations);
+			b2AddToHistogram(stats->gjkIterHistogram, distanceOutput.iterations);
+		}
 
 		// If the shapes are overlapped, we give up on continuous collision.
 		if (distanceOutput.distance <= 0.0f)
@@ -328,7 +369,7 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 
 		// Initialize the separating axis.
 		b2SeparationFunction fcn;
-		fcn.Initialize(&cache, proxyA, sweepA, proxyB, sweepB, t1);
+		fcn.Initialize(cache, proxyA, sweepA, proxyB, sweepB, t1);
 #if 0
 		// Dump the curve seen by the root finder
 		{
@@ -426,7 +467,7 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 				}
 
 				++rootIterCount;
-				++b2_toiRootIters;
+				++rootIters;
 
 				float s = fcn.Evaluate(indexA, indexB, t);
 
@@ -449,13 +490,18 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 					s2 = s;
 				}
 				
-				if (rootIterCount == 50)
+				if (rootIterCount == b2_maxTOIRootIterations)
 				{
 					break;
 				}
 			}
 
-			b2_toiMaxRootIters = b2Max(b2_toiMaxRootIters, rootIterCount);
+			maxRootIters = b2Max(maxRootIters, rootIterCount);
+
+			if (stats)
+			{
+				b2AddToHistogram(stats->toiRootIterHistogram, rootIterCount);
+			}
 
 			++pushBackIter;
 
@@ -466,14 +512,13 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 		}
 
 		++iter;
-		++b2_toiIters;
 
 		if (done)
 		{
 			break;
 		}
 
-		if (iter == k_maxIterations)
+		if (iter == b2_maxTOIIterations)
 		{
 			// Root finder got stuck. Semi-victory.
 			output->state = b2TOIOutput::e_failed;
@@ -482,9 +527,17 @@ void b2TimeOfImpact(b2TOIOutput* output, const b2TOIInput* input)
 		}
 	}
 
-	b2_toiMaxIters = b2Max(b2_toiMaxIters, iter);
-
-	float time = timer.GetMilliseconds();
-	b2_toiMaxTime = b2Max(b2_toiMaxTime, time);
-	b2_toiTime += time;
+	if (stats)
+	{
+		++stats->toiCalls;
+		stats->toiIters += iter;
+		stats->toiMaxIters = b2Max(stats->toiMaxIters, iter);
+		stats->toiRootIters += rootIters;
+		stats->toiMaxRootIters = b2Max(stats->toiMaxRootIters, maxRootIters);
+		b2AddToHistogram(stats->toiIterHistogram, iter);
+
+		float time = timer.GetMilliseconds();
+		stats->toiMaxTime = b2Max(stats->toiMaxTime, time);
+		stats->toiTime += time;
+	}
 }
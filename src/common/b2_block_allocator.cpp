@@ -24,6 +24,7 @@
 #include <limits.h>
 #include <string.h>
 #include <stddef.h>
+#include <mutex>
 
 int32 b2BlockAllocator::s_blockSizes[b2_blockSizes] = 
 {
@@ -43,7 +44,9 @@ int32 b2BlockAllocator::s_blockSizes[b2_blockSizes] =
 	640,	// 13
 };
 uint8 b2BlockAllocator::s_blockSizeLookup[b2_maxBlockSize + 1];
-bool b2BlockAllocator::s_blockSizeLookupInitialized;
+
+// Allocators may be constructed on different threads, so the lookup is built once.
+static std::once_flag b2_blockSizeLookupFlag;
 
 struct b2Chunk
 {
@@ -67,7 +70,7 @@ b2BlockAllocator::b2BlockAllocator()
 	memset(m_chunks, 0, m_chunkSpace * sizeof(b2Chunk));
 	memset(m_freeLists, 0, sizeof(m_freeLists));
 
-	if (s_blockSizeLookupInitialized == false)
+	std::call_once(b2_blockSizeLookupFlag, []()
 	{
 		int32 j = 0;
 		for (int32 i = 1; i <= b2_maxBlockSize; ++i)
@@ -83,9 +86,7 @@ b2BlockAllocator::b2BlockAllocator()
 				s_blockSizeLookup[i] = (uint8)j;
 			}
 		}
-
-		s_blockSizeLookupInitialized = true;
-	}
+	});
 }
 
 b2BlockAllocator::~b2BlockAllocator()
@@ -25,6 +25,7 @@
 
 b2StackAllocator::b2StackAllocator()
 {
+	m_data = nullptr;
 	m_index = 0;
 	m_allocation = 0;
 	m_maxAllocation = 0;
@@ -35,6 +36,7 @@ b2StackAllocator::~b2StackAllocator()
 {
 	b2Assert(m_index == 0);
 	b2Assert(m_entryCount == 0);
+	b2Free(m_data);
 }
 
 void* b2StackAllocator::Allocate(int32 size)
@@ -50,6 +52,11 @@ void* b2StackAllocator::Allocate(int32 size)
 	}
 	else
 	{
+		if (m_data == nullptr)
+		{
+			m_data = (char*)b2Alloc(b2_stackSize);
+		}
+
 		entry->data = m_data + m_index;
 		entry->usedMalloc = false;
 		m_index += size;
@@ -24,6 +24,7 @@
 #include "box2d/b2_contact.h"
 #include "box2d/b2_fixture.h"
 #include "box2d/b2_joint.h"
+#include "box2d/b2_polygon_shape.h"
 #include "box2d/b2_world.h"
 
 b2Body::b2Body(const b2BodyDef* bd, b2World* world)
@@ -34,6 +35,7 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 	b2Assert(b2IsValid(bd->angularVelocity));
 	b2Assert(b2IsValid(bd->angularDamping) && bd->angularDamping >= 0.0f);
 	b2Assert(b2IsValid(bd->linearDamping) && bd->linearDamping >= 0.0f);
+	b2Assert(b2IsValid(bd->sleepThreshold) && bd->sleepThreshold >= 0.0f);
 
 	m_flags = 0;
 
@@ -86,6 +88,11 @@ b2Body::b2Body(const b2BodyDef* bd, b2World* world)
 	m_torque = 0.0f;
 
 	m_sleepTime = 0.0f;
+	m_sleepThreshold = bd->sleepThreshold;
+	m_sleepingIsland = b2_nullSleepingIsland;
+	m_sleepingNext = nullptr;
+
+	m_kinematicIndex = -1;
 
 	m_type = bd->type;
 
@@ -127,8 +134,18 @@ void b2Body::SetType(b2BodyType type)
 		return;
 	}
 
+	if (m_type == b2_kinematicBody)
+	{
+		m_world->RemoveKinematicBody(this);
+	}
+
 	m_type = type;
 
+	if (m_type == b2_kinematicBody)
+	{
+		m_world->AddKinematicBody(this);
+	}
+
 	ResetMassData();
 
 	if (m_type == b2_staticBody)
@@ -175,23 +192,7 @@ b2Fixture* b2Body::CreateFixture(const b2FixtureDef* def)
 		return nullptr;
 	}
 
-	b2BlockAllocator* allocator = &m_world->m_blockAllocator;
-
-	void* memory = allocator->Allocate(sizeof(b2Fixture));
-	b2Fixture* fixture = new (memory) b2Fixture;
-	fixture->Create(allocator, this, def);
-
-	if (m_flags & e_activeFlag)
-	{
-		b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
-		fixture->CreateProxies(broadPhase, m_xf);
-	}
-
-	fixture->m_next = m_fixtureList;
-	m_fixtureList = fixture;
-	++m_fixtureCount;
-
-	fixture->m_body = this;
+	b2Fixture* fixture = AddFixture(def);
 
 	// Adjust mass properties if needed.
 	if (fixture->m_density > 0.0f)
@@ -215,6 +216,59 @@ b2Fixture* b2Body::CreateFixture(const b2Shape* shape, float density)
 	return CreateFixture(&def);
 }
 
+b2Fixture* b2Body::CreateFixtures(const b2FixtureDef* def, const b2PolygonShape* polygons, int32 count,
+									const b2MassData* massData)
+{
+	b2Assert(m_world->IsLocked() == false);
+	if (m_world->IsLocked() == true)
+	{
+		return nullptr;
+	}
+
+	b2FixtureDef fd = *def;
+	for (int32 i = 0; i < count; ++i)
+	{
+		fd.shape = polygons + i;
+		AddFixture(&fd);
+	}
+
+	if (massData != nullptr)
+	{
+		SetMassData(massData);
+	}
+	else if (count > 0 && fd.density > 0.0f)
+	{
+		ResetMassData();
+	}
+
+	m_world->m_flags |= b2World::e_newFixture;
+
+	return m_fixtureList;
+}
+
+b2Fixture* b2Body::AddFixture(const b2FixtureDef* def)
+{
+	b2BlockAllocator* allocator = &m_world->m_blockAllocator;
+
+	void* memory = allocator->Allocate(sizeof(b2Fixture));
+	b2Fixture* fixture = new (memory) b2Fixture;
+	fixture->Create(allocator, this, def);
+
+	if (m_flags & e_activeFlag)
+	{
+		b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
+		fixture->CreateProxies(broadPhase, m_xf);
+	}
+
+	fixture->m_next = m_fixtureList;
+	m_fixtureList = fixture;
+	++m_fixtureCount;
+
+	fixture->m_body = this;
+
+	return fixture;
+}
+
 void b2Body::DestroyFixture(b2Fixture* fixture)
 {
 	if (fixture == NULL)
@@ -400,6 +454,11 @@ void b2Body::SetMassData(const b2MassData* massData)
 	m_linearVelocity += b2Cross(m_angularVelocity, m_sweep.c - oldCenter);
 }
 
+void b2Body::WakeSleepingIsland()
+{
+	m_world->WakeSleepingIsland(m_sleepingIsland);
+}
+
 bool b2Body::ShouldCollide(const b2Body* other) const
 {
 	// At least one body should be dynamic.
@@ -460,6 +519,44 @@ void b2Body::SynchronizeFixtures()
 	}
 }
 
+// Compute the swept proxy AABBs without touching the broad-phase tree. Returns true if
+// a proxy left its fat AABB or belongs to a fixture with a single proxy, which looks for new
+// pairs whenever it moves.
+bool b2Body::ComputeSweptAABBs()
+{
+	b2Transform xf1;
+	xf1.q.Set(m_sweep.a0);
+	xf1.p = m_sweep.c0 - b2Mul(xf1.q, m_sweep.localCenter);
+
+	const b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
+	bool enlarged = false;
+	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
+	{
+		f->ComputeSweptAABBs(xf1, m_xf);
+		enlarged = enlarged || (f->m_singleProxy && f->m_proxyCount > 0);
+
+		for (int32 i = 0; i < f->m_proxyCount; ++i)
+		{
+			const b2FixtureProxy* proxy = f->m_proxies + i;
+			enlarged = enlarged || broadPhase->GetFatAABB(proxy->proxyId).Contains(proxy->aabb) == false;
+		}
+	}
+
+	return enlarged;
+}
+
+void b2Body::MoveProxies()
+{
+	b2Vec2 c0 = m_sweep.c0 - b2Mul(b2Rot(m_sweep.a0), m_sweep.localCenter);
+	b2Vec2 displacement = m_xf.p - c0;
+
+	b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
+	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
+	{
+		f->MoveProxies(broadPhase, displacement);
+	}
+}
+
 void b2Body::SetActive(bool flag)
 {
 	b2Assert(m_world->IsLocked() == false);
@@ -484,6 +581,12 @@ void b2Body::SetActive(bool flag)
 	}
 	else
 	{
+		// Inactive bodies cannot stay in a sleeping island.
+		if (m_sleepingIsland != b2_nullSleepingIsland)
+		{
+			WakeSleepingIsland();
+		}
+
 		m_flags &= ~e_activeFlag;
 
 		// Destroy all proxies.
@@ -546,6 +649,7 @@ void b2Body::Dump()
 	b2Log("  bd.bullet = bool(%d);\n", m_flags & e_bulletFlag);
 	b2Log("  bd.active = bool(%d);\n", m_flags & e_activeFlag);
 	b2Log("  bd.gravityScale = %.15lef;\n", m_gravityScale);
+	b2Log("  bd.sleepThreshold = %.15lef;\n", m_sleepThreshold);
 	b2Log("  bodies[%d] = m_world->CreateBody(&bd);\n", m_islandIndex);
 	b2Log("\n");
 	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
@@ -24,7 +24,6 @@
 #include "box2d/b2_block_allocator.h"
 #include "box2d/b2_fixture.h"
 #include "box2d/b2_chain_shape.h"
-#include "box2d/b2_edge_shape.h"
 
 #include <new>
 
@@ -50,8 +49,6 @@ b2ChainAndCircleContact::b2ChainAndCircleContact(b2Fixture* fixtureA, int32 inde
 void b2ChainAndCircleContact::Evaluate(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB)
 {
 	b2ChainShape* chain = (b2ChainShape*)m_fixtureA->GetShape();
-	b2EdgeShape edge;
-	chain->GetChildEdge(&edge, m_indexA);
-	b2CollideEdgeAndCircle(	manifold, &edge, xfA,
-							(b2CircleShape*)m_fixtureB->GetShape(), xfB);
+	b2CollideChainAndCircle(	manifold, chain, m_indexA, xfA,
+								(b2CircleShape*)m_fixtureB->GetShape(), xfB);
 }
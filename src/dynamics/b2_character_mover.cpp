@@ -0,0 +1,406 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "box2d/b2_character_mover.h"
+#include "box2d/b2_broad_phase.h"
+#include "box2d/b2_circle_shape.h"
+#include "box2d/b2_distance.h"
+#include "box2d/b2_shape.h"
+#include "box2d/b2_world.h"
+
+#include <string.h>
+
+// The part of a translation that stops short of a hit by the linear slop, so the next cast
+// starts outside of the surface.
+static b2Vec2 b2StopShort(const b2Vec2& translation, float fraction)
+{
+	float length = translation.Length();
+	float distance = fraction * length - b2_linearSlop;
+	if (distance <= 0.0f)
+	{
+		return b2Vec2_zero;
+	}
+
+	return (distance / length) * translation;
+}
+
+b2CharacterMover::b2CharacterMover(b2World* world, const b2CharacterMoverDef* def)
+{
+	b2Assert(def->shape != nullptr);
+	b2Assert(def->position.IsValid());
+	b2Assert(def->up.IsValid() && def->up.LengthSquared() > 0.0f);
+	b2Assert(0.0f <= def->maxSlopeAngle && def->maxSlopeAngle < 0.5f * b2_pi);
+	b2Assert(def->stepHeight >= 0.0f);
+	b2Assert(def->maxIterations > 0);
+	b2Assert(def->cacheMargin >= 0.0f);
+
+	m_world = world;
+	m_shape = def->shape;
+	m_position = def->position;
+	m_up = def->up;
+	m_up.Normalize();
+	m_minGroundDot = cosf(def->maxSlopeAngle);
+	m_stepHeight = def->stepHeight;
+	m_maxIterations = def->maxIterations;
+	m_cacheMargin = def->cacheMargin;
+	m_filter = def->filter;
+	m_ignoreBody = def->ignoreBody;
+
+	m_planeCount = 0;
+	m_groundIndex = -1;
+
+	m_candidateCapacity = 16;
+	m_candidateCount = 0;
+	m_candidates = (b2FixtureProxy**)b2Alloc(m_candidateCapacity * sizeof(b2FixtureProxy*));
+	m_cacheAABB.lowerBound.SetZero();
+	m_cacheAABB.upperBound.SetZero();
+	m_cacheRevision = 0;
+	m_cacheValid = false;
+	m_queryCount = 0;
+}
+
+b2CharacterMover::~b2CharacterMover()
+{
+	b2Free(m_candidates);
+}
+
+// This is called from b2DynamicTree::Query when the cache is refreshed.
+bool b2CharacterMover::QueryCallback(int32 proxyId)
+{
+	b2FixtureProxy* proxy = (b2FixtureProxy*)m_world->m_contactManager.m_broadPhase.GetUserData(proxyId);
+	if (proxy->fixture->GetBody() == m_ignoreBody)
+	{
+		return true;
+	}
+
+	if (m_candidateCount == m_candidateCapacity)
+	{
+		b2FixtureProxy** oldCandidates = m_candidates;
+		m_candidateCapacity *= 2;
+		m_candidates = (b2FixtureProxy**)b2Alloc(m_candidateCapacity * sizeof(b2FixtureProxy*));
+		memcpy(m_candidates, oldCandidates, m_candidateCount * sizeof(b2FixtureProxy*));
+		b2Free(oldCandidates);
+	}
+
+	m_candidates[m_candidateCount] = proxy;
+	++m_candidateCount;
+	return true;
+}
+
+void b2CharacterMover::UpdateCache(const b2AABB& aabb)
+{
+	const b2BroadPhase& broadPhase = m_world->m_contactManager.m_broadPhase;
+	if (m_cacheValid && m_cacheAABB.Contains(aabb) && broadPhase.TestChanges(m_cacheRevision, m_cacheAABB) == false)
+	{
+		// Proxies that changed elsewhere in the world do not affect the candidates.
+		m_cacheRevision = broadPhase.GetRevision();
+		return;
+	}
+
+	b2Vec2 margin(m_cacheMargin, m_cacheMargin);
+	m_cacheAABB.lowerBound = aabb.lowerBound - margin;
+	m_cacheAABB.upperBound = aabb.upperBound + margin;
+
+	m_candidateCount = 0;
+	broadPhase.Query(this, m_cacheAABB);
+
+	m_cacheRevision = broadPhase.GetRevision();
+	m_cacheValid = true;
+	++m_queryCount;
+}
+
+// Find the closest surface hit by a shape moving from a position by a translation.
+bool b2CharacterMover::CastShape(b2CharacterPlane* plane, float* fraction, const b2Shape* shape, const b2Vec2& position,
+								const b2Vec2& translation) const
+{
+	b2Transform xf(position, b2Rot(0.0f));
+
+	b2AABB aabb;
+	shape->ComputeAABB(&aabb, xf, 0);
+	aabb.lowerBound += b2Min(translation, b2Vec2_zero);
+	aabb.upperBound += b2Max(translation, b2Vec2_zero);
+
+	bool hit = false;
+	float maxFraction = 1.0f;
+	for (int32 i = 0; i < m_candidateCount && maxFraction > 0.0f; ++i)
+	{
+		const b2FixtureProxy* proxy = m_candidates[i];
+		if (b2TestOverlap(proxy->aabb, aabb) == false)
+		{
+			continue;
+		}
+
+		b2Fixture* fixture = proxy->fixture;
+		if (fixture->IsSensor() || b2ShouldCollide(fixture->GetFilterData(), m_filter) == false)
+		{
+			continue;
+		}
+
+		b2ShapeCastOutput output;
+		if (fixture->ShapeCast(&output, shape, xf, maxFraction * translation, proxy->childIndex))
+		{
+			maxFraction *= output.lambda;
+			plane->fixture = fixture;
+			plane->point = output.point;
+			plane->normal = output.normal;
+			hit = true;
+		}
+	}
+
+	*fraction = maxFraction;
+	return hit;
+}
+
+bool b2CharacterMover::IsWalkable(const b2CharacterPlane& plane) const
+{
+	float rise = b2Dot(plane.normal, m_up);
+	if (rise >= m_minGroundDot)
+	{
+		return true;
+	}
+
+	if (rise <= 0.0f)
+	{
+		return false;
+	}
+
+	// A rounded shape touches the edge of a step with a tilted normal. Probe the surface just
+	// beyond the contact point to tell the edge of a step from a steep slope.
+	b2Vec2 ahead = rise * m_up - plane.normal;
+	ahead.Normalize();
+
+	b2CircleShape point;
+	point.m_radius = 0.0f;
+
+	// The contact point lies on the skin of the surface.
+	float offset = b2_polygonRadius + b2_linearSlop;
+	b2Vec2 start = plane.point + offset * ahead + 2.0f * offset * m_up;
+
+	b2CharacterPlane surface;
+	float fraction;
+	if (CastShape(&surface, &fraction, &point, start, -4.0f * offset * m_up) == false)
+	{
+		return false;
+	}
+
+	return b2Dot(surface.normal, m_up) >= m_minGroundDot;
+}
+
+bool b2CharacterMover::Cast(b2CharacterPlane* plane, float* fraction, const b2Vec2& position, const b2Vec2& translation) const
+{
+	if (CastShape(plane, fraction, m_shape, position, translation) == false)
+	{
+		return false;
+	}
+
+	plane->walkable = IsWalkable(*plane);
+	return true;
+}
+
+// Remove the part of a translation that goes into a surface.
+b2Vec2 b2CharacterMover::Clip(const b2Vec2& translation, const b2CharacterPlane& plane) const
+{
+	const b2Vec2& normal = plane.normal;
+	float approach = b2Dot(translation, normal);
+	if (approach >= 0.0f)
+	{
+		return translation;
+	}
+
+	if (plane.walkable)
+	{
+		// Keep the motion across the ground and follow its slope. The motion along up that
+		// pushes into the ground is dropped, so the mover does not slide down the slope.
+		b2Vec2 side = translation - b2Dot(translation, m_up) * m_up;
+		return side - (b2Dot(side, normal) / b2Dot(m_up, normal)) * m_up;
+	}
+
+	b2Vec2 slide = translation - approach * normal;
+	if (b2Dot(slide, m_up) > 0.0f && b2Dot(normal, m_up) > 0.0f)
+	{
+		// A steep slope blocks the mover like an upright wall, so the mover cannot climb it
+		// but still falls down along it.
+		b2Vec2 wall = normal - b2Dot(normal, m_up) * m_up;
+		if (wall.Normalize() < b2_epsilon)
+		{
+			return b2Vec2_zero;
+		}
+
+		slide = translation - b2Dot(translation, wall) * wall;
+	}
+
+	return slide;
+}
+
+// Try to walk onto a step in front of the mover by lifting the shape, moving it across and
+// dropping it back down onto walkable ground.
+bool b2CharacterMover::Step(b2Vec2* translation)
+{
+	b2Vec2 side = *translation - b2Dot(*translation, m_up) * m_up;
+	if (side.LengthSquared() < b2_linearSlop * b2_linearSlop)
+	{
+		return false;
+	}
+
+	b2CharacterPlane plane;
+	float fraction;
+
+	b2Vec2 position = m_position;
+	b2Vec2 lift = m_stepHeight * m_up;
+	if (Cast(&plane, &fraction, position, lift))
+	{
+		lift = b2StopShort(lift, fraction);
+	}
+	position += lift;
+
+	float sideFraction;
+	b2Vec2 across = side;
+	if (Cast(&plane, &sideFraction, position, side))
+	{
+		across = b2StopShort(side, sideFraction);
+	}
+
+	if (across.LengthSquared() < b2_linearSlop * b2_linearSlop)
+	{
+		return false;
+	}
+	position += across;
+
+	b2CharacterPlane ground;
+	b2Vec2 drop = -(b2Dot(lift, m_up) + 2.0f * b2_linearSlop) * m_up;
+	if (Cast(&ground, &fraction, position, drop) == false || ground.walkable == false)
+	{
+		return false;
+	}
+	position += b2StopShort(drop, fraction);
+
+	m_position = position;
+	AddPlane(ground);
+	*translation = (1.0f - sideFraction) * side;
+	return true;
+}
+
+void b2CharacterMover::AddPlane(const b2CharacterPlane& plane)
+{
+	if (m_planeCount == b2_maxCharacterPlanes)
+	{
+		return;
+	}
+
+	if (plane.walkable)
+	{
+		if (m_groundIndex == -1 || b2Dot(plane.normal, m_up) > b2Dot(m_planes[m_groundIndex].normal, m_up))
+		{
+			m_groundIndex = m_planeCount;
+		}
+	}
+
+	m_planes[m_planeCount] = plane;
+	++m_planeCount;
+}
+
+b2Vec2 b2CharacterMover::Move(const b2Vec2& displacement)
+{
+	bool wasGrounded = m_groundIndex != -1;
+	b2Vec2 start = m_position;
+	m_planeCount = 0;
+	m_groundIndex = -1;
+
+	// One query covers every cast of the move. The slides are no longer than the displacement
+	// and a step and the ground probe each reach at most the step height further.
+	float reach = displacement.Length() + 2.0f * (m_stepHeight + b2_linearSlop);
+	b2AABB aabb;
+	m_shape->ComputeAABB(&aabb, b2Transform(m_position, b2Rot(0.0f)), 0);
+	aabb.lowerBound -= b2Vec2(reach, reach);
+	aabb.upperBound += b2Vec2(reach, reach);
+	UpdateCache(aabb);
+
+	b2Vec2 translation = displacement;
+	bool stepped = false;
+	int32 firstPlane = 0;
+	for (int32 iteration = 0; iteration < m_maxIterations; ++iteration)
+	{
+		if (translation.LengthSquared() < b2_epsilon * b2_epsilon)
+		{
+			break;
+		}
+
+		b2CharacterPlane plane;
+		float fraction;
+		if (Cast(&plane, &fraction, m_position, translation) == false)
+		{
+			m_position += translation;
+			break;
+		}
+
+		m_position += b2StopShort(translation, fraction);
+		AddPlane(plane);
+		translation = (1.0f - fraction) * translation;
+
+		// The mover walks onto one step per move.
+		if (plane.walkable == false && wasGrounded && stepped == false && m_stepHeight > 0.0f)
+		{
+			stepped = Step(&translation);
+			if (stepped)
+			{
+				firstPlane = m_planeCount;
+				continue;
+			}
+		}
+
+		translation = Clip(translation, plane);
+
+		// In 2D two different surfaces that both block the motion form a corner.
+		for (int32 i = firstPlane; i < m_planeCount; ++i)
+		{
+			const b2Vec2& normal = m_planes[i].normal;
+			if (b2Dot(normal, plane.normal) < 0.999f && b2Dot(translation, normal) < 0.0f)
+			{
+				translation.SetZero();
+				break;
+			}
+		}
+	}
+
+	// Keep a grounded mover on the ground when it walks down slopes and steps, and find the
+	// ground under a mover that did not touch it.
+	if (m_groundIndex == -1 && b2Dot(displacement, m_up) <= 0.0f)
+	{
+		float probe = 2.0f * b2_linearSlop;
+		if (wasGrounded)
+		{
+			probe += m_stepHeight;
+		}
+
+		b2Vec2 drop = -probe * m_up;
+		b2CharacterPlane plane;
+		float fraction;
+		if (Cast(&plane, &fraction, m_position, drop) && plane.walkable)
+		{
+			m_position += b2StopShort(drop, fraction);
+			AddPlane(plane);
+		}
+	}
+
+	return m_position - start;
+}
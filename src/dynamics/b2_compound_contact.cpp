@@ -0,0 +1,264 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "b2_compound_contact.h"
+
+#include "box2d/b2_block_allocator.h"
+#include "box2d/b2_capsule_shape.h"
+#include "box2d/b2_chain_shape.h"
+#include "box2d/b2_circle_shape.h"
+#include "box2d/b2_compound_shape.h"
+#include "box2d/b2_edge_shape.h"
+#include "box2d/b2_fixture.h"
+#include "box2d/b2_heightfield_shape.h"
+#include "box2d/b2_polygon_shape.h"
+
+#include <new>
+
+b2Contact* b2CompoundContact::Create(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB, b2BlockAllocator* allocator)
+{
+	void* mem = allocator->Allocate(sizeof(b2CompoundContact));
+	return new (mem) b2CompoundContact(fixtureA, indexA, fixtureB, indexB);
+}
+
+void b2CompoundContact::Destroy(b2Contact* contact, b2BlockAllocator* allocator)
+{
+	((b2CompoundContact*)contact)->~b2CompoundContact();
+	allocator->Free(contact, sizeof(b2CompoundContact));
+}
+
+b2CompoundContact::b2CompoundContact(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB)
+: b2Contact(fixtureA, indexA, fixtureB, indexB)
+{
+	b2Assert(m_fixtureA->GetType() == b2Shape::e_compound || m_fixtureB->GetType() == b2Shape::e_compound);
+	m_cache.edgeA = 0;
+	m_cache.edgeB = 0;
+}
+
+// The manifold of a pair that was collided in the other order, seen from the original order.
+static void b2FlipManifold(b2Manifold* manifold)
+{
+	switch (manifold->type)
+	{
+	case b2Manifold::e_circles:
+		b2Swap(manifold->localPoint, manifold->points[0].localPoint);
+		break;
+
+	case b2Manifold::e_faceA:
+		manifold->type = b2Manifold::e_faceB;
+		break;
+
+	case b2Manifold::e_faceB:
+		manifold->type = b2Manifold::e_faceA;
+		break;
+	}
+
+	for (int32 i = 0; i < manifold->pointCount; ++i)
+	{
+		b2ContactFeature& cf = manifold->points[i].id.cf;
+		b2Swap(cf.indexA, cf.indexB);
+		b2Swap(cf.typeA, cf.typeB);
+	}
+}
+
+void b2CompoundContact::Evaluate(b2Manifold* manifold, const b2Transform& xfA, const b2Transform& xfB)
+{
+	// Resolve compound children so shape B is always convex.
+	const b2Shape* shapeA = m_fixtureA->GetShape();
+	int32 indexA = m_indexA;
+	if (shapeA->m_type == b2Shape::e_compound)
+	{
+		shapeA = ((const b2CompoundShape*)shapeA)->GetChild(indexA);
+		indexA = 0;
+	}
+
+	const b2Shape* shapeB = m_fixtureB->GetShape();
+	if (shapeB->m_type == b2Shape::e_compound)
+	{
+		shapeB = ((const b2CompoundShape*)shapeB)->GetChild(m_indexB);
+	}
+
+	const b2CircleShape* circleB = (const b2CircleShape*)shapeB;
+	const b2PolygonShape* polygonB = (const b2PolygonShape*)shapeB;
+	const b2CapsuleShape* capsuleB = (const b2CapsuleShape*)shapeB;
+
+	// Pairs that have no collide function in this order are collided swapped.
+	bool flip = false;
+	switch (shapeA->m_type)
+	{
+	case b2Shape::e_circle:
+		{
+			const b2CircleShape* circleA = (const b2CircleShape*)shapeA;
+			switch (shapeB->m_type)
+			{
+			case b2Shape::e_circle:
+				b2CollideCircles(manifold, circleA, xfA, circleB, xfB);
+				break;
+
+			case b2Shape::e_polygon:
+				b2CollidePolygonAndCircle(manifold, polygonB, xfB, circleA, xfA);
+				flip = true;
+				break;
+
+			case b2Shape::e_capsule:
+				b2CollideCapsuleAndCircle(manifold, capsuleB, xfB, circleA, xfA);
+				flip = true;
+				break;
+
+			default:
+				b2Assert(false);
+				break;
+			}
+		}
+		break;
+
+	case b2Shape::e_polygon:
+		{
+			const b2PolygonShape* polygonA = (const b2PolygonShape*)shapeA;
+			switch (shapeB->m_type)
+			{
+			case b2Shape::e_circle:
+				b2CollidePolygonAndCircle(manifold, polygonA, xfA, circleB, xfB);
+				break;
+
+			case b2Shape::e_polygon:
+				b2CollidePolygons(manifold, polygonA, xfA, polygonB, xfB, &m_cache);
+				break;
+
+			case b2Shape::e_capsule:
+				b2CollideCapsuleAndPolygon(manifold, capsuleB, xfB, polygonA, xfA);
+				flip = true;
+				break;
+
+			default:
+				b2Assert(false);
+				break;
+			}
+		}
+		break;
+
+	case b2Shape::e_capsule:
+		{
+			const b2CapsuleShape* capsuleA = (const b2CapsuleShape*)shapeA;
+			switch (shapeB->m_type)
+			{
+			case b2Shape::e_circle:
+				b2CollideCapsuleAndCircle(manifold, capsuleA, xfA, circleB, xfB);
+				break;
+
+			case b2Shape::e_polygon:
+				b2CollideCapsuleAndPolygon(manifold, capsuleA, xfA, polygonB, xfB);
+				break;
+
+			case b2Shape::e_capsule:
+				b2CollideCapsules(manifold, capsuleA, xfA, capsuleB, xfB);
+				break;
+
+			default:
+				b2Assert(false);
+				break;
+			}
+		}
+		break;
+
+	case b2Shape::e_edge:
+		{
+			const b2EdgeShape* edgeA = (const b2EdgeShape*)shapeA;
+			switch (shapeB->m_type)
+			{
+			case b2Shape::e_circle:
+				b2CollideEdgeAndCircle(manifold, edgeA, xfA, circleB, xfB);
+				break;
+
+			case b2Shape::e_polygon:
+				b2CollideEdgeAndPolygon(manifold, edgeA, xfA, polygonB, xfB);
+				break;
+
+			case b2Shape::e_capsule:
+				b2CollideEdgeAndCapsule(manifold, edgeA, xfA, capsuleB, xfB);
+				break;
+
+			default:
+				b2Assert(false);
+				break;
+			}
+		}
+		break;
+
+	case b2Shape::e_chain:
+		{
+			const b2ChainShape* chainA = (const b2ChainShape*)shapeA;
+			switch (shapeB->m_type)
+			{
+			case b2Shape::e_circle:
+				b2CollideChainAndCircle(manifold, chainA, indexA, xfA, circleB, xfB);
+				break;
+
+			case b2Shape::e_polygon:
+				b2CollideChainAndPolygon(manifold, chainA, indexA, xfA, polygonB, xfB);
+				break;
+
+			case b2Shape::e_capsule:
+				b2CollideChainAndCapsule(manifold, chainA, indexA, xfA, capsuleB, xfB);
+				break;
+
+			default:
+				b2Assert(false);
+				break;
+			}
+		}
+		break;
+
+	case b2Shape::e_heightfield:
+		{
+			const b2HeightfieldShape* heightfieldA = (const b2HeightfieldShape*)shapeA;
+			switch (shapeB->m_type)
+			{
+			case b2Shape::e_circle:
+				b2CollideHeightfieldAndCircle(manifold, heightfieldA, indexA, xfA, circleB, xfB);
+				break;
+
+			case b2Shape::e_polygon:
+				b2CollideHeightfieldAndPolygon(manifold, heightfieldA, indexA, xfA, polygonB, xfB);
+				break;
+
+			case b2Shape::e_capsule:
+				b2CollideHeightfieldAndCapsule(manifold, heightfieldA, indexA, xfA, capsuleB, xfB);
+				break;
+
+			default:
+				b2Assert(false);
+				break;
+			}
+		}
+		break;
+
+	default:
+		b2Assert(false);
+		break;
+	}
+
+	if (flip)
+	{
+		b2FlipManifold(manifold);
+	}
+}
@@ -0,0 +1,150 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "b2_constraint_graph.h"
+
+#include "box2d/b2_body.h"
+#include "box2d/b2_contact.h"
+#include "box2d/b2_fixture.h"
+#include "box2d/b2_joint.h"
+#include "box2d/b2_stack_allocator.h"
+
+#include <string.h>
+
+// Find the lowest color not used by either body. The index is -1 for a body that does
+// not take part in coloring.
+static int32 b2AssignColor(uint32* bodyColors, int32 indexA, int32 indexB)
+{
+	uint32 usedColors = 0;
+	if (indexA != -1)
+	{
+		usedColors |= bodyColors[indexA];
+	}
+	if (indexB != -1)
+	{
+		usedColors |= bodyColors[indexB];
+	}
+
+	for (int32 color = 0; color < b2_graphColorCount; ++color)
+	{
+		uint32 bit = uint32(1) << color;
+		if ((usedColors & bit) == 0)
+		{
+			if (indexA != -1)
+			{
+				bodyColors[indexA] |= bit;
+			}
+			if (indexB != -1)
+			{
+				bodyColors[indexB] |= bit;
+			}
+			return color;
+		}
+	}
+
+	return b2_graphColorCount;
+}
+
+void b2ConstraintGraph::Color(b2StackAllocator* allocator, int32 bodyCount,
+							  b2Joint** joints, int32 jointCount, b2Contact** contacts, int32 contactCount)
+{
+	b2Assert(b2_graphColorCount <= 32);
+
+	const int32 colorCount = b2_graphColorCount + 1;
+	int32 jointCounts[colorCount] = {0};
+	int32 contactCounts[colorCount] = {0};
+
+	uint32* bodyColors = (uint32*)allocator->Allocate(bodyCount * sizeof(uint32));
+	memset(bodyColors, 0, bodyCount * sizeof(uint32));
+
+	int32 maxCount = b2Max(jointCount, contactCount);
+	int32* colors = (int32*)allocator->Allocate(maxCount * sizeof(int32));
+	void** sorted = (void**)allocator->Allocate(maxCount * sizeof(void*));
+
+	// Joints first so they get the low colors. Joints write back both bodies even if one
+	// has no mass, and gear joints touch four bodies, so those are not colored.
+	for (int32 i = 0; i < jointCount; ++i)
+	{
+		b2Joint* joint = joints[i];
+		b2Body* bodyA = joint->GetBodyA();
+		b2Body* bodyB = joint->GetBodyB();
+
+		int32 color = b2_graphColorCount;
+		if (joint->GetType() != e_gearJoint && bodyA->m_type == b2_dynamicBody && bodyB->m_type == b2_dynamicBody)
+		{
+			color = b2AssignColor(bodyColors, bodyA->m_islandIndex, bodyB->m_islandIndex);
+		}
+
+		colors[i] = color;
+		++jointCounts[color];
+	}
+
+	int32 offsets[colorCount];
+	int32 offset = 0;
+	for (int32 color = 0; color < colorCount; ++color)
+	{
+		offsets[color] = offset;
+		m_colors[color].jointStart = offset;
+		m_colors[color].jointCount = jointCounts[color];
+		offset += jointCounts[color];
+	}
+
+	// Stable counting sort.
+	for (int32 i = 0; i < jointCount; ++i)
+	{
+		sorted[offsets[colors[i]]++] = joints[i];
+	}
+	memcpy(joints, sorted, jointCount * sizeof(b2Joint*));
+
+	for (int32 i = 0; i < contactCount; ++i)
+	{
+		b2Contact* contact = contacts[i];
+		b2Body* bodyA = contact->GetFixtureA()->GetBody();
+		b2Body* bodyB = contact->GetFixtureB()->GetBody();
+		int32 indexA = bodyA->m_type == b2_dynamicBody ? bodyA->m_islandIndex : -1;
+		int32 indexB = bodyB->m_type == b2_dynamicBody ? bodyB->m_islandIndex : -1;
+
+		int32 color = b2AssignColor(bodyColors, indexA, indexB);
+		colors[i] = color;
+		++contactCounts[color];
+	}
+
+	offset = 0;
+	for (int32 color = 0; color < colorCount; ++color)
+	{
+		offsets[color] = offset;
+		m_colors[color].contactStart = offset;
+		m_colors[color].contactCount = contactCounts[color];
+		offset += contactCounts[color];
+	}
+
+	for (int32 i = 0; i < contactCount; ++i)
+	{
+		sorted[offsets[colors[i]]++] = contacts[i];
+	}
+	memcpy(contacts, sorted, contactCount * sizeof(b2Contact*));
+
+	allocator->Free(sorted);
+	allocator->Free(colors);
+	allocator->Free(bodyColors);
+}
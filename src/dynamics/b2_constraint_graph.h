@@ -0,0 +1,62 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef B2_CONSTRAINT_GRAPH_H
+#define B2_CONSTRAINT_GRAPH_H
+
+#include "box2d/b2_settings.h"
+
+class b2Body;
+class b2Contact;
+class b2Joint;
+class b2StackAllocator;
+
+/// The number of graph colors. Constraints that do not fit go to an overflow color.
+const int32 b2_graphColorCount = 12;
+
+/// The constraints of one color. These are ranges of the island joint and contact arrays.
+struct b2GraphColor
+{
+	int32 jointStart;
+	int32 jointCount;
+	int32 contactStart;
+	int32 contactCount;
+};
+
+/// This is an internal class. It colors the constraints of an island so that the
+/// constraints of one color share no dynamic body and can be solved in parallel.
+/// Static and kinematic bodies are ignored because the solver never writes to them.
+/// Constraints that cannot be colored go to the overflow color, which is solved
+/// serially.
+class b2ConstraintGraph
+{
+public:
+	/// Reorder the joints and contacts by color. The bodies must have island indices.
+	void Color(b2StackAllocator* allocator, int32 bodyCount,
+				b2Joint** joints, int32 jointCount, b2Contact** contacts, int32 contactCount);
+
+	/// The colors followed by the overflow color.
+	b2GraphColor m_colors[b2_graphColorCount + 1];
+};
+
+#endif
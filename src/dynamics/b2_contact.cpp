@@ -20,12 +20,21 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include "b2_capsule_circle_contact.h"
+#include "b2_capsule_contact.h"
+#include "b2_capsule_polygon_contact.h"
+#include "b2_chain_capsule_contact.h"
 #include "b2_chain_circle_contact.h"
 #include "b2_chain_polygon_contact.h"
 #include "b2_circle_contact.h"
+#include "b2_compound_contact.h"
 #include "b2_contact_solver.h"
+#include "b2_edge_capsule_contact.h"
 #include "b2_edge_circle_contact.h"
 #include "b2_edge_polygon_contact.h"
+#include "b2_heightfield_capsule_contact.h"
+#include "b2_heightfield_circle_contact.h"
+#include "b2_heightfield_polygon_contact.h"
 #include "b2_polygon_circle_contact.h"
 #include "b2_polygon_contact.h"
 
@@ -50,6 +59,21 @@ void b2Contact::InitializeRegisters()
 	AddType(b2EdgeAndPolygonContact::Create, b2EdgeAndPolygonContact::Destroy, b2Shape::e_edge, b2Shape::e_polygon);
 	AddType(b2ChainAndCircleContact::Create, b2ChainAndCircleContact::Destroy, b2Shape::e_chain, b2Shape::e_circle);
 	AddType(b2ChainAndPolygonContact::Create, b2ChainAndPolygonContact::Destroy, b2Shape::e_chain, b2Shape::e_polygon);
+	AddType(b2HeightfieldAndCircleContact::Create, b2HeightfieldAndCircleContact::Destroy, b2Shape::e_heightfield, b2Shape::e_circle);
+	AddType(b2HeightfieldAndPolygonContact::Create, b2HeightfieldAndPolygonContact::Destroy, b2Shape::e_heightfield, b2Shape::e_polygon);
+	AddType(b2CapsuleContact::Create, b2CapsuleContact::Destroy, b2Shape::e_capsule, b2Shape::e_capsule);
+	AddType(b2CapsuleAndCircleContact::Create, b2CapsuleAndCircleContact::Destroy, b2Shape::e_capsule, b2Shape::e_circle);
+	AddType(b2CapsuleAndPolygonContact::Create, b2CapsuleAndPolygonContact::Destroy, b2Shape::e_capsule, b2Shape::e_polygon);
+	AddType(b2EdgeAndCapsuleContact::Create, b2EdgeAndCapsuleContact::Destroy, b2Shape::e_edge, b2Shape::e_capsule);
+	AddType(b2ChainAndCapsuleContact::Create, b2ChainAndCapsuleContact::Destroy, b2Shape::e_chain, b2Shape::e_capsule);
+	AddType(b2HeightfieldAndCapsuleContact::Create, b2HeightfieldAndCapsuleContact::Destroy, b2Shape::e_heightfield, b2Shape::e_capsule);
+	AddType(b2CompoundContact::Create, b2CompoundContact::Destroy, b2Shape::e_compound, b2Shape::e_circle);
+	AddType(b2CompoundContact::Create, b2CompoundContact::Destroy, b2Shape::e_compound, b2Shape::e_polygon);
+	AddType(b2CompoundContact::Create, b2CompoundContact::Destroy, b2Shape::e_compound, b2Shape::e_capsule);
+	AddType(b2CompoundContact::Create, b2CompoundContact::Destroy, b2Shape::e_compound, b2Shape::e_compound);
+	AddType(b2CompoundContact::Create, b2CompoundContact::Destroy, b2Shape::e_edge, b2Shape::e_compound);
+	AddType(b2CompoundContact::Create, b2CompoundContact::Destroy, b2Shape::e_chain, b2Shape::e_compound);
+	AddType(b2CompoundContact::Create, b2CompoundContact::Destroy, b2Shape::e_heightfield, b2Shape::e_compound);
 }
 
 void b2Contact::AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* destoryFcn,
@@ -72,11 +96,8 @@ void b2Contact::AddType(b2ContactCreateFcn* createFcn, b2ContactDestroyFcn* dest
 
 b2Contact* b2Contact::Create(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB, b2BlockAllocator* allocator)
 {
-	if (s_initialized == false)
-	{
-		InitializeRegisters();
-		s_initialized = true;
-	}
+	// The registers are built by the world constructor.
+	b2Assert(s_initialized == true);
 
 	b2Shape::Type type1 = fixtureA->GetType();
 	b2Shape::Type type2 = fixtureB->GetType();
@@ -138,6 +159,7 @@ b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 	m_indexB = indexB;
 
 	m_manifold.pointCount = 0;
+	m_manifoldXf.SetIdentity();
 
 	m_prev = nullptr;
 	m_next = nullptr;
@@ -153,6 +175,7 @@ b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 	m_nodeB.other = nullptr;
 
 	m_toiCount = 0;
+	m_simplexCache.count = 0;
 
 	m_friction = b2MixFriction(m_fixtureA->m_friction, m_fixtureB->m_friction);
 	m_restitution = b2MixRestitution(m_fixtureA->m_restitution, m_fixtureB->m_restitution);
@@ -162,9 +185,10 @@ b2Contact::b2Contact(b2Fixture* fA, int32 indexA, b2Fixture* fB, int32 indexB)
 
 // Update the contact manifold and touching status.
 // Note: do not assume the fixture AABBs are overlapping or are valid.
-void b2Contact::Update(b2ContactListener* listener)
+bool b2Contact::Update(b2ContactListener* listener, float linearTolerance, float angularTolerance)
 {
 	b2Manifold oldManifold = m_manifold;
+	bool reused = false;
 
 	// Re-enable this contact.
 	m_flags |= e_enabledFlag;
@@ -191,10 +215,18 @@ void b2Contact::Update(b2ContactListener* listener)
 		// Sensors don't generate manifolds.
 		m_manifold.pointCount = 0;
 	}
+	else if (wasTouching && m_manifold.pointCount > 0 && CanReuseManifold(xfA, xfB, linearTolerance, angularTolerance))
+	{
+		// The local manifold is still valid. The solver computes the separations from
+		// the current transforms and the stored impulses carry over.
+		touching = true;
+		reused = true;
+	}
 	else
 	{
 		Evaluate(&m_manifold, xfA, xfB);
 		touching = m_manifold.pointCount > 0;
+		m_manifoldXf = b2MulT(xfA, xfB);
 
 		// Match old contact ids to new contact ids and copy the
 		// stored impulses to warm start the solver.
@@ -248,4 +280,28 @@ void b2Contact::Update(b2ContactListener* listener)
 	{
 		listener->PreSolve(this, &oldManifold);
 	}
+
+	return reused;
+}
+
+bool b2Contact::CanReuseManifold(const b2Transform& xfA, const b2Transform& xfB, float linearTolerance, float angularTolerance) const
+{
+	if (linearTolerance <= 0.0f)
+	{
+		return false;
+	}
+
+	b2Transform xf = b2MulT(xfA, xfB);
+
+	b2Vec2 d = xf.p - m_manifoldXf.p;
+	if (b2Dot(d, d) > linearTolerance * linearTolerance)
+	{
+		return false;
+	}
+
+	// Sine and cosine of the rotation since the manifold was computed. The cosine rules out
+	// a half turn, which has a small sine too.
+	float s = m_manifoldXf.q.c * xf.q.s - m_manifoldXf.q.s * xf.q.c;
+	float c = m_manifoldXf.q.c * xf.q.c + m_manifoldXf.q.s * xf.q.s;
+	return c > 0.0f && b2Abs(s) <= angularTolerance;
 }
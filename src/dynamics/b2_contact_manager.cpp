@@ -21,9 +21,12 @@
 // SOFTWARE.
 
 #include "box2d/b2_body.h"
+#include "box2d/b2_chain_shape.h"
+#include "box2d/b2_compound_shape.h"
 #include "box2d/b2_contact.h"
 #include "box2d/b2_contact_manager.h"
 #include "box2d/b2_fixture.h"
+#include "box2d/b2_heightfield_shape.h"
 #include "box2d/b2_world_callbacks.h"
 
 b2ContactFilter b2_defaultFilter;
@@ -36,6 +39,10 @@ b2ContactManager::b2ContactManager()
 	m_contactFilter = &b2_defaultFilter;
 	m_contactListener = &b2_defaultListener;
 	m_allocator = nullptr;
+	m_cacheLinearTolerance = 0.0f;
+	m_cacheAngularTolerance = 0.0f;
+	m_cacheHitCount = 0;
+	m_cacheMissCount = 0;
 }
 
 void b2ContactManager::Destroy(b2Contact* c)
@@ -103,11 +110,79 @@ void b2ContactManager::Destroy(b2Contact* c)
 	--m_contactCount;
 }
 
+// Bring a fat AABB into the frame of a fixture with a single proxy. The box grows by the
+// margin of that proxy, so children that move with the fixture within its fat AABB are still
+// found.
+static b2AABB b2GetChildQueryAABB(const b2Fixture* fixture, const b2AABB& aabb)
+{
+	b2Vec2 r(b2_aabbExtension, b2_aabbExtension);
+	b2AABB fatAABB;
+	fatAABB.lowerBound = aabb.lowerBound - r;
+	fatAABB.upperBound = aabb.upperBound + r;
+	return b2MulT(fixture->GetBody()->GetTransform(), fatAABB);
+}
+
+// Does a child of a fixture with a single proxy overlap a world box?
+static bool b2TestChildOverlap(const b2Fixture* fixture, int32 childIndex, const b2AABB& aabb)
+{
+	b2AABB childAABB;
+	b2Transform identity;
+	identity.SetIdentity();
+	fixture->GetShape()->ComputeAABB(&childAABB, identity, childIndex);
+	return b2TestOverlap(childAABB, b2GetChildQueryAABB(fixture, aabb));
+}
+
+// Find the children of a fixture with a single proxy that may overlap an AABB given in the
+// shape frame.
+template <typename T>
+static void b2QueryChildren(const b2Fixture* fixture, T* callback, const b2AABB& aabb)
+{
+	const b2Shape* shape = fixture->GetShape();
+	switch (shape->m_type)
+	{
+	case b2Shape::e_chain:
+		((const b2ChainShape*)shape)->QueryTree(callback, aabb);
+		break;
+
+	case b2Shape::e_heightfield:
+		((const b2HeightfieldShape*)shape)->QueryCells(callback, aabb);
+		break;
+
+	case b2Shape::e_compound:
+		((const b2CompoundShape*)shape)->QueryTree(callback, aabb);
+		break;
+
+	default:
+		b2Assert(false);
+		break;
+	}
+}
+
+// The fat proxy AABB or, for a fixture with a single proxy, the child AABB grown by the proxy
+// margin.
+b2AABB b2ContactManager::GetPairAABB(const b2Fixture* fixture, int32 childIndex) const
+{
+	if (fixture->m_singleProxy == false)
+	{
+		return m_broadPhase.GetFatAABB(fixture->m_proxies[childIndex].proxyId);
+	}
+
+	b2Vec2 r(b2_aabbExtension, b2_aabbExtension);
+	b2AABB aabb;
+	fixture->GetShape()->ComputeAABB(&aabb, fixture->GetBody()->GetTransform(), childIndex);
+	aabb.lowerBound -= r;
+	aabb.upperBound += r;
+	return aabb;
+}
+
 // This is the top level collision call for the time step. Here
 // all the narrow phase collision is processed for the world
 // contact list.
 void b2ContactManager::Collide()
 {
+	m_cacheHitCount = 0;
+	m_cacheMissCount = 0;
+
 	// Update awake contacts.
 	b2Contact* c = m_contactList;
 	while (c)
@@ -154,10 +229,21 @@ void b2ContactManager::Collide()
 			continue;
 		}
 
-		int32 proxyIdA = fixtureA->m_proxies[indexA].proxyId;
-		int32 proxyIdB = fixtureB->m_proxies[indexB].proxyId;
+		int32 proxyIdA = fixtureA->m_proxies[fixtureA->m_singleProxy ? 0 : indexA].proxyId;
+		int32 proxyIdB = fixtureB->m_proxies[fixtureB->m_singleProxy ? 0 : indexB].proxyId;
 		bool overlap = m_broadPhase.TestOverlap(proxyIdA, proxyIdB);
 
+		// A single proxy covers every child, so the children are tested on their own like in
+		// AddPair. When both fixtures have a single proxy either side may keep the pair.
+		if (overlap && (fixtureA->m_singleProxy || fixtureB->m_singleProxy))
+		{
+			bool overlapA = fixtureA->m_singleProxy &&
+				b2TestChildOverlap(fixtureA, indexA, GetPairAABB(fixtureB, indexB));
+			bool overlapB = fixtureB->m_singleProxy &&
+				b2TestChildOverlap(fixtureB, indexB, GetPairAABB(fixtureA, indexA));
+			overlap = overlapA || overlapB;
+		}
+
 		// Here we destroy contacts that cease to overlap in the broad-phase.
 		if (overlap == false)
 		{
@@ -168,7 +254,15 @@ void b2ContactManager::Collide()
 		}
 
 		// The contact persists.
-		c->Update(m_contactListener);
+		if (c->Update(m_contactListener, m_cacheLinearTolerance, m_cacheAngularTolerance))
+		{
+			++m_cacheHitCount;
+		}
+		else
+		{
+			++m_cacheMissCount;
+		}
+
 		c = c->GetNext();
 	}
 }
@@ -178,6 +272,37 @@ void b2ContactManager::FindNewContacts()
 	m_broadPhase.UpdatePairs(this);
 }
 
+// Adds a contact for each child found by a child query. If the other fixture has a single
+// proxy too, its children near each child are found in turn.
+struct b2ChildPairCallback
+{
+	bool QueryCallback(int32 childIndex)
+	{
+		if (pairChildren)
+		{
+			b2ChildPairCallback callback;
+			callback.contactManager = contactManager;
+			callback.fixture = otherFixture;
+			callback.otherFixture = fixture;
+			callback.otherIndex = childIndex;
+			callback.pairChildren = false;
+
+			b2AABB aabb = contactManager->GetPairAABB(fixture, childIndex);
+			b2QueryChildren(otherFixture, &callback, b2GetChildQueryAABB(otherFixture, aabb));
+			return true;
+		}
+
+		contactManager->AddContact(fixture, childIndex, otherFixture, otherIndex);
+		return true;
+	}
+
+	b2ContactManager* contactManager;
+	b2Fixture* fixture;
+	b2Fixture* otherFixture;
+	int32 otherIndex;
+	bool pairChildren;
+};
+
 void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 {
 	b2FixtureProxy* proxyA = (b2FixtureProxy*)proxyUserDataA;
@@ -186,18 +311,54 @@ void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 	b2Fixture* fixtureA = proxyA->fixture;
 	b2Fixture* fixtureB = proxyB->fixture;
 
-	int32 indexA = proxyA->childIndex;
-	int32 indexB = proxyB->childIndex;
-
-	b2Body* bodyA = fixtureA->GetBody();
-	b2Body* bodyB = fixtureB->GetBody();
-
 	// Are the fixtures on the same body?
-	if (bodyA == bodyB)
+	if (fixtureA->GetBody() == fixtureB->GetBody())
+	{
+		return;
+	}
+
+	// Chains with a segment tree, heightfields and compounds have one proxy, so pair the other
+	// proxy with each child near it. Only compounds collide with another such fixture.
+	if (fixtureA->m_singleProxy || fixtureB->m_singleProxy)
 	{
+		if (fixtureB->m_singleProxy)
+		{
+			b2Swap(proxyA, proxyB);
+			b2Swap(fixtureA, fixtureB);
+		}
+
+		if (fixtureB->m_singleProxy && fixtureA->GetType() != b2Shape::e_compound &&
+			fixtureB->GetType() != b2Shape::e_compound)
+		{
+			return;
+		}
+
+		// Skip the child queries for bodies that cannot collide.
+		if (fixtureB->GetBody()->ShouldCollide(fixtureA->GetBody()) == false)
+		{
+			return;
+		}
+
+		b2ChildPairCallback callback;
+		callback.contactManager = this;
+		callback.fixture = fixtureA;
+		callback.otherFixture = fixtureB;
+		callback.otherIndex = proxyB->childIndex;
+		callback.pairChildren = fixtureB->m_singleProxy;
+
+		b2AABB aabb = b2GetChildQueryAABB(fixtureA, m_broadPhase.GetFatAABB(proxyB->proxyId));
+		b2QueryChildren(fixtureA, &callback, aabb);
 		return;
 	}
 
+	AddContact(fixtureA, proxyA->childIndex, fixtureB, proxyB->childIndex);
+}
+
+void b2ContactManager::AddContact(b2Fixture* fixtureA, int32 indexA, b2Fixture* fixtureB, int32 indexB)
+{
+	b2Body* bodyA = fixtureA->GetBody();
+	b2Body* bodyB = fixtureB->GetBody();
+
 	// TODO_ERIN use a hash table to remove a potential bottleneck when both
 	// bodies have a lot of contacts.
 	// Does a contact already exist?
@@ -254,6 +415,21 @@ void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 	bodyA = fixtureA->GetBody();
 	bodyB = fixtureB->GetBody();
 
+	Link(c);
+
+	// Wake up the bodies
+	if (fixtureA->IsSensor() == false && fixtureB->IsSensor() == false)
+	{
+		bodyA->SetAwake(true);
+		bodyB->SetAwake(true);
+	}
+}
+
+void b2ContactManager::Link(b2Contact* c)
+{
+	b2Body* bodyA = c->GetFixtureA()->GetBody();
+	b2Body* bodyB = c->GetFixtureB()->GetBody();
+
 	// Insert into the world.
 	c->m_prev = nullptr;
 	c->m_next = m_contactList;
@@ -289,12 +465,5 @@ void b2ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 	}
 	bodyB->m_contactList = &c->m_nodeB;
 
-	// Wake up the bodies
-	if (fixtureA->IsSensor() == false && fixtureB->IsSensor() == false)
-	{
-		bodyA->SetAwake(true);
-		bodyB->SetAwake(true);
-	}
-
 	++m_contactCount;
 }
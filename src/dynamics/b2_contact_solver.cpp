@@ -68,8 +68,8 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 		b2Fixture* fixtureB = contact->m_fixtureB;
 		b2Shape* shapeA = fixtureA->GetShape();
 		b2Shape* shapeB = fixtureB->GetShape();
-		float radiusA = shapeA->m_radius;
-		float radiusB = shapeB->m_radius;
+		float radiusA = shapeA->GetChildRadius(contact->m_indexA);
+		float radiusB = shapeB->GetChildRadius(contact->m_indexB);
 		b2Body* bodyA = fixtureA->GetBody();
 		b2Body* bodyB = fixtureB->GetBody();
 		b2Manifold* manifold = contact->GetManifold();
@@ -129,6 +129,7 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 			vcp->normalMass = 0.0f;
 			vcp->tangentMass = 0.0f;
 			vcp->velocityBias = 0.0f;
+			vcp->maxNormalImpulse = 0.0f;
 
 			pc->localPoints[j] = cp->localPoint;
 		}
@@ -253,10 +254,10 @@ void b2ContactSolver::InitializeVelocityConstraints()
 	}
 }
 
-void b2ContactSolver::WarmStart()
+void b2ContactSolver::WarmStart(int32 start, int32 end)
 {
 	// Warm start.
-	for (int32 i = 0; i < m_count; ++i)
+	for (int32 i = start; i < end; ++i)
 	{
 		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
 
@@ -286,16 +287,24 @@ void b2ContactSolver::WarmStart()
 			vB += mB * P;
 		}
 
-		m_velocities[indexA].v = vA;
-		m_velocities[indexA].w = wA;
-		m_velocities[indexB].v = vB;
-		m_velocities[indexB].w = wB;
+		// Only write back bodies with mass, see SolveVelocityConstraints.
+		if (mA != 0.0f || iA != 0.0f)
+		{
+			m_velocities[indexA].v = vA;
+			m_velocities[indexA].w = wA;
+		}
+
+		if (mB != 0.0f || iB != 0.0f)
+		{
+			m_velocities[indexB].v = vB;
+			m_velocities[indexB].w = wB;
+		}
 	}
 }
 
-void b2ContactSolver::SolveVelocityConstraints()
+void b2ContactSolver::SolveVelocityConstraints(int32 start, int32 end)
 {
-	for (int32 i = 0; i < m_count; ++i)
+	for (int32 i = start; i < end; ++i)
 	{
 		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
 
@@ -598,10 +607,19 @@ void b2ContactSolver::SolveVelocityConstraints()
 			}
 		}
 
-		m_velocities[indexA].v = vA;
-		m_velocities[indexA].w = wA;
-		m_velocities[indexB].v = vB;
-		m_velocities[indexB].w = wB;
+		// Bodies without mass may be shared by constraints solved on other threads and
+		// their velocity does not change, so only write back bodies with mass.
+		if (mA != 0.0f || iA != 0.0f)
+		{
+			m_velocities[indexA].v = vA;
+			m_velocities[indexA].w = wA;
+		}
+
+		if (mB != 0.0f || iB != 0.0f)
+		{
+			m_velocities[indexB].v = vB;
+			m_velocities[indexB].w = wB;
+		}
 	}
 }
 
@@ -672,11 +690,11 @@ struct b2PositionSolverManifold
 };
 
 // Sequential solver.
-bool b2ContactSolver::SolvePositionConstraints()
+bool b2ContactSolver::SolvePositionConstraints(int32 start, int32 end)
 {
 	float minSeparation = 0.0f;
 
-	for (int32 i = 0; i < m_count; ++i)
+	for (int32 i = start; i < end; ++i)
 	{
 		b2ContactPositionConstraint* pc = m_positionConstraints + i;
 
@@ -738,11 +756,18 @@ bool b2ContactSolver::SolvePositionConstraints()
 			aB += iB * b2Cross(rB, P);
 		}
 
-		m_positions[indexA].c = cA;
-		m_positions[indexA].a = aA;
+		// Only write back bodies with mass, see SolveVelocityConstraints.
+		if (mA != 0.0f || iA != 0.0f)
+		{
+			m_positions[indexA].c = cA;
+			m_positions[indexA].a = aA;
+		}
 
-		m_positions[indexB].c = cB;
-		m_positions[indexB].a = aB;
+		if (mB != 0.0f || iB != 0.0f)
+		{
+			m_positions[indexB].c = cB;
+			m_positions[indexB].a = aB;
+		}
 	}
 
 	// We can't expect minSpeparation >= -b2_linearSlop because we don't
@@ -840,3 +865,190 @@ bool b2ContactSolver::SolveTOIPositionConstraints(int32 toiIndexA, int32 toiInde
 	// push the separation above -b2_linearSlop.
 	return minSeparation >= -1.5f * b2_linearSlop;
 }
+
+// The soft step solver computes the current separation from the body positions and
+// turns it into a soft velocity bias. Relaxing solves again without the bias to remove
+// the velocity it added. Positive separation is handled speculatively in both passes.
+void b2ContactSolver::SolveSoftVelocityConstraints(bool useBias, int32 start, int32 end)
+{
+	float inv_h = m_step.inv_dt;
+	float pushVelocity = m_step.contactPushVelocity;
+
+	for (int32 i = start; i < end; ++i)
+	{
+		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		b2ContactPositionConstraint* pc = m_positionConstraints + i;
+
+		int32 indexA = vc->indexA;
+		int32 indexB = vc->indexB;
+		float mA = vc->invMassA;
+		float iA = vc->invIA;
+		float mB = vc->invMassB;
+		float iB = vc->invIB;
+		int32 pointCount = vc->pointCount;
+
+		b2Vec2 vA = m_velocities[indexA].v;
+		float wA = m_velocities[indexA].w;
+		b2Vec2 vB = m_velocities[indexB].v;
+		float wB = m_velocities[indexB].w;
+
+		b2Transform xfA, xfB;
+		xfA.q.Set(m_positions[indexA].a);
+		xfB.q.Set(m_positions[indexB].a);
+		xfA.p = m_positions[indexA].c - b2Mul(xfA.q, pc->localCenterA);
+		xfB.p = m_positions[indexB].c - b2Mul(xfB.q, pc->localCenterB);
+
+		// Contacts against static and kinematic bodies can be stiffer.
+		const b2Softness& soft = (mA == 0.0f || mB == 0.0f) ? m_step.staticSoftness : m_step.contactSoftness;
+
+		b2Vec2 normal = vc->normal;
+		b2Vec2 tangent = b2Cross(normal, 1.0f);
+		float friction = vc->friction;
+
+		b2Assert(pointCount == 1 || pointCount == 2);
+
+		// Solve normal constraints first so friction sees the current normal impulse.
+		for (int32 j = 0; j < pointCount; ++j)
+		{
+			b2VelocityConstraintPoint* vcp = vc->points + j;
+
+			b2PositionSolverManifold psm;
+			psm.Initialize(pc, xfA, xfB, j);
+
+			// Allow some slop.
+			float s = psm.separation + b2_linearSlop;
+
+			float bias = 0.0f;
+			float massScale = 1.0f;
+			float impulseScale = 0.0f;
+			if (s > 0.0f)
+			{
+				// Speculative
+				bias = s * inv_h;
+			}
+			else if (useBias)
+			{
+				bias = b2Max(soft.biasRate * s, -pushVelocity);
+				massScale = soft.massScale;
+				impulseScale = soft.impulseScale;
+			}
+
+			// Relative velocity at contact
+			b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
+			float vn = b2Dot(dv, normal);
+
+			// Compute the soft normal impulse and clamp the accumulated impulse
+			float impulse = -vcp->normalMass * massScale * (vn + bias) - impulseScale * vcp->normalImpulse;
+			float newImpulse = b2Max(vcp->normalImpulse + impulse, 0.0f);
+			impulse = newImpulse - vcp->normalImpulse;
+			vcp->normalImpulse = newImpulse;
+			vcp->maxNormalImpulse = b2Max(vcp->maxNormalImpulse, impulse);
+
+			// Apply contact impulse
+			b2Vec2 P = impulse * normal;
+			vA -= mA * P;
+			wA -= iA * b2Cross(vcp->rA, P);
+
+			vB += mB * P;
+			wB += iB * b2Cross(vcp->rB, P);
+		}
+
+		for (int32 j = 0; j < pointCount; ++j)
+		{
+			b2VelocityConstraintPoint* vcp = vc->points + j;
+
+			// Relative velocity at contact
+			b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
+
+			// Compute tangent force
+			float vt = b2Dot(dv, tangent) - vc->tangentSpeed;
+			float lambda = vcp->tangentMass * (-vt);
+
+			// b2Clamp the accumulated force
+			float maxFriction = friction * vcp->normalImpulse;
+			float newImpulse = b2Clamp(vcp->tangentImpulse + lambda, -maxFriction, maxFriction);
+			lambda = newImpulse - vcp->tangentImpulse;
+			vcp->tangentImpulse = newImpulse;
+
+			// Apply contact impulse
+			b2Vec2 P = lambda * tangent;
+
+			vA -= mA * P;
+			wA -= iA * b2Cross(vcp->rA, P);
+
+			vB += mB * P;
+			wB += iB * b2Cross(vcp->rB, P);
+		}
+
+		// Only write back bodies with mass, see SolveVelocityConstraints.
+		if (mA != 0.0f || iA != 0.0f)
+		{
+			m_velocities[indexA].v = vA;
+			m_velocities[indexA].w = wA;
+		}
+
+		if (mB != 0.0f || iB != 0.0f)
+		{
+			m_velocities[indexB].v = vB;
+			m_velocities[indexB].w = wB;
+		}
+	}
+}
+
+// Restitution is applied once after the sub-steps, using the approach velocity
+// recorded when the constraints were initialized.
+void b2ContactSolver::ApplyRestitution()
+{
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		if (vc->restitution == 0.0f)
+		{
+			continue;
+		}
+
+		int32 indexA = vc->indexA;
+		int32 indexB = vc->indexB;
+		float mA = vc->invMassA;
+		float iA = vc->invIA;
+		float mB = vc->invMassB;
+		float iB = vc->invIB;
+		int32 pointCount = vc->pointCount;
+
+		b2Vec2 vA = m_velocities[indexA].v;
+		float wA = m_velocities[indexA].w;
+		b2Vec2 vB = m_velocities[indexB].v;
+		float wB = m_velocities[indexB].w;
+
+		b2Vec2 normal = vc->normal;
+
+		for (int32 j = 0; j < pointCount; ++j)
+		{
+			b2VelocityConstraintPoint* vcp = vc->points + j;
+			if (vcp->velocityBias == 0.0f || vcp->maxNormalImpulse == 0.0f)
+			{
+				continue;
+			}
+
+			b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
+			float vn = b2Dot(dv, normal);
+
+			float impulse = -vcp->normalMass * (vn - vcp->velocityBias);
+			float newImpulse = b2Max(vcp->normalImpulse + impulse, 0.0f);
+			impulse = newImpulse - vcp->normalImpulse;
+			vcp->normalImpulse = newImpulse;
+
+			b2Vec2 P = impulse * normal;
+			vA -= mA * P;
+			wA -= iA * b2Cross(vcp->rA, P);
+
+			vB += mB * P;
+			wB += iB * b2Cross(vcp->rB, P);
+		}
+
+		m_velocities[indexA].v = vA;
+		m_velocities[indexA].w = wA;
+		m_velocities[indexB].v = vB;
+		m_velocities[indexB].w = wB;
+	}
+}
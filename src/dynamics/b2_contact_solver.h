@@ -41,6 +41,7 @@ struct b2VelocityConstraintPoint
 	float normalMass;
 	float tangentMass;
 	float velocityBias;
+	float maxNormalImpulse;
 };
 
 struct b2ContactVelocityConstraint
@@ -78,13 +79,24 @@ public:
 
 	void InitializeVelocityConstraints();
 
-	void WarmStart();
-	void SolveVelocityConstraints();
+	void WarmStart() { WarmStart(0, m_count); }
+	void SolveVelocityConstraints() { SolveVelocityConstraints(0, m_count); }
 	void StoreImpulses();
 
-	bool SolvePositionConstraints();
+	// Soft step solver.
+	void SolveSoftVelocityConstraints(bool useBias) { SolveSoftVelocityConstraints(useBias, 0, m_count); }
+	void ApplyRestitution();
+
+	bool SolvePositionConstraints() { return SolvePositionConstraints(0, m_count); }
 	bool SolveTOIPositionConstraints(int32 toiIndexA, int32 toiIndexB);
 
+	// Solve the constraints in [start, end). Ranges that share no body with mass may be
+	// solved concurrently.
+	void WarmStart(int32 start, int32 end);
+	void SolveVelocityConstraints(int32 start, int32 end);
+	void SolveSoftVelocityConstraints(bool useBias, int32 start, int32 end);
+	bool SolvePositionConstraints(int32 start, int32 end);
+
 	b2TimeStep m_step;
 	b2Position* m_positions;
 	b2Velocity* m_velocities;
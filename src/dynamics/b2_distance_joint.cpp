@@ -248,6 +248,16 @@ float b2DistanceJoint::GetReactionTorque(float inv_dt) const
 	return 0.0f;
 }
 
+void b2DistanceJoint::SerializeState(b2JointStateStream& stream)
+{
+	stream.Serialize(m_frequencyHz);
+	stream.Serialize(m_dampingRatio);
+	stream.Serialize(m_localAnchorA);
+	stream.Serialize(m_localAnchorB);
+	stream.Serialize(m_length);
+	stream.Serialize(m_impulse);
+}
+
 void b2DistanceJoint::Dump()
 {
 	int32 indexA = m_bodyA->m_islandIndex;
@@ -264,3 +274,8 @@ void b2DistanceJoint::Dump()
 	b2Log("  jd.dampingRatio = %.15lef;\n", m_dampingRatio);
 	b2Log("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+b2JointBatchRegister b2DistanceJoint::GetBatchRegister()
+{
+	return CreateBatchRegister<b2DistanceJoint>();
+}
@@ -23,11 +23,15 @@
 #include "box2d/b2_fixture.h"
 #include "box2d/b2_block_allocator.h"
 #include "box2d/b2_broad_phase.h"
+#include "box2d/b2_capsule_shape.h"
 #include "box2d/b2_chain_shape.h"
 #include "box2d/b2_circle_shape.h"
 #include "box2d/b2_collision.h"
+#include "box2d/b2_compound_shape.h"
 #include "box2d/b2_contact.h"
+#include "box2d/b2_distance.h"
 #include "box2d/b2_edge_shape.h"
+#include "box2d/b2_heightfield_shape.h"
 #include "box2d/b2_polygon_shape.h"
 #include "box2d/b2_world.h"
 
@@ -38,7 +42,9 @@ b2Fixture::b2Fixture()
 	m_next = nullptr;
 	m_proxies = nullptr;
 	m_proxyCount = 0;
+	m_singleProxy = false;
 	m_shape = nullptr;
+	m_sharedShape = false;
 	m_density = 0.0f;
 }
 
@@ -55,10 +61,21 @@ void b2Fixture::Create(b2BlockAllocator* allocator, b2Body* body, const b2Fixtur
 
 	m_isSensor = def->isSensor;
 
-	m_shape = def->shape->Clone(allocator);
+	m_sharedShape = def->shareShape;
+	if (m_sharedShape)
+	{
+		m_shape = const_cast<b2Shape*>(def->shape);
+	}
+	else
+	{
+		m_shape = def->shape->Clone(allocator);
+	}
+
+	m_singleProxy = m_shape->m_type == b2Shape::e_heightfield || m_shape->m_type == b2Shape::e_compound ||
+		(m_shape->m_type == b2Shape::e_chain && ((b2ChainShape*)m_shape)->HasTree());
 
 	// Reserve proxy space
-	int32 childCount = m_shape->GetChildCount();
+	int32 childCount = m_singleProxy ? 1 : m_shape->GetChildCount();
 	m_proxies = (b2FixtureProxy*)allocator->Allocate(childCount * sizeof(b2FixtureProxy));
 	for (int32 i = 0; i < childCount; ++i)
 	{
@@ -76,10 +93,17 @@ void b2Fixture::Destroy(b2BlockAllocator* allocator)
 	b2Assert(m_proxyCount == 0);
 
 	// Free the proxy array.
-	int32 childCount = m_shape->GetChildCount();
+	int32 childCount = m_singleProxy ? 1 : m_shape->GetChildCount();
 	allocator->Free(m_proxies, childCount * sizeof(b2FixtureProxy));
 	m_proxies = nullptr;
 
+	// Shared shapes are owned by the user.
+	if (m_sharedShape)
+	{
+		m_shape = nullptr;
+		return;
+	}
+
 	// Free the child shape.
 	switch (m_shape->m_type)
 	{
@@ -115,6 +139,30 @@ void b2Fixture::Destroy(b2BlockAllocator* allocator)
 		}
 		break;
 
+	case b2Shape::e_heightfield:
+		{
+			b2HeightfieldShape* s = (b2HeightfieldShape*)m_shape;
+			s->~b2HeightfieldShape();
+			allocator->Free(s, sizeof(b2HeightfieldShape));
+		}
+		break;
+
+	case b2Shape::e_capsule:
+		{
+			b2CapsuleShape* s = (b2CapsuleShape*)m_shape;
+			s->~b2CapsuleShape();
+			allocator->Free(s, sizeof(b2CapsuleShape));
+		}
+		break;
+
+	case b2Shape::e_compound:
+		{
+			b2CompoundShape* s = (b2CompoundShape*)m_shape;
+			s->~b2CompoundShape();
+			allocator->Free(s, sizeof(b2CompoundShape));
+		}
+		break;
+
 	default:
 		b2Assert(false);
 		break;
@@ -123,10 +171,37 @@ void b2Fixture::Destroy(b2BlockAllocator* allocator)
 	m_shape = nullptr;
 }
 
+// The bounds of all children in the shape frame for a fixture with a single proxy.
+static const b2AABB& b2GetSingleProxyBounds(const b2Shape* shape)
+{
+	if (shape->m_type == b2Shape::e_chain)
+	{
+		return ((const b2ChainShape*)shape)->m_nodes[0].aabb;
+	}
+
+	if (shape->m_type == b2Shape::e_compound)
+	{
+		return ((const b2CompoundShape*)shape)->GetBounds();
+	}
+
+	return ((const b2HeightfieldShape*)shape)->GetBounds();
+}
+
 void b2Fixture::CreateProxies(b2BroadPhase* broadPhase, const b2Transform& xf)
 {
 	b2Assert(m_proxyCount == 0);
 
+	if (m_singleProxy)
+	{
+		b2FixtureProxy* proxy = m_proxies;
+		proxy->aabb = b2Mul(xf, b2GetSingleProxyBounds(m_shape));
+		proxy->proxyId = broadPhase->CreateProxy(proxy->aabb, proxy);
+		proxy->fixture = this;
+		proxy->childIndex = 0;
+		m_proxyCount = 1;
+		return;
+	}
+
 	// Create proxies in the broad-phase.
 	m_proxyCount = m_shape->GetChildCount();
 
@@ -160,19 +235,130 @@ void b2Fixture::Synchronize(b2BroadPhase* broadPhase, const b2Transform& transfo
 		return;
 	}
 
-	for (int32 i = 0; i < m_proxyCount; ++i)
+	ComputeSweptAABBs(transform1, transform2);
+	MoveProxies(broadPhase, transform2.p - transform1.p);
+}
+
+// Compute the AABBs that cover the swept shape (may miss some rotation effect). This gives the
+// same result as combining b2Shape::ComputeAABB at both transforms, but the common shapes are
+// handled inline in one pass over the vertices instead of two virtual calls per proxy.
+void b2Fixture::ComputeSweptAABBs(const b2Transform& xf1, const b2Transform& xf2)
+{
+	if (m_proxyCount == 0)
 	{
-		b2FixtureProxy* proxy = m_proxies + i;
+		return;
+	}
+
+	if (m_singleProxy)
+	{
+		const b2AABB& bounds = b2GetSingleProxyBounds(m_shape);
+		m_proxies[0].aabb.Combine(b2Mul(xf1, bounds), b2Mul(xf2, bounds));
+		return;
+	}
+
+	switch (m_shape->m_type)
+	{
+	case b2Shape::e_circle:
+		{
+			b2CircleShape* circle = (b2CircleShape*)m_shape;
+			b2Vec2 p1 = xf1.p + b2Mul(xf1.q, circle->m_p);
+			b2Vec2 p2 = xf2.p + b2Mul(xf2.q, circle->m_p);
+			b2Vec2 r(circle->m_radius, circle->m_radius);
+			m_proxies[0].aabb.lowerBound = b2Min(p1, p2) - r;
+			m_proxies[0].aabb.upperBound = b2Max(p1, p2) + r;
+		}
+		break;
+
+	case b2Shape::e_edge:
+		{
+			b2EdgeShape* edge = (b2EdgeShape*)m_shape;
+			b2Vec2 v1 = b2Mul(xf1, edge->m_vertex1);
+			b2Vec2 v2 = b2Mul(xf1, edge->m_vertex2);
+			b2Vec2 v3 = b2Mul(xf2, edge->m_vertex1);
+			b2Vec2 v4 = b2Mul(xf2, edge->m_vertex2);
+			b2Vec2 r(edge->m_radius, edge->m_radius);
+			m_proxies[0].aabb.lowerBound = b2Min(b2Min(v1, v2), b2Min(v3, v4)) - r;
+			m_proxies[0].aabb.upperBound = b2Max(b2Max(v1, v2), b2Max(v3, v4)) + r;
+		}
+		break;
+
+	case b2Shape::e_capsule:
+		{
+			b2CapsuleShape* capsule = (b2CapsuleShape*)m_shape;
+			b2Vec2 v1 = b2Mul(xf1, capsule->m_vertex1);
+			b2Vec2 v2 = b2Mul(xf1, capsule->m_vertex2);
+			b2Vec2 v3 = b2Mul(xf2, capsule->m_vertex1);
+			b2Vec2 v4 = b2Mul(xf2, capsule->m_vertex2);
+			b2Vec2 r(capsule->m_radius, capsule->m_radius);
+			m_proxies[0].aabb.lowerBound = b2Min(b2Min(v1, v2), b2Min(v3, v4)) - r;
+			m_proxies[0].aabb.upperBound = b2Max(b2Max(v1, v2), b2Max(v3, v4)) + r;
+		}
+		break;
 
-		// Compute an AABB that covers the swept shape (may miss some rotation effect).
-		b2AABB aabb1, aabb2;
-		m_shape->ComputeAABB(&aabb1, transform1, proxy->childIndex);
-		m_shape->ComputeAABB(&aabb2, transform2, proxy->childIndex);
-	
-		proxy->aabb.Combine(aabb1, aabb2);
+	case b2Shape::e_polygon:
+		{
+			b2PolygonShape* poly = (b2PolygonShape*)m_shape;
+			b2Vec2 lower = b2Mul(xf1, poly->m_vertices[0]);
+			b2Vec2 upper = lower;
+			for (int32 i = 0; i < poly->m_count; ++i)
+			{
+				b2Vec2 v1 = b2Mul(xf1, poly->m_vertices[i]);
+				b2Vec2 v2 = b2Mul(xf2, poly->m_vertices[i]);
+				lower = b2Min(lower, b2Min(v1, v2));
+				upper = b2Max(upper, b2Max(v1, v2));
+			}
 
-		b2Vec2 displacement = transform2.p - transform1.p;
+			b2Vec2 r(poly->m_radius, poly->m_radius);
+			m_proxies[0].aabb.lowerBound = lower - r;
+			m_proxies[0].aabb.upperBound = upper + r;
+		}
+		break;
+
+	case b2Shape::e_chain:
+		{
+			// Chain AABBs do not include the radius.
+			b2ChainShape* chain = (b2ChainShape*)m_shape;
+			for (int32 i = 0; i < m_proxyCount; ++i)
+			{
+				b2FixtureProxy* proxy = m_proxies + i;
+				int32 i1 = proxy->childIndex;
+				int32 i2 = i1 + 1 == chain->m_count ? 0 : i1 + 1;
+				b2Vec2 v1 = b2Mul(xf1, chain->m_vertices[i1]);
+				b2Vec2 v2 = b2Mul(xf1, chain->m_vertices[i2]);
+				b2Vec2 v3 = b2Mul(xf2, chain->m_vertices[i1]);
+				b2Vec2 v4 = b2Mul(xf2, chain->m_vertices[i2]);
+				proxy->aabb.lowerBound = b2Min(b2Min(v1, v2), b2Min(v3, v4));
+				proxy->aabb.upperBound = b2Max(b2Max(v1, v2), b2Max(v3, v4));
+			}
+		}
+		break;
+
+	default:
+		for (int32 i = 0; i < m_proxyCount; ++i)
+		{
+			b2FixtureProxy* proxy = m_proxies + i;
+			b2AABB aabb1, aabb2;
+			m_shape->ComputeAABB(&aabb1, xf1, proxy->childIndex);
+			m_shape->ComputeAABB(&aabb2, xf2, proxy->childIndex);
+			proxy->aabb.Combine(aabb1, aabb2);
+		}
+		break;
+	}
+}
 
+void b2Fixture::MoveProxies(b2BroadPhase* broadPhase, const b2Vec2& displacement)
+{
+	// The children of a single proxy can reach other shapes while the proxy stays inside its
+	// fat AABB, so the proxy looks for new pairs whenever it moves.
+	if (m_singleProxy && m_proxyCount > 0 && broadPhase->GetFatAABB(m_proxies[0].proxyId).Contains(m_proxies[0].aabb))
+	{
+		broadPhase->TouchProxy(m_proxies[0].proxyId);
+		return;
+	}
+
+	for (int32 i = 0; i < m_proxyCount; ++i)
+	{
+		b2FixtureProxy* proxy = m_proxies + i;
 		broadPhase->MoveProxy(proxy->proxyId, proxy->aabb, displacement);
 	}
 }
@@ -230,6 +416,158 @@ void b2Fixture::SetSensor(bool sensor)
 	}
 }
 
+// Is the shape covered by a single proxy whose children are found with a query?
+static bool b2HasChildQuery(const b2Shape* shape)
+{
+	return (shape->m_type == b2Shape::e_chain && ((const b2ChainShape*)shape)->HasTree()) ||
+		shape->m_type == b2Shape::e_heightfield || shape->m_type == b2Shape::e_compound;
+}
+
+// Find the children of a shape that may overlap a local AABB.
+template <typename T>
+static void b2QueryChildren(const b2Shape* shape, T* callback, const b2AABB& aabb)
+{
+	switch (shape->m_type)
+	{
+	case b2Shape::e_chain:
+		((const b2ChainShape*)shape)->QueryTree(callback, aabb);
+		break;
+
+	case b2Shape::e_heightfield:
+		((const b2HeightfieldShape*)shape)->QueryCells(callback, aabb);
+		break;
+
+	case b2Shape::e_compound:
+		((const b2CompoundShape*)shape)->QueryTree(callback, aabb);
+		break;
+
+	default:
+		b2Assert(false);
+		break;
+	}
+}
+
+// Reports whether a shape overlaps any child found by a child query.
+struct b2ShapeOverlapChildCallback
+{
+	bool QueryCallback(int32 childIndex)
+	{
+		overlap = b2TestOverlap(fixtureShape, childIndex, shape, 0, fixtureTransform, transform);
+		return overlap == false;
+	}
+
+	const b2Shape* fixtureShape;
+	b2Transform fixtureTransform;
+	const b2Shape* shape;
+	b2Transform transform;
+	bool overlap;
+};
+
+bool b2Fixture::TestOverlap(const b2Shape* shape, const b2Transform& transform, int32 childIndex) const
+{
+	const b2Transform& xf = m_body->GetTransform();
+	if (b2HasChildQuery(m_shape) == false)
+	{
+		return b2TestOverlap(m_shape, childIndex, shape, 0, xf, transform);
+	}
+
+	b2AABB aabb;
+	shape->ComputeAABB(&aabb, transform, 0);
+
+	b2ShapeOverlapChildCallback callback;
+	callback.fixtureShape = m_shape;
+	callback.fixtureTransform = xf;
+	callback.shape = shape;
+	callback.transform = transform;
+	callback.overlap = false;
+	b2QueryChildren(m_shape, &callback, b2MulT(xf, aabb));
+	return callback.overlap;
+}
+
+// Cast a proxy against one child of a shape. A proxy that touches the child at the start is
+// free to move away from it or along it.
+static bool b2ShapeCastChild(b2ShapeCastOutput* output, const b2Shape* fixtureShape, int32 childIndex,
+							const b2Transform& fixtureTransform, const b2DistanceProxy& proxy,
+							const b2Transform& transform, const b2Vec2& translation)
+{
+	b2ShapeCastInput input;
+	input.proxyA.Set(fixtureShape, childIndex);
+	input.proxyB = proxy;
+	input.transformA = fixtureTransform;
+	input.transformB = transform;
+	input.translationB = translation;
+
+	bool hit = b2ShapeCast(output, &input);
+	if (hit && output->lambda == 0.0f && b2Dot(output->normal, translation) >= 0.0f)
+	{
+		return false;
+	}
+
+	return hit;
+}
+
+// Keeps the closest hit among the children found by a child query.
+struct b2ShapeCastChildCallback
+{
+	bool QueryCallback(int32 childIndex)
+	{
+		b2ShapeCastOutput childOutput;
+		if (b2ShapeCastChild(&childOutput, fixtureShape, childIndex, fixtureTransform, proxy, transform, translation))
+		{
+			if (hit == false || childOutput.lambda < output.lambda)
+			{
+				output = childOutput;
+				hit = true;
+			}
+		}
+
+		return true;
+	}
+
+	const b2Shape* fixtureShape;
+	b2Transform fixtureTransform;
+	b2DistanceProxy proxy;
+	b2Transform transform;
+	b2Vec2 translation;
+	b2ShapeCastOutput output;
+	bool hit;
+};
+
+bool b2Fixture::ShapeCast(b2ShapeCastOutput* output, const b2Shape* shape, const b2Transform& transform,
+						const b2Vec2& translation, int32 childIndex) const
+{
+	const b2Transform& xf = m_body->GetTransform();
+	b2DistanceProxy proxy;
+	proxy.Set(shape, 0);
+
+	if (b2HasChildQuery(m_shape) == false)
+	{
+		return b2ShapeCastChild(output, m_shape, childIndex, xf, proxy, transform, translation);
+	}
+
+	// Only children touched by the swept bounds are cast.
+	b2AABB aabb;
+	shape->ComputeAABB(&aabb, transform, 0);
+	aabb.lowerBound += b2Min(translation, b2Vec2_zero);
+	aabb.upperBound += b2Max(translation, b2Vec2_zero);
+
+	b2ShapeCastChildCallback callback;
+	callback.fixtureShape = m_shape;
+	callback.fixtureTransform = xf;
+	callback.proxy = proxy;
+	callback.transform = transform;
+	callback.translation = translation;
+	callback.hit = false;
+	b2QueryChildren(m_shape, &callback, b2MulT(xf, aabb));
+
+	if (callback.hit)
+	{
+		*output = callback.output;
+	}
+
+	return callback.hit;
+}
+
 void b2Fixture::Dump(int32 bodyIndex)
 {
 	b2Log("    b2FixtureDef fd;\n");
@@ -293,6 +631,84 @@ void b2Fixture::Dump(int32 bodyIndex)
 			b2Log("    shape.m_nextVertex.Set(%.15lef, %.15lef);\n", s->m_nextVertex.x, s->m_nextVertex.y);
 			b2Log("    shape.m_hasPrevVertex = bool(%d);\n", s->m_hasPrevVertex);
 			b2Log("    shape.m_hasNextVertex = bool(%d);\n", s->m_hasNextVertex);
+			if (s->HasTree())
+			{
+				b2Log("    shape.CreateTree();\n");
+			}
+		}
+		break;
+
+	case b2Shape::e_heightfield:
+		{
+			b2HeightfieldShape* s = (b2HeightfieldShape*)m_shape;
+			b2Log("    b2HeightfieldShape shape;\n");
+			b2Log("    int16 hs[%d];\n", s->m_count);
+			for (int32 i = 0; i < s->m_count; ++i)
+			{
+				b2Log("    hs[%d] = %d;\n", i, s->m_heights[i]);
+			}
+			b2Log("    shape.Create(hs, %d, %.15lef, %.15lef);\n", s->m_count, s->m_spacing, s->m_heightScale);
+			b2Log("    shape.m_radius = %.15lef;\n", s->m_radius);
+		}
+		break;
+
+	case b2Shape::e_capsule:
+		{
+			b2CapsuleShape* s = (b2CapsuleShape*)m_shape;
+			b2Log("    b2CapsuleShape shape;\n");
+			b2Log("    shape.Set(b2Vec2(%.15lef, %.15lef), b2Vec2(%.15lef, %.15lef), %.15lef);\n",
+				s->m_vertex1.x, s->m_vertex1.y, s->m_vertex2.x, s->m_vertex2.y, s->m_radius);
+		}
+		break;
+
+	case b2Shape::e_compound:
+		{
+			b2CompoundShape* s = (b2CompoundShape*)m_shape;
+			b2Log("    const b2Shape* children[%d];\n", s->m_count);
+			for (int32 i = 0; i < s->m_count; ++i)
+			{
+				const b2Shape* child = s->GetChild(i);
+				switch (child->m_type)
+				{
+				case b2Shape::e_circle:
+					{
+						const b2CircleShape* c = (const b2CircleShape*)child;
+						b2Log("    b2CircleShape c%d;\n", i);
+						b2Log("    c%d.m_radius = %.15lef;\n", i, c->m_radius);
+						b2Log("    c%d.m_p.Set(%.15lef, %.15lef);\n", i, c->m_p.x, c->m_p.y);
+					}
+					break;
+
+				case b2Shape::e_polygon:
+					{
+						const b2PolygonShape* c = (const b2PolygonShape*)child;
+						b2Log("    b2PolygonShape c%d;\n", i);
+						b2Log("    b2Vec2 vs%d[%d];\n", i, b2_maxPolygonVertices);
+						for (int32 j = 0; j < c->m_count; ++j)
+						{
+							b2Log("    vs%d[%d].Set(%.15lef, %.15lef);\n", i, j, c->m_vertices[j].x, c->m_vertices[j].y);
+						}
+						b2Log("    c%d.Set(vs%d, %d);\n", i, i, c->m_count);
+					}
+					break;
+
+				case b2Shape::e_capsule:
+					{
+						const b2CapsuleShape* c = (const b2CapsuleShape*)child;
+						b2Log("    b2CapsuleShape c%d;\n", i);
+						b2Log("    c%d.Set(b2Vec2(%.15lef, %.15lef), b2Vec2(%.15lef, %.15lef), %.15lef);\n",
+							i, c->m_vertex1.x, c->m_vertex1.y, c->m_vertex2.x, c->m_vertex2.y, c->m_radius);
+					}
+					break;
+
+				default:
+					break;
+				}
+
+				b2Log("    children[%d] = &c%d;\n", i, i);
+			}
+			b2Log("    b2CompoundShape shape;\n");
+			b2Log("    shape.Create(children, %d);\n", s->m_count);
 		}
 		break;
 
@@ -0,0 +1,569 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "box2d/b2_fracture.h"
+#include "box2d/b2_body.h"
+#include "box2d/b2_fixture.h"
+#include "box2d/b2_hull.h"
+#include "box2d/b2_polygon_shape.h"
+#include "box2d/b2_world.h"
+
+#include <new>
+#include <string.h>
+
+struct b2FractureRequest
+{
+	b2Body* body;
+	const b2FracturePattern* pattern;
+	b2Vec2 point;
+	b2Vec2 impulse;
+};
+
+// Clip a convex polygon to the left side of the line a -> b. Returns the new vertex count.
+static int32 b2ClipToLine(b2Vec2* out, const b2Vec2* vs, int32 count, const b2Vec2& a, const b2Vec2& b)
+{
+	b2Vec2 e = b - a;
+	int32 n = 0;
+	for (int32 i = 0; i < count; ++i)
+	{
+		const b2Vec2& p1 = vs[i];
+		const b2Vec2& p2 = vs[i + 1 < count ? i + 1 : 0];
+		float s1 = b2Cross(e, p1 - a);
+		float s2 = b2Cross(e, p2 - a);
+
+		if (s1 >= 0.0f)
+		{
+			out[n++] = p1;
+		}
+
+		if ((s1 >= 0.0f) != (s2 >= 0.0f))
+		{
+			float t = s1 / (s1 - s2);
+			out[n++] = p1 + t * (p2 - p1);
+		}
+	}
+
+	return n;
+}
+
+b2FracturePattern::b2FracturePattern()
+{
+	m_vertices = nullptr;
+	m_cellStarts = nullptr;
+	m_cellCount = 0;
+	m_maxCellVertexCount = 0;
+	m_impactCell = 0;
+}
+
+b2FracturePattern::~b2FracturePattern()
+{
+	Clear();
+}
+
+void b2FracturePattern::Clear()
+{
+	b2Free(m_vertices);
+	b2Free(m_cellStarts);
+	m_vertices = nullptr;
+	m_cellStarts = nullptr;
+	m_cellCount = 0;
+	m_maxCellVertexCount = 0;
+	m_impactCell = 0;
+}
+
+void b2FracturePattern::Create(const b2Vec2* sites, int32 count)
+{
+	b2Assert(count >= 1);
+	Clear();
+
+	// A cell is the square clipped by the bisector of its site and each other site, so it has
+	// at most count + 3 vertices.
+	int32 bufferCount = count + 4;
+	b2Vec2* buffer1 = (b2Vec2*)b2Alloc(bufferCount * sizeof(b2Vec2));
+	b2Vec2* buffer2 = (b2Vec2*)b2Alloc(bufferCount * sizeof(b2Vec2));
+
+	int32 capacity = 8 * count;
+	m_vertices = (b2Vec2*)b2Alloc(capacity * sizeof(b2Vec2));
+	m_cellStarts = (int32*)b2Alloc((count + 1) * sizeof(int32));
+	m_cellCount = count;
+
+	int32 vertexCount = 0;
+	float bestDistance = b2_maxFloat;
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Vec2 site = sites[i];
+		if (site.LengthSquared() < bestDistance)
+		{
+			bestDistance = site.LengthSquared();
+			m_impactCell = i;
+		}
+
+		b2Vec2* vs = buffer1;
+		b2Vec2* out = buffer2;
+		vs[0].Set(-1.0f, -1.0f);
+		vs[1].Set(1.0f, -1.0f);
+		vs[2].Set(1.0f, 1.0f);
+		vs[3].Set(-1.0f, 1.0f);
+		int32 n = 4;
+
+		for (int32 j = 0; j < count && n > 0; ++j)
+		{
+			b2Vec2 d = sites[j] - site;
+			if (j == i || d.LengthSquared() < b2_epsilon * b2_epsilon)
+			{
+				continue;
+			}
+
+			// Keep the side of the bisector that holds the site.
+			b2Vec2 mid = 0.5f * (site + sites[j]);
+			b2Vec2 a = mid + b2Cross(d, 1.0f);
+			n = b2ClipToLine(out, vs, n, a, mid);
+			b2Swap(vs, out);
+		}
+
+		if (n < 3)
+		{
+			n = 0;
+		}
+
+		if (vertexCount + n > capacity)
+		{
+			capacity = b2Max(2 * capacity, vertexCount + n);
+			b2Vec2* vertices = (b2Vec2*)b2Alloc(capacity * sizeof(b2Vec2));
+			memcpy(vertices, m_vertices, vertexCount * sizeof(b2Vec2));
+			b2Free(m_vertices);
+			m_vertices = vertices;
+		}
+
+		m_cellStarts[i] = vertexCount;
+		memcpy(m_vertices + vertexCount, vs, n * sizeof(b2Vec2));
+		vertexCount += n;
+		m_maxCellVertexCount = b2Max(m_maxCellVertexCount, n);
+	}
+
+	m_cellStarts[count] = vertexCount;
+
+	b2Free(buffer2);
+	b2Free(buffer1);
+}
+
+void b2FracturePattern::CreateRadial(int32 ringCount, int32 ringSiteCount)
+{
+	b2Assert(ringCount >= 0 && ringSiteCount >= 3);
+
+	int32 count = 1 + ringCount * ringSiteCount;
+	b2Vec2* sites = (b2Vec2*)b2Alloc(count * sizeof(b2Vec2));
+	sites[0].SetZero();
+
+	// The ring radius grows with the square of the ring index, so the cells near the impact
+	// are small. Odd rings are rotated by half a cell.
+	int32 n = 1;
+	for (int32 i = 1; i <= ringCount; ++i)
+	{
+		float s = float(i) / float(ringCount);
+		float radius = 0.9f * s * s;
+		float offset = (i & 1) ? 0.5f : 0.0f;
+		for (int32 j = 0; j < ringSiteCount; ++j)
+		{
+			float angle = 2.0f * b2_pi * (j + offset) / ringSiteCount;
+			sites[n++].Set(radius * cosf(angle), radius * sinf(angle));
+		}
+	}
+
+	Create(sites, count);
+	b2Free(sites);
+}
+
+const b2Vec2* b2FracturePattern::GetCellVertices(int32 index, int32* count) const
+{
+	b2Assert(0 <= index && index < m_cellCount);
+	*count = m_cellStarts[index + 1] - m_cellStarts[index];
+	return m_vertices + m_cellStarts[index];
+}
+
+b2FractureQueue::b2FractureQueue()
+{
+	m_requests = nullptr;
+	m_requestCount = 0;
+	m_requestCapacity = 0;
+	m_pieces = nullptr;
+	m_pieceFixtures = nullptr;
+	m_pieceCapacity = 0;
+	m_clipVertices = nullptr;
+	m_clipCapacity = 0;
+}
+
+b2FractureQueue::~b2FractureQueue()
+{
+	b2Free(m_requests);
+	b2Free(m_pieces);
+	b2Free(m_pieceFixtures);
+	b2Free(m_clipVertices);
+}
+
+void b2FractureQueue::Add(b2Body* body, const b2FracturePattern* pattern, const b2Vec2& point, const b2Vec2& impulse)
+{
+	for (int32 i = 0; i < m_requestCount; ++i)
+	{
+		if (m_requests[i].body == body)
+		{
+			return;
+		}
+	}
+
+	if (m_requestCount == m_requestCapacity)
+	{
+		int32 capacity = b2Max(2 * m_requestCapacity, 16);
+		b2FractureRequest* requests = (b2FractureRequest*)b2Alloc(capacity * sizeof(b2FractureRequest));
+		memcpy(requests, m_requests, m_requestCount * sizeof(b2FractureRequest));
+		b2Free(m_requests);
+		m_requests = requests;
+		m_requestCapacity = capacity;
+	}
+
+	b2FractureRequest* request = m_requests + m_requestCount;
+	request->body = body;
+	request->pattern = pattern;
+	request->point = point;
+	request->impulse = impulse;
+	++m_requestCount;
+}
+
+void b2FractureQueue::Remove(b2Body* body)
+{
+	for (int32 i = 0; i < m_requestCount; ++i)
+	{
+		if (m_requests[i].body == body)
+		{
+			memmove(m_requests + i, m_requests + i + 1, (m_requestCount - i - 1) * sizeof(b2FractureRequest));
+			--m_requestCount;
+			return;
+		}
+	}
+}
+
+int32 b2FractureQueue::Process(int32 maxFragments)
+{
+	int32 fragmentCount = 0;
+	int32 index = 0;
+	while (index < m_requestCount)
+	{
+		const b2FractureRequest* request = m_requests + index;
+
+		// A body makes at most one fragment per cell.
+		if (index > 0 && fragmentCount + request->pattern->GetCellCount() > maxFragments)
+		{
+			break;
+		}
+
+		fragmentCount += Break(request->body, request->pattern, request->point, request->impulse, nullptr, 0);
+		++index;
+	}
+
+	memmove(m_requests, m_requests + index, (m_requestCount - index) * sizeof(b2FractureRequest));
+	m_requestCount -= index;
+	return fragmentCount;
+}
+
+int32 b2FractureQueue::Fracture(b2Body* body, const b2FracturePattern* pattern, const b2Vec2& point, const b2Vec2& impulse,
+								b2Body** fragments, int32 capacity)
+{
+	Remove(body);
+	return Break(body, pattern, point, impulse, fragments, capacity);
+}
+
+void b2FractureQueue::ReservePieces(int32 capacity)
+{
+	if (capacity <= m_pieceCapacity)
+	{
+		return;
+	}
+
+	capacity = b2Max(capacity, 2 * m_pieceCapacity);
+	b2PolygonShape* pieces = (b2PolygonShape*)b2Alloc(capacity * sizeof(b2PolygonShape));
+	b2Fixture** pieceFixtures = (b2Fixture**)b2Alloc(capacity * sizeof(b2Fixture*));
+	for (int32 i = 0; i < capacity; ++i)
+	{
+		new (pieces + i) b2PolygonShape;
+	}
+
+	memcpy(pieceFixtures, m_pieceFixtures, m_pieceCapacity * sizeof(b2Fixture*));
+	for (int32 i = 0; i < m_pieceCapacity; ++i)
+	{
+		pieces[i] = m_pieces[i];
+	}
+
+	b2Free(m_pieces);
+	b2Free(m_pieceFixtures);
+	m_pieces = pieces;
+	m_pieceFixtures = pieceFixtures;
+	m_pieceCapacity = capacity;
+}
+
+int32 b2FractureQueue::Break(b2Body* body, const b2FracturePattern* pattern, const b2Vec2& point, const b2Vec2& impulse,
+							b2Body** fragments, int32 capacity)
+{
+	b2World* world = body->GetWorld();
+	b2Assert(world->IsLocked() == false);
+	if (world->IsLocked())
+	{
+		return 0;
+	}
+
+	// The pieces are built in body coordinates, so the fragments keep the body transform.
+	const b2Transform& xf = body->GetTransform();
+	b2Vec2 localPoint = b2MulT(xf, point);
+
+	b2Rot q;
+	b2Vec2 direction = b2MulT(xf.q, impulse);
+	if (direction.Normalize() < b2_epsilon)
+	{
+		q.SetIdentity();
+	}
+	else
+	{
+		q.s = direction.y;
+		q.c = direction.x;
+	}
+
+	// Scale the pattern to cover all polygons.
+	int32 fixtureCount = 0;
+	int32 polygonCount = 0;
+	float scale = 0.0f;
+	for (b2Fixture* f = body->GetFixtureList(); f; f = f->GetNext())
+	{
+		++fixtureCount;
+		if (f->GetType() != b2Shape::e_polygon)
+		{
+			continue;
+		}
+
+		const b2PolygonShape* polygon = (const b2PolygonShape*)f->GetShape();
+		for (int32 i = 0; i < polygon->m_count; ++i)
+		{
+			scale = b2Max(scale, b2DistanceSquared(polygon->m_vertices[i], localPoint));
+		}
+		++polygonCount;
+	}
+
+	if (polygonCount == 0)
+	{
+		return 0;
+	}
+
+	scale = sqrtf(scale) + b2_linearSlop;
+
+	// A polygon clipped by a cell has at most one vertex per polygon edge and cell edge.
+	int32 maxClipCount = b2_maxPolygonVertices + pattern->GetMaxCellVertexCount();
+	if (3 * maxClipCount > m_clipCapacity)
+	{
+		b2Free(m_clipVertices);
+		m_clipCapacity = 3 * maxClipCount;
+		m_clipVertices = (b2Vec2*)b2Alloc(m_clipCapacity * sizeof(b2Vec2));
+	}
+
+	b2Vec2* cell = m_clipVertices;
+	b2Vec2* clip1 = m_clipVertices + maxClipCount;
+	b2Vec2* clip2 = m_clipVertices + 2 * maxClipCount;
+
+	b2BodyDef bd;
+	bd.type = body->GetType();
+	bd.position = body->GetPosition();
+	bd.angle = body->GetAngle();
+	bd.linearVelocity = body->GetLinearVelocityFromLocalPoint(b2Vec2_zero);
+	bd.angularVelocity = body->GetAngularVelocity();
+	bd.linearDamping = body->GetLinearDamping();
+	bd.angularDamping = body->GetAngularDamping();
+	bd.allowSleep = body->IsSleepingAllowed();
+	bd.fixedRotation = body->IsFixedRotation();
+	bd.bullet = body->IsBullet();
+	bd.gravityScale = body->GetGravityScale();
+	bd.sleepThreshold = body->GetSleepThreshold();
+
+	b2Body* impactFragment = nullptr;
+	float impactDistance = b2_maxFloat;
+	int32 fragmentCount = 0;
+
+	b2Transform identity;
+	identity.SetIdentity();
+
+	int32 cellCount = pattern->GetCellCount();
+	for (int32 c = 0; c < cellCount; ++c)
+	{
+		int32 cellVertexCount;
+		const b2Vec2* cellVertices = pattern->GetCellVertices(c, &cellVertexCount);
+		if (cellVertexCount == 0)
+		{
+			continue;
+		}
+
+		b2AABB cellAABB;
+		for (int32 i = 0; i < cellVertexCount; ++i)
+		{
+			cell[i] = localPoint + scale * b2Mul(q, cellVertices[i]);
+		}
+
+		cellAABB.lowerBound = cell[0];
+		cellAABB.upperBound = cell[0];
+		for (int32 i = 1; i < cellVertexCount; ++i)
+		{
+			cellAABB.lowerBound = b2Min(cellAABB.lowerBound, cell[i]);
+			cellAABB.upperBound = b2Max(cellAABB.upperBound, cell[i]);
+		}
+
+		b2MassData massData;
+		massData.mass = 0.0f;
+		massData.center.SetZero();
+		massData.I = 0.0f;
+
+		int32 pieceCount = 0;
+		for (b2Fixture* f = body->GetFixtureList(); f; f = f->GetNext())
+		{
+			if (f->GetType() != b2Shape::e_polygon)
+			{
+				continue;
+			}
+
+			const b2PolygonShape* polygon = (const b2PolygonShape*)f->GetShape();
+			b2AABB aabb;
+			polygon->ComputeAABB(&aabb, identity, 0);
+			if (b2TestOverlap(aabb, cellAABB) == false)
+			{
+				continue;
+			}
+
+			b2Vec2* vs = clip1;
+			b2Vec2* out = clip2;
+			memcpy(vs, polygon->m_vertices, polygon->m_count * sizeof(b2Vec2));
+			int32 n = polygon->m_count;
+			for (int32 i = 0; i < cellVertexCount && n > 0; ++i)
+			{
+				n = b2ClipToLine(out, vs, n, cell[i], cell[i + 1 < cellVertexCount ? i + 1 : 0]);
+				b2Swap(vs, out);
+			}
+
+			if (n < 3)
+			{
+				continue;
+			}
+
+			// Slivers are dropped by the hull. Rarely a clipped polygon needs to be split.
+			ReservePieces(pieceCount + maxClipCount);
+			int32 addCount = 0;
+			b2HullResult result = m_pieces[pieceCount].SetHull(vs, n);
+			if (result == b2_hullOk)
+			{
+				addCount = 1;
+			}
+			else if (result == b2_hullTooManyVertices)
+			{
+				b2DecomposeHull(m_pieces + pieceCount, &addCount, maxClipCount, vs, n);
+			}
+
+			for (int32 i = 0; i < addCount; ++i)
+			{
+				b2MassData pieceMass;
+				m_pieces[pieceCount].ComputeMass(&pieceMass, f->GetDensity());
+				massData.mass += pieceMass.mass;
+				massData.center += pieceMass.mass * pieceMass.center;
+				massData.I += pieceMass.I;
+				m_pieceFixtures[pieceCount] = f;
+				++pieceCount;
+			}
+		}
+
+		if (pieceCount == 0)
+		{
+			continue;
+		}
+
+		if (massData.mass > 0.0f)
+		{
+			massData.center *= 1.0f / massData.mass;
+		}
+
+		b2Body* fragment = world->CreateBody(&bd);
+
+		// The pieces of each fixture share its material. Setting the mass is cheap, so each
+		// batch sets it instead of computing it from the fixtures.
+		int32 start = 0;
+		while (start < pieceCount)
+		{
+			b2Fixture* f = m_pieceFixtures[start];
+			int32 end = start + 1;
+			while (end < pieceCount && m_pieceFixtures[end] == f)
+			{
+				++end;
+			}
+
+			b2FixtureDef fd;
+			fd.friction = f->GetFriction();
+			fd.restitution = f->GetRestitution();
+			fd.density = f->GetDensity();
+			fd.isSensor = f->IsSensor();
+			fd.filter = f->GetFilterData();
+			fragment->CreateFixtures(&fd, m_pieces + start, end - start, &massData);
+			start = end;
+		}
+
+		float distance = b2DistanceSquared(b2Mul(xf, massData.center), point);
+		if (distance < impactDistance)
+		{
+			impactDistance = distance;
+			impactFragment = fragment;
+		}
+
+		if (fragmentCount < capacity)
+		{
+			fragments[fragmentCount] = fragment;
+		}
+		++fragmentCount;
+	}
+
+	if (fragmentCount == 0)
+	{
+		return 0;
+	}
+
+	impactFragment->ApplyLinearImpulse(impulse, point, true);
+
+	// Remove the broken polygons.
+	if (polygonCount == fixtureCount)
+	{
+		world->DestroyBody(body);
+	}
+	else
+	{
+		b2Fixture* f = body->GetFixtureList();
+		while (f)
+		{
+			b2Fixture* next = f->GetNext();
+			if (f->GetType() == b2Shape::e_polygon)
+			{
+				body->DestroyFixture(f);
+			}
+			f = next;
+		}
+	}
+
+	return fragmentCount;
+}
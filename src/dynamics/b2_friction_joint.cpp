@@ -238,6 +238,16 @@ float b2FrictionJoint::GetMaxTorque() const
 	return m_maxTorque;
 }
 
+void b2FrictionJoint::SerializeState(b2JointStateStream& stream)
+{
+	stream.Serialize(m_localAnchorA);
+	stream.Serialize(m_localAnchorB);
+	stream.Serialize(m_linearImpulse);
+	stream.Serialize(m_angularImpulse);
+	stream.Serialize(m_maxForce);
+	stream.Serialize(m_maxTorque);
+}
+
 void b2FrictionJoint::Dump()
 {
 	int32 indexA = m_bodyA->m_islandIndex;
@@ -253,3 +263,8 @@ void b2FrictionJoint::Dump()
 	b2Log("  jd.maxTorque = %.15lef;\n", m_maxTorque);
 	b2Log("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+b2JointBatchRegister b2FrictionJoint::GetBatchRegister()
+{
+	return CreateBatchRegister<b2FrictionJoint>();
+}
@@ -404,6 +404,21 @@ float b2GearJoint::GetRatio() const
 	return m_ratio;
 }
 
+void b2GearJoint::SerializeState(b2JointStateStream& stream)
+{
+	stream.Serialize(m_localAnchorA);
+	stream.Serialize(m_localAnchorB);
+	stream.Serialize(m_localAnchorC);
+	stream.Serialize(m_localAnchorD);
+	stream.Serialize(m_localAxisC);
+	stream.Serialize(m_localAxisD);
+	stream.Serialize(m_referenceAngleA);
+	stream.Serialize(m_referenceAngleB);
+	stream.Serialize(m_constant);
+	stream.Serialize(m_ratio);
+	stream.Serialize(m_impulse);
+}
+
 void b2GearJoint::Dump()
 {
 	int32 indexA = m_bodyA->m_islandIndex;
@@ -421,3 +436,8 @@ void b2GearJoint::Dump()
 	b2Log("  jd.ratio = %.15lef;\n", m_ratio);
 	b2Log("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+b2JointBatchRegister b2GearJoint::GetBatchRegister()
+{
+	return CreateBatchRegister<b2GearJoint>();
+}
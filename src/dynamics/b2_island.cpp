@@ -29,9 +29,14 @@
 #include "box2d/b2_timer.h"
 #include "box2d/b2_world.h"
 
+#include "box2d/b2_task.h"
+
 #include "b2_island.h"
+#include "dynamics/b2_constraint_graph.h"
 #include "dynamics/b2_contact_solver.h"
 
+#include <string.h>
+
 /*
 Position Correction Notes
 =========================
@@ -150,6 +155,38 @@ This might be faster than computing sin+cos.
 However, we can compute sin+cos of the same angle fast.
 */
 
+// A run of island joints that share a type.
+struct b2JointRun
+{
+	const b2JointBatchRegister* batch;
+	b2Joint** joints;
+	int32 count;
+};
+
+// Islands with fewer constraints are not worth coloring.
+const int32 b2_graphMinConstraints = 256;
+
+// The minimum number of constraints per task when solving a color.
+const int32 b2_graphMinRange = 64;
+
+enum b2GraphStage
+{
+	e_graphPrepare,
+	e_graphSolveVelocity,
+	e_graphSolvePosition,
+	e_graphSolveJointPosition
+};
+
+struct b2GraphContext
+{
+	b2ContactSolver* contactSolver;
+	const b2SolverData* data;
+	b2Joint** joints;
+	const b2GraphColor* color;
+	b2GraphStage stage;
+	bool* workerOkay;
+};
+
 b2Island::b2Island(
 	int32 bodyCapacity,
 	int32 contactCapacity,
@@ -166,6 +203,8 @@ b2Island::b2Island(
 
 	m_allocator = allocator;
 	m_listener = listener;
+	m_executor = nullptr;
+	m_energySleep = false;
 
 	m_bodies = (b2Body**)m_allocator->Allocate(bodyCapacity * sizeof(b2Body*));
 	m_contacts = (b2Contact**)m_allocator->Allocate(contactCapacity	 * sizeof(b2Contact*));
@@ -187,6 +226,12 @@ b2Island::~b2Island()
 
 void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep)
 {
+	if (step.solverType == b2_softStepSolver)
+	{
+		SolveSoft(profile, step, gravity, allowSleep);
+		return;
+	}
+
 	b2Timer timer;
 
 	float h = step.dt;
@@ -235,6 +280,15 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	solverData.step = step;
 	solverData.positions = m_positions;
 	solverData.velocities = m_velocities;
+	solverData.useBias = true;
+
+	// Color large islands so their constraints can be solved in parallel.
+	b2ConstraintGraph graph;
+	bool useGraph = UseGraph();
+	if (useGraph)
+	{
+		ColorGraph(&graph);
+	}
 
 	// Initialize velocity constraints.
 	b2ContactSolverDef contactSolverDef;
@@ -248,35 +302,161 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 	b2ContactSolver contactSolver(&contactSolverDef);
 	contactSolver.InitializeVelocityConstraints();
 
-	if (step.warmStarting)
+	b2JointRun jointRuns[b2Joint::e_jointTypeCount];
+	int32 jointRunCount = 0;
+
+	if (useGraph)
 	{
-		contactSolver.WarmStart();
+		SolveGraph(&graph, e_graphPrepare, &contactSolver, solverData);
 	}
-	
-	for (int32 i = 0; i < m_jointCount; ++i)
+	else
 	{
-		m_joints[i]->InitVelocityConstraints(solverData);
+		if (step.warmStarting)
+		{
+			contactSolver.WarmStart();
+		}
+
+		jointRunCount = SortJoints(jointRuns, m_joints, m_jointCount);
+
+		for (int32 i = 0; i < jointRunCount; ++i)
+		{
+			const b2JointRun* run = jointRuns + i;
+			run->batch->initVelocityFcn(run->joints, run->count, solverData);
+		}
 	}
 
 	profile->solveInit = timer.GetMilliseconds();
 
+	// Adaptive iterations compare the velocities before and after an iteration.
+	bool adaptive = step.linearIterationTolerance > 0.0f;
+	b2Velocity* previous = nullptr;
+	if (adaptive)
+	{
+		previous = (b2Velocity*)m_allocator->Allocate(m_bodyCount * sizeof(b2Velocity));
+	}
+
 	// Solve velocity constraints
 	timer.Reset();
+	int32 iterationCount = 0;
 	for (int32 i = 0; i < step.velocityIterations; ++i)
 	{
-		for (int32 j = 0; j < m_jointCount; ++j)
+		bool measure = adaptive && i + 1 >= step.minVelocityIterations;
+		if (measure)
 		{
-			m_joints[j]->SolveVelocityConstraints(solverData);
+			memcpy(previous, m_velocities, m_bodyCount * sizeof(b2Velocity));
 		}
 
-		contactSolver.SolveVelocityConstraints();
+		++iterationCount;
+
+		if (useGraph)
+		{
+			SolveGraph(&graph, e_graphSolveVelocity, &contactSolver, solverData);
+		}
+		else
+		{
+			for (int32 j = 0; j < jointRunCount; ++j)
+			{
+				const b2JointRun* run = jointRuns + j;
+				run->batch->solveVelocityFcn(run->joints, run->count, solverData);
+			}
+
+			contactSolver.SolveVelocityConstraints();
+		}
+
+		if (measure && IsConverged(previous, step))
+		{
+			break;
+		}
+	}
+
+	if (adaptive)
+	{
+		m_allocator->Free(previous);
 	}
 
 	// Store impulses for warm starting
 	contactSolver.StoreImpulses();
 	profile->solveVelocity = timer.GetMilliseconds();
+	profile->velocityIterations = iterationCount;
 
 	// Integrate positions
+	IntegratePositions(h);
+
+	// Solve position constraints
+	timer.Reset();
+	bool positionSolved = false;
+	for (int32 i = 0; i < step.positionIterations; ++i)
+	{
+		if (useGraph)
+		{
+			if (SolveGraph(&graph, e_graphSolvePosition, &contactSolver, solverData))
+			{
+				positionSolved = true;
+				break;
+			}
+			continue;
+		}
+
+		bool contactsOkay = contactSolver.SolvePositionConstraints();
+
+		bool jointsOkay = true;
+		for (int32 j = 0; j < jointRunCount; ++j)
+		{
+			const b2JointRun* run = jointRuns + j;
+			bool jointOkay = run->batch->solvePositionFcn(run->joints, run->count, solverData);
+			jointsOkay = jointsOkay && jointOkay;
+		}
+
+		if (contactsOkay && jointsOkay)
+		{
+			// Exit early if the position errors are small.
+			positionSolved = true;
+			break;
+		}
+	}
+
+	// Copy state buffers back to the bodies
+	for (int32 i = 0; i < m_bodyCount; ++i)
+	{
+		b2Body* body = m_bodies[i];
+		body->m_sweep.c = m_positions[i].c;
+		body->m_sweep.a = m_positions[i].a;
+		body->m_linearVelocity = m_velocities[i].v;
+		body->m_angularVelocity = m_velocities[i].w;
+		body->SynchronizeTransform();
+	}
+
+	profile->solvePosition = timer.GetMilliseconds();
+
+	Report(contactSolver.m_velocityConstraints);
+
+	if (allowSleep)
+	{
+		UpdateSleep(h, positionSolved);
+	}
+}
+
+bool b2Island::IsConverged(const b2Velocity* previous, const b2TimeStep& step) const
+{
+	float linearTolSqr = step.linearIterationTolerance * step.linearIterationTolerance;
+	float angularTol = step.angularIterationTolerance;
+
+	for (int32 i = 0; i < m_bodyCount; ++i)
+	{
+		b2Vec2 dv = m_velocities[i].v - previous[i].v;
+		float dw = m_velocities[i].w - previous[i].w;
+
+		if (b2Dot(dv, dv) > linearTolSqr || b2Abs(dw) > angularTol)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void b2Island::IntegratePositions(float h)
+{
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
 		b2Vec2 c = m_positions[i].c;
@@ -308,81 +488,261 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 		m_velocities[i].v = v;
 		m_velocities[i].w = w;
 	}
+}
 
-	// Solve position constraints
-	timer.Reset();
-	bool positionSolved = false;
-	for (int32 i = 0; i < step.positionIterations; ++i)
+void b2Island::UpdateSleep(float h, bool positionSolved)
+{
+	// The angular threshold scales with the per-body linear threshold.
+	const float angularScale = b2_angularSleepTolerance / b2_linearSleepTolerance;
+
+	bool resting = true;
+	if (m_energySleep)
 	{
-		bool contactsOkay = contactSolver.SolvePositionConstraints();
+		// Compare the mass weighted squared speed of the island against the mass weighted
+		// thresholds. A single jittering body in a resting pile no longer keeps the pile awake.
+		const float invScaleSqr = 1.0f / (angularScale * angularScale);
+		float energy = 0.0f;
+		float threshold = 0.0f;
+		for (int32 i = 0; i < m_bodyCount; ++i)
+		{
+			b2Body* b = m_bodies[i];
+			if (b->GetType() == b2_staticBody)
+			{
+				continue;
+			}
 
-		bool jointsOkay = true;
-		for (int32 j = 0; j < m_jointCount; ++j)
+			if ((b->m_flags & b2Body::e_autoSleepFlag) == 0)
+			{
+				resting = false;
+				break;
+			}
+
+			float linTolSqr = b->m_sleepThreshold * b->m_sleepThreshold;
+			float speedSqr = b2Dot(b->m_linearVelocity, b->m_linearVelocity) + invScaleSqr * b->m_angularVelocity * b->m_angularVelocity;
+
+			// Kinematic bodies have no mass so they must rest on their own.
+			if (b->GetType() == b2_kinematicBody)
+			{
+				if (speedSqr > linTolSqr)
+				{
+					resting = false;
+					break;
+				}
+				continue;
+			}
+
+			energy += b->m_mass * speedSqr;
+			threshold += b->m_mass * linTolSqr;
+		}
+
+		resting = resting && energy <= threshold;
+	}
+
+	float minSleepTime = b2_maxFloat;
+	for (int32 i = 0; i < m_bodyCount; ++i)
+	{
+		b2Body* b = m_bodies[i];
+		if (b->GetType() == b2_staticBody)
 		{
-			bool jointOkay = m_joints[j]->SolvePositionConstraints(solverData);
-			jointsOkay = jointsOkay && jointOkay;
+			continue;
 		}
 
-		if (contactsOkay && jointsOkay)
+		bool bodyResting = resting;
+		if (m_energySleep == false)
 		{
-			// Exit early if the position errors are small.
-			positionSolved = true;
-			break;
+			float linTol = b->m_sleepThreshold;
+			float angTol = angularScale * linTol;
+			bodyResting = (b->m_flags & b2Body::e_autoSleepFlag) != 0 &&
+				b->m_angularVelocity * b->m_angularVelocity <= angTol * angTol &&
+				b2Dot(b->m_linearVelocity, b->m_linearVelocity) <= linTol * linTol;
+		}
+
+		if (bodyResting)
+		{
+			b->m_sleepTime += h;
+			minSleepTime = b2Min(minSleepTime, b->m_sleepTime);
+		}
+		else
+		{
+			b->m_sleepTime = 0.0f;
+			minSleepTime = 0.0f;
 		}
 	}
 
-	// Copy state buffers back to the bodies
+	if (minSleepTime >= b2_timeToSleep && positionSolved)
+	{
+		for (int32 i = 0; i < m_bodyCount; ++i)
+		{
+			b2Body* b = m_bodies[i];
+			b->SetAwake(false);
+		}
+	}
+}
+
+// Soft step solver. Each sub-step integrates velocities, solves the constraints with a
+// soft position bias, integrates positions and then relaxes the constraints without the
+// bias so the bias does not add energy. Restitution is applied once at the end.
+void b2Island::SolveSoft(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep)
+{
+	b2Timer timer;
+
+	int32 subStepCount = b2Max(step.velocityIterations, 1);
+	float h = step.dt / subStepCount;
+
+	// Initialize the body state.
 	for (int32 i = 0; i < m_bodyCount; ++i)
 	{
-		b2Body* body = m_bodies[i];
-		body->m_sweep.c = m_positions[i].c;
-		body->m_sweep.a = m_positions[i].a;
-		body->m_linearVelocity = m_velocities[i].v;
-		body->m_angularVelocity = m_velocities[i].w;
-		body->SynchronizeTransform();
+		b2Body* b = m_bodies[i];
+
+		// Store positions for continuous collision.
+		b->m_sweep.c0 = b->m_sweep.c;
+		b->m_sweep.a0 = b->m_sweep.a;
+
+		m_positions[i].c = b->m_sweep.c;
+		m_positions[i].a = b->m_sweep.a;
+		m_velocities[i].v = b->m_linearVelocity;
+		m_velocities[i].w = b->m_angularVelocity;
 	}
 
-	profile->solvePosition = timer.GetMilliseconds();
+	b2TimeStep subStep = step;
+	subStep.dt = h;
+	subStep.inv_dt = h > 0.0f ? 1.0f / h : 0.0f;
 
-	Report(contactSolver.m_velocityConstraints);
+	// Solver data
+	b2SolverData solverData;
+	solverData.step = subStep;
+	solverData.positions = m_positions;
+	solverData.velocities = m_velocities;
+	solverData.useBias = true;
 
-	if (allowSleep)
+	b2ConstraintGraph graph;
+	bool useGraph = UseGraph();
+	if (useGraph)
 	{
-		float minSleepTime = b2_maxFloat;
+		ColorGraph(&graph);
+	}
+
+	// The contact anchors and masses are computed once per step.
+	b2ContactSolverDef contactSolverDef;
+	contactSolverDef.step = subStep;
+	contactSolverDef.contacts = m_contacts;
+	contactSolverDef.count = m_contactCount;
+	contactSolverDef.positions = m_positions;
+	contactSolverDef.velocities = m_velocities;
+	contactSolverDef.allocator = m_allocator;
+
+	b2ContactSolver contactSolver(&contactSolverDef);
+	contactSolver.InitializeVelocityConstraints();
+
+	b2JointRun jointRuns[b2Joint::e_jointTypeCount];
+	int32 jointRunCount = useGraph ? 0 : SortJoints(jointRuns, m_joints, m_jointCount);
 
-		const float linTolSqr = b2_linearSleepTolerance * b2_linearSleepTolerance;
-		const float angTolSqr = b2_angularSleepTolerance * b2_angularSleepTolerance;
+	profile->solveInit = timer.GetMilliseconds();
 
+	timer.Reset();
+	for (int32 subStepIndex = 0; subStepIndex < subStepCount; ++subStepIndex)
+	{
+		// Integrate velocities and apply damping.
 		for (int32 i = 0; i < m_bodyCount; ++i)
 		{
 			b2Body* b = m_bodies[i];
-			if (b->GetType() == b2_staticBody)
+			if (b->m_type != b2_dynamicBody)
 			{
 				continue;
 			}
 
-			if ((b->m_flags & b2Body::e_autoSleepFlag) == 0 ||
-				b->m_angularVelocity * b->m_angularVelocity > angTolSqr ||
-				b2Dot(b->m_linearVelocity, b->m_linearVelocity) > linTolSqr)
-			{
-				b->m_sleepTime = 0.0f;
-				minSleepTime = 0.0f;
-			}
-			else
-			{
-				b->m_sleepTime += h;
-				minSleepTime = b2Min(minSleepTime, b->m_sleepTime);
-			}
+			b2Vec2 v = m_velocities[i].v;
+			float w = m_velocities[i].w;
+
+			v += h * (b->m_gravityScale * gravity + b->m_invMass * b->m_force);
+			w += h * b->m_invI * b->m_torque;
+
+			v *= 1.0f / (1.0f + h * b->m_linearDamping);
+			w *= 1.0f / (1.0f + h * b->m_angularDamping);
+
+			m_velocities[i].v = v;
+			m_velocities[i].w = w;
 		}
 
-		if (minSleepTime >= b2_timeToSleep && positionSolved)
+		// Joints are prepared every sub-step from the current positions. The previous
+		// step's impulses are only scaled on the first sub-step.
+		solverData.step.dtRatio = subStepIndex == 0 ? step.dtRatio : 1.0f;
+		solverData.useBias = true;
+
+		if (useGraph)
 		{
-			for (int32 i = 0; i < m_bodyCount; ++i)
-			{
-				b2Body* b = m_bodies[i];
-				b->SetAwake(false);
-			}
+			SolveGraph(&graph, e_graphPrepare, &contactSolver, solverData);
+			SolveGraph(&graph, e_graphSolveVelocity, &contactSolver, solverData);
+
+			IntegratePositions(h);
+
+			solverData.useBias = false;
+			SolveGraph(&graph, e_graphSolveVelocity, &contactSolver, solverData);
+			SolveGraph(&graph, e_graphSolveJointPosition, &contactSolver, solverData);
+			continue;
+		}
+
+		for (int32 i = 0; i < jointRunCount; ++i)
+		{
+			const b2JointRun* run = jointRuns + i;
+			run->batch->initVelocityFcn(run->joints, run->count, solverData);
 		}
+
+		if (step.warmStarting)
+		{
+			contactSolver.WarmStart();
+		}
+
+		// Solve with the soft bias.
+		for (int32 i = 0; i < jointRunCount; ++i)
+		{
+			const b2JointRun* run = jointRuns + i;
+			run->batch->solveVelocityFcn(run->joints, run->count, solverData);
+		}
+		contactSolver.SolveSoftVelocityConstraints(true);
+
+		IntegratePositions(h);
+
+		// Relax
+		solverData.useBias = false;
+		for (int32 i = 0; i < jointRunCount; ++i)
+		{
+			const b2JointRun* run = jointRuns + i;
+			run->batch->solveVelocityFcn(run->joints, run->count, solverData);
+		}
+		contactSolver.SolveSoftVelocityConstraints(false);
+
+		// Joints without soft support correct their position error here.
+		for (int32 i = 0; i < jointRunCount; ++i)
+		{
+			const b2JointRun* run = jointRuns + i;
+			run->batch->solvePositionFcn(run->joints, run->count, solverData);
+		}
+	}
+
+	contactSolver.ApplyRestitution();
+	contactSolver.StoreImpulses();
+	profile->solveVelocity = timer.GetMilliseconds();
+
+	// Copy state buffers back to the bodies
+	for (int32 i = 0; i < m_bodyCount; ++i)
+	{
+		b2Body* body = m_bodies[i];
+		body->m_sweep.c = m_positions[i].c;
+		body->m_sweep.a = m_positions[i].a;
+		body->m_linearVelocity = m_velocities[i].v;
+		body->m_angularVelocity = m_velocities[i].w;
+		body->SynchronizeTransform();
+	}
+
+	profile->solvePosition = 0.0f;
+	profile->velocityIterations = subStepCount;
+
+	Report(contactSolver.m_velocityConstraints);
+
+	if (allowSleep)
+	{
+		UpdateSleep(step.dt, true);
 	}
 }
 
@@ -542,3 +902,195 @@ void b2Island::Report(const b2ContactVelocityConstraint* constraints)
 		m_listener->PostSolve(c, &impulse);
 	}
 }
+
+int32 b2Island::SortJoints(b2JointRun* runs, b2Joint** joints, int32 count)
+{
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	int32 counts[b2Joint::e_jointTypeCount] = {0};
+	for (int32 i = 0; i < count; ++i)
+	{
+		++counts[joints[i]->m_type];
+	}
+
+	int32 offsets[b2Joint::e_jointTypeCount];
+	int32 runCount = 0;
+	int32 offset = 0;
+	for (int32 type = 0; type < b2Joint::e_jointTypeCount; ++type)
+	{
+		offsets[type] = offset;
+		if (counts[type] > 0)
+		{
+			b2JointRun* run = runs + runCount;
+			run->batch = b2Joint::s_batchRegisters + type;
+			run->joints = joints + offset;
+			run->count = counts[type];
+			++runCount;
+		}
+		offset += counts[type];
+	}
+
+	if (runCount == 1)
+	{
+		return runCount;
+	}
+
+	// Counting sort. This is stable, so joints of one type keep their island order.
+	b2Joint** sorted = (b2Joint**)m_allocator->Allocate(count * sizeof(b2Joint*));
+	for (int32 i = 0; i < count; ++i)
+	{
+		b2Joint* joint = joints[i];
+		sorted[offsets[joint->m_type]++] = joint;
+	}
+	memcpy(joints, sorted, count * sizeof(b2Joint*));
+	m_allocator->Free(sorted);
+
+	return runCount;
+}
+
+void b2Island::ColorGraph(b2ConstraintGraph* graph)
+{
+	graph->Color(m_allocator, m_bodyCount, m_joints, m_jointCount, m_contacts, m_contactCount);
+
+	// The graph tasks solve the joints of a color in per-type runs, like the serial path.
+	b2JointRun runs[b2Joint::e_jointTypeCount];
+	for (int32 i = 0; i < b2_graphColorCount + 1; ++i)
+	{
+		const b2GraphColor* color = graph->m_colors + i;
+		SortJoints(runs, m_joints + color->jointStart, color->jointCount);
+	}
+}
+
+bool b2Island::UseGraph() const
+{
+	return m_executor != nullptr && m_executor->GetWorkerCount() > 1 &&
+		m_jointCount + m_contactCount >= b2_graphMinConstraints;
+}
+
+void b2Island::SolveGraphTask(int32 startIndex, int32 endIndex, int32 workerIndex, void* context)
+{
+	b2GraphContext* graphContext = (b2GraphContext*)context;
+	const b2GraphColor* color = graphContext->color;
+	const b2SolverData& data = *graphContext->data;
+	b2ContactSolver* contactSolver = graphContext->contactSolver;
+
+	// The range covers the joints of the color followed by the contacts. The joints of a
+	// color are grouped by type, so the part of the range with joints splits into runs.
+	bool okay = true;
+	int32 jointEnd = b2Min(endIndex, color->jointCount);
+	for (int32 i = startIndex; i < jointEnd;)
+	{
+		b2Joint** joints = graphContext->joints + color->jointStart + i;
+		b2JointType type = joints[0]->m_type;
+		int32 count = 1;
+		while (i + count < jointEnd && joints[count]->m_type == type)
+		{
+			++count;
+		}
+
+		const b2JointBatchRegister* batch = b2Joint::s_batchRegisters + type;
+		switch (graphContext->stage)
+		{
+		case e_graphPrepare:
+			batch->initVelocityFcn(joints, count, data);
+			break;
+
+		case e_graphSolveVelocity:
+			batch->solveVelocityFcn(joints, count, data);
+			break;
+
+		case e_graphSolvePosition:
+		case e_graphSolveJointPosition:
+			{
+				bool jointsOkay = batch->solvePositionFcn(joints, count, data);
+				okay = okay && jointsOkay;
+			}
+			break;
+		}
+
+		i += count;
+	}
+
+	int32 contactStart = color->contactStart + b2Max(startIndex - color->jointCount, 0);
+	int32 contactEnd = color->contactStart + endIndex - color->jointCount;
+	if (contactStart < contactEnd)
+	{
+		switch (graphContext->stage)
+		{
+		case e_graphPrepare:
+			if (data.step.warmStarting)
+			{
+				contactSolver->WarmStart(contactStart, contactEnd);
+			}
+			break;
+
+		case e_graphSolveVelocity:
+			if (data.step.solverType == b2_softStepSolver)
+			{
+				contactSolver->SolveSoftVelocityConstraints(data.useBias, contactStart, contactEnd);
+			}
+			else
+			{
+				contactSolver->SolveVelocityConstraints(contactStart, contactEnd);
+			}
+			break;
+
+		case e_graphSolvePosition:
+			{
+				bool contactsOkay = contactSolver->SolvePositionConstraints(contactStart, contactEnd);
+				okay = okay && contactsOkay;
+			}
+			break;
+
+		case e_graphSolveJointPosition:
+			break;
+		}
+	}
+
+	if (okay == false)
+	{
+		graphContext->workerOkay[workerIndex] = false;
+	}
+}
+
+bool b2Island::SolveGraph(const b2ConstraintGraph* graph, int32 stage, b2ContactSolver* contactSolver, const b2SolverData& data)
+{
+	int32 workerCount = m_executor->GetWorkerCount();
+	bool* workerOkay = (bool*)m_allocator->Allocate(workerCount * sizeof(bool));
+	for (int32 i = 0; i < workerCount; ++i)
+	{
+		workerOkay[i] = true;
+	}
+
+	b2GraphContext context;
+	context.contactSolver = contactSolver;
+	context.data = &data;
+	context.joints = m_joints;
+	context.stage = b2GraphStage(stage);
+	context.workerOkay = workerOkay;
+
+	// The constraints of a color share no dynamic body.
+	for (int32 i = 0; i < b2_graphColorCount; ++i)
+	{
+		const b2GraphColor* color = graph->m_colors + i;
+		context.color = color;
+		b2ParallelFor(m_executor, SolveGraphTask, &context, color->jointCount + color->contactCount, b2_graphMinRange);
+	}
+
+	// The overflow constraints are solved on this thread.
+	const b2GraphColor* overflow = graph->m_colors + b2_graphColorCount;
+	context.color = overflow;
+	SolveGraphTask(0, overflow->jointCount + overflow->contactCount, 0, &context);
+
+	bool okay = true;
+	for (int32 i = 0; i < workerCount; ++i)
+	{
+		okay = okay && workerOkay[i];
+	}
+
+	m_allocator->Free(workerOkay);
+	return okay;
+}
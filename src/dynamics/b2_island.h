@@ -32,6 +32,11 @@ class b2Joint;
 class b2StackAllocator;
 class b2ContactListener;
 struct b2ContactVelocityConstraint;
+struct b2JointRun;
+struct b2SolverData;
+class b2ConstraintGraph;
+class b2ContactSolver;
+class b2TaskExecutor;
 struct b2Profile;
 
 /// This is an internal class.
@@ -50,6 +55,7 @@ public:
 	}
 
 	void Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep);
+	void SolveSoft(b2Profile* profile, const b2TimeStep& step, const b2Vec2& gravity, bool allowSleep);
 
 	void SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiIndexB);
 
@@ -75,8 +81,31 @@ public:
 
 	void Report(const b2ContactVelocityConstraint* constraints);
 
+	void IntegratePositions(float h);
+	void UpdateSleep(float h, bool positionSolved);
+
+	// Returns true if no body velocity moved by more than the iteration tolerances since
+	// the given snapshot.
+	bool IsConverged(const b2Velocity* previous, const b2TimeStep& step) const;
+
+	// Group a range of the island joints by type and return the number of runs.
+	int32 SortJoints(b2JointRun* runs, b2Joint** joints, int32 count);
+
+	// Color the constraints and group the joints of each color by type.
+	void ColorGraph(b2ConstraintGraph* graph);
+
+	// Solve one stage of a colored island, returns false if a position constraint is
+	// not solved.
+	bool UseGraph() const;
+	bool SolveGraph(const b2ConstraintGraph* graph, int32 stage, b2ContactSolver* contactSolver, const b2SolverData& data);
+	static void SolveGraphTask(int32 startIndex, int32 endIndex, int32 workerIndex, void* context);
+
 	b2StackAllocator* m_allocator;
 	b2ContactListener* m_listener;
+	b2TaskExecutor* m_executor;
+
+	// Sleep the island on its mass weighted speed instead of requiring every body to rest.
+	bool m_energySleep;
 
 	b2Body** m_bodies;
 	b2Contact** m_contacts;
@@ -94,4 +123,13 @@ public:
 	int32 m_jointCapacity;
 };
 
+/// This is an internal structure. The bodies of an island that fell asleep together. The
+/// bodies store the record index so waking any of them wakes the group without a graph search.
+struct b2SleepingIsland
+{
+	b2Body* bodyList;
+	int32 bodyCount;
+	int32 next;
+};
+
 #endif
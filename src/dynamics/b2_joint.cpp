@@ -36,6 +36,7 @@
 #include "box2d/b2_world.h"
 
 #include <new>
+#include <string.h>
 
 b2Joint* b2Joint::Create(const b2JointDef* def, b2BlockAllocator* allocator)
 {
@@ -183,6 +184,76 @@ void b2Joint::Destroy(b2Joint* joint, b2BlockAllocator* allocator)
 	}
 }
 
+b2JointStateStream::b2JointStateStream(Mode mode, void* data)
+{
+	b2Assert(mode == e_measure || data != nullptr);
+	m_mode = mode;
+	m_data = (char*)data;
+	m_size = 0;
+}
+
+void b2JointStateStream::SerializeBytes(void* value, int32 size)
+{
+	if (m_mode == e_write)
+	{
+		memcpy(m_data + m_size, value, size);
+	}
+	else if (m_mode == e_read)
+	{
+		memcpy(value, m_data + m_size, size);
+	}
+
+	m_size += size;
+}
+
+void b2JointStateStream::Serialize(float& value)
+{
+	SerializeBytes(&value, sizeof(float));
+}
+
+void b2JointStateStream::Serialize(int32& value)
+{
+	SerializeBytes(&value, sizeof(int32));
+}
+
+void b2JointStateStream::Serialize(bool& value)
+{
+	uint8 byte = value ? 1 : 0;
+	SerializeBytes(&byte, sizeof(uint8));
+	value = byte != 0;
+}
+
+void b2JointStateStream::Serialize(b2Vec2& value)
+{
+	Serialize(value.x);
+	Serialize(value.y);
+}
+
+void b2JointStateStream::Serialize(b2Vec3& value)
+{
+	Serialize(value.x);
+	Serialize(value.y);
+	Serialize(value.z);
+}
+
+b2JointBatchRegister b2Joint::s_batchRegisters[e_jointTypeCount];
+
+void b2Joint::InitializeBatchRegisters()
+{
+	s_batchRegisters[e_unknownJoint] = b2JointBatchRegister();
+	s_batchRegisters[e_revoluteJoint] = b2RevoluteJoint::GetBatchRegister();
+	s_batchRegisters[e_prismaticJoint] = b2PrismaticJoint::GetBatchRegister();
+	s_batchRegisters[e_distanceJoint] = b2DistanceJoint::GetBatchRegister();
+	s_batchRegisters[e_pulleyJoint] = b2PulleyJoint::GetBatchRegister();
+	s_batchRegisters[e_mouseJoint] = b2MouseJoint::GetBatchRegister();
+	s_batchRegisters[e_gearJoint] = b2GearJoint::GetBatchRegister();
+	s_batchRegisters[e_wheelJoint] = b2WheelJoint::GetBatchRegister();
+	s_batchRegisters[e_weldJoint] = b2WeldJoint::GetBatchRegister();
+	s_batchRegisters[e_frictionJoint] = b2FrictionJoint::GetBatchRegister();
+	s_batchRegisters[e_ropeJoint] = b2RopeJoint::GetBatchRegister();
+	s_batchRegisters[e_motorJoint] = b2MotorJoint::GetBatchRegister();
+}
+
 b2Joint::b2Joint(const b2JointDef* def)
 {
 	b2Assert(def->bodyA != def->bodyB);
@@ -295,6 +295,17 @@ float b2MotorJoint::GetAngularOffset() const
 	return m_angularOffset;
 }
 
+void b2MotorJoint::SerializeState(b2JointStateStream& stream)
+{
+	stream.Serialize(m_linearOffset);
+	stream.Serialize(m_angularOffset);
+	stream.Serialize(m_linearImpulse);
+	stream.Serialize(m_angularImpulse);
+	stream.Serialize(m_maxForce);
+	stream.Serialize(m_maxTorque);
+	stream.Serialize(m_correctionFactor);
+}
+
 void b2MotorJoint::Dump()
 {
 	int32 indexA = m_bodyA->m_islandIndex;
@@ -311,3 +322,8 @@ void b2MotorJoint::Dump()
 	b2Log("  jd.correctionFactor = %.15lef;\n", m_correctionFactor);
 	b2Log("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+b2JointBatchRegister b2MotorJoint::GetBatchRegister()
+{
+	return CreateBatchRegister<b2MotorJoint>();
+}
@@ -224,3 +224,18 @@ void b2MouseJoint::ShiftOrigin(const b2Vec2& newOrigin)
 {
 	m_targetA -= newOrigin;
 }
+
+void b2MouseJoint::SerializeState(b2JointStateStream& stream)
+{
+	stream.Serialize(m_localAnchorB);
+	stream.Serialize(m_targetA);
+	stream.Serialize(m_frequencyHz);
+	stream.Serialize(m_dampingRatio);
+	stream.Serialize(m_impulse);
+	stream.Serialize(m_maxForce);
+}
+
+b2JointBatchRegister b2MouseJoint::GetBatchRegister()
+{
+	return CreateBatchRegister<b2MouseJoint>();
+}
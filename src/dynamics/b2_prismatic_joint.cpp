@@ -623,6 +623,24 @@ float b2PrismaticJoint::GetMotorForce(float inv_dt) const
 	return inv_dt * m_motorImpulse;
 }
 
+void b2PrismaticJoint::SerializeState(b2JointStateStream& stream)
+{
+	stream.Serialize(m_localAnchorA);
+	stream.Serialize(m_localAnchorB);
+	stream.Serialize(m_localXAxisA);
+	stream.Serialize(m_localYAxisA);
+	stream.Serialize(m_referenceAngle);
+	stream.Serialize(m_impulse);
+	stream.Serialize(m_motorImpulse);
+	stream.Serialize(m_lowerTranslation);
+	stream.Serialize(m_upperTranslation);
+	stream.Serialize(m_maxMotorForce);
+	stream.Serialize(m_motorSpeed);
+	stream.Serialize(m_enableLimit);
+	stream.Serialize(m_enableMotor);
+	stream.SerializeEnum(m_limitState);
+}
+
 void b2PrismaticJoint::Dump()
 {
 	int32 indexA = m_bodyA->m_islandIndex;
@@ -644,3 +662,8 @@ void b2PrismaticJoint::Dump()
 	b2Log("  jd.maxMotorForce = %.15lef;\n", m_maxMotorForce);
 	b2Log("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+b2JointBatchRegister b2PrismaticJoint::GetBatchRegister()
+{
+	return CreateBatchRegister<b2PrismaticJoint>();
+}
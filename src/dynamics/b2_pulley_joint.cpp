@@ -326,6 +326,19 @@ float b2PulleyJoint::GetCurrentLengthB() const
 	return d.Length();
 }
 
+void b2PulleyJoint::SerializeState(b2JointStateStream& stream)
+{
+	stream.Serialize(m_groundAnchorA);
+	stream.Serialize(m_groundAnchorB);
+	stream.Serialize(m_lengthA);
+	stream.Serialize(m_lengthB);
+	stream.Serialize(m_localAnchorA);
+	stream.Serialize(m_localAnchorB);
+	stream.Serialize(m_constant);
+	stream.Serialize(m_ratio);
+	stream.Serialize(m_impulse);
+}
+
 void b2PulleyJoint::Dump()
 {
 	int32 indexA = m_bodyA->m_islandIndex;
@@ -350,3 +363,8 @@ void b2PulleyJoint::ShiftOrigin(const b2Vec2& newOrigin)
 	m_groundAnchorA -= newOrigin;
 	m_groundAnchorB -= newOrigin;
 }
+
+b2JointBatchRegister b2PulleyJoint::GetBatchRegister()
+{
+	return CreateBatchRegister<b2PulleyJoint>();
+}
@@ -186,6 +186,12 @@ void b2RevoluteJoint::InitVelocityConstraints(const b2SolverData& data)
 
 void b2RevoluteJoint::SolveVelocityConstraints(const b2SolverData& data)
 {
+	if (data.step.solverType == b2_softStepSolver)
+	{
+		SolveSoftVelocityConstraints(data);
+		return;
+	}
+
 	b2Vec2 vA = data.velocities[m_indexA].v;
 	float wA = data.velocities[m_indexA].w;
 	b2Vec2 vB = data.velocities[m_indexB].v;
@@ -292,8 +298,138 @@ void b2RevoluteJoint::SolveVelocityConstraints(const b2SolverData& data)
 	data.velocities[m_indexB].w = wB;
 }
 
+void b2RevoluteJoint::SolveSoftVelocityConstraints(const b2SolverData& data)
+{
+	b2Vec2 cA = data.positions[m_indexA].c;
+	float aA = data.positions[m_indexA].a;
+	b2Vec2 vA = data.velocities[m_indexA].v;
+	float wA = data.velocities[m_indexA].w;
+
+	b2Vec2 cB = data.positions[m_indexB].c;
+	float aB = data.positions[m_indexB].a;
+	b2Vec2 vB = data.velocities[m_indexB].v;
+	float wB = data.velocities[m_indexB].w;
+
+	float mA = m_invMassA, mB = m_invMassB;
+	float iA = m_invIA, iB = m_invIB;
+
+	bool fixedRotation = (iA + iB == 0.0f);
+
+	const b2Softness& soft = data.step.jointSoftness;
+
+	// Solve motor constraint.
+	if (m_enableMotor && m_limitState != e_equalLimits && fixedRotation == false)
+	{
+		float Cdot = wB - wA - m_motorSpeed;
+		float impulse = -m_motorMass * Cdot;
+		float oldImpulse = m_motorImpulse;
+		float maxImpulse = data.step.dt * m_maxMotorTorque;
+		m_motorImpulse = b2Clamp(m_motorImpulse + impulse, -maxImpulse, maxImpulse);
+		impulse = m_motorImpulse - oldImpulse;
+
+		wA -= iA * impulse;
+		wB += iB * impulse;
+	}
+
+	// Solve limit constraint.
+	if (m_enableLimit && m_limitState != e_inactiveLimit && fixedRotation == false)
+	{
+		float angle = aB - aA - m_referenceAngle;
+
+		if (m_limitState == e_equalLimits)
+		{
+			float bias = 0.0f;
+			float massScale = 1.0f;
+			float impulseScale = 0.0f;
+			if (data.useBias)
+			{
+				float C = angle - m_lowerAngle;
+				bias = soft.biasRate * C;
+				massScale = soft.massScale;
+				impulseScale = soft.impulseScale;
+			}
+
+			float Cdot = wB - wA;
+			float impulse = -m_motorMass * massScale * (Cdot + bias) - impulseScale * m_impulse.z;
+			m_impulse.z += impulse;
+
+			wA -= iA * impulse;
+			wB += iB * impulse;
+		}
+		else
+		{
+			// The lower limit pushes the angle up and the upper limit pushes it down.
+			float sign = m_limitState == e_atLowerLimit ? 1.0f : -1.0f;
+			float limit = m_limitState == e_atLowerLimit ? m_lowerAngle : m_upperAngle;
+			float C = sign * (angle - limit);
+
+			float bias = 0.0f;
+			float massScale = 1.0f;
+			float impulseScale = 0.0f;
+			if (C > 0.0f)
+			{
+				// Speculative
+				bias = C * data.step.inv_dt;
+			}
+			else if (data.useBias)
+			{
+				bias = soft.biasRate * C;
+				massScale = soft.massScale;
+				impulseScale = soft.impulseScale;
+			}
+
+			float Cdot = sign * (wB - wA);
+			float oldImpulse = sign * m_impulse.z;
+			float impulse = -m_motorMass * massScale * (Cdot + bias) - impulseScale * oldImpulse;
+			float newImpulse = b2Max(oldImpulse + impulse, 0.0f);
+			impulse = newImpulse - oldImpulse;
+			m_impulse.z = sign * newImpulse;
+
+			wA -= iA * sign * impulse;
+			wB += iB * sign * impulse;
+		}
+	}
+
+	// Solve point-to-point constraint
+	{
+		b2Vec2 bias(0.0f, 0.0f);
+		float massScale = 1.0f;
+		float impulseScale = 0.0f;
+		if (data.useBias)
+		{
+			b2Vec2 C = cB + m_rB - cA - m_rA;
+			bias = soft.biasRate * C;
+			massScale = soft.massScale;
+			impulseScale = soft.impulseScale;
+		}
+
+		b2Vec2 Cdot = vB + b2Cross(wB, m_rB) - vA - b2Cross(wA, m_rA);
+		b2Vec2 impulse = -massScale * m_mass.Solve22(Cdot + bias) - impulseScale * b2Vec2(m_impulse.x, m_impulse.y);
+
+		m_impulse.x += impulse.x;
+		m_impulse.y += impulse.y;
+
+		vA -= mA * impulse;
+		wA -= iA * b2Cross(m_rA, impulse);
+
+		vB += mB * impulse;
+		wB += iB * b2Cross(m_rB, impulse);
+	}
+
+	data.velocities[m_indexA].v = vA;
+	data.velocities[m_indexA].w = wA;
+	data.velocities[m_indexB].v = vB;
+	data.velocities[m_indexB].w = wB;
+}
+
 bool b2RevoluteJoint::SolvePositionConstraints(const b2SolverData& data)
 {
+	// The soft step solver corrects the position error in the velocity solver.
+	if (data.step.solverType == b2_softStepSolver)
+	{
+		return true;
+	}
+
 	b2Vec2 cA = data.positions[m_indexA].c;
 	float aA = data.positions[m_indexA].a;
 	b2Vec2 cB = data.positions[m_indexB].c;
@@ -493,6 +629,22 @@ void b2RevoluteJoint::SetLimits(float lower, float upper)
 	}
 }
 
+void b2RevoluteJoint::SerializeState(b2JointStateStream& stream)
+{
+	stream.Serialize(m_localAnchorA);
+	stream.Serialize(m_localAnchorB);
+	stream.Serialize(m_referenceAngle);
+	stream.Serialize(m_impulse);
+	stream.Serialize(m_motorImpulse);
+	stream.Serialize(m_enableMotor);
+	stream.Serialize(m_maxMotorTorque);
+	stream.Serialize(m_motorSpeed);
+	stream.Serialize(m_enableLimit);
+	stream.Serialize(m_lowerAngle);
+	stream.Serialize(m_upperAngle);
+	stream.SerializeEnum(m_limitState);
+}
+
 void b2RevoluteJoint::Dump()
 {
 	int32 indexA = m_bodyA->m_islandIndex;
@@ -513,3 +665,8 @@ void b2RevoluteJoint::Dump()
 	b2Log("  jd.maxMotorTorque = %.15lef;\n", m_maxMotorTorque);
 	b2Log("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+b2JointBatchRegister b2RevoluteJoint::GetBatchRegister()
+{
+	return CreateBatchRegister<b2RevoluteJoint>();
+}
@@ -229,6 +229,16 @@ b2LimitState b2RopeJoint::GetLimitState() const
 	return m_state;
 }
 
+void b2RopeJoint::SerializeState(b2JointStateStream& stream)
+{
+	stream.Serialize(m_localAnchorA);
+	stream.Serialize(m_localAnchorB);
+	stream.Serialize(m_maxLength);
+	stream.Serialize(m_length);
+	stream.Serialize(m_impulse);
+	stream.SerializeEnum(m_state);
+}
+
 void b2RopeJoint::Dump()
 {
 	int32 indexA = m_bodyA->m_islandIndex;
@@ -243,3 +253,8 @@ void b2RopeJoint::Dump()
 	b2Log("  jd.maxLength = %.15lef;\n", m_maxLength);
 	b2Log("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+b2JointBatchRegister b2RopeJoint::GetBatchRegister()
+{
+	return CreateBatchRegister<b2RopeJoint>();
+}
@@ -0,0 +1,1150 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "box2d/b2_scene.h"
+#include "box2d/b2_body.h"
+#include "box2d/b2_capsule_shape.h"
+#include "box2d/b2_chain_shape.h"
+#include "box2d/b2_circle_shape.h"
+#include "box2d/b2_compound_shape.h"
+#include "box2d/b2_distance_joint.h"
+#include "box2d/b2_edge_shape.h"
+#include "box2d/b2_fixture.h"
+#include "box2d/b2_friction_joint.h"
+#include "box2d/b2_gear_joint.h"
+#include "box2d/b2_heightfield_shape.h"
+#include "box2d/b2_motor_joint.h"
+#include "box2d/b2_mouse_joint.h"
+#include "box2d/b2_polygon_shape.h"
+#include "box2d/b2_prismatic_joint.h"
+#include "box2d/b2_pulley_joint.h"
+#include "box2d/b2_revolute_joint.h"
+#include "box2d/b2_rope_joint.h"
+#include "box2d/b2_weld_joint.h"
+#include "box2d/b2_wheel_joint.h"
+#include "box2d/b2_world.h"
+
+#include <algorithm>
+#include <new>
+#include <stdint.h>
+#include <string.h>
+
+static const uint32 b2_sceneMagic = 0x4e435342;
+static const uint32 b2_sceneVersion = 2;
+
+// Used to find the index of a body or joint from its pointer while saving.
+struct b2SceneIndex
+{
+	const void* pointer;
+	int32 index;
+};
+
+static inline bool b2SceneIndexLessThan(const b2SceneIndex& a, const b2SceneIndex& b)
+{
+	return a.pointer < b.pointer;
+}
+
+static int32 b2FindSceneIndex(const b2SceneIndex* indices, int32 count, const void* pointer)
+{
+	b2SceneIndex key;
+	key.pointer = pointer;
+	key.index = -1;
+	const b2SceneIndex* it = std::lower_bound(indices, indices + count, key, b2SceneIndexLessThan);
+	if (it == indices + count || it->pointer != pointer)
+	{
+		return -1;
+	}
+	return it->index;
+}
+
+// The number of vertex pool entries used by a shape.
+static int32 b2GetSceneVertexCount(const b2Shape* shape)
+{
+	switch (shape->GetType())
+	{
+	case b2Shape::e_circle:
+		return 1;
+
+	case b2Shape::e_edge:
+		return 4;
+
+	case b2Shape::e_polygon:
+		return 1 + 2 * ((const b2PolygonShape*)shape)->m_count;
+
+	case b2Shape::e_chain:
+		return 2 + ((const b2ChainShape*)shape)->m_count;
+
+	case b2Shape::e_heightfield:
+		return 1 + (((const b2HeightfieldShape*)shape)->m_count + 1) / 2;
+
+	case b2Shape::e_capsule:
+		return 2;
+
+	case b2Shape::e_compound:
+		{
+			const b2CompoundShape* compound = (const b2CompoundShape*)shape;
+			int32 count = 0;
+			for (int32 i = 0; i < compound->m_count; ++i)
+			{
+				const b2Shape* child = compound->GetChild(i);
+				count += child->GetType() == b2Shape::e_polygon ? 2 : 1;
+				count += b2GetSceneVertexCount(child);
+			}
+			return count;
+		}
+
+	default:
+		b2Assert(false);
+		return 0;
+	}
+}
+
+static void b2CountScene(const b2World* world, int32* fixtureCount, int32* vertexCount)
+{
+	*fixtureCount = 0;
+	*vertexCount = 0;
+	for (const b2Body* b = world->GetBodyList(); b; b = b->GetNext())
+	{
+		for (const b2Fixture* f = b->GetFixtureList(); f; f = f->GetNext())
+		{
+			*fixtureCount += 1;
+			*vertexCount += b2GetSceneVertexCount(f->GetShape());
+		}
+	}
+}
+
+int32 b2GetSceneSize(const b2World* world)
+{
+	int32 fixtureCount, vertexCount;
+	b2CountScene(world, &fixtureCount, &vertexCount);
+
+	int32 size = sizeof(b2SceneHeader);
+	size += world->GetBodyCount() * sizeof(b2SceneBody);
+	size += fixtureCount * sizeof(b2SceneFixture);
+	size += world->GetJointCount() * sizeof(b2SceneJoint);
+	size += vertexCount * sizeof(b2Vec2);
+	return size;
+}
+
+static void b2SaveSceneShape(b2SceneFixture* record, b2Vec2* vertices, const b2Shape* shape)
+{
+	record->shapeType = shape->GetType();
+	record->radius = shape->m_radius;
+
+	switch (shape->GetType())
+	{
+	case b2Shape::e_circle:
+		{
+			const b2CircleShape* circle = (const b2CircleShape*)shape;
+			record->vertexCount = 1;
+			vertices[0] = circle->m_p;
+		}
+		break;
+
+	case b2Shape::e_edge:
+		{
+			const b2EdgeShape* edge = (const b2EdgeShape*)shape;
+			record->vertexCount = 4;
+			vertices[0] = edge->m_vertex0;
+			vertices[1] = edge->m_vertex1;
+			vertices[2] = edge->m_vertex2;
+			vertices[3] = edge->m_vertex3;
+			record->flags |= edge->m_hasVertex0 ? b2SceneFixture::e_hasVertex0 : 0;
+			record->flags |= edge->m_hasVertex3 ? b2SceneFixture::e_hasVertex3 : 0;
+		}
+		break;
+
+	case b2Shape::e_polygon:
+		{
+			const b2PolygonShape* poly = (const b2PolygonShape*)shape;
+			int32 count = poly->m_count;
+			record->vertexCount = count;
+			vertices[0] = poly->m_centroid;
+			memcpy(vertices + 1, poly->m_vertices, count * sizeof(b2Vec2));
+			memcpy(vertices + 1 + count, poly->m_normals, count * sizeof(b2Vec2));
+		}
+		break;
+
+	case b2Shape::e_chain:
+		{
+			const b2ChainShape* chain = (const b2ChainShape*)shape;
+			record->vertexCount = chain->m_count;
+			vertices[0] = chain->m_prevVertex;
+			vertices[1] = chain->m_nextVertex;
+			memcpy(vertices + 2, chain->m_vertices, chain->m_count * sizeof(b2Vec2));
+			record->flags |= chain->m_hasPrevVertex ? b2SceneFixture::e_hasVertex0 : 0;
+			record->flags |= chain->m_hasNextVertex ? b2SceneFixture::e_hasVertex3 : 0;
+			record->flags |= chain->HasTree() ? b2SceneFixture::e_chainTree : 0;
+		}
+		break;
+
+	case b2Shape::e_heightfield:
+		{
+			const b2HeightfieldShape* heightfield = (const b2HeightfieldShape*)shape;
+			int32 count = heightfield->m_count;
+			record->vertexCount = count;
+			vertices[0].Set(heightfield->m_spacing, heightfield->m_heightScale);
+			for (int32 i = 0; i < count; i += 2)
+			{
+				float h2 = i + 1 < count ? float(heightfield->m_heights[i + 1]) : 0.0f;
+				vertices[1 + i / 2].Set(float(heightfield->m_heights[i]), h2);
+			}
+		}
+		break;
+
+	case b2Shape::e_capsule:
+		{
+			const b2CapsuleShape* capsule = (const b2CapsuleShape*)shape;
+			record->vertexCount = 2;
+			vertices[0] = capsule->m_vertex1;
+			vertices[1] = capsule->m_vertex2;
+		}
+		break;
+
+	case b2Shape::e_compound:
+		{
+			const b2CompoundShape* compound = (const b2CompoundShape*)shape;
+			record->vertexCount = compound->m_count;
+			b2Vec2* v = vertices;
+			for (int32 i = 0; i < compound->m_count; ++i)
+			{
+				const b2Shape* child = compound->GetChild(i);
+				*v++ = b2Vec2(float(child->GetType()), child->m_radius);
+				if (child->GetType() == b2Shape::e_polygon)
+				{
+					*v++ = b2Vec2(float(((const b2PolygonShape*)child)->m_count), 0.0f);
+				}
+
+				b2SceneFixture childRecord;
+				b2SaveSceneShape(&childRecord, v, child);
+				v += b2GetSceneVertexCount(child);
+			}
+		}
+		break;
+
+	default:
+		b2Assert(false);
+		break;
+	}
+}
+
+static void b2SaveSceneJoint(b2SceneJoint* record, const b2Joint* joint,
+	const b2SceneIndex* bodyIndices, int32 bodyCount, const b2SceneIndex* jointIndices, int32 jointCount)
+{
+	// The joint getters are not const.
+	b2Joint* j = const_cast<b2Joint*>(joint);
+
+	*record = b2SceneJoint();
+	record->type = j->GetType();
+	record->bodyA = b2FindSceneIndex(bodyIndices, bodyCount, j->GetBodyA());
+	record->bodyB = b2FindSceneIndex(bodyIndices, bodyCount, j->GetBodyB());
+	record->jointA = -1;
+	record->jointB = -1;
+	record->flags = j->GetCollideConnected() ? b2SceneJoint::e_collideConnected : 0;
+
+	switch (j->GetType())
+	{
+	case e_distanceJoint:
+		{
+			b2DistanceJoint* dj = (b2DistanceJoint*)j;
+			record->localAnchorA = dj->GetLocalAnchorA();
+			record->localAnchorB = dj->GetLocalAnchorB();
+			record->lower = dj->GetLength();
+			record->frequencyHz = dj->GetFrequency();
+			record->dampingRatio = dj->GetDampingRatio();
+		}
+		break;
+
+	case e_frictionJoint:
+		{
+			b2FrictionJoint* fj = (b2FrictionJoint*)j;
+			record->localAnchorA = fj->GetLocalAnchorA();
+			record->localAnchorB = fj->GetLocalAnchorB();
+			record->maxMotorForce = fj->GetMaxForce();
+			record->maxTorque = fj->GetMaxTorque();
+		}
+		break;
+
+	case e_gearJoint:
+		{
+			b2GearJoint* gj = (b2GearJoint*)j;
+			record->jointA = b2FindSceneIndex(jointIndices, jointCount, gj->GetJoint1());
+			record->jointB = b2FindSceneIndex(jointIndices, jointCount, gj->GetJoint2());
+			record->ratio = gj->GetRatio();
+		}
+		break;
+
+	case e_motorJoint:
+		{
+			b2MotorJoint* mj = (b2MotorJoint*)j;
+			record->axis = mj->GetLinearOffset();
+			record->referenceAngle = mj->GetAngularOffset();
+			record->maxMotorForce = mj->GetMaxForce();
+			record->maxTorque = mj->GetMaxTorque();
+			record->ratio = mj->GetCorrectionFactor();
+		}
+		break;
+
+	case e_mouseJoint:
+		{
+			b2MouseJoint* mj = (b2MouseJoint*)j;
+			record->localAnchorB = mj->GetLocalAnchorB();
+			record->axis = mj->GetTarget();
+			record->maxMotorForce = mj->GetMaxForce();
+			record->frequencyHz = mj->GetFrequency();
+			record->dampingRatio = mj->GetDampingRatio();
+		}
+		break;
+
+	case e_prismaticJoint:
+		{
+			b2PrismaticJoint* pj = (b2PrismaticJoint*)j;
+			record->localAnchorA = pj->GetLocalAnchorA();
+			record->localAnchorB = pj->GetLocalAnchorB();
+			record->axis = pj->GetLocalAxisA();
+			record->referenceAngle = pj->GetReferenceAngle();
+			record->lower = pj->GetLowerLimit();
+			record->upper = pj->GetUpperLimit();
+			record->motorSpeed = pj->GetMotorSpeed();
+			record->maxMotorForce = pj->GetMaxMotorForce();
+			record->flags |= pj->IsLimitEnabled() ? b2SceneJoint::e_enableLimit : 0;
+			record->flags |= pj->IsMotorEnabled() ? b2SceneJoint::e_enableMotor : 0;
+		}
+		break;
+
+	case e_pulleyJoint:
+		{
+			b2PulleyJoint* pj = (b2PulleyJoint*)j;
+			record->localAnchorA = pj->GetBodyA()->GetLocalPoint(pj->GetAnchorA());
+			record->localAnchorB = pj->GetBodyB()->GetLocalPoint(pj->GetAnchorB());
+			record->groundAnchorA = pj->GetGroundAnchorA();
+			record->groundAnchorB = pj->GetGroundAnchorB();
+			record->lower = pj->GetLengthA();
+			record->upper = pj->GetLengthB();
+			record->ratio = pj->GetRatio();
+		}
+		break;
+
+	case e_revoluteJoint:
+		{
+			b2RevoluteJoint* rj = (b2RevoluteJoint*)j;
+			record->localAnchorA = rj->GetLocalAnchorA();
+			record->localAnchorB = rj->GetLocalAnchorB();
+			record->referenceAngle = rj->GetReferenceAngle();
+			record->lower = rj->GetLowerLimit();
+			record->upper = rj->GetUpperLimit();
+			record->motorSpeed = rj->GetMotorSpeed();
+			record->maxMotorForce = rj->GetMaxMotorTorque();
+			record->flags |= rj->IsLimitEnabled() ? b2SceneJoint::e_enableLimit : 0;
+			record->flags |= rj->IsMotorEnabled() ? b2SceneJoint::e_enableMotor : 0;
+		}
+		break;
+
+	case e_ropeJoint:
+		{
+			b2RopeJoint* rj = (b2RopeJoint*)j;
+			record->localAnchorA = rj->GetLocalAnchorA();
+			record->localAnchorB = rj->GetLocalAnchorB();
+			record->upper = rj->GetMaxLength();
+		}
+		break;
+
+	case e_weldJoint:
+		{
+			b2WeldJoint* wj = (b2WeldJoint*)j;
+			record->localAnchorA = wj->GetLocalAnchorA();
+			record->localAnchorB = wj->GetLocalAnchorB();
+			record->referenceAngle = wj->GetReferenceAngle();
+			record->frequencyHz = wj->GetFrequency();
+			record->dampingRatio = wj->GetDampingRatio();
+		}
+		break;
+
+	case e_wheelJoint:
+		{
+			b2WheelJoint* wj = (b2WheelJoint*)j;
+			record->localAnchorA = wj->GetLocalAnchorA();
+			record->localAnchorB = wj->GetLocalAnchorB();
+			record->axis = wj->GetLocalAxisA();
+			record->motorSpeed = wj->GetMotorSpeed();
+			record->maxMotorForce = wj->GetMaxMotorTorque();
+			record->frequencyHz = wj->GetSpringFrequencyHz();
+			record->dampingRatio = wj->GetSpringDampingRatio();
+			record->flags |= wj->IsMotorEnabled() ? b2SceneJoint::e_enableMotor : 0;
+		}
+		break;
+
+	default:
+		b2Assert(false);
+		break;
+	}
+}
+
+int32 b2SaveScene(const b2World* world, void* buffer, int32 capacity)
+{
+	int32 size = b2GetSceneSize(world);
+	if (size > capacity)
+	{
+		return 0;
+	}
+
+	int32 bodyCount = world->GetBodyCount();
+	int32 jointCount = world->GetJointCount();
+	int32 fixtureCount, vertexCount;
+	b2CountScene(world, &fixtureCount, &vertexCount);
+
+	char* data = (char*)buffer;
+	b2SceneHeader* header = (b2SceneHeader*)data;
+	header->magic = b2_sceneMagic;
+	header->version = b2_sceneVersion;
+	header->size = size;
+	header->gravity = world->GetGravity();
+	header->bodyCount = bodyCount;
+	header->bodyOffset = sizeof(b2SceneHeader);
+	header->fixtureCount = fixtureCount;
+	header->fixtureOffset = header->bodyOffset + bodyCount * sizeof(b2SceneBody);
+	header->jointCount = jointCount;
+	header->jointOffset = header->fixtureOffset + fixtureCount * sizeof(b2SceneFixture);
+	header->vertexCount = vertexCount;
+	header->vertexOffset = header->jointOffset + jointCount * sizeof(b2SceneJoint);
+
+	b2SceneBody* bodies = (b2SceneBody*)(data + header->bodyOffset);
+	b2SceneFixture* fixtures = (b2SceneFixture*)(data + header->fixtureOffset);
+	b2SceneJoint* joints = (b2SceneJoint*)(data + header->jointOffset);
+	b2Vec2* vertices = (b2Vec2*)(data + header->vertexOffset);
+
+	b2SceneIndex* bodyIndices = (b2SceneIndex*)b2Alloc((bodyCount + jointCount) * sizeof(b2SceneIndex));
+	b2SceneIndex* jointIndices = bodyIndices + bodyCount;
+
+	int32 bodyIndex = 0;
+	int32 fixtureIndex = 0;
+	int32 vertexIndex = 0;
+	for (const b2Body* b = world->GetBodyList(); b; b = b->GetNext())
+	{
+		b2SceneBody* record = bodies + bodyIndex;
+		record->type = b->GetType();
+		record->flags = 0;
+		record->flags |= b->IsSleepingAllowed() ? b2SceneBody::e_allowSleep : 0;
+		record->flags |= b->IsAwake() ? b2SceneBody::e_awake : 0;
+		record->flags |= b->IsFixedRotation() ? b2SceneBody::e_fixedRotation : 0;
+		record->flags |= b->IsBullet() ? b2SceneBody::e_bullet : 0;
+		record->flags |= b->IsActive() ? b2SceneBody::e_active : 0;
+		record->position = b->GetPosition();
+		record->angle = b->GetAngle();
+		record->linearVelocity = b->GetLinearVelocity();
+		record->angularVelocity = b->GetAngularVelocity();
+		record->linearDamping = b->GetLinearDamping();
+		record->angularDamping = b->GetAngularDamping();
+		record->gravityScale = b->GetGravityScale();
+		record->sleepThreshold = b->GetSleepThreshold();
+		record->fixtureIndex = fixtureIndex;
+		record->fixtureCount = 0;
+
+		for (const b2Fixture* f = b->GetFixtureList(); f; f = f->GetNext())
+		{
+			b2SceneFixture* fixture = fixtures + fixtureIndex;
+			const b2Filter& filter = f->GetFilterData();
+			fixture->vertexIndex = vertexIndex;
+			fixture->friction = f->GetFriction();
+			fixture->restitution = f->GetRestitution();
+			fixture->density = f->GetDensity();
+			fixture->categoryBits = filter.categoryBits;
+			fixture->maskBits = filter.maskBits;
+			fixture->groupIndex = filter.groupIndex;
+			fixture->flags = f->IsSensor() ? b2SceneFixture::e_sensor : 0;
+			b2SaveSceneShape(fixture, vertices + vertexIndex, f->GetShape());
+
+			vertexIndex += b2GetSceneVertexCount(f->GetShape());
+			++fixtureIndex;
+			++record->fixtureCount;
+		}
+
+		bodyIndices[bodyIndex].pointer = b;
+		bodyIndices[bodyIndex].index = bodyIndex;
+		++bodyIndex;
+	}
+
+	int32 jointIndex = 0;
+	for (const b2Joint* j = world->GetJointList(); j; j = j->GetNext())
+	{
+		jointIndices[jointIndex].pointer = j;
+		jointIndices[jointIndex].index = jointIndex;
+		++jointIndex;
+	}
+
+	std::sort(bodyIndices, bodyIndices + bodyCount, b2SceneIndexLessThan);
+	std::sort(jointIndices, jointIndices + jointCount, b2SceneIndexLessThan);
+
+	jointIndex = 0;
+	for (const b2Joint* j = world->GetJointList(); j; j = j->GetNext())
+	{
+		b2SaveSceneJoint(joints + jointIndex, j, bodyIndices, bodyCount, jointIndices, jointCount);
+		++jointIndex;
+	}
+
+	b2Free(bodyIndices);
+
+	return size;
+}
+
+static bool b2IsValidSection(const b2SceneHeader* header, int32 offset, int32 count, int32 recordSize)
+{
+	if (count < 0 || offset < (int32)sizeof(b2SceneHeader) || (offset & 3) != 0)
+	{
+		return false;
+	}
+
+	return count <= (header->size - offset) / recordSize;
+}
+
+const b2SceneHeader* b2GetSceneHeader(const void* buffer, int32 size)
+{
+	if (buffer == nullptr || ((uintptr_t)buffer & 3) != 0 || size < (int32)sizeof(b2SceneHeader))
+	{
+		return nullptr;
+	}
+
+	const b2SceneHeader* header = (const b2SceneHeader*)buffer;
+	if (header->magic != b2_sceneMagic || header->version != b2_sceneVersion || header->size > size)
+	{
+		return nullptr;
+	}
+
+	if (b2IsValidSection(header, header->bodyOffset, header->bodyCount, sizeof(b2SceneBody)) == false ||
+		b2IsValidSection(header, header->fixtureOffset, header->fixtureCount, sizeof(b2SceneFixture)) == false ||
+		b2IsValidSection(header, header->jointOffset, header->jointCount, sizeof(b2SceneJoint)) == false ||
+		b2IsValidSection(header, header->vertexOffset, header->vertexCount, sizeof(b2Vec2)) == false)
+	{
+		return nullptr;
+	}
+
+	return header;
+}
+
+// The number of vertex pool entries used by the children of a compound record or -1 if the
+// children are not valid.
+static int32 b2GetSceneCompoundSize(const b2SceneFixture* fixture, const b2Vec2* vertices, int32 vertexCount)
+{
+	int32 index = fixture->vertexIndex;
+	if (fixture->vertexCount < 1 || index < 0)
+	{
+		return -1;
+	}
+
+	for (int32 i = 0; i < fixture->vertexCount; ++i)
+	{
+		if (index >= vertexCount)
+		{
+			return -1;
+		}
+
+		switch (int32(vertices[index].x))
+		{
+		case b2Shape::e_circle:
+			index += 2;
+			break;
+
+		case b2Shape::e_capsule:
+			index += 3;
+			break;
+
+		case b2Shape::e_polygon:
+			{
+				if (index + 1 >= vertexCount)
+				{
+					return -1;
+				}
+
+				int32 count = int32(vertices[index + 1].x);
+				if (count < 3 || count > b2_maxPolygonVertices)
+				{
+					return -1;
+				}
+				index += 3 + 2 * count;
+			}
+			break;
+
+		default:
+			return -1;
+		}
+	}
+
+	return index - fixture->vertexIndex;
+}
+
+static bool b2IsValidSceneFixture(const b2SceneFixture* fixture, const b2Vec2* vertices, int32 vertexCount)
+{
+	int32 count = fixture->vertexCount;
+	int32 required;
+	switch (fixture->shapeType)
+	{
+	case b2Shape::e_circle:
+		required = 1;
+		break;
+
+	case b2Shape::e_edge:
+		required = 4;
+		break;
+
+	case b2Shape::e_polygon:
+		if (count < 3 || count > b2_maxPolygonVertices)
+		{
+			return false;
+		}
+		required = 1 + 2 * count;
+		break;
+
+	case b2Shape::e_chain:
+		if (count < 2)
+		{
+			return false;
+		}
+		required = 2 + count;
+		break;
+
+	case b2Shape::e_heightfield:
+		if (count < 2)
+		{
+			return false;
+		}
+		required = 1 + (count + 1) / 2;
+		break;
+
+	case b2Shape::e_capsule:
+		required = 2;
+		break;
+
+	case b2Shape::e_compound:
+		required = b2GetSceneCompoundSize(fixture, vertices, vertexCount);
+		if (required < 0)
+		{
+			return false;
+		}
+		break;
+
+	default:
+		return false;
+	}
+
+	return 0 <= fixture->vertexIndex && fixture->vertexIndex <= vertexCount - required;
+}
+
+static bool b2IsValidScene(const b2SceneHeader* header)
+{
+	const char* data = (const char*)header;
+	const b2SceneBody* bodies = (const b2SceneBody*)(data + header->bodyOffset);
+	const b2SceneFixture* fixtures = (const b2SceneFixture*)(data + header->fixtureOffset);
+	const b2SceneJoint* joints = (const b2SceneJoint*)(data + header->jointOffset);
+	const b2Vec2* vertices = (const b2Vec2*)(data + header->vertexOffset);
+
+	for (int32 i = 0; i < header->bodyCount; ++i)
+	{
+		const b2SceneBody* body = bodies + i;
+		if (body->type < b2_staticBody || body->type > b2_dynamicBody ||
+			body->fixtureIndex < 0 || body->fixtureCount < 0 ||
+			body->fixtureCount > header->fixtureCount - body->fixtureIndex)
+		{
+			return false;
+		}
+	}
+
+	for (int32 i = 0; i < header->fixtureCount; ++i)
+	{
+		if (b2IsValidSceneFixture(fixtures + i, vertices, header->vertexCount) == false)
+		{
+			return false;
+		}
+	}
+
+	for (int32 i = 0; i < header->jointCount; ++i)
+	{
+		const b2SceneJoint* joint = joints + i;
+		if (joint->type <= e_unknownJoint || joint->type > e_motorJoint ||
+			joint->bodyA < 0 || joint->bodyA >= header->bodyCount ||
+			joint->bodyB < 0 || joint->bodyB >= header->bodyCount ||
+			joint->bodyA == joint->bodyB)
+		{
+			return false;
+		}
+
+		if (joint->type == e_gearJoint)
+		{
+			// Joints are created in reverse order, so gear joints must refer to later records.
+			if (joint->jointA <= i || joint->jointA >= header->jointCount ||
+				joint->jointB <= i || joint->jointB >= header->jointCount)
+			{
+				return false;
+			}
+
+			int32 typeA = joints[joint->jointA].type;
+			int32 typeB = joints[joint->jointB].type;
+			if ((typeA != e_revoluteJoint && typeA != e_prismaticJoint) ||
+				(typeB != e_revoluteJoint && typeB != e_prismaticJoint))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static b2Fixture* b2LoadSceneFixture(b2Body* body, const b2SceneFixture* record, const b2Vec2* vertices)
+{
+	b2FixtureDef fd;
+	fd.friction = record->friction;
+	fd.restitution = record->restitution;
+	fd.isSensor = (record->flags & b2SceneFixture::e_sensor) != 0;
+	fd.filter.categoryBits = record->categoryBits;
+	fd.filter.maskBits = record->maskBits;
+	fd.filter.groupIndex = record->groupIndex;
+
+	// The body mass is computed once all fixtures are added.
+	fd.density = 0.0f;
+
+	const b2Vec2* v = vertices + record->vertexIndex;
+	b2Fixture* fixture = nullptr;
+
+	switch (record->shapeType)
+	{
+	case b2Shape::e_circle:
+		{
+			b2CircleShape circle;
+			circle.m_radius = record->radius;
+			circle.m_p = v[0];
+			fd.shape = &circle;
+			fixture = body->CreateFixture(&fd);
+		}
+		break;
+
+	case b2Shape::e_edge:
+		{
+			b2EdgeShape edge;
+			edge.m_radius = record->radius;
+			edge.m_vertex0 = v[0];
+			edge.m_vertex1 = v[1];
+			edge.m_vertex2 = v[2];
+			edge.m_vertex3 = v[3];
+			edge.m_hasVertex0 = (record->flags & b2SceneFixture::e_hasVertex0) != 0;
+			edge.m_hasVertex3 = (record->flags & b2SceneFixture::e_hasVertex3) != 0;
+			fd.shape = &edge;
+			fixture = body->CreateFixture(&fd);
+		}
+		break;
+
+	case b2Shape::e_polygon:
+		{
+			// The saved polygon is already a convex hull.
+			int32 count = record->vertexCount;
+			b2PolygonShape poly;
+			poly.m_radius = record->radius;
+			poly.m_count = count;
+			poly.m_centroid = v[0];
+			memcpy(poly.m_vertices, v + 1, count * sizeof(b2Vec2));
+			memcpy(poly.m_normals, v + 1 + count, count * sizeof(b2Vec2));
+			fd.shape = &poly;
+			fixture = body->CreateFixture(&fd);
+		}
+		break;
+
+	case b2Shape::e_chain:
+		{
+			b2ChainShape chain;
+			chain.CreateChain(v + 2, record->vertexCount);
+			chain.m_radius = record->radius;
+			if (record->flags & b2SceneFixture::e_hasVertex0)
+			{
+				chain.SetPrevVertex(v[0]);
+			}
+			if (record->flags & b2SceneFixture::e_hasVertex3)
+			{
+				chain.SetNextVertex(v[1]);
+			}
+			if (record->flags & b2SceneFixture::e_chainTree)
+			{
+				chain.CreateTree();
+			}
+			fd.shape = &chain;
+			fixture = body->CreateFixture(&fd);
+		}
+		break;
+
+	case b2Shape::e_heightfield:
+		{
+			int32 count = record->vertexCount;
+			int16* heights = (int16*)b2Alloc(count * sizeof(int16));
+			for (int32 i = 0; i < count; ++i)
+			{
+				const b2Vec2& pair = v[1 + i / 2];
+				heights[i] = int16(i % 2 == 0 ? pair.x : pair.y);
+			}
+
+			b2HeightfieldShape heightfield;
+			heightfield.Create(heights, count, v[0].x, v[0].y);
+			heightfield.m_radius = record->radius;
+			b2Free(heights);
+			fd.shape = &heightfield;
+			fixture = body->CreateFixture(&fd);
+		}
+		break;
+
+	case b2Shape::e_capsule:
+		{
+			b2CapsuleShape capsule;
+			capsule.m_radius = record->radius;
+			capsule.m_vertex1 = v[0];
+			capsule.m_vertex2 = v[1];
+			fd.shape = &capsule;
+			fixture = body->CreateFixture(&fd);
+		}
+		break;
+
+	case b2Shape::e_compound:
+		{
+			// The children are read into fixed storage for each type, then copied by Create.
+			int32 count = record->vertexCount;
+			b2CircleShape* circles = (b2CircleShape*)b2Alloc(count * sizeof(b2CircleShape));
+			b2PolygonShape* polygons = (b2PolygonShape*)b2Alloc(count * sizeof(b2PolygonShape));
+			b2CapsuleShape* capsules = (b2CapsuleShape*)b2Alloc(count * sizeof(b2CapsuleShape));
+			const b2Shape** children = (const b2Shape**)b2Alloc(count * sizeof(b2Shape*));
+
+			const b2Vec2* cv = v;
+			for (int32 i = 0; i < count; ++i)
+			{
+				int32 type = int32(cv[0].x);
+				float radius = cv[0].y;
+				if (type == b2Shape::e_circle)
+				{
+					b2CircleShape* circle = new (circles + i) b2CircleShape;
+					circle->m_radius = radius;
+					circle->m_p = cv[1];
+					children[i] = circle;
+					cv += 2;
+				}
+				else if (type == b2Shape::e_capsule)
+				{
+					b2CapsuleShape* capsule = new (capsules + i) b2CapsuleShape;
+					capsule->m_radius = radius;
+					capsule->m_vertex1 = cv[1];
+					capsule->m_vertex2 = cv[2];
+					children[i] = capsule;
+					cv += 3;
+				}
+				else
+				{
+					int32 polygonCount = int32(cv[1].x);
+					b2PolygonShape* poly = new (polygons + i) b2PolygonShape;
+					poly->m_radius = radius;
+					poly->m_count = polygonCount;
+					poly->m_centroid = cv[2];
+					memcpy(poly->m_vertices, cv + 3, polygonCount * sizeof(b2Vec2));
+					memcpy(poly->m_normals, cv + 3 + polygonCount, polygonCount * sizeof(b2Vec2));
+					children[i] = poly;
+					cv += 3 + 2 * polygonCount;
+				}
+			}
+
+			b2CompoundShape compound;
+			compound.Create(children, count);
+			fd.shape = &compound;
+			fixture = body->CreateFixture(&fd);
+
+			b2Free(children);
+			b2Free(capsules);
+			b2Free(polygons);
+			b2Free(circles);
+		}
+		break;
+
+	default:
+		b2Assert(false);
+		break;
+	}
+
+	fixture->SetDensity(record->density);
+	return fixture;
+}
+
+static b2Joint* b2LoadSceneJoint(b2World* world, const b2SceneJoint* record, b2Body** bodies, b2Joint** joints)
+{
+	b2Body* bodyA = bodies[record->bodyA];
+	b2Body* bodyB = bodies[record->bodyB];
+	bool collideConnected = (record->flags & b2SceneJoint::e_collideConnected) != 0;
+	bool enableLimit = (record->flags & b2SceneJoint::e_enableLimit) != 0;
+	bool enableMotor = (record->flags & b2SceneJoint::e_enableMotor) != 0;
+
+	switch (record->type)
+	{
+	case e_distanceJoint:
+		{
+			b2DistanceJointDef jd;
+			jd.bodyA = bodyA;
+			jd.bodyB = bodyB;
+			jd.collideConnected = collideConnected;
+			jd.localAnchorA = record->localAnchorA;
+			jd.localAnchorB = record->localAnchorB;
+			jd.length = record->lower;
+			jd.frequencyHz = record->frequencyHz;
+			jd.dampingRatio = record->dampingRatio;
+			return world->CreateJoint(&jd);
+		}
+
+	case e_frictionJoint:
+		{
+			b2FrictionJointDef jd;
+			jd.bodyA = bodyA;
+			jd.bodyB = bodyB;
+			jd.collideConnected = collideConnected;
+			jd.localAnchorA = record->localAnchorA;
+			jd.localAnchorB = record->localAnchorB;
+			jd.maxForce = record->maxMotorForce;
+			jd.maxTorque = record->maxTorque;
+			return world->CreateJoint(&jd);
+		}
+
+	case e_gearJoint:
+		{
+			b2GearJointDef jd;
+			jd.bodyA = bodyA;
+			jd.bodyB = bodyB;
+			jd.collideConnected = collideConnected;
+			jd.joint1 = joints[record->jointA];
+			jd.joint2 = joints[record->jointB];
+			jd.ratio = record->ratio;
+			return world->CreateJoint(&jd);
+		}
+
+	case e_motorJoint:
+		{
+			b2MotorJointDef jd;
+			jd.bodyA = bodyA;
+			jd.bodyB = bodyB;
+			jd.collideConnected = collideConnected;
+			jd.linearOffset = record->axis;
+			jd.angularOffset = record->referenceAngle;
+			jd.maxForce = record->maxMotorForce;
+			jd.maxTorque = record->maxTorque;
+			jd.correctionFactor = record->ratio;
+			return world->CreateJoint(&jd);
+		}
+
+	case e_mouseJoint:
+		{
+			// The definition places the anchor under the target, so the joint is created at
+			// the saved anchor and then moved to the saved target.
+			b2MouseJointDef jd;
+			jd.bodyA = bodyA;
+			jd.bodyB = bodyB;
+			jd.collideConnected = collideConnected;
+			jd.target = b2Mul(bodyB->GetTransform(), record->localAnchorB);
+			jd.maxForce = record->maxMotorForce;
+			jd.frequencyHz = record->frequencyHz;
+			jd.dampingRatio = record->dampingRatio;
+			b2MouseJoint* joint = (b2MouseJoint*)world->CreateJoint(&jd);
+			joint->SetTarget(record->axis);
+			return joint;
+		}
+
+	case e_prismaticJoint:
+		{
+			b2PrismaticJointDef jd;
+			jd.bodyA = bodyA;
+			jd.bodyB = bodyB;
+			jd.collideConnected = collideConnected;
+			jd.localAnchorA = record->localAnchorA;
+			jd.localAnchorB = record->localAnchorB;
+			jd.localAxisA = record->axis;
+			jd.referenceAngle = record->referenceAngle;
+			jd.enableLimit = enableLimit;
+			jd.lowerTranslation = record->lower;
+			jd.upperTranslation = record->upper;
+			jd.enableMotor = enableMotor;
+			jd.motorSpeed = record->motorSpeed;
+			jd.maxMotorForce = record->maxMotorForce;
+			return world->CreateJoint(&jd);
+		}
+
+	case e_pulleyJoint:
+		{
+			b2PulleyJointDef jd;
+			jd.bodyA = bodyA;
+			jd.bodyB = bodyB;
+			jd.collideConnected = collideConnected;
+			jd.groundAnchorA = record->groundAnchorA;
+			jd.groundAnchorB = record->groundAnchorB;
+			jd.localAnchorA = record->localAnchorA;
+			jd.localAnchorB = record->localAnchorB;
+			jd.lengthA = record->lower;
+			jd.lengthB = record->upper;
+			jd.ratio = record->ratio;
+			return world->CreateJoint(&jd);
+		}
+
+	case e_revoluteJoint:
+		{
+			b2RevoluteJointDef jd;
+			jd.bodyA = bodyA;
+			jd.bodyB = bodyB;
+			jd.collideConnected = collideConnected;
+			jd.localAnchorA = record->localAnchorA;
+			jd.localAnchorB = record->localAnchorB;
+			jd.referenceAngle = record->referenceAngle;
+			jd.enableLimit = enableLimit;
+			jd.lowerAngle = record->lower;
+			jd.upperAngle = record->upper;
+			jd.enableMotor = enableMotor;
+			jd.motorSpeed = record->motorSpeed;
+			jd.maxMotorTorque = record->maxMotorForce;
+			return world->CreateJoint(&jd);
+		}
+
+	case e_ropeJoint:
+		{
+			b2RopeJointDef jd;
+			jd.bodyA = bodyA;
+			jd.bodyB = bodyB;
+			jd.collideConnected = collideConnected;
+			jd.localAnchorA = record->localAnchorA;
+			jd.localAnchorB = record->localAnchorB;
+			jd.maxLength = record->upper;
+			return world->CreateJoint(&jd);
+		}
+
+	case e_weldJoint:
+		{
+			b2WeldJointDef jd;
+			jd.bodyA = bodyA;
+			jd.bodyB = bodyB;
+			jd.collideConnected = collideConnected;
+			jd.localAnchorA = record->localAnchorA;
+			jd.localAnchorB = record->localAnchorB;
+			jd.referenceAngle = record->referenceAngle;
+			jd.frequencyHz = record->frequencyHz;
+			jd.dampingRatio = record->dampingRatio;
+			return world->CreateJoint(&jd);
+		}
+
+	case e_wheelJoint:
+		{
+			b2WheelJointDef jd;
+			jd.bodyA = bodyA;
+			jd.bodyB = bodyB;
+			jd.collideConnected = collideConnected;
+			jd.localAnchorA = record->localAnchorA;
+			jd.localAnchorB = record->localAnchorB;
+			jd.localAxisA = record->axis;
+			jd.enableMotor = enableMotor;
+			jd.motorSpeed = record->motorSpeed;
+			jd.maxMotorTorque = record->maxMotorForce;
+			jd.frequencyHz = record->frequencyHz;
+			jd.dampingRatio = record->dampingRatio;
+			return world->CreateJoint(&jd);
+		}
+
+	default:
+		b2Assert(false);
+		return nullptr;
+	}
+}
+
+bool b2LoadScene(b2World* world, const void* buffer, int32 size, b2Body** bodies, b2Joint** joints)
+{
+	b2Assert(world->IsLocked() == false);
+	if (world->IsLocked())
+	{
+		return false;
+	}
+
+	const b2SceneHeader* header = b2GetSceneHeader(buffer, size);
+	if (header == nullptr || b2IsValidScene(header) == false)
+	{
+		return false;
+	}
+
+	const char* data = (const char*)buffer;
+	const b2SceneBody* bodyRecords = (const b2SceneBody*)(data + header->bodyOffset);
+	const b2SceneFixture* fixtureRecords = (const b2SceneFixture*)(data + header->fixtureOffset);
+	const b2SceneJoint* jointRecords = (const b2SceneJoint*)(data + header->jointOffset);
+	const b2Vec2* vertices = (const b2Vec2*)(data + header->vertexOffset);
+
+	int32 bodyCount = header->bodyCount;
+	int32 jointCount = header->jointCount;
+
+	// Gear joints need the joint array even if the caller does not.
+	void* mem = nullptr;
+	b2Body** bodyArray = bodies;
+	b2Joint** jointArray = joints;
+	if (bodyArray == nullptr || jointArray == nullptr)
+	{
+		mem = b2Alloc((bodyCount + jointCount) * sizeof(void*));
+		bodyArray = bodies ? bodies : (b2Body**)mem;
+		jointArray = joints ? joints : (b2Joint**)mem + bodyCount;
+	}
+
+	world->SetGravity(header->gravity);
+
+	// Objects are pushed onto the head of the world lists, so they are created
+	// in reverse to keep the saved order.
+	for (int32 i = bodyCount - 1; i >= 0; --i)
+	{
+		const b2SceneBody* record = bodyRecords + i;
+
+		b2BodyDef bd;
+		bd.type = b2BodyType(record->type);
+		bd.position = record->position;
+		bd.angle = record->angle;
+		bd.linearVelocity = record->linearVelocity;
+		bd.angularVelocity = record->angularVelocity;
+		bd.linearDamping = record->linearDamping;
+		bd.angularDamping = record->angularDamping;
+		bd.gravityScale = record->gravityScale;
+		bd.sleepThreshold = record->sleepThreshold;
+		bd.allowSleep = (record->flags & b2SceneBody::e_allowSleep) != 0;
+		bd.awake = (record->flags & b2SceneBody::e_awake) != 0;
+		bd.fixedRotation = (record->flags & b2SceneBody::e_fixedRotation) != 0;
+		bd.bullet = (record->flags & b2SceneBody::e_bullet) != 0;
+		bd.active = (record->flags & b2SceneBody::e_active) != 0;
+
+		b2Body* body = world->CreateBody(&bd);
+		bodyArray[i] = body;
+
+		for (int32 j = record->fixtureCount - 1; j >= 0; --j)
+		{
+			b2LoadSceneFixture(body, fixtureRecords + record->fixtureIndex + j, vertices);
+		}
+
+		body->ResetMassData();
+	}
+
+	for (int32 i = jointCount - 1; i >= 0; --i)
+	{
+		jointArray[i] = b2LoadSceneJoint(world, jointRecords + i, bodyArray, jointArray);
+	}
+
+	if (mem)
+	{
+		b2Free(mem);
+	}
+
+	return true;
+}
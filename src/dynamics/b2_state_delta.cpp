@@ -0,0 +1,498 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "box2d/b2_state_delta.h"
+#include "box2d/b2_body.h"
+#include "box2d/b2_world.h"
+
+#include <string.h>
+
+// Frame layout:
+// uint8 frame type, varint sequence, varint body count
+// per changed body: varint index gap + 1, uint8 change mask, zigzag varint deltas
+// varint 0 terminates the frame
+enum
+{
+	e_deltaFrame = 0,
+	e_fullFrame = 1
+};
+
+// Change mask
+enum
+{
+	e_positionChanged = 0x01,
+	e_angleChanged = 0x02,
+	e_linearVelocityChanged = 0x04,
+	e_angularVelocityChanged = 0x08,
+	e_awakeChanged = 0x10,
+	e_awakeValue = 0x20
+};
+
+static inline int32 b2Quantize(float value, float precision)
+{
+	return int32(floorf(value / precision + 0.5f));
+}
+
+static void b2QuantizeBody(b2QuantizedBodyState* state, const b2Body* body, const b2StateDeltaPrecision& precision)
+{
+	b2Vec2 p = body->GetPosition();
+	state->x = b2Quantize(p.x, precision.position);
+	state->y = b2Quantize(p.y, precision.position);
+	state->angle = b2Quantize(body->GetAngle(), precision.angle);
+
+	state->awake = body->IsAwake();
+	if (state->awake)
+	{
+		b2Vec2 v = body->GetLinearVelocity();
+		state->vx = b2Quantize(v.x, precision.linearVelocity);
+		state->vy = b2Quantize(v.y, precision.linearVelocity);
+		state->w = b2Quantize(body->GetAngularVelocity(), precision.angularVelocity);
+	}
+	else
+	{
+		// Sleeping bodies have no velocity.
+		state->vx = 0;
+		state->vy = 0;
+		state->w = 0;
+	}
+}
+
+static uint8 b2ComputeChangeMask(const b2QuantizedBodyState& a, const b2QuantizedBodyState& b)
+{
+	uint8 mask = 0;
+	if (a.x != b.x || a.y != b.y)
+	{
+		mask |= e_positionChanged;
+	}
+
+	if (a.angle != b.angle)
+	{
+		mask |= e_angleChanged;
+	}
+
+	if (a.vx != b.vx || a.vy != b.vy)
+	{
+		mask |= e_linearVelocityChanged;
+	}
+
+	if (a.w != b.w)
+	{
+		mask |= e_angularVelocityChanged;
+	}
+
+	if (a.awake != b.awake)
+	{
+		mask |= e_awakeChanged;
+	}
+
+	if (b.awake)
+	{
+		mask |= e_awakeValue;
+	}
+
+	return mask;
+}
+
+struct b2DeltaWriter
+{
+	void WriteByte(uint8 value)
+	{
+		if (count < capacity)
+		{
+			data[count] = value;
+		}
+		++count;
+	}
+
+	void WriteVarint(uint32 value)
+	{
+		while (value >= 0x80)
+		{
+			WriteByte(uint8(value | 0x80));
+			value >>= 7;
+		}
+		WriteByte(uint8(value));
+	}
+
+	void WriteDelta(int32 value, int32 baseline)
+	{
+		// Zigzag encoding keeps small negative deltas small.
+		int32 delta = int32(uint32(value) - uint32(baseline));
+		WriteVarint((uint32(delta) << 1) ^ uint32(delta >> 31));
+	}
+
+	uint8* data;
+	int32 capacity;
+	int32 count;
+};
+
+struct b2DeltaReader
+{
+	bool ReadByte(uint8* value)
+	{
+		if (count >= size)
+		{
+			return false;
+		}
+		*value = data[count++];
+		return true;
+	}
+
+	bool ReadVarint(uint32* value)
+	{
+		uint32 result = 0;
+		for (int32 shift = 0; shift < 35; shift += 7)
+		{
+			uint8 byte;
+			if (ReadByte(&byte) == false)
+			{
+				return false;
+			}
+
+			result |= uint32(byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0)
+			{
+				*value = result;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool ReadDelta(int32* value, int32 baseline)
+	{
+		uint32 zigzag;
+		if (ReadVarint(&zigzag) == false)
+		{
+			return false;
+		}
+
+		uint32 delta = (zigzag >> 1) ^ (0u - (zigzag & 1));
+		*value = int32(uint32(baseline) + delta);
+		return true;
+	}
+
+	const uint8* data;
+	int32 size;
+	int32 count;
+};
+
+static void b2GrowStates(b2QuantizedBodyState** states, int32 capacity)
+{
+	b2Free(*states);
+	*states = (b2QuantizedBodyState*)b2Alloc(capacity * sizeof(b2QuantizedBodyState));
+}
+
+b2StateDeltaEncoder::b2StateDeltaEncoder()
+{
+	m_baseline = nullptr;
+	m_current = nullptr;
+	m_count = 0;
+	m_capacity = 0;
+	m_sequence = 0;
+	m_changedCount = 0;
+	m_fullFrame = true;
+}
+
+b2StateDeltaEncoder::~b2StateDeltaEncoder()
+{
+	b2Free(m_baseline);
+	b2Free(m_current);
+}
+
+void b2StateDeltaEncoder::SetPrecision(const b2StateDeltaPrecision& precision)
+{
+	b2Assert(precision.position > 0.0f && precision.angle > 0.0f);
+	b2Assert(precision.linearVelocity > 0.0f && precision.angularVelocity > 0.0f);
+	m_precision = precision;
+	m_fullFrame = true;
+}
+
+void b2StateDeltaEncoder::Reset()
+{
+	m_fullFrame = true;
+}
+
+int32 b2StateDeltaEncoder::Encode(const b2World* world, void* buffer, int32 capacity)
+{
+	int32 count = world->GetBodyCount();
+	bool fullFrame = m_fullFrame || count != m_count;
+
+	if (count > m_capacity)
+	{
+		// The baseline is lost, so a full frame is written.
+		m_capacity = b2Max(count, 2 * m_capacity);
+		b2GrowStates(&m_baseline, m_capacity);
+		b2GrowStates(&m_current, m_capacity);
+		fullFrame = true;
+	}
+
+	if (fullFrame)
+	{
+		memset(m_baseline, 0, count * sizeof(b2QuantizedBodyState));
+	}
+
+	b2DeltaWriter writer;
+	writer.data = (uint8*)buffer;
+	writer.capacity = capacity;
+	writer.count = 0;
+
+	uint32 sequence = m_sequence + 1;
+	writer.WriteByte(fullFrame ? e_fullFrame : e_deltaFrame);
+	writer.WriteVarint(sequence);
+	writer.WriteVarint(uint32(count));
+
+	int32 changedCount = 0;
+	int32 previousIndex = -1;
+	int32 index = 0;
+	for (const b2Body* b = world->GetBodyList(); b; b = b->GetNext(), ++index)
+	{
+		const b2QuantizedBodyState& base = m_baseline[index];
+		b2QuantizedBodyState& state = m_current[index];
+
+		// A body that was and still is asleep can only have been moved by the user.
+		if (fullFrame == false && base.awake == false && b->IsAwake() == false)
+		{
+			b2Vec2 p = b->GetPosition();
+			if (b2Quantize(p.x, m_precision.position) == base.x &&
+				b2Quantize(p.y, m_precision.position) == base.y &&
+				b2Quantize(b->GetAngle(), m_precision.angle) == base.angle)
+			{
+				state = base;
+				continue;
+			}
+		}
+
+		b2QuantizeBody(&state, b, m_precision);
+
+		uint8 mask = b2ComputeChangeMask(base, state);
+		if (fullFrame == false && (mask & ~e_awakeValue) == 0)
+		{
+			continue;
+		}
+
+		writer.WriteVarint(uint32(index - previousIndex));
+		writer.WriteByte(mask);
+
+		if (mask & e_positionChanged)
+		{
+			writer.WriteDelta(state.x, base.x);
+			writer.WriteDelta(state.y, base.y);
+		}
+
+		if (mask & e_angleChanged)
+		{
+			writer.WriteDelta(state.angle, base.angle);
+		}
+
+		if (mask & e_linearVelocityChanged)
+		{
+			writer.WriteDelta(state.vx, base.vx);
+			writer.WriteDelta(state.vy, base.vy);
+		}
+
+		if (mask & e_angularVelocityChanged)
+		{
+			writer.WriteDelta(state.w, base.w);
+		}
+
+		previousIndex = index;
+		++changedCount;
+	}
+
+	writer.WriteVarint(0);
+
+	if (writer.count > capacity)
+	{
+		// Keep the old baseline so the next frame is still valid.
+		if (fullFrame)
+		{
+			m_fullFrame = true;
+		}
+		return 0;
+	}
+
+	b2QuantizedBodyState* temp = m_baseline;
+	m_baseline = m_current;
+	m_current = temp;
+	m_count = count;
+	m_sequence = sequence;
+	m_changedCount = changedCount;
+	m_fullFrame = false;
+
+	return writer.count;
+}
+
+b2StateDeltaDecoder::b2StateDeltaDecoder()
+{
+	m_baseline = nullptr;
+	m_current = nullptr;
+	m_count = 0;
+	m_capacity = 0;
+	m_sequence = 0;
+	m_hasBaseline = false;
+}
+
+b2StateDeltaDecoder::~b2StateDeltaDecoder()
+{
+	b2Free(m_baseline);
+	b2Free(m_current);
+}
+
+bool b2StateDeltaDecoder::Decode(b2World* world, const void* buffer, int32 size)
+{
+	b2DeltaReader reader;
+	reader.data = (const uint8*)buffer;
+	reader.size = size;
+	reader.count = 0;
+
+	uint8 frameType;
+	uint32 sequence, count;
+	if (reader.ReadByte(&frameType) == false || reader.ReadVarint(&sequence) == false || reader.ReadVarint(&count) == false)
+	{
+		return false;
+	}
+
+	bool fullFrame = frameType == e_fullFrame;
+	if (int32(count) != world->GetBodyCount())
+	{
+		return false;
+	}
+
+	if (fullFrame == false && (m_hasBaseline == false || sequence != m_sequence + 1 || int32(count) != m_count))
+	{
+		return false;
+	}
+
+	if (int32(count) > m_capacity)
+	{
+		// Only full frames get here.
+		m_capacity = int32(count);
+		b2GrowStates(&m_baseline, m_capacity);
+		b2GrowStates(&m_current, m_capacity);
+	}
+
+	if (fullFrame)
+	{
+		memset(m_current, 0, count * sizeof(b2QuantizedBodyState));
+	}
+	else
+	{
+		memcpy(m_current, m_baseline, count * sizeof(b2QuantizedBodyState));
+	}
+
+	// Read the whole frame before touching the world.
+	int32 index = -1;
+	for (;;)
+	{
+		uint32 gap;
+		if (reader.ReadVarint(&gap) == false)
+		{
+			return false;
+		}
+
+		if (gap == 0)
+		{
+			break;
+		}
+
+		index += int32(gap);
+
+		uint8 mask;
+		if (index >= int32(count) || reader.ReadByte(&mask) == false)
+		{
+			return false;
+		}
+
+		b2QuantizedBodyState& state = m_current[index];
+		bool ok = true;
+
+		if (mask & e_positionChanged)
+		{
+			ok = ok && reader.ReadDelta(&state.x, state.x);
+			ok = ok && reader.ReadDelta(&state.y, state.y);
+		}
+
+		if (mask & e_angleChanged)
+		{
+			ok = ok && reader.ReadDelta(&state.angle, state.angle);
+		}
+
+		if (mask & e_linearVelocityChanged)
+		{
+			ok = ok && reader.ReadDelta(&state.vx, state.vx);
+			ok = ok && reader.ReadDelta(&state.vy, state.vy);
+		}
+
+		if (mask & e_angularVelocityChanged)
+		{
+			ok = ok && reader.ReadDelta(&state.w, state.w);
+		}
+
+		if (ok == false)
+		{
+			return false;
+		}
+
+		state.awake = (mask & e_awakeValue) != 0;
+	}
+
+	index = 0;
+	for (b2Body* b = world->GetBodyList(); b; b = b->GetNext(), ++index)
+	{
+		const b2QuantizedBodyState& base = m_baseline[index];
+		const b2QuantizedBodyState& state = m_current[index];
+
+		uint8 mask = fullFrame ? 0xFF : b2ComputeChangeMask(base, state);
+		if ((mask & ~e_awakeValue) == 0)
+		{
+			continue;
+		}
+
+		if (mask & (e_positionChanged | e_angleChanged))
+		{
+			b2Vec2 p(state.x * m_precision.position, state.y * m_precision.position);
+			b->SetTransform(p, state.angle * m_precision.angle);
+		}
+
+		if (state.awake)
+		{
+			b->SetAwake(true);
+			b->SetLinearVelocity(b2Vec2(state.vx * m_precision.linearVelocity, state.vy * m_precision.linearVelocity));
+			b->SetAngularVelocity(state.w * m_precision.angularVelocity);
+		}
+		else
+		{
+			b->SetAwake(false);
+		}
+	}
+
+	b2QuantizedBodyState* temp = m_baseline;
+	m_baseline = m_current;
+	m_current = temp;
+	m_count = int32(count);
+	m_sequence = sequence;
+	m_hasBaseline = true;
+
+	return true;
+}
@@ -172,6 +172,12 @@ void b2WeldJoint::InitVelocityConstraints(const b2SolverData& data)
 
 void b2WeldJoint::SolveVelocityConstraints(const b2SolverData& data)
 {
+	if (data.step.solverType == b2_softStepSolver)
+	{
+		SolveSoftVelocityConstraints(data);
+		return;
+	}
+
 	b2Vec2 vA = data.velocities[m_indexA].v;
 	float wA = data.velocities[m_indexA].w;
 	b2Vec2 vB = data.velocities[m_indexB].v;
@@ -228,8 +234,101 @@ void b2WeldJoint::SolveVelocityConstraints(const b2SolverData& data)
 	data.velocities[m_indexB].w = wB;
 }
 
+void b2WeldJoint::SolveSoftVelocityConstraints(const b2SolverData& data)
+{
+	b2Vec2 cA = data.positions[m_indexA].c;
+	float aA = data.positions[m_indexA].a;
+	b2Vec2 vA = data.velocities[m_indexA].v;
+	float wA = data.velocities[m_indexA].w;
+
+	b2Vec2 cB = data.positions[m_indexB].c;
+	float aB = data.positions[m_indexB].a;
+	b2Vec2 vB = data.velocities[m_indexB].v;
+	float wB = data.velocities[m_indexB].w;
+
+	float mA = m_invMassA, mB = m_invMassB;
+	float iA = m_invIA, iB = m_invIB;
+
+	// Solve angular constraint. An angular spring stays soft while relaxing.
+	{
+		b2Softness soft = data.step.jointSoftness;
+		bool useBias = data.useBias;
+		if (m_frequencyHz > 0.0f)
+		{
+			soft = b2MakeSoft(m_frequencyHz, m_dampingRatio, data.step.dt);
+			useBias = true;
+		}
+
+		float bias = 0.0f;
+		float massScale = 1.0f;
+		float impulseScale = 0.0f;
+		if (useBias)
+		{
+			float C = aB - aA - m_referenceAngle;
+			bias = soft.biasRate * C;
+			massScale = soft.massScale;
+			impulseScale = soft.impulseScale;
+		}
+
+		float invM = iA + iB;
+		float axialMass = invM > 0.0f ? 1.0f / invM : 0.0f;
+
+		float Cdot = wB - wA;
+		float impulse = -axialMass * massScale * (Cdot + bias) - impulseScale * m_impulse.z;
+		m_impulse.z += impulse;
+
+		wA -= iA * impulse;
+		wB += iB * impulse;
+	}
+
+	// Solve linear constraint.
+	{
+		const b2Softness& soft = data.step.jointSoftness;
+
+		b2Vec2 bias(0.0f, 0.0f);
+		float massScale = 1.0f;
+		float impulseScale = 0.0f;
+		if (data.useBias)
+		{
+			b2Vec2 C = cB + m_rB - cA - m_rA;
+			bias = soft.biasRate * C;
+			massScale = soft.massScale;
+			impulseScale = soft.impulseScale;
+		}
+
+		b2Mat22 K;
+		K.ex.x = mA + mB + m_rA.y * m_rA.y * iA + m_rB.y * m_rB.y * iB;
+		K.ey.x = -m_rA.y * m_rA.x * iA - m_rB.y * m_rB.x * iB;
+		K.ex.y = K.ey.x;
+		K.ey.y = mA + mB + m_rA.x * m_rA.x * iA + m_rB.x * m_rB.x * iB;
+
+		b2Vec2 Cdot = vB + b2Cross(wB, m_rB) - vA - b2Cross(wA, m_rA);
+		b2Vec2 impulse = -massScale * K.Solve(Cdot + bias) - impulseScale * b2Vec2(m_impulse.x, m_impulse.y);
+
+		m_impulse.x += impulse.x;
+		m_impulse.y += impulse.y;
+
+		vA -= mA * impulse;
+		wA -= iA * b2Cross(m_rA, impulse);
+
+		vB += mB * impulse;
+		wB += iB * b2Cross(m_rB, impulse);
+	}
+
+	data.velocities[m_indexA].v = vA;
+	data.velocities[m_indexA].w = wA;
+	data.velocities[m_indexB].v = vB;
+	data.velocities[m_indexB].w = wB;
+}
+
 bool b2WeldJoint::SolvePositionConstraints(const b2SolverData& data)
 {
+	// The soft step solver corrects the position error in the velocity solver.
+	if (data.step.solverType == b2_softStepSolver)
+	{
+		return true;
+	}
+
 	b2Vec2 cA = data.positions[m_indexA].c;
 	float aA = data.positions[m_indexA].a;
 	b2Vec2 cB = data.positions[m_indexB].c;
@@ -330,6 +429,16 @@ float b2WeldJoint::GetReactionTorque(float inv_dt) const
 	return inv_dt * m_impulse.z;
 }
 
+void b2WeldJoint::SerializeState(b2JointStateStream& stream)
+{
+	stream.Serialize(m_frequencyHz);
+	stream.Serialize(m_dampingRatio);
+	stream.Serialize(m_localAnchorA);
+	stream.Serialize(m_localAnchorB);
+	stream.Serialize(m_referenceAngle);
+	stream.Serialize(m_impulse);
+}
+
 void b2WeldJoint::Dump()
 {
 	int32 indexA = m_bodyA->m_islandIndex;
@@ -346,3 +455,8 @@ void b2WeldJoint::Dump()
 	b2Log("  jd.dampingRatio = %.15lef;\n", m_dampingRatio);
 	b2Log("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+b2JointBatchRegister b2WeldJoint::GetBatchRegister()
+{
+	return CreateBatchRegister<b2WeldJoint>();
+}
@@ -439,6 +439,22 @@ float b2WheelJoint::GetMotorTorque(float inv_dt) const
 	return inv_dt * m_motorImpulse;
 }
 
+void b2WheelJoint::SerializeState(b2JointStateStream& stream)
+{
+	stream.Serialize(m_frequencyHz);
+	stream.Serialize(m_dampingRatio);
+	stream.Serialize(m_localAnchorA);
+	stream.Serialize(m_localAnchorB);
+	stream.Serialize(m_localXAxisA);
+	stream.Serialize(m_localYAxisA);
+	stream.Serialize(m_impulse);
+	stream.Serialize(m_motorImpulse);
+	stream.Serialize(m_springImpulse);
+	stream.Serialize(m_maxMotorTorque);
+	stream.Serialize(m_motorSpeed);
+	stream.Serialize(m_enableMotor);
+}
+
 void b2WheelJoint::Dump()
 {
 	int32 indexA = m_bodyA->m_islandIndex;
@@ -458,3 +474,8 @@ void b2WheelJoint::Dump()
 	b2Log("  jd.dampingRatio = %.15lef;\n", m_dampingRatio);
 	b2Log("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+b2JointBatchRegister b2WheelJoint::GetBatchRegister()
+{
+	return CreateBatchRegister<b2WheelJoint>();
+}
@@ -25,21 +25,31 @@
 
 #include "box2d/b2_body.h"
 #include "box2d/b2_broad_phase.h"
+#include "box2d/b2_capsule_shape.h"
 #include "box2d/b2_chain_shape.h"
 #include "box2d/b2_circle_shape.h"
 #include "box2d/b2_collision.h"
+#include "box2d/b2_compound_shape.h"
 #include "box2d/b2_contact.h"
+#include "box2d/b2_distance.h"
 #include "box2d/b2_draw.h"
 #include "box2d/b2_edge_shape.h"
 #include "box2d/b2_fixture.h"
+#include "box2d/b2_heightfield_shape.h"
 #include "box2d/b2_polygon_shape.h"
 #include "box2d/b2_pulley_joint.h"
+#include "box2d/b2_rope_system.h"
 #include "box2d/b2_time_of_impact.h"
+#include "box2d/b2_task.h"
 #include "box2d/b2_timer.h"
 #include "box2d/b2_world.h"
 
+#include <mutex>
 #include <new>
 
+// Guards the one-time construction of the contact and joint registers.
+static std::once_flag b2_registerFlag;
+
 b2World::b2World(const b2Vec2& gravity)
 {
 	m_destructionListener = nullptr;
@@ -51,22 +61,56 @@ b2World::b2World(const b2Vec2& gravity)
 	m_bodyCount = 0;
 	m_jointCount = 0;
 
+	m_kinematicBodies = nullptr;
+	m_kinematicCount = 0;
+	m_kinematicCapacity = 0;
+
 	m_warmStarting = true;
 	m_continuousPhysics = true;
 	m_subStepping = false;
 
+	m_solverType = b2_ngsSolver;
+	m_contactHertz = 30.0f;
+	m_contactDampingRatio = 10.0f;
+	m_contactPushVelocity = 3.0f;
+	m_jointHertz = 60.0f;
+	m_jointDampingRatio = 2.0f;
+
+	m_linearIterationTolerance = 0.0f;
+	m_angularIterationTolerance = 0.0f;
+	m_minVelocityIterations = 2;
+
 	m_stepComplete = true;
 
 	m_allowSleep = true;
+	m_energySleep = false;
 	m_gravity = gravity;
 
+	m_sleepingIslands = nullptr;
+	m_sleepingIslandCapacity = 0;
+	m_sleepingIslandCount = 0;
+	m_freeSleepingIsland = b2_nullSleepingIsland;
+
 	m_flags = e_clearForces;
 
 	m_inv_dt0 = 0.0f;
 
 	m_contactManager.m_allocator = &m_blockAllocator;
+	m_scratchAllocator = &m_stackAllocator;
+	m_executor = nullptr;
+	m_ropeSystem = nullptr;
+
+	// Build the contact and joint registers up front so worlds can be stepped on different threads.
+	// Worlds may also be constructed on different threads, so this only runs once.
+	std::call_once(b2_registerFlag, []()
+	{
+		b2Contact::InitializeRegisters();
+		b2Contact::s_initialized = true;
+		b2Joint::InitializeBatchRegisters();
+	});
 
 	memset(&m_profile, 0, sizeof(b2Profile));
+	m_toiStats.SetZero();
 }
 
 b2World::~b2World()
@@ -88,6 +132,9 @@ b2World::~b2World()
 
 		b = bNext;
 	}
+
+	b2Free(m_kinematicBodies);
+	b2Free(m_sleepingIslands);
 }
 
 void b2World::SetDestructionListener(b2DestructionListener* listener)
@@ -131,6 +178,11 @@ b2Body* b2World::CreateBody(const b2BodyDef* def)
 	m_bodyList = b;
 	++m_bodyCount;
 
+	if (b->m_type == b2_kinematicBody)
+	{
+		AddKinematicBody(b);
+	}
+
 	return b;
 }
 
@@ -143,6 +195,22 @@ void b2World::DestroyBody(b2Body* b)
 		return;
 	}
 
+	// Wake the bodies this body fell asleep with.
+	if (b->m_sleepingIsland != b2_nullSleepingIsland)
+	{
+		WakeSleepingIsland(b->m_sleepingIsland);
+	}
+
+	if (m_ropeSystem != nullptr)
+	{
+		m_ropeSystem->DestroyAttachments(b);
+	}
+
+	if (b->m_type == b2_kinematicBody)
+	{
+		RemoveKinematicBody(b);
+	}
+
 	// Delete the attached joints.
 	b2JointEdge* je = b->m_jointList;
 	while (je)
@@ -388,19 +456,282 @@ void b2World::SetAllowSleeping(bool flag)
 	}
 }
 
+void b2World::SetContactTuning(float hertz, float dampingRatio, float pushVelocity)
+{
+	b2Assert(b2IsValid(hertz) && hertz >= 0.0f);
+	b2Assert(b2IsValid(dampingRatio) && dampingRatio >= 0.0f);
+	b2Assert(b2IsValid(pushVelocity) && pushVelocity >= 0.0f);
+	m_contactHertz = hertz;
+	m_contactDampingRatio = dampingRatio;
+	m_contactPushVelocity = pushVelocity;
+}
+
+void b2World::SetJointTuning(float hertz, float dampingRatio)
+{
+	b2Assert(b2IsValid(hertz) && hertz >= 0.0f);
+	b2Assert(b2IsValid(dampingRatio) && dampingRatio >= 0.0f);
+	m_jointHertz = hertz;
+	m_jointDampingRatio = dampingRatio;
+}
+
+void b2World::SetAdaptiveIterations(float linearTolerance, float angularTolerance, int32 minIterations)
+{
+	b2Assert(b2IsValid(linearTolerance) && linearTolerance >= 0.0f);
+	b2Assert(b2IsValid(angularTolerance) && angularTolerance >= 0.0f);
+	b2Assert(minIterations >= 1);
+	m_linearIterationTolerance = linearTolerance;
+	m_angularIterationTolerance = angularTolerance;
+	m_minVelocityIterations = minIterations;
+}
+
+void b2World::SetContactCaching(float linearTolerance, float angularTolerance)
+{
+	b2Assert(b2IsValid(linearTolerance) && linearTolerance >= 0.0f);
+	b2Assert(b2IsValid(angularTolerance) && angularTolerance >= 0.0f);
+	m_contactManager.m_cacheLinearTolerance = linearTolerance;
+	m_contactManager.m_cacheAngularTolerance = angularTolerance;
+}
+
+void b2World::AddKinematicBody(b2Body* body)
+{
+	b2Assert(body->m_kinematicIndex == -1);
+	if (m_kinematicCount == m_kinematicCapacity)
+	{
+		b2Body** oldBodies = m_kinematicBodies;
+		m_kinematicCapacity = b2Max(2 * m_kinematicCapacity, 16);
+		m_kinematicBodies = (b2Body**)b2Alloc(m_kinematicCapacity * sizeof(b2Body*));
+		if (oldBodies)
+		{
+			memcpy(m_kinematicBodies, oldBodies, m_kinematicCount * sizeof(b2Body*));
+			b2Free(oldBodies);
+		}
+	}
+
+	body->m_kinematicIndex = m_kinematicCount;
+	m_kinematicBodies[m_kinematicCount++] = body;
+}
+
+void b2World::RemoveKinematicBody(b2Body* body)
+{
+	int32 index = body->m_kinematicIndex;
+	b2Assert(0 <= index && index < m_kinematicCount && m_kinematicBodies[index] == body);
+
+	// Move the last body into the hole.
+	b2Body* last = m_kinematicBodies[--m_kinematicCount];
+	m_kinematicBodies[index] = last;
+	last->m_kinematicIndex = index;
+	body->m_kinematicIndex = -1;
+}
+
+// Move the awake kinematic bodies that have no touching contact and no joint to a dynamic body.
+// They have nothing to solve, so they skip the island search and the island solver. The
+// rest are left to seed islands.
+void b2World::SolveKinematic(const b2TimeStep& step)
+{
+	float h = step.dt;
+	const float angularScale = b2_angularSleepTolerance / b2_linearSleepTolerance;
+
+	for (int32 i = 0; i < m_kinematicCount; ++i)
+	{
+		b2Body* b = m_kinematicBodies[i];
+		if (b->IsAwake() == false || b->IsActive() == false)
+		{
+			continue;
+		}
+
+		// Kinematic bodies only collide with dynamic bodies, so any solid touching contact counts.
+		bool linked = false;
+		for (b2ContactEdge* ce = b->m_contactList; ce && linked == false; ce = ce->next)
+		{
+			b2Contact* contact = ce->contact;
+			linked = contact->IsEnabled() && contact->IsTouching() &&
+					 contact->m_fixtureA->m_isSensor == false && contact->m_fixtureB->m_isSensor == false;
+		}
+
+		for (b2JointEdge* je = b->m_jointList; je && linked == false; je = je->next)
+		{
+			linked = je->other->m_type == b2_dynamicBody && je->other->IsActive();
+		}
+
+		if (linked)
+		{
+			continue;
+		}
+
+		// The island flag keeps the body out of the island search and has its fixtures
+		// synchronized with the island bodies.
+		b->m_flags |= b2Body::e_islandFlag;
+
+		// Store positions for continuous collision.
+		b->m_sweep.c0 = b->m_sweep.c;
+		b->m_sweep.a0 = b->m_sweep.a;
+
+		b2Vec2 v = b->m_linearVelocity;
+		float w = b->m_angularVelocity;
+
+		// Check for large velocities
+		b2Vec2 translation = h * v;
+		if (b2Dot(translation, translation) > b2_maxTranslationSquared)
+		{
+			float ratio = b2_maxTranslation / translation.Length();
+			v *= ratio;
+		}
+
+		float rotation = h * w;
+		if (rotation * rotation > b2_maxRotationSquared)
+		{
+			float ratio = b2_maxRotation / b2Abs(rotation);
+			w *= ratio;
+		}
+
+		b->m_sweep.c += h * v;
+		b->m_sweep.a += h * w;
+		b->m_linearVelocity = v;
+		b->m_angularVelocity = w;
+		b->SynchronizeTransform();
+
+		if (m_allowSleep == false)
+		{
+			continue;
+		}
+
+		float linTol = b->m_sleepThreshold;
+		float angTol = angularScale * linTol;
+		if ((b->m_flags & b2Body::e_autoSleepFlag) == 0 ||
+			w * w > angTol * angTol ||
+			b2Dot(v, v) > linTol * linTol)
+		{
+			b->m_sleepTime = 0.0f;
+		}
+		else
+		{
+			b->m_sleepTime += h;
+			if (b->m_sleepTime >= b2_timeToSleep)
+			{
+				b->SetAwake(false);
+			}
+		}
+	}
+}
+
+void b2World::ReserveSleepingIslands(int32 capacity)
+{
+	if (capacity <= m_sleepingIslandCapacity)
+	{
+		return;
+	}
+
+	b2SleepingIsland* oldIslands = m_sleepingIslands;
+	m_sleepingIslands = (b2SleepingIsland*)b2Alloc(capacity * sizeof(b2SleepingIsland));
+	if (oldIslands)
+	{
+		memcpy(m_sleepingIslands, oldIslands, m_sleepingIslandCapacity * sizeof(b2SleepingIsland));
+		b2Free(oldIslands);
+	}
+
+	// Link the new records into the free list.
+	for (int32 i = capacity - 1; i >= m_sleepingIslandCapacity; --i)
+	{
+		m_sleepingIslands[i].bodyList = nullptr;
+		m_sleepingIslands[i].bodyCount = 0;
+		m_sleepingIslands[i].next = m_freeSleepingIsland;
+		m_freeSleepingIsland = i;
+	}
+
+	m_sleepingIslandCapacity = capacity;
+}
+
+// Record the bodies of an island that just fell asleep so waking one of them wakes the rest.
+void b2World::AddSleepingIsland(const b2Island& island)
+{
+	if (m_freeSleepingIsland == b2_nullSleepingIsland)
+	{
+		ReserveSleepingIslands(b2Max(2 * m_sleepingIslandCapacity, 16));
+	}
+
+	int32 id = m_freeSleepingIsland;
+	b2SleepingIsland* record = m_sleepingIslands + id;
+	m_freeSleepingIsland = record->next;
+	record->bodyList = nullptr;
+	record->bodyCount = 0;
+	record->next = b2_nullSleepingIsland;
+	++m_sleepingIslandCount;
+
+	for (int32 i = 0; i < island.m_bodyCount; ++i)
+	{
+		b2Body* b = island.m_bodies[i];
+		if (b->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+
+		b2Assert(b->m_sleepingIsland == b2_nullSleepingIsland);
+		b->m_sleepingIsland = id;
+		b->m_sleepingNext = record->bodyList;
+		record->bodyList = b;
+		++record->bodyCount;
+	}
+}
+
+// Wake all bodies of a sleeping island and release the record. The sleep timers are kept,
+// like the island search does, so the caller decides whether to reset them.
+void b2World::WakeSleepingIsland(int32 id)
+{
+	b2Assert(0 <= id && id < m_sleepingIslandCapacity);
+	b2SleepingIsland* record = m_sleepingIslands + id;
+
+	b2Body* b = record->bodyList;
+	while (b)
+	{
+		b2Body* next = b->m_sleepingNext;
+		b->m_flags |= b2Body::e_awakeFlag;
+		b->m_sleepingIsland = b2_nullSleepingIsland;
+		b->m_sleepingNext = nullptr;
+		b = next;
+	}
+
+	record->bodyList = nullptr;
+	record->bodyCount = 0;
+	record->next = m_freeSleepingIsland;
+	m_freeSleepingIsland = id;
+	--m_sleepingIslandCount;
+}
+
+struct b2SynchronizeContext
+{
+	b2Body** bodies;
+	bool* enlarged;
+};
+
+void b2World::SynchronizeTask(int32 startIndex, int32 endIndex, int32 workerIndex, void* context)
+{
+	B2_NOT_USED(workerIndex);
+
+	b2SynchronizeContext* synchronize = (b2SynchronizeContext*)context;
+	for (int32 i = startIndex; i < endIndex; ++i)
+	{
+		synchronize->enlarged[i] = synchronize->bodies[i]->ComputeSweptAABBs();
+	}
+}
+
 // Find islands, integrate and solve constraints, solve position constraints
 void b2World::Solve(const b2TimeStep& step)
 {
 	m_profile.solveInit = 0.0f;
 	m_profile.solveVelocity = 0.0f;
 	m_profile.solvePosition = 0.0f;
+	m_profile.islandCount = 0;
+	m_profile.velocityIterations = 0;
+	m_profile.maxVelocityIterations = 0;
 
 	// Size the island for the worst case.
 	b2Island island(m_bodyCount,
 					m_contactManager.m_contactCount,
 					m_jointCount,
-					&m_stackAllocator,
+					m_scratchAllocator,
 					m_contactManager.m_contactListener);
+	island.m_executor = m_executor;
+	island.m_energySleep = m_energySleep;
 
 	// Clear all the island flags.
 	for (b2Body* b = m_bodyList; b; b = b->m_next)
@@ -416,9 +747,11 @@ void b2World::Solve(const b2TimeStep& step)
 		j->m_islandFlag = false;
 	}
 
+	SolveKinematic(step);
+
 	// Build and simulate all awake islands.
 	int32 stackSize = m_bodyCount;
-	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
+	b2Body** stack = (b2Body**)m_scratchAllocator->Allocate(stackSize * sizeof(b2Body*));
 	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
 	{
 		if (seed->m_flags & b2Body::e_islandFlag)
@@ -451,7 +784,12 @@ void b2World::Solve(const b2TimeStep& step)
 			b2Assert(b->IsActive() == true);
 			island.Add(b);
 
-			// Make sure the body is awake (without resetting sleep timer).
+			// Make sure the body is awake (without resetting sleep timer). This also wakes
+			// the bodies it fell asleep with.
+			if (b->m_sleepingIsland != b2_nullSleepingIsland)
+			{
+				WakeSleepingIsland(b->m_sleepingIsland);
+			}
 			b->m_flags |= b2Body::e_awakeFlag;
 
 			// To keep islands as small as possible, we don't
@@ -538,6 +876,15 @@ void b2World::Solve(const b2TimeStep& step)
 		m_profile.solveInit += profile.solveInit;
 		m_profile.solveVelocity += profile.solveVelocity;
 		m_profile.solvePosition += profile.solvePosition;
+		m_profile.islandCount += 1;
+		m_profile.velocityIterations += profile.velocityIterations;
+		m_profile.maxVelocityIterations = b2Max(m_profile.maxVelocityIterations, profile.velocityIterations);
+
+		// The seed is never static, so it is asleep only if the whole island fell asleep.
+		if (seed->IsAwake() == false)
+		{
+			AddSleepingIsland(island);
+		}
 
 		// Post solve cleanup.
 		for (int32 i = 0; i < island.m_bodyCount; ++i)
@@ -551,11 +898,13 @@ void b2World::Solve(const b2TimeStep& step)
 		}
 	}
 
-	m_stackAllocator.Free(stack);
+	m_scratchAllocator->Free(stack);
 
 	{
 		b2Timer timer;
 		// Synchronize fixtures, check for out of range bodies.
+		int32 movedCount = 0;
+		b2Body** moved = (b2Body**)m_scratchAllocator->Allocate(m_bodyCount * sizeof(b2Body*));
 		for (b2Body* b = m_bodyList; b; b = b->GetNext())
 		{
 			// If a body was not in an island then it did not move.
@@ -569,10 +918,38 @@ void b2World::Solve(const b2TimeStep& step)
 				continue;
 			}
 
-			// Update fixtures (for broad-phase).
-			b->SynchronizeFixtures();
+			// Without an executor, update the fixtures while the body is in cache.
+			if (m_executor == nullptr)
+			{
+				if (b->ComputeSweptAABBs())
+				{
+					b->MoveProxies();
+				}
+				continue;
+			}
+
+			moved[movedCount++] = b;
+		}
+
+		// The swept AABBs only depend on the body, so compute them in parallel. Then update the
+		// broad-phase for the bodies that left their fat AABBs, in body order so the tree does
+		// not depend on the thread count.
+		b2SynchronizeContext context;
+		context.bodies = moved;
+		context.enlarged = (bool*)m_scratchAllocator->Allocate(movedCount * sizeof(bool));
+		b2ParallelFor(m_executor, SynchronizeTask, &context, movedCount, 64);
+
+		for (int32 i = 0; i < movedCount; ++i)
+		{
+			if (context.enlarged[i])
+			{
+				moved[i]->MoveProxies();
+			}
 		}
 
+		m_scratchAllocator->Free(context.enlarged);
+		m_scratchAllocator->Free(moved);
+
 		// Look for new contacts.
 		m_contactManager.FindNewContacts();
 		m_profile.broadphase = timer.GetMilliseconds();
@@ -582,7 +959,7 @@ void b2World::Solve(const b2TimeStep& step)
 // Find TOI contacts and solve them.
 void b2World::SolveTOI(const b2TimeStep& step)
 {
-	b2Island island(2 * b2_maxTOIContacts, b2_maxTOIContacts, 0, &m_stackAllocator, m_contactManager.m_contactListener);
+	b2Island island(2 * b2_maxTOIContacts, b2_maxTOIContacts, 0, m_scratchAllocator, m_contactManager.m_contactListener);
 
 	if (m_stepComplete)
 	{
@@ -693,7 +1070,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 				input.tMax = 1.0f;
 
 				b2TOIOutput output;
-				b2TimeOfImpact(&output, &input);
+				b2TimeOfImpact(&output, &input, &c->m_simplexCache, &m_toiStats);
 
 				// Beta is the fraction of the remaining portion of the .
 				float beta = output.t;
@@ -738,7 +1115,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		bB->Advance(minAlpha);
 
 		// The TOI contact likely has some new contact points.
-		minContact->Update(m_contactManager.m_contactListener);
+		minContact->Update(m_contactManager.m_contactListener, 0.0f, 0.0f);
 		minContact->m_flags &= ~b2Contact::e_toiFlag;
 		++minContact->m_toiCount;
 
@@ -818,7 +1195,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 					}
 
 					// Update the contact points
-					contact->Update(m_contactManager.m_contactListener);
+					contact->Update(m_contactManager.m_contactListener, 0.0f, 0.0f);
 
 					// Was the contact disabled by the user?
 					if (contact->IsEnabled() == false)
@@ -866,6 +1243,10 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		subStep.positionIterations = 20;
 		subStep.velocityIterations = step.velocityIterations;
 		subStep.warmStarting = false;
+		subStep.linearIterationTolerance = 0.0f;
+		subStep.angularIterationTolerance = 0.0f;
+		subStep.minVelocityIterations = step.velocityIterations;
+		subStep.solverType = b2_ngsSolver;
 		island.SolveTOI(subStep, bA->m_islandIndex, bB->m_islandIndex);
 
 		// Reset island flags and synchronize broad-phase proxies.
@@ -913,6 +1294,8 @@ void b2World::Step(float dt, int32 velocityIterations, int32 positionIterations)
 
 	m_flags |= e_locked;
 
+	m_toiStats.SetZero();
+
 	b2TimeStep step;
 	step.dt = dt;
 	step.velocityIterations	= velocityIterations;
@@ -929,12 +1312,48 @@ void b2World::Step(float dt, int32 velocityIterations, int32 positionIterations)
 	step.dtRatio = m_inv_dt0 * dt;
 
 	step.warmStarting = m_warmStarting;
-	
+
+	step.linearIterationTolerance = m_linearIterationTolerance;
+	step.angularIterationTolerance = m_angularIterationTolerance;
+	step.minVelocityIterations = m_minVelocityIterations;
+
+	step.solverType = m_solverType;
+	if (m_solverType == b2_softStepSolver)
+	{
+		// The softness is computed for one sub-step. Constraints that are stiff relative
+		// to the sub-step rate are unstable in long chains, so the stiffness is capped.
+		int32 subStepCount = b2Max(velocityIterations, 1);
+		float h = dt / subStepCount;
+		float contactHertz = m_contactHertz;
+		float staticHertz = 2.0f * m_contactHertz;
+		float jointHertz = m_jointHertz;
+		if (h > 0.0f)
+		{
+			contactHertz = b2Min(contactHertz, 0.25f / h);
+			staticHertz = b2Min(staticHertz, 0.25f / h);
+			jointHertz = b2Min(jointHertz, 0.25f / h);
+		}
+
+		step.contactSoftness = b2MakeSoft(contactHertz, m_contactDampingRatio, h);
+		step.staticSoftness = b2MakeSoft(staticHertz, m_contactDampingRatio, h);
+		step.jointSoftness = b2MakeSoft(jointHertz, m_jointDampingRatio, h);
+		step.contactPushVelocity = m_contactPushVelocity;
+	}
+	else
+	{
+		step.contactSoftness = b2MakeSoft(0.0f, 0.0f, 0.0f);
+		step.staticSoftness = step.contactSoftness;
+		step.jointSoftness = step.contactSoftness;
+		step.contactPushVelocity = 0.0f;
+	}
+
 	// Update contacts. This is where some contacts are destroyed.
 	{
 		b2Timer timer;
 		m_contactManager.Collide();
 		m_profile.collide = timer.GetMilliseconds();
+		m_profile.contactCacheHits = m_contactManager.m_cacheHitCount;
+		m_profile.contactCacheMisses = m_contactManager.m_cacheMissCount;
 	}
 
 	// Integrate velocities, solve velocity constraints, and integrate positions.
@@ -953,6 +1372,14 @@ void b2World::Step(float dt, int32 velocityIterations, int32 positionIterations)
 		m_profile.solveTOI = timer.GetMilliseconds();
 	}
 
+	// Step the ropes against the solved bodies. Their impulses act on the next step.
+	if (m_ropeSystem != nullptr && step.dt > 0.0f)
+	{
+		b2Timer timer;
+		m_ropeSystem->StepCoupled(this, step.dt, step.velocityIterations);
+		m_profile.solveRope = timer.GetMilliseconds();
+	}
+
 	if (step.dt > 0.0f)
 	{
 		m_inv_dt0 = step.inv_dt;
@@ -997,6 +1424,34 @@ void b2World::QueryAABB(b2QueryCallback* callback, const b2AABB& aabb) const
 	m_contactManager.m_broadPhase.Query(&wrapper, aabb);
 }
 
+// Reports each child of a single proxy fixture that the ray hits, the same way the broad-phase
+// reports fixtures that have a proxy per child. The max fraction follows the user's answers.
+struct b2WorldRayCastChildWrapper
+{
+	float RayCastCallback(const b2RayCastInput& input, int32 childIndex)
+	{
+		b2RayCastOutput output;
+		if (fixture->RayCast(&output, input, childIndex) == false)
+		{
+			return -1.0f;
+		}
+
+		float fraction = output.fraction;
+		b2Vec2 point = (1.0f - fraction) * input.p1 + fraction * input.p2;
+		float value = callback->ReportFixture(fixture, point, output.normal, fraction);
+		if (value >= 0.0f)
+		{
+			maxFraction = value;
+		}
+
+		return value;
+	}
+
+	b2Fixture* fixture;
+	b2RayCastCallback* callback;
+	float maxFraction;
+};
+
 struct b2WorldRayCastWrapper
 {
 	float RayCastCallback(const b2RayCastInput& input, int32 proxyId)
@@ -1005,9 +1460,39 @@ struct b2WorldRayCastWrapper
 		b2FixtureProxy* proxy = (b2FixtureProxy*)userData;
 		b2Fixture* fixture = proxy->fixture;
 		int32 index = proxy->childIndex;
+
+		// Fixtures with a single proxy report each child the ray hits.
+		b2WorldRayCastChildWrapper childWrapper;
+		childWrapper.fixture = fixture;
+		childWrapper.callback = callback;
+		childWrapper.maxFraction = input.maxFraction;
+
+		const b2Shape* shape = fixture->GetShape();
+		const b2Transform& xf = fixture->GetBody()->GetTransform();
+		switch (shape->m_type)
+		{
+		case b2Shape::e_chain:
+			if (((const b2ChainShape*)shape)->HasTree())
+			{
+				((const b2ChainShape*)shape)->RayCastTree(&childWrapper, input, xf);
+				return childWrapper.maxFraction;
+			}
+			break;
+
+		case b2Shape::e_heightfield:
+			((const b2HeightfieldShape*)shape)->RayCastCells(&childWrapper, input, xf);
+			return childWrapper.maxFraction;
+
+		case b2Shape::e_compound:
+			((const b2CompoundShape*)shape)->RayCastTree(&childWrapper, input, xf);
+			return childWrapper.maxFraction;
+
+		default:
+			break;
+		}
+
 		b2RayCastOutput output;
 		bool hit = fixture->RayCast(&output, input, index);
-
 		if (hit)
 		{
 			float fraction = output.fraction;
@@ -1034,13 +1519,164 @@ void b2World::RayCast(b2RayCastCallback* callback, const b2Vec2& point1, const b
 	m_contactManager.m_broadPhase.RayCast(&wrapper, input);
 }
 
-void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color& color)
+struct b2WorldShapeQueryWrapper
+{
+	bool QueryCallback(int32 proxyId)
+	{
+		b2FixtureProxy* proxy = (b2FixtureProxy*)broadPhase->GetUserData(proxyId);
+		b2Fixture* fixture = proxy->fixture;
+
+		bool overlap = fixture->TestOverlap(shape, transform, proxy->childIndex);
+		if (overlap)
+		{
+			return callback->ReportFixture(fixture);
+		}
+
+		return true;
+	}
+
+	const b2BroadPhase* broadPhase;
+	b2QueryCallback* callback;
+	const b2Shape* shape;
+	b2Transform transform;
+	b2AABB aabb;
+};
+
+void b2World::QueryShape(b2QueryCallback* callback, const b2Shape* shape, const b2Transform& transform) const
+{
+	b2WorldShapeQueryWrapper wrapper;
+	wrapper.broadPhase = &m_contactManager.m_broadPhase;
+	wrapper.callback = callback;
+	wrapper.shape = shape;
+	wrapper.transform = transform;
+	shape->ComputeAABB(&wrapper.aabb, transform, 0);
+	m_contactManager.m_broadPhase.Query(&wrapper, wrapper.aabb);
+}
+
+struct b2WorldShapeCastWrapper
+{
+	float ShapeCastCallback(float maxFraction, int32 proxyId)
+	{
+		b2FixtureProxy* proxy = (b2FixtureProxy*)broadPhase->GetUserData(proxyId);
+		b2Fixture* fixture = proxy->fixture;
+
+		// Filter before the GJK work when the cast comes from a batch query.
+		if (query != nullptr)
+		{
+			if (fixture->IsSensor() || fixture->GetBody() == query->ignoreBody)
+			{
+				return -1.0f;
+			}
+
+			if (b2ShouldCollide(fixture->GetFilterData(), query->filter) == false)
+			{
+				return -1.0f;
+			}
+		}
+
+		// The cast is clipped to the closest hit so far.
+		b2Vec2 clippedTranslation = maxFraction * translation;
+
+		b2ShapeCastOutput output;
+		if (fixture->ShapeCast(&output, shape, transform, clippedTranslation, proxy->childIndex))
+		{
+			return callback->ReportFixture(fixture, output.point, output.normal, output.lambda * maxFraction);
+		}
+
+		return maxFraction;
+	}
+
+	const b2BroadPhase* broadPhase;
+	b2ShapeCastCallback* callback;
+	const b2ShapeCastQuery* query;
+	const b2Shape* shape;
+	b2Transform transform;
+	b2Vec2 translation;
+	b2AABB aabb;
+};
+
+void b2World::ShapeCast(b2ShapeCastCallback* callback, const b2Shape* shape, const b2Transform& transform,
+						const b2Vec2& translation) const
+{
+	b2WorldShapeCastWrapper wrapper;
+	wrapper.broadPhase = &m_contactManager.m_broadPhase;
+	wrapper.callback = callback;
+	wrapper.query = nullptr;
+	wrapper.shape = shape;
+	wrapper.transform = transform;
+	wrapper.translation = translation;
+	shape->ComputeAABB(&wrapper.aabb, transform, 0);
+	m_contactManager.m_broadPhase.ShapeCast(&wrapper, wrapper.aabb, translation, 1.0f);
+}
+
+// Keeps the closest hit of a batch query.
+class b2ClosestShapeCastCallback : public b2ShapeCastCallback
+{
+public:
+	float ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float fraction) override
+	{
+		result->fixture = fixture;
+		result->point = point;
+		result->normal = normal;
+		result->fraction = fraction;
+		return fraction;
+	}
+
+	b2ShapeCastResult* result;
+};
+
+struct b2ShapeCastBatchContext
 {
-	switch (fixture->GetType())
+	const b2BroadPhase* broadPhase;
+	const b2ShapeCastQuery* queries;
+	b2ShapeCastResult* results;
+};
+
+static void b2ShapeCastBatchTask(int32 startIndex, int32 endIndex, int32 workerIndex, void* context)
+{
+	B2_NOT_USED(workerIndex);
+
+	b2ShapeCastBatchContext* batch = (b2ShapeCastBatchContext*)context;
+	for (int32 i = startIndex; i < endIndex; ++i)
+	{
+		const b2ShapeCastQuery* query = batch->queries + i;
+		b2ShapeCastResult* result = batch->results + i;
+		result->fixture = nullptr;
+		result->point.SetZero();
+		result->normal.SetZero();
+		result->fraction = 1.0f;
+
+		b2ClosestShapeCastCallback callback;
+		callback.result = result;
+
+		b2WorldShapeCastWrapper wrapper;
+		wrapper.broadPhase = batch->broadPhase;
+		wrapper.callback = &callback;
+		wrapper.query = query;
+		wrapper.shape = query->shape;
+		wrapper.transform = query->transform;
+		wrapper.translation = query->translation;
+		query->shape->ComputeAABB(&wrapper.aabb, query->transform, 0);
+		batch->broadPhase->ShapeCast(&wrapper, wrapper.aabb, query->translation, 1.0f);
+	}
+}
+
+void b2World::ShapeCastBatch(const b2ShapeCastQuery* queries, b2ShapeCastResult* results, int32 count) const
+{
+	b2ShapeCastBatchContext context;
+	context.broadPhase = &m_contactManager.m_broadPhase;
+	context.queries = queries;
+	context.results = results;
+	b2ParallelFor(m_executor, b2ShapeCastBatchTask, &context, count, 16);
+}
+
+void b2World::DrawShape(const b2Shape* shape, const b2Transform& xf, const b2Color& color)
+{
+	switch (shape->m_type)
 	{
 	case b2Shape::e_circle:
 		{
-			b2CircleShape* circle = (b2CircleShape*)fixture->GetShape();
+			const b2CircleShape* circle = (const b2CircleShape*)shape;
 
 			b2Vec2 center = b2Mul(xf, circle->m_p);
 			float radius = circle->m_radius;
@@ -1052,7 +1688,7 @@ void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color
 
 	case b2Shape::e_edge:
 		{
-			b2EdgeShape* edge = (b2EdgeShape*)fixture->GetShape();
+			const b2EdgeShape* edge = (const b2EdgeShape*)shape;
 			b2Vec2 v1 = b2Mul(xf, edge->m_vertex1);
 			b2Vec2 v2 = b2Mul(xf, edge->m_vertex2);
 			m_debugDraw->DrawSegment(v1, v2, color);
@@ -1061,7 +1697,7 @@ void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color
 
 	case b2Shape::e_chain:
 		{
-			b2ChainShape* chain = (b2ChainShape*)fixture->GetShape();
+			const b2ChainShape* chain = (const b2ChainShape*)shape;
 			int32 count = chain->m_count;
 			const b2Vec2* vertices = chain->m_vertices;
 
@@ -1094,9 +1730,59 @@ void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color
 		}
 		break;
 
+	case b2Shape::e_heightfield:
+		{
+			const b2HeightfieldShape* heightfield = (const b2HeightfieldShape*)shape;
+			int32 cellCount = heightfield->m_count - 1;
+			for (int32 i = 0; i < cellCount; ++i)
+			{
+				if (heightfield->IsHole(i) == false)
+				{
+					b2Vec2 v1 = b2Mul(xf, heightfield->GetVertex(i));
+					b2Vec2 v2 = b2Mul(xf, heightfield->GetVertex(i + 1));
+					m_debugDraw->DrawSegment(v1, v2, color);
+				}
+			}
+		}
+		break;
+
+	case b2Shape::e_capsule:
+		{
+			// Outline the capsule with a half circle around each end.
+			const b2CapsuleShape* capsule = (const b2CapsuleShape*)shape;
+			b2Vec2 v1 = b2Mul(xf, capsule->m_vertex1);
+			b2Vec2 v2 = b2Mul(xf, capsule->m_vertex2);
+			float radius = capsule->m_radius;
+			b2Vec2 axis = v2 - v1;
+			axis.Normalize();
+			b2Vec2 normal(-axis.y, axis.x);
+
+			const int32 k_segments = 8;
+			const float k_increment = b2_pi / k_segments;
+			b2Vec2 vertices[2 * k_segments + 2];
+			int32 vertexCount = 0;
+			for (int32 i = 0; i <= k_segments; ++i)
+			{
+				float angle = i * k_increment;
+				b2Vec2 offset = radius * (cosf(angle) * -normal + sinf(angle) * axis);
+				vertices[vertexCount++] = v2 + offset;
+			}
+
+			for (int32 i = 0; i <= k_segments; ++i)
+			{
+				float angle = i * k_increment;
+				b2Vec2 offset = radius * (cosf(angle) * normal - sinf(angle) * axis);
+				vertices[vertexCount++] = v1 + offset;
+			}
+
+			m_debugDraw->DrawSolidPolygon(vertices, vertexCount, color);
+			m_debugDraw->DrawSegment(v1, v2, color);
+		}
+		break;
+
 	case b2Shape::e_polygon:
 		{
-			b2PolygonShape* poly = (b2PolygonShape*)fixture->GetShape();
+			const b2PolygonShape* poly = (const b2PolygonShape*)shape;
 			int32 vertexCount = poly->m_count;
 			b2Assert(vertexCount <= b2_maxPolygonVertices);
 			b2Vec2 vertices[b2_maxPolygonVertices];
@@ -1109,6 +1795,16 @@ void b2World::DrawShape(b2Fixture* fixture, const b2Transform& xf, const b2Color
 			m_debugDraw->DrawSolidPolygon(vertices, vertexCount, color);
 		}
 		break;
+
+	case b2Shape::e_compound:
+		{
+			const b2CompoundShape* compound = (const b2CompoundShape*)shape;
+			for (int32 i = 0; i < compound->m_count; ++i)
+			{
+				DrawShape(compound->GetChild(i), xf, color);
+			}
+		}
+		break;
             
     default:
         break;
@@ -1183,23 +1879,23 @@ void b2World::DrawDebugData()
 			{
 				if (b->IsActive() == false)
 				{
-					DrawShape(f, xf, b2Color(0.5f, 0.5f, 0.3f));
+					DrawShape(f->GetShape(), xf, b2Color(0.5f, 0.5f, 0.3f));
 				}
 				else if (b->GetType() == b2_staticBody)
 				{
-					DrawShape(f, xf, b2Color(0.5f, 0.9f, 0.5f));
+					DrawShape(f->GetShape(), xf, b2Color(0.5f, 0.9f, 0.5f));
 				}
 				else if (b->GetType() == b2_kinematicBody)
 				{
-					DrawShape(f, xf, b2Color(0.5f, 0.5f, 0.9f));
+					DrawShape(f->GetShape(), xf, b2Color(0.5f, 0.5f, 0.9f));
 				}
 				else if (b->IsAwake() == false)
 				{
-					DrawShape(f, xf, b2Color(0.6f, 0.6f, 0.6f));
+					DrawShape(f->GetShape(), xf, b2Color(0.6f, 0.6f, 0.6f));
 				}
 				else
 				{
-					DrawShape(f, xf, b2Color(0.9f, 0.7f, 0.7f));
+					DrawShape(f->GetShape(), xf, b2Color(0.9f, 0.7f, 0.7f));
 				}
 			}
 		}
@@ -1370,3 +2066,475 @@ void b2World::Dump()
 	b2Log("joints = nullptr;\n");
 	b2Log("bodies = nullptr;\n");
 }
+
+// Snapshot records. These hold the simulation state of each object in list order. Pointers
+// are not stored. Records are zeroed before they are filled so padding bytes are deterministic.
+static const uint32 b2_snapshotMagic = 0x62327332;
+
+struct b2SnapshotHeader
+{
+	uint32 magic;
+	int32 size;
+	int32 bodyCount;
+	int32 fixtureCount;
+	int32 proxyCount;
+	int32 jointCount;
+	int32 contactCount;
+	int32 flags;
+	b2Vec2 gravity;
+	float inv_dt0;
+	bool stepComplete;
+};
+
+struct b2BodySnapshot
+{
+	b2Transform xf;
+	b2Sweep sweep;
+	b2Vec2 linearVelocity;
+	float angularVelocity;
+	b2Vec2 force;
+	float torque;
+	float mass, invMass;
+	float I, invI;
+	float linearDamping;
+	float angularDamping;
+	float gravityScale;
+	float sleepTime;
+	float sleepThreshold;
+	int32 sleepingIsland;
+	int32 fixtureCount;
+	uint16 flags;
+};
+
+struct b2FixtureSnapshot
+{
+	float density;
+	float friction;
+	float restitution;
+	b2Filter filter;
+	int32 proxyCount;
+	bool isSensor;
+};
+
+struct b2ProxySnapshot
+{
+	b2AABB aabb;
+	int32 proxyId;
+};
+
+struct b2ContactSnapshot
+{
+	// Each fixture is identified by the broad-phase proxy of its first child.
+	int32 proxyIdA;
+	int32 proxyIdB;
+	int32 indexA;
+	int32 indexB;
+	uint32 flags;
+	b2Manifold manifold;
+	b2Transform manifoldXf;
+	b2SimplexCache simplexCache;
+	int32 toiCount;
+	float toi;
+	float friction;
+	float restitution;
+	float tangentSpeed;
+};
+
+static inline void b2WriteSnapshot(char*& data, const void* source, int32 size)
+{
+	memcpy(data, source, size);
+	data += size;
+}
+
+static inline void b2ReadSnapshot(const char*& data, void* destination, int32 size)
+{
+	memcpy(destination, data, size);
+	data += size;
+}
+
+int32 b2World::GetSnapshotSize() const
+{
+	int32 size = sizeof(b2SnapshotHeader);
+	size += m_bodyCount * sizeof(b2BodySnapshot);
+
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			size += sizeof(b2FixtureSnapshot) + f->m_proxyCount * sizeof(b2ProxySnapshot);
+		}
+	}
+
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		b2JointStateStream stream(b2JointStateStream::e_measure, nullptr);
+		j->SerializeState(stream);
+		size += sizeof(int32) + stream.GetSize();
+	}
+
+	size += m_contactManager.m_contactCount * sizeof(b2ContactSnapshot);
+	size += m_contactManager.m_broadPhase.GetStateSize();
+	return size;
+}
+
+int32 b2World::SaveSnapshot(void* buffer, int32 capacity) const
+{
+	b2Assert(IsLocked() == false);
+
+	int32 size = GetSnapshotSize();
+	if (size > capacity)
+	{
+		return 0;
+	}
+
+	char* data = (char*)buffer;
+
+	b2SnapshotHeader header;
+	memset((void*)&header, 0, sizeof(header));
+	header.magic = b2_snapshotMagic;
+	header.size = size;
+	header.bodyCount = m_bodyCount;
+	header.fixtureCount = 0;
+	header.proxyCount = m_contactManager.m_broadPhase.GetProxyCount();
+	header.jointCount = m_jointCount;
+	header.contactCount = m_contactManager.m_contactCount;
+	header.flags = m_flags;
+	header.gravity = m_gravity;
+	header.inv_dt0 = m_inv_dt0;
+	header.stepComplete = m_stepComplete;
+
+	// The fixture count is patched once the fixtures are written.
+	char* headerData = data;
+	data += sizeof(b2SnapshotHeader);
+
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		b2BodySnapshot bs;
+		memset((void*)&bs, 0, sizeof(bs));
+		bs.xf = b->m_xf;
+		bs.sweep = b->m_sweep;
+		bs.linearVelocity = b->m_linearVelocity;
+		bs.angularVelocity = b->m_angularVelocity;
+		bs.force = b->m_force;
+		bs.torque = b->m_torque;
+		bs.mass = b->m_mass;
+		bs.invMass = b->m_invMass;
+		bs.I = b->m_I;
+		bs.invI = b->m_invI;
+		bs.linearDamping = b->m_linearDamping;
+		bs.angularDamping = b->m_angularDamping;
+		bs.gravityScale = b->m_gravityScale;
+		bs.sleepTime = b->m_sleepTime;
+		bs.sleepThreshold = b->m_sleepThreshold;
+		bs.sleepingIsland = b->m_sleepingIsland;
+		bs.fixtureCount = b->m_fixtureCount;
+		bs.flags = b->m_flags & ~b2Body::e_islandFlag;
+		b2WriteSnapshot(data, &bs, sizeof(bs));
+
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			b2FixtureSnapshot fs;
+			memset((void*)&fs, 0, sizeof(fs));
+			fs.density = f->m_density;
+			fs.friction = f->m_friction;
+			fs.restitution = f->m_restitution;
+			fs.filter = f->m_filter;
+			fs.proxyCount = f->m_proxyCount;
+			fs.isSensor = f->m_isSensor;
+			b2WriteSnapshot(data, &fs, sizeof(fs));
+
+			for (int32 i = 0; i < f->m_proxyCount; ++i)
+			{
+				b2ProxySnapshot ps;
+				memset((void*)&ps, 0, sizeof(ps));
+				ps.aabb = f->m_proxies[i].aabb;
+				ps.proxyId = f->m_proxies[i].proxyId;
+				b2WriteSnapshot(data, &ps, sizeof(ps));
+			}
+
+			++header.fixtureCount;
+		}
+	}
+
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		int32 type = j->m_type;
+		b2WriteSnapshot(data, &type, sizeof(int32));
+
+		b2JointStateStream stream(b2JointStateStream::e_write, data);
+		j->SerializeState(stream);
+		data += stream.GetSize();
+	}
+
+	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	{
+		b2ContactSnapshot cs;
+		memset((void*)&cs, 0, sizeof(cs));
+		cs.proxyIdA = c->m_fixtureA->m_proxies[0].proxyId;
+		cs.proxyIdB = c->m_fixtureB->m_proxies[0].proxyId;
+		cs.indexA = c->m_indexA;
+		cs.indexB = c->m_indexB;
+		cs.flags = c->m_flags;
+
+		// Points past the point count are stale, so only the live ones are copied.
+		cs.manifold.localNormal = c->m_manifold.localNormal;
+		cs.manifold.localPoint = c->m_manifold.localPoint;
+		cs.manifold.type = c->m_manifold.type;
+		cs.manifold.pointCount = c->m_manifold.pointCount;
+		for (int32 i = 0; i < c->m_manifold.pointCount; ++i)
+		{
+			cs.manifold.points[i] = c->m_manifold.points[i];
+		}
+
+		cs.manifoldXf = c->m_manifoldXf;
+		cs.simplexCache = c->m_simplexCache;
+		cs.toiCount = c->m_toiCount;
+		cs.toi = c->m_toi;
+		cs.friction = c->m_friction;
+		cs.restitution = c->m_restitution;
+		cs.tangentSpeed = c->m_tangentSpeed;
+		b2WriteSnapshot(data, &cs, sizeof(cs));
+	}
+
+	data += m_contactManager.m_broadPhase.SaveState(data);
+
+	memcpy(headerData, &header, sizeof(b2SnapshotHeader));
+
+	b2Assert(data - (char*)buffer == size);
+	return size;
+}
+
+bool b2World::RestoreSnapshot(const void* buffer, int32 size)
+{
+	b2Assert(IsLocked() == false);
+	if (IsLocked() || size < (int32)sizeof(b2SnapshotHeader))
+	{
+		return false;
+	}
+
+	const char* data = (const char*)buffer;
+
+	b2SnapshotHeader header;
+	b2ReadSnapshot(data, &header, sizeof(header));
+
+	if (header.magic != b2_snapshotMagic || header.size != size ||
+		header.bodyCount != m_bodyCount || header.jointCount != m_jointCount ||
+		header.proxyCount != m_contactManager.m_broadPhase.GetProxyCount())
+	{
+		return false;
+	}
+
+	// Validate the structure before changing anything.
+	const char* bodyData = data;
+	int32 fixtureCount = 0;
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		b2BodySnapshot bs;
+		b2ReadSnapshot(data, &bs, sizeof(bs));
+		if (bs.fixtureCount != b->m_fixtureCount)
+		{
+			return false;
+		}
+
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			b2FixtureSnapshot fs;
+			b2ReadSnapshot(data, &fs, sizeof(fs));
+			if (fs.proxyCount != f->m_proxyCount)
+			{
+				return false;
+			}
+
+			for (int32 i = 0; i < f->m_proxyCount; ++i)
+			{
+				b2ProxySnapshot ps;
+				b2ReadSnapshot(data, &ps, sizeof(ps));
+				if (ps.proxyId != f->m_proxies[i].proxyId)
+				{
+					return false;
+				}
+			}
+
+			++fixtureCount;
+		}
+	}
+
+	if (fixtureCount != header.fixtureCount)
+	{
+		return false;
+	}
+
+	const char* jointData = data;
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		int32 type;
+		b2ReadSnapshot(data, &type, sizeof(int32));
+		if (type != j->m_type)
+		{
+			return false;
+		}
+
+		b2JointStateStream stream(b2JointStateStream::e_measure, nullptr);
+		j->SerializeState(stream);
+		data += stream.GetSize();
+	}
+
+	// Contacts come first because destroying a contact may wake its bodies.
+	const char* contactData = data;
+	data += header.contactCount * sizeof(b2ContactSnapshot);
+
+	bool contactsMatch = header.contactCount == m_contactManager.m_contactCount;
+	const char* cursor = contactData;
+	for (b2Contact* c = m_contactManager.m_contactList; c && contactsMatch; c = c->m_next)
+	{
+		b2ContactSnapshot cs;
+		b2ReadSnapshot(cursor, &cs, sizeof(cs));
+		contactsMatch = cs.proxyIdA == c->m_fixtureA->m_proxies[0].proxyId &&
+						cs.proxyIdB == c->m_fixtureB->m_proxies[0].proxyId &&
+						cs.indexA == c->m_indexA && cs.indexB == c->m_indexB;
+	}
+
+	if (contactsMatch == false)
+	{
+		// Destroy all contacts without reporting to the user.
+		b2ContactListener* listener = m_contactManager.m_contactListener;
+		m_contactManager.m_contactListener = nullptr;
+		while (m_contactManager.m_contactList)
+		{
+			m_contactManager.Destroy(m_contactManager.m_contactList);
+		}
+		m_contactManager.m_contactListener = listener;
+
+		// Contacts are pushed at the head of the world and body lists, so
+		// re-create them in reverse to reproduce the saved order.
+		for (int32 i = header.contactCount - 1; i >= 0; --i)
+		{
+			cursor = contactData + i * sizeof(b2ContactSnapshot);
+
+			b2ContactSnapshot cs;
+			b2ReadSnapshot(cursor, &cs, sizeof(cs));
+
+			b2FixtureProxy* proxyA = (b2FixtureProxy*)m_contactManager.m_broadPhase.GetUserData(cs.proxyIdA);
+			b2FixtureProxy* proxyB = (b2FixtureProxy*)m_contactManager.m_broadPhase.GetUserData(cs.proxyIdB);
+			b2Contact* c = b2Contact::Create(proxyA->fixture, cs.indexA, proxyB->fixture, cs.indexB, &m_blockAllocator);
+			b2Assert(c != nullptr && c->m_fixtureA == proxyA->fixture);
+			m_contactManager.Link(c);
+		}
+	}
+
+	cursor = contactData;
+	for (b2Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	{
+		b2ContactSnapshot cs;
+		b2ReadSnapshot(cursor, &cs, sizeof(cs));
+		c->m_flags = cs.flags;
+		c->m_manifold = cs.manifold;
+		c->m_manifoldXf = cs.manifoldXf;
+		c->m_simplexCache = cs.simplexCache;
+		c->m_toiCount = cs.toiCount;
+		c->m_toi = cs.toi;
+		c->m_friction = cs.friction;
+		c->m_restitution = cs.restitution;
+		c->m_tangentSpeed = cs.tangentSpeed;
+	}
+
+	// Release the sleeping islands, they are rebuilt from the saved body records.
+	for (int32 i = 0; i < m_sleepingIslandCapacity; ++i)
+	{
+		m_sleepingIslands[i].bodyList = nullptr;
+		m_sleepingIslands[i].bodyCount = 0;
+	}
+
+	data = bodyData;
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
+	{
+		b2BodySnapshot bs;
+		b2ReadSnapshot(data, &bs, sizeof(bs));
+		b->m_xf = bs.xf;
+		b->m_sweep = bs.sweep;
+		b->m_linearVelocity = bs.linearVelocity;
+		b->m_angularVelocity = bs.angularVelocity;
+		b->m_force = bs.force;
+		b->m_torque = bs.torque;
+		b->m_mass = bs.mass;
+		b->m_invMass = bs.invMass;
+		b->m_I = bs.I;
+		b->m_invI = bs.invI;
+		b->m_linearDamping = bs.linearDamping;
+		b->m_angularDamping = bs.angularDamping;
+		b->m_gravityScale = bs.gravityScale;
+		b->m_sleepTime = bs.sleepTime;
+		b->m_sleepThreshold = bs.sleepThreshold;
+		b->m_flags = bs.flags;
+
+		b->m_sleepingIsland = bs.sleepingIsland;
+		b->m_sleepingNext = nullptr;
+		if (bs.sleepingIsland != b2_nullSleepingIsland)
+		{
+			if (bs.sleepingIsland >= m_sleepingIslandCapacity)
+			{
+				ReserveSleepingIslands(b2Max(2 * m_sleepingIslandCapacity, bs.sleepingIsland + 1));
+			}
+
+			b2SleepingIsland* record = m_sleepingIslands + bs.sleepingIsland;
+			b->m_sleepingNext = record->bodyList;
+			record->bodyList = b;
+			++record->bodyCount;
+		}
+
+		for (b2Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			b2FixtureSnapshot fs;
+			b2ReadSnapshot(data, &fs, sizeof(fs));
+			f->m_density = fs.density;
+			f->m_friction = fs.friction;
+			f->m_restitution = fs.restitution;
+			f->m_filter = fs.filter;
+			f->m_isSensor = fs.isSensor;
+
+			for (int32 i = 0; i < f->m_proxyCount; ++i)
+			{
+				b2ProxySnapshot ps;
+				b2ReadSnapshot(data, &ps, sizeof(ps));
+				f->m_proxies[i].aabb = ps.aabb;
+			}
+		}
+	}
+
+	m_sleepingIslandCount = 0;
+	m_freeSleepingIsland = b2_nullSleepingIsland;
+	for (int32 i = m_sleepingIslandCapacity - 1; i >= 0; --i)
+	{
+		if (m_sleepingIslands[i].bodyList)
+		{
+			m_sleepingIslands[i].next = b2_nullSleepingIsland;
+			++m_sleepingIslandCount;
+		}
+		else
+		{
+			m_sleepingIslands[i].next = m_freeSleepingIsland;
+			m_freeSleepingIsland = i;
+		}
+	}
+
+	data = jointData;
+	for (b2Joint* j = m_jointList; j; j = j->m_next)
+	{
+		data += sizeof(int32);
+
+		b2JointStateStream stream(b2JointStateStream::e_read, const_cast<char*>(data));
+		j->SerializeState(stream);
+		data += stream.GetSize();
+	}
+
+	data = contactData + header.contactCount * sizeof(b2ContactSnapshot);
+	data += m_contactManager.m_broadPhase.RestoreState(data);
+	b2Assert(data - (const char*)buffer == size);
+
+	m_flags = header.flags;
+	m_gravity = header.gravity;
+	m_inv_dt0 = header.inv_dt0;
+	m_stepComplete = header.stepComplete;
+
+	return true;
+}
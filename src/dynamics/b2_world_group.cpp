@@ -0,0 +1,224 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "box2d/b2_world_group.h"
+#include "box2d/b2_stack_allocator.h"
+#include "box2d/b2_task.h"
+#include "box2d/b2_timer.h"
+#include "box2d/b2_world.h"
+
+#include <new>
+#include <string.h>
+
+b2WorldGroup::b2WorldGroup()
+{
+	m_executor = nullptr;
+
+	m_allocators = nullptr;
+	m_allocatorCount = 0;
+
+	m_worldCapacity = 16;
+	m_worldCount = 0;
+	m_worlds = (b2World**)b2Alloc(m_worldCapacity * sizeof(b2World*));
+
+	m_timeStep = 0.0f;
+	m_velocityIterations = 0;
+	m_positionIterations = 0;
+	m_locked = false;
+
+	memset(&m_profile, 0, sizeof(b2Profile));
+	memset(&m_maxProfile, 0, sizeof(b2Profile));
+	m_toiStats.SetZero();
+	m_stepTime = 0.0f;
+
+	CreateAllocators(1);
+}
+
+b2WorldGroup::~b2WorldGroup()
+{
+	b2Assert(m_locked == false);
+	DestroyAllocators();
+	b2Free(m_worlds);
+}
+
+void b2WorldGroup::CreateAllocators(int32 count)
+{
+	b2Assert(count > 0);
+	m_allocatorCount = count;
+	m_allocators = (b2StackAllocator*)b2Alloc(count * sizeof(b2StackAllocator));
+	for (int32 i = 0; i < count; ++i)
+	{
+		new (m_allocators + i) b2StackAllocator;
+	}
+}
+
+void b2WorldGroup::DestroyAllocators()
+{
+	for (int32 i = 0; i < m_allocatorCount; ++i)
+	{
+		m_allocators[i].~b2StackAllocator();
+	}
+	b2Free(m_allocators);
+	m_allocators = nullptr;
+	m_allocatorCount = 0;
+}
+
+void b2WorldGroup::SetTaskExecutor(b2TaskExecutor* executor)
+{
+	b2Assert(m_locked == false);
+	if (m_locked)
+	{
+		return;
+	}
+
+	m_executor = executor;
+
+	int32 count = executor != nullptr ? executor->GetWorkerCount() : 1;
+	b2Assert(count > 0);
+	count = b2Max(count, 1);
+
+	if (count != m_allocatorCount)
+	{
+		DestroyAllocators();
+		CreateAllocators(count);
+	}
+}
+
+void b2WorldGroup::AddWorld(b2World* world)
+{
+	b2Assert(m_locked == false);
+	b2Assert(world != nullptr);
+	if (m_locked)
+	{
+		return;
+	}
+
+	if (m_worldCount == m_worldCapacity)
+	{
+		b2World** oldWorlds = m_worlds;
+		m_worldCapacity *= 2;
+		m_worlds = (b2World**)b2Alloc(m_worldCapacity * sizeof(b2World*));
+		memcpy(m_worlds, oldWorlds, m_worldCount * sizeof(b2World*));
+		b2Free(oldWorlds);
+	}
+
+	m_worlds[m_worldCount] = world;
+	++m_worldCount;
+}
+
+void b2WorldGroup::RemoveWorld(b2World* world)
+{
+	b2Assert(m_locked == false);
+	if (m_locked)
+	{
+		return;
+	}
+
+	for (int32 i = 0; i < m_worldCount; ++i)
+	{
+		if (m_worlds[i] == world)
+		{
+			// Swap with the last world.
+			--m_worldCount;
+			m_worlds[i] = m_worlds[m_worldCount];
+			return;
+		}
+	}
+
+	b2Assert(false);
+}
+
+void b2WorldGroup::StepTask(int32 startIndex, int32 endIndex, int32 workerIndex, void* context)
+{
+	b2WorldGroup* group = (b2WorldGroup*)context;
+	b2Assert(0 <= workerIndex && workerIndex < group->m_allocatorCount);
+	b2StackAllocator* allocator = group->m_allocators + workerIndex;
+
+	for (int32 i = startIndex; i < endIndex; ++i)
+	{
+		b2World* world = group->m_worlds[i];
+		world->m_scratchAllocator = allocator;
+		world->Step(group->m_timeStep, group->m_velocityIterations, group->m_positionIterations);
+		world->m_scratchAllocator = &world->m_stackAllocator;
+	}
+}
+
+void b2WorldGroup::Step(float timeStep, int32 velocityIterations, int32 positionIterations)
+{
+	b2Assert(m_locked == false);
+
+	b2Timer timer;
+
+	m_timeStep = timeStep;
+	m_velocityIterations = velocityIterations;
+	m_positionIterations = positionIterations;
+
+	m_locked = true;
+
+	// Worlds are coarse grained, so each one may be a task of its own.
+	b2ParallelFor(m_executor, StepTask, this, m_worldCount, 1);
+
+	m_locked = false;
+
+	memset(&m_profile, 0, sizeof(b2Profile));
+	memset(&m_maxProfile, 0, sizeof(b2Profile));
+	m_toiStats.SetZero();
+	for (int32 i = 0; i < m_worldCount; ++i)
+	{
+		const b2Profile& p = m_worlds[i]->GetProfile();
+
+		m_profile.step += p.step;
+		m_profile.collide += p.collide;
+		m_profile.solve += p.solve;
+		m_profile.solveInit += p.solveInit;
+		m_profile.solveVelocity += p.solveVelocity;
+		m_profile.solvePosition += p.solvePosition;
+		m_profile.broadphase += p.broadphase;
+		m_profile.solveTOI += p.solveTOI;
+		m_profile.solveRope += p.solveRope;
+		m_profile.islandCount += p.islandCount;
+		m_profile.velocityIterations += p.velocityIterations;
+		m_profile.maxVelocityIterations = b2Max(m_profile.maxVelocityIterations, p.maxVelocityIterations);
+		m_profile.contactCacheHits += p.contactCacheHits;
+		m_profile.contactCacheMisses += p.contactCacheMisses;
+
+		m_maxProfile.step = b2Max(m_maxProfile.step, p.step);
+		m_maxProfile.collide = b2Max(m_maxProfile.collide, p.collide);
+		m_maxProfile.solve = b2Max(m_maxProfile.solve, p.solve);
+		m_maxProfile.solveInit = b2Max(m_maxProfile.solveInit, p.solveInit);
+		m_maxProfile.solveVelocity = b2Max(m_maxProfile.solveVelocity, p.solveVelocity);
+		m_maxProfile.solvePosition = b2Max(m_maxProfile.solvePosition, p.solvePosition);
+		m_maxProfile.broadphase = b2Max(m_maxProfile.broadphase, p.broadphase);
+		m_maxProfile.solveTOI = b2Max(m_maxProfile.solveTOI, p.solveTOI);
+		m_maxProfile.solveRope = b2Max(m_maxProfile.solveRope, p.solveRope);
+		m_maxProfile.islandCount = b2Max(m_maxProfile.islandCount, p.islandCount);
+		m_maxProfile.velocityIterations = b2Max(m_maxProfile.velocityIterations, p.velocityIterations);
+		m_maxProfile.maxVelocityIterations = b2Max(m_maxProfile.maxVelocityIterations, p.maxVelocityIterations);
+		m_maxProfile.contactCacheHits = b2Max(m_maxProfile.contactCacheHits, p.contactCacheHits);
+		m_maxProfile.contactCacheMisses = b2Max(m_maxProfile.contactCacheMisses, p.contactCacheMisses);
+
+		m_toiStats.Combine(m_worlds[i]->GetTOIStats());
+	}
+
+	m_stepTime = timer.GetMilliseconds();
+}
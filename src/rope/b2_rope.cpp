@@ -20,6 +20,8 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include "b2_rope_solver.h"
+
 #include "box2d/b2_draw.h"
 #include "box2d/b2_rope.h"
 
@@ -33,6 +35,7 @@ b2Rope::b2Rope()
 	m_ims = nullptr;
 	m_Ls = nullptr;
 	m_as = nullptr;
+	m_bendingLambdas = nullptr;
 	m_gravity.SetZero();
 }
 
@@ -58,55 +61,33 @@ void b2Rope::Initialize(const b2RopeDef* def)
 	m_vs = (b2Vec2*)b2Alloc(m_count * sizeof(b2Vec2));
 	m_ims = (float*)b2Alloc(m_count * sizeof(float));
 
-	for (int32 i = 0; i < m_count; ++i)
-	{
-		m_bindPositions[i] = def->vertices[i];
-		m_ps[i] = def->vertices[i];
-		m_p0s[i] = def->vertices[i];
-		m_vs[i].SetZero();
-
-		float m = def->masses[i];
-		if (m > 0.0f)
-		{
-			m_ims[i] = 1.0f / m;
-		}
-		else
-		{
-			m_ims[i] = 0.0f;
-		}
-	}
-
 	m_stretchCount = m_count - 1;
 	m_bendCount = m_count - 2;
 	m_Ls = (float*)b2Alloc(m_stretchCount * sizeof(float));
 	m_as = (float*)b2Alloc(m_bendCount * sizeof(float));
 	m_bendingLambdas = (float*)b2Alloc(m_bendCount * sizeof(float));
 
-	for (int32 i = 0; i < m_stretchCount; ++i)
-	{
-		b2Vec2 p1 = m_ps[i];
-		b2Vec2 p2 = m_ps[i+1];
-		m_Ls[i] = b2Distance(p1, p2);
-	}
-
-	for (int32 i = 0; i < m_bendCount; ++i)
-	{
-		b2Vec2 p1 = m_ps[i];
-		b2Vec2 p2 = m_ps[i + 1];
-		b2Vec2 p3 = m_ps[i + 2];
-
-		b2Vec2 d1 = p2 - p1;
-		b2Vec2 d2 = p3 - p2;
-
-		float a = b2Cross(d1, d2);
-		float b = b2Dot(d1, d2);
-
-		m_as[i] = b2Atan2(a, b);
-		m_bendingLambdas[i] = 0.0f;
-	}
+	b2RopeData rope = GetData();
+	b2InitializeRope(&rope, def);
+	m_gravity = rope.gravity;
+	m_tuning = rope.tuning;
+}
 
-	m_gravity = def->gravity;
-	m_tuning = def->tuning;
+b2RopeData b2Rope::GetData() const
+{
+	b2RopeData rope;
+	rope.count = m_count;
+	rope.bindPositions = m_bindPositions;
+	rope.ps = m_ps;
+	rope.p0s = m_p0s;
+	rope.vs = m_vs;
+	rope.ims = m_ims;
+	rope.Ls = m_Ls;
+	rope.as = m_as;
+	rope.bendingLambdas = m_bendingLambdas;
+	rope.gravity = m_gravity;
+	rope.tuning = m_tuning;
+	return rope;
 }
 
 void b2Rope::SetTuning(const b2RopeTuning& tuning)
@@ -116,77 +97,87 @@ void b2Rope::SetTuning(const b2RopeTuning& tuning)
 
 void b2Rope::Step(float dt, int32 iterations, const b2Vec2& position)
 {
-	if (dt == 0.0)
+	b2RopeData rope = GetData();
+	b2StepRope(&rope, dt, iterations, position);
+}
+
+void b2Rope::SetAngle(float angle)
+{
+	for (int32 i = 0; i < m_bendCount; ++i)
 	{
-		return;
+		m_as[i] = angle;
 	}
+}
 
-	const float inv_dt = 1.0f / dt;
-	float d = expf(- dt * m_tuning.damping);
+void b2Rope::Draw(b2Draw* draw) const
+{
+	b2RopeData rope = GetData();
+	b2DrawRope(&rope, draw);
+}
+
+void b2InitializeRope(b2RopeData* rope, const b2RopeDef* def)
+{
+	b2Assert(def->count == rope->count);
 
-	for (int32 i = 0; i < m_count; ++i)
+	for (int32 i = 0; i < rope->count; ++i)
 	{
-		if (m_ims[i] > 0.0f)
+		rope->bindPositions[i] = def->vertices[i];
+		rope->ps[i] = def->vertices[i];
+		rope->p0s[i] = def->vertices[i];
+		rope->vs[i].SetZero();
+
+		float m = def->masses[i];
+		if (m > 0.0f)
 		{
-			m_vs[i] += dt * m_gravity;
-			m_vs[i] *= d;
+			rope->ims[i] = 1.0f / m;
 		}
 		else
 		{
-			m_vs[i] = inv_dt * (m_bindPositions[i] + position - m_p0s[i]);
+			rope->ims[i] = 0.0f;
 		}
 	}
 
-	if (m_tuning.bendingModel == b2_forceAngleBendingModel)
+	for (int32 i = 0; i < rope->count - 1; ++i)
 	{
-		ApplyBendForces(dt);
+		b2Vec2 p1 = rope->ps[i];
+		b2Vec2 p2 = rope->ps[i+1];
+		rope->Ls[i] = b2Distance(p1, p2);
 	}
 
-	for (int32 i = 0; i < m_count; ++i)
+	for (int32 i = 0; i < rope->count - 2; ++i)
 	{
-		m_ps[i] += dt * m_vs[i];
-	}
+		b2Vec2 p1 = rope->ps[i];
+		b2Vec2 p2 = rope->ps[i + 1];
+		b2Vec2 p3 = rope->ps[i + 2];
 
-	for (int32 i = 0; i < m_bendCount; ++i)
-	{
-		m_bendingLambdas[i] = 0.0f;
-	}
+		b2Vec2 d1 = p2 - p1;
+		b2Vec2 d2 = p3 - p2;
 
-	for (int32 i = 0; i < iterations; ++i)
-	{
-		if (m_tuning.bendingModel == b2_pbdAngleBendingModel)
-		{
-			SolveBend_PBD_Angle();
-		}
-		else if (m_tuning.bendingModel == b2_xpbdAngleBendingModel)
-		{
-			SolveBend_XPBD_Angle(dt);
-		}
+		float a = b2Cross(d1, d2);
+		float b = b2Dot(d1, d2);
 
-		SolveStretch();
+		rope->as[i] = b2Atan2(a, b);
+		rope->bendingLambdas[i] = 0.0f;
 	}
 
-	for (int32 i = 0; i < m_count; ++i)
-	{
-		m_vs[i] = inv_dt * (m_ps[i] - m_p0s[i]);
-		m_p0s[i] = m_ps[i];
-	}
+	rope->gravity = def->gravity;
+	rope->tuning = def->tuning;
 }
 
-void b2Rope::SolveStretch()
+static void b2SolveStretch(b2RopeData* rope)
 {
-	const float k2 = m_tuning.stretchStiffness;
+	const float k2 = rope->tuning.stretchStiffness;
 
-	for (int32 i = 0; i < m_stretchCount; ++i)
+	for (int32 i = 0; i < rope->count - 1; ++i)
 	{
-		b2Vec2 p1 = m_ps[i];
-		b2Vec2 p2 = m_ps[i + 1];
+		b2Vec2 p1 = rope->ps[i];
+		b2Vec2 p2 = rope->ps[i + 1];
 
 		b2Vec2 d = p2 - p1;
 		float L = d.Normalize();
 
-		float im1 = m_ims[i];
-		float im2 = m_ims[i + 1];
+		float im1 = rope->ims[i];
+		float im2 = rope->ims[i + 1];
 
 		if (im1 + im2 == 0.0f)
 		{
@@ -196,35 +187,27 @@ void b2Rope::SolveStretch()
 		float s1 = im1 / (im1 + im2);
 		float s2 = im2 / (im1 + im2);
 
-		p1 -= k2 * s1 * (m_Ls[i] - L) * d;
-		p2 += k2 * s2 * (m_Ls[i] - L) * d;
+		p1 -= k2 * s1 * (rope->Ls[i] - L) * d;
+		p2 += k2 * s2 * (rope->Ls[i] - L) * d;
 
-		m_ps[i] = p1;
-		m_ps[i + 1] = p2;
+		rope->ps[i] = p1;
+		rope->ps[i + 1] = p2;
 	}
 }
 
-void b2Rope::SetAngle(float angle)
-{
-	for (int32 i = 0; i < m_bendCount; ++i)
-	{
-		m_as[i] = angle;
-	}
-}
-
-void b2Rope::SolveBend_PBD_Angle()
+static void b2SolveBend_PBD_Angle(b2RopeData* rope)
 {
-	const float k3 = m_tuning.bendStiffness;
+	const float k3 = rope->tuning.bendStiffness;
 
-	for (int32 i = 0; i < m_bendCount; ++i)
+	for (int32 i = 0; i < rope->count - 2; ++i)
 	{
-		b2Vec2 p1 = m_ps[i];
-		b2Vec2 p2 = m_ps[i + 1];
-		b2Vec2 p3 = m_ps[i + 2];
+		b2Vec2 p1 = rope->ps[i];
+		b2Vec2 p2 = rope->ps[i + 1];
+		b2Vec2 p3 = rope->ps[i + 2];
 
-		float m1 = m_ims[i];
-		float m2 = m_ims[i + 1];
-		float m3 = m_ims[i + 2];
+		float m1 = rope->ims[i];
+		float m2 = rope->ims[i + 1];
+		float m3 = rope->ims[i + 2];
 
 		b2Vec2 d1 = p2 - p1;
 		b2Vec2 d2 = p3 - p2;
@@ -257,18 +240,18 @@ void b2Rope::SolveBend_PBD_Angle()
 
 		mass = 1.0f / mass;
 
-		float C = angle - m_as[i];
+		float C = angle - rope->as[i];
 
 		while (C > b2_pi)
 		{
 			angle -= 2 * b2_pi;
-			C = angle - m_as[i];
+			C = angle - rope->as[i];
 		}
 
 		while (C < -b2_pi)
 		{
 			angle += 2.0f * b2_pi;
-			C = angle - m_as[i];
+			C = angle - rope->as[i];
 		}
 
 		float impulse = - k3 * mass * C;
@@ -277,29 +260,29 @@ void b2Rope::SolveBend_PBD_Angle()
 		p2 += (m2 * impulse) * J2;
 		p3 += (m3 * impulse) * J3;
 
-		m_ps[i] = p1;
-		m_ps[i + 1] = p2;
-		m_ps[i + 2] = p3;
+		rope->ps[i] = p1;
+		rope->ps[i + 1] = p2;
+		rope->ps[i + 2] = p3;
 	}
 }
 
-void b2Rope::SolveBend_XPBD_Angle(float dt)
+static void b2SolveBend_XPBD_Angle(b2RopeData* rope, float dt)
 {
 	b2Assert(dt > 0.0f);
 
-	for (int32 i = 0; i < m_bendCount; ++i)
+	for (int32 i = 0; i < rope->count - 2; ++i)
 	{
-		b2Vec2 p1 = m_ps[i];
-		b2Vec2 p2 = m_ps[i + 1];
-		b2Vec2 p3 = m_ps[i + 2];
+		b2Vec2 p1 = rope->ps[i];
+		b2Vec2 p2 = rope->ps[i + 1];
+		b2Vec2 p3 = rope->ps[i + 2];
 
-		b2Vec2 v1 = m_vs[i];
-		b2Vec2 v2 = m_vs[i + 1];
-		b2Vec2 v3 = m_vs[i + 2];
+		b2Vec2 v1 = rope->vs[i];
+		b2Vec2 v2 = rope->vs[i + 1];
+		b2Vec2 v3 = rope->vs[i + 2];
 
-		float m1 = m_ims[i];
-		float m2 = m_ims[i + 1];
-		float m3 = m_ims[i + 2];
+		float m1 = rope->ims[i];
+		float m2 = rope->ims[i + 1];
+		float m3 = rope->ims[i + 2];
 
 		b2Vec2 d1 = p2 - p1;
 		b2Vec2 d2 = p3 - p2;
@@ -324,7 +307,7 @@ void b2Rope::SolveBend_XPBD_Angle(float dt)
 		b2Vec2 J2 = Jd1 - Jd2;
 		b2Vec2 J3 = Jd2;
 
-		float lambda = m_bendingLambdas[i];
+		float lambda = rope->bendingLambdas[i];
 
 		float W = m1 * b2Dot(J1, J1) + m2 * b2Dot(J2, J2) + m3 * b2Dot(J3, J3);
 		if (W == 0.0f)
@@ -335,23 +318,23 @@ void b2Rope::SolveBend_XPBD_Angle(float dt)
 		float meff = 1.0f / W;
 
 		// omega = 2 * pi * hz
-		float omega = 2.0f * b2_pi * m_tuning.bendHertz;
+		float omega = 2.0f * b2_pi * rope->tuning.bendHertz;
 		const float spring = meff * omega * omega;
-		const float damper = 2.0f * meff * m_tuning.bendDamping * omega;
+		const float damper = 2.0f * meff * rope->tuning.bendDamping * omega;
 
 		const float alpha = 1.0f / (spring * dt * dt);
 		const float beta = dt * dt * damper;
-		float C = angle - m_as[i];
+		float C = angle - rope->as[i];
 		while (C > b2_pi)
 		{
 			angle -= 2 * b2_pi;
-			C = angle - m_as[i];
+			C = angle - rope->as[i];
 		}
 
 		while (C < -b2_pi)
 		{
 			angle += 2.0f * b2_pi;
-			C = angle - m_as[i];
+			C = angle - rope->as[i];
 		}
 
 		float Cdot = b2Dot(J1, v1) + b2Dot(J2, v2) + b2Dot(J3, v3);
@@ -365,32 +348,32 @@ void b2Rope::SolveBend_XPBD_Angle(float dt)
 		p3 += (m3 * impulse) * J3;
 		lambda += impulse;
 
-		m_ps[i] = p1;
-		m_ps[i + 1] = p2;
-		m_ps[i + 2] = p3;
-		m_bendingLambdas[i] = lambda;
+		rope->ps[i] = p1;
+		rope->ps[i + 1] = p2;
+		rope->ps[i + 2] = p3;
+		rope->bendingLambdas[i] = lambda;
 	}
 }
 
-void b2Rope::ApplyBendForces(float dt)
+static void b2ApplyBendForces(b2RopeData* rope, float dt)
 {
-	int32 count3 = m_count - 2;
-	const float stiffness = m_tuning.bendStiffness;
-	const float damping = m_tuning.bendDamping;
+	int32 count3 = rope->count - 2;
+	const float stiffness = rope->tuning.bendStiffness;
+	const float damping = rope->tuning.bendDamping;
 
 	for (int32 i = 0; i < count3; ++i)
 	{
-		b2Vec2 p1 = m_ps[i];
-		b2Vec2 p2 = m_ps[i + 1];
-		b2Vec2 p3 = m_ps[i + 2];
+		b2Vec2 p1 = rope->ps[i];
+		b2Vec2 p2 = rope->ps[i + 1];
+		b2Vec2 p3 = rope->ps[i + 2];
 
-		b2Vec2 v1 = m_vs[i];
-		b2Vec2 v2 = m_vs[i + 1];
-		b2Vec2 v3 = m_vs[i + 2];
+		b2Vec2 v1 = rope->vs[i];
+		b2Vec2 v2 = rope->vs[i + 1];
+		b2Vec2 v3 = rope->vs[i + 2];
 
-		float m1 = m_ims[i];
-		float m2 = m_ims[i + 1];
-		float m3 = m_ims[i + 2];
+		float m1 = rope->ims[i];
+		float m2 = rope->ims[i + 1];
+		float m3 = rope->ims[i + 2];
 
 		b2Vec2 d1 = p2 - p1;
 		b2Vec2 d2 = p3 - p2;
@@ -424,47 +407,123 @@ void b2Rope::ApplyBendForces(float dt)
 		float meff = 1.0f / W;
 
 		// omega = 2 * pi * hz
-		float omega = 2.0f * b2_pi * m_tuning.bendHertz;
+		float omega = 2.0f * b2_pi * rope->tuning.bendHertz;
 		const float spring = meff * omega * omega;
-		const float damper = 2.0f * meff * m_tuning.bendDamping * omega;
+		const float damper = 2.0f * meff * rope->tuning.bendDamping * omega;
 
-		float C = angle - m_as[i];
+		float C = angle - rope->as[i];
 		float Cdot = b2Dot(J1, v1) + b2Dot(J2, v2) + b2Dot(J3, v3);
 
 		while (C > b2_pi)
 		{
 			angle -= 2 * b2_pi;
-			C = angle - m_as[i];
+			C = angle - rope->as[i];
 		}
 
 		while (C < -b2_pi)
 		{
 			angle += 2.0f * b2_pi;
-			C = angle - m_as[i];
+			C = angle - rope->as[i];
 		}
 
 		float impulse = -dt * (spring * C + damper * Cdot);
 
-		m_vs[i + 0] += (m1 * impulse) * J1;
-		m_vs[i + 1] += (m2 * impulse) * J2;
-		m_vs[i + 2] += (m3 * impulse) * J3;
+		rope->vs[i + 0] += (m1 * impulse) * J1;
+		rope->vs[i + 1] += (m2 * impulse) * J2;
+		rope->vs[i + 2] += (m3 * impulse) * J3;
 	}
 }
 
-void b2Rope::Draw(b2Draw* draw) const
+void b2IntegrateRope(b2RopeData* rope, float dt, const b2Vec2& position)
+{
+	const float inv_dt = 1.0f / dt;
+	float d = expf(- dt * rope->tuning.damping);
+
+	for (int32 i = 0; i < rope->count; ++i)
+	{
+		if (rope->ims[i] > 0.0f)
+		{
+			rope->vs[i] += dt * rope->gravity;
+			rope->vs[i] *= d;
+		}
+		else
+		{
+			rope->vs[i] = inv_dt * (rope->bindPositions[i] + position - rope->p0s[i]);
+		}
+	}
+
+	if (rope->tuning.bendingModel == b2_forceAngleBendingModel)
+	{
+		b2ApplyBendForces(rope, dt);
+	}
+
+	for (int32 i = 0; i < rope->count; ++i)
+	{
+		rope->ps[i] += dt * rope->vs[i];
+	}
+
+	for (int32 i = 0; i < rope->count - 2; ++i)
+	{
+		rope->bendingLambdas[i] = 0.0f;
+	}
+}
+
+void b2SolveRope(b2RopeData* rope, float dt)
+{
+	if (rope->tuning.bendingModel == b2_pbdAngleBendingModel)
+	{
+		b2SolveBend_PBD_Angle(rope);
+	}
+	else if (rope->tuning.bendingModel == b2_xpbdAngleBendingModel)
+	{
+		b2SolveBend_XPBD_Angle(rope, dt);
+	}
+
+	b2SolveStretch(rope);
+}
+
+void b2FinishRope(b2RopeData* rope, float dt)
+{
+	const float inv_dt = 1.0f / dt;
+
+	for (int32 i = 0; i < rope->count; ++i)
+	{
+		rope->vs[i] = inv_dt * (rope->ps[i] - rope->p0s[i]);
+		rope->p0s[i] = rope->ps[i];
+	}
+}
+
+void b2StepRope(b2RopeData* rope, float dt, int32 iterations, const b2Vec2& position)
+{
+	if (dt == 0.0)
+	{
+		return;
+	}
+
+	b2IntegrateRope(rope, dt, position);
+
+	for (int32 i = 0; i < iterations; ++i)
+	{
+		b2SolveRope(rope, dt);
+	}
+
+	b2FinishRope(rope, dt);
+}
+
+void b2DrawRope(const b2RopeData* rope, b2Draw* draw)
 {
 	b2Color c(0.4f, 0.5f, 0.7f);
 	b2Color pg(0.1f, 0.8f, 0.1f);
 	b2Color pd(0.7f, 0.2f, 0.4f);
 
-	for (int32 i = 0; i < m_count - 1; ++i)
+	for (int32 i = 0; i < rope->count - 1; ++i)
 	{
-		draw->DrawSegment(m_ps[i], m_ps[i+1], c);
+		draw->DrawSegment(rope->ps[i], rope->ps[i+1], c);
 
-		const b2Color& pc = m_ims[i] > 0.0f ? pd : pg;
-		draw->DrawPoint(m_ps[i], 5.0f, pc);
+		const b2Color& pc = rope->ims[i] > 0.0f ? pd : pg;
+		draw->DrawPoint(rope->ps[i], 5.0f, pc);
 	}
 
-	const b2Color& pc = m_ims[m_count - 1] > 0.0f ? pd : pg;
-	draw->DrawPoint(m_ps[m_count - 1], 5.0f, pc);
+	const b2Color& pc = rope->ims[rope->count - 1] > 0.0f ? pd : pg;
+	draw->DrawPoint(rope->ps[rope->count - 1], 5.0f, pc);
 }
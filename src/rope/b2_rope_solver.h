@@ -0,0 +1,68 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef B2_ROPE_SOLVER_H
+#define B2_ROPE_SOLVER_H
+
+#include "box2d/b2_rope.h"
+
+class b2Draw;
+
+// The state of one rope. b2Rope points this at its own arrays and b2RopeSystem points it into
+// the pooled arrays. The stretch constraint i joins vertices i and i + 1 and the bend
+// constraint i spans vertices i, i + 1 and i + 2.
+struct b2RopeData
+{
+	int32 count;
+
+	b2Vec2* bindPositions;
+	b2Vec2* ps;
+	b2Vec2* p0s;
+	b2Vec2* vs;
+
+	float* ims;
+
+	float* Ls;
+	float* as;
+	float* bendingLambdas;
+
+	b2Vec2 gravity;
+	b2RopeTuning tuning;
+};
+
+// Fill the rope state from a definition. The arrays must already hold def->count elements.
+void b2InitializeRope(b2RopeData* rope, const b2RopeDef* def);
+
+// Advance the rope. Vertices with zero mass follow their bind positions offset by position.
+void b2StepRope(b2RopeData* rope, float dt, int32 iterations, const b2Vec2& position);
+
+// The stages of b2StepRope, so other constraints can be solved between the rope iterations.
+// Integrate predicts the positions, each solve call runs one iteration of the bend and
+// stretch constraints and finish derives the velocities. The start positions stay in p0s
+// until finish.
+void b2IntegrateRope(b2RopeData* rope, float dt, const b2Vec2& position);
+void b2SolveRope(b2RopeData* rope, float dt);
+void b2FinishRope(b2RopeData* rope, float dt);
+
+void b2DrawRope(const b2RopeData* rope, b2Draw* draw);
+
+#endif
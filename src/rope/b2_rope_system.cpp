@@ -0,0 +1,850 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "b2_rope_solver.h"
+
+#include "box2d/b2_body.h"
+#include "box2d/b2_chain_shape.h"
+#include "box2d/b2_collision.h"
+#include "box2d/b2_compound_shape.h"
+#include "box2d/b2_distance.h"
+#include "box2d/b2_fixture.h"
+#include "box2d/b2_heightfield_shape.h"
+#include "box2d/b2_rope_system.h"
+#include "box2d/b2_task.h"
+#include "box2d/b2_world.h"
+
+#include <string.h>
+
+// A rope in the pooled arrays. Free slots have a count of zero and form a list through next.
+struct b2RopeSlot
+{
+	int32 vertexStart;
+	int32 count;
+	b2Vec2 position;
+	b2Vec2 gravity;
+	b2RopeTuning tuning;
+	int32 next;
+
+	float radius;
+	float friction;
+	uint16 categoryBits;
+	uint16 maskBits;
+
+	// Constraint ranges of the coupled step.
+	int32 contactStart;
+	int32 contactCount;
+	int32 attachmentStart;
+	int32 attachmentCount;
+};
+
+// A vertex pinned to a body anchor. Free attachments have a null body.
+struct b2RopeAttachment
+{
+	int32 ropeId;
+	int32 vertexIndex;
+	b2Body* body;
+	b2Vec2 localAnchor;
+	int32 next;
+
+	// Solver temporaries. The body does not move while the rope is solved, so the anchor
+	// is shifted by the displacement the accumulated impulse would give the body.
+	b2Vec2 anchor;
+	b2Vec2 center;
+	b2Vec2 offset;
+	b2Vec2 lambda;
+	float invMass;
+	float invI;
+};
+
+// A vertex touching a fixture, linearized as a plane at the start of the step.
+struct b2RopeContact
+{
+	int32 vertex;
+	b2Body* body;
+	b2Vec2 point;
+	b2Vec2 normal;
+	b2Vec2 surfaceMotion;
+	float invMass;
+	float friction;
+
+	// Solver temporaries.
+	float offset;
+	float normalLambda;
+	float tangentLambda;
+};
+
+b2RopeSystem::b2RopeSystem()
+{
+	m_slots = nullptr;
+	m_slotCapacity = 0;
+	m_freeSlot = -1;
+	m_ropeCount = 0;
+
+	m_bindPositions = nullptr;
+	m_ps = nullptr;
+	m_p0s = nullptr;
+	m_vs = nullptr;
+	m_ims = nullptr;
+	m_Ls = nullptr;
+	m_as = nullptr;
+	m_bendingLambdas = nullptr;
+	m_vertexCount = 0;
+	m_vertexCapacity = 0;
+
+	m_attachments = nullptr;
+	m_attachmentCapacity = 0;
+	m_freeAttachment = -1;
+
+	m_attachmentOrder = nullptr;
+	m_attachmentOrderCapacity = 0;
+
+	m_contacts = nullptr;
+	m_contactCount = 0;
+	m_contactCapacity = 0;
+
+	m_executor = nullptr;
+
+	m_stepTime = 0.0f;
+	m_stepIterations = 0;
+}
+
+b2RopeSystem::~b2RopeSystem()
+{
+	b2Free(m_slots);
+	b2Free(m_bindPositions);
+	b2Free(m_ps);
+	b2Free(m_p0s);
+	b2Free(m_vs);
+	b2Free(m_ims);
+	b2Free(m_Ls);
+	b2Free(m_as);
+	b2Free(m_bendingLambdas);
+	b2Free(m_attachments);
+	b2Free(m_attachmentOrder);
+	b2Free(m_contacts);
+}
+
+template <typename T>
+static T* b2GrowArray(T* array, int32 count, int32 capacity)
+{
+	T* newArray = (T*)b2Alloc(capacity * sizeof(T));
+	if (array)
+	{
+		memcpy(newArray, array, count * sizeof(T));
+		b2Free(array);
+	}
+	return newArray;
+}
+
+void b2RopeSystem::ReserveVertices(int32 capacity)
+{
+	if (capacity <= m_vertexCapacity)
+	{
+		return;
+	}
+
+	capacity = b2Max(capacity, 2 * m_vertexCapacity);
+	m_bindPositions = b2GrowArray(m_bindPositions, m_vertexCount, capacity);
+	m_ps = b2GrowArray(m_ps, m_vertexCount, capacity);
+	m_p0s = b2GrowArray(m_p0s, m_vertexCount, capacity);
+	m_vs = b2GrowArray(m_vs, m_vertexCount, capacity);
+	m_ims = b2GrowArray(m_ims, m_vertexCount, capacity);
+	m_Ls = b2GrowArray(m_Ls, m_vertexCount, capacity);
+	m_as = b2GrowArray(m_as, m_vertexCount, capacity);
+	m_bendingLambdas = b2GrowArray(m_bendingLambdas, m_vertexCount, capacity);
+	m_vertexCapacity = capacity;
+}
+
+b2RopeData b2RopeSystem::GetData(int32 ropeId) const
+{
+	b2Assert(0 <= ropeId && ropeId < m_slotCapacity);
+	const b2RopeSlot* slot = m_slots + ropeId;
+	b2Assert(slot->count > 0);
+
+	int32 start = slot->vertexStart;
+
+	b2RopeData rope;
+	rope.count = slot->count;
+	rope.bindPositions = m_bindPositions + start;
+	rope.ps = m_ps + start;
+	rope.p0s = m_p0s + start;
+	rope.vs = m_vs + start;
+	rope.ims = m_ims + start;
+	rope.Ls = m_Ls + start;
+	rope.as = m_as + start;
+	rope.bendingLambdas = m_bendingLambdas + start;
+	rope.gravity = slot->gravity;
+	rope.tuning = slot->tuning;
+	return rope;
+}
+
+int32 b2RopeSystem::CreateRope(const b2RopeDef* def)
+{
+	b2Assert(def->count >= 3);
+
+	if (m_freeSlot == -1)
+	{
+		int32 oldCapacity = m_slotCapacity;
+		m_slotCapacity = b2Max(2 * m_slotCapacity, 16);
+		m_slots = b2GrowArray(m_slots, oldCapacity, m_slotCapacity);
+		for (int32 i = m_slotCapacity - 1; i >= oldCapacity; --i)
+		{
+			m_slots[i].count = 0;
+			m_slots[i].next = m_freeSlot;
+			m_freeSlot = i;
+		}
+	}
+
+	ReserveVertices(m_vertexCount + def->count);
+
+	int32 ropeId = m_freeSlot;
+	b2RopeSlot* slot = m_slots + ropeId;
+	m_freeSlot = slot->next;
+
+	slot->vertexStart = m_vertexCount;
+	slot->count = def->count;
+	slot->position.SetZero();
+	slot->next = -1;
+	slot->radius = def->radius;
+	slot->friction = def->friction;
+	slot->categoryBits = def->categoryBits;
+	slot->maskBits = def->maskBits;
+	slot->contactStart = 0;
+	slot->contactCount = 0;
+	slot->attachmentStart = 0;
+	slot->attachmentCount = 0;
+	m_vertexCount += def->count;
+	++m_ropeCount;
+
+	b2RopeData rope = GetData(ropeId);
+	b2InitializeRope(&rope, def);
+	slot->gravity = rope.gravity;
+	slot->tuning = rope.tuning;
+
+	return ropeId;
+}
+
+void b2RopeSystem::DestroyRope(int32 ropeId)
+{
+	b2Assert(0 <= ropeId && ropeId < m_slotCapacity);
+	b2RopeSlot* slot = m_slots + ropeId;
+	b2Assert(slot->count > 0);
+
+	for (int32 i = 0; i < m_attachmentCapacity; ++i)
+	{
+		if (m_attachments[i].body != nullptr && m_attachments[i].ropeId == ropeId)
+		{
+			DestroyAttachment(i);
+		}
+	}
+
+	// Close the gap in the pooled arrays.
+	int32 start = slot->vertexStart;
+	int32 count = slot->count;
+	int32 tail = m_vertexCount - (start + count);
+	memmove(m_bindPositions + start, m_bindPositions + start + count, tail * sizeof(b2Vec2));
+	memmove(m_ps + start, m_ps + start + count, tail * sizeof(b2Vec2));
+	memmove(m_p0s + start, m_p0s + start + count, tail * sizeof(b2Vec2));
+	memmove(m_vs + start, m_vs + start + count, tail * sizeof(b2Vec2));
+	memmove(m_ims + start, m_ims + start + count, tail * sizeof(float));
+	memmove(m_Ls + start, m_Ls + start + count, tail * sizeof(float));
+	memmove(m_as + start, m_as + start + count, tail * sizeof(float));
+	memmove(m_bendingLambdas + start, m_bendingLambdas + start + count, tail * sizeof(float));
+	m_vertexCount -= count;
+
+	for (int32 i = 0; i < m_slotCapacity; ++i)
+	{
+		if (m_slots[i].count > 0 && m_slots[i].vertexStart > start)
+		{
+			m_slots[i].vertexStart -= count;
+		}
+	}
+
+	slot->count = 0;
+	slot->next = m_freeSlot;
+	m_freeSlot = ropeId;
+	--m_ropeCount;
+}
+
+int32 b2RopeSystem::CreateAttachment(int32 ropeId, int32 vertexIndex, b2Body* body, const b2Vec2& localAnchor)
+{
+	b2Assert(0 <= ropeId && ropeId < m_slotCapacity && m_slots[ropeId].count > 0);
+	b2Assert(0 <= vertexIndex && vertexIndex < m_slots[ropeId].count);
+	b2Assert(body != nullptr);
+
+	if (m_freeAttachment == -1)
+	{
+		int32 oldCapacity = m_attachmentCapacity;
+		m_attachmentCapacity = b2Max(2 * m_attachmentCapacity, 16);
+		m_attachments = b2GrowArray(m_attachments, oldCapacity, m_attachmentCapacity);
+		for (int32 i = m_attachmentCapacity - 1; i >= oldCapacity; --i)
+		{
+			m_attachments[i].body = nullptr;
+			m_attachments[i].next = m_freeAttachment;
+			m_freeAttachment = i;
+		}
+	}
+
+	int32 attachmentId = m_freeAttachment;
+	b2RopeAttachment* attachment = m_attachments + attachmentId;
+	m_freeAttachment = attachment->next;
+
+	attachment->ropeId = ropeId;
+	attachment->vertexIndex = vertexIndex;
+	attachment->body = body;
+	attachment->localAnchor = localAnchor;
+	attachment->next = -1;
+	return attachmentId;
+}
+
+void b2RopeSystem::DestroyAttachment(int32 attachmentId)
+{
+	b2Assert(0 <= attachmentId && attachmentId < m_attachmentCapacity);
+	b2RopeAttachment* attachment = m_attachments + attachmentId;
+	b2Assert(attachment->body != nullptr);
+
+	attachment->body = nullptr;
+	attachment->next = m_freeAttachment;
+	m_freeAttachment = attachmentId;
+}
+
+void b2RopeSystem::DestroyAttachments(b2Body* body)
+{
+	for (int32 i = 0; i < m_attachmentCapacity; ++i)
+	{
+		if (m_attachments[i].body == body)
+		{
+			DestroyAttachment(i);
+		}
+	}
+}
+
+void b2RopeSystem::SetTuning(int32 ropeId, const b2RopeTuning& tuning)
+{
+	b2Assert(0 <= ropeId && ropeId < m_slotCapacity && m_slots[ropeId].count > 0);
+	m_slots[ropeId].tuning = tuning;
+}
+
+void b2RopeSystem::SetPosition(int32 ropeId, const b2Vec2& position)
+{
+	b2Assert(0 <= ropeId && ropeId < m_slotCapacity && m_slots[ropeId].count > 0);
+	m_slots[ropeId].position = position;
+}
+
+void b2RopeSystem::SetAngle(int32 ropeId, float angle)
+{
+	b2RopeData rope = GetData(ropeId);
+	for (int32 i = 0; i < rope.count - 2; ++i)
+	{
+		rope.as[i] = angle;
+	}
+}
+
+int32 b2RopeSystem::GetVertexCount(int32 ropeId) const
+{
+	b2Assert(0 <= ropeId && ropeId < m_slotCapacity);
+	return m_slots[ropeId].count;
+}
+
+const b2Vec2* b2RopeSystem::GetVertices(int32 ropeId) const
+{
+	b2Assert(0 <= ropeId && ropeId < m_slotCapacity && m_slots[ropeId].count > 0);
+	return m_ps + m_slots[ropeId].vertexStart;
+}
+
+void b2RopeSystem::StepTask(int32 startIndex, int32 endIndex, int32 workerIndex, void* context)
+{
+	B2_NOT_USED(workerIndex);
+
+	b2RopeSystem* system = (b2RopeSystem*)context;
+	for (int32 i = startIndex; i < endIndex; ++i)
+	{
+		const b2RopeSlot* slot = system->m_slots + i;
+		if (slot->count == 0)
+		{
+			continue;
+		}
+
+		b2RopeData rope = system->GetData(i);
+		b2StepRope(&rope, system->m_stepTime, system->m_stepIterations, slot->position);
+	}
+}
+
+void b2RopeSystem::Step(float timeStep, int32 iterations)
+{
+	m_stepTime = timeStep;
+	m_stepIterations = iterations;
+
+	// Ropes are short, so give each task enough of them to amortize the dispatch.
+	b2ParallelFor(m_executor, StepTask, this, m_slotCapacity, 64);
+}
+
+void b2RopeSystem::Draw(b2Draw* draw) const
+{
+	for (int32 i = 0; i < m_slotCapacity; ++i)
+	{
+		if (m_slots[i].count > 0)
+		{
+			b2RopeData rope = GetData(i);
+			b2DrawRope(&rope, draw);
+		}
+	}
+}
+
+// Coupled step. The rigid bodies have already been solved for this step. The ropes are
+// integrated, then each rope solves its own constraints together with its attachments and
+// fixture contacts, treating the bodies as fixed but tracking how far the accumulated
+// impulses would move them. The impulses are applied to the bodies at the end, so they act
+// on the bodies in the next step.
+void b2RopeSystem::StepCoupled(b2World* world, float timeStep, int32 iterations)
+{
+	m_contactCount = 0;
+
+	if (m_ropeCount == 0 || timeStep == 0.0f)
+	{
+		return;
+	}
+
+	m_stepTime = timeStep;
+	m_stepIterations = iterations;
+
+	b2ParallelFor(m_executor, IntegrateTask, this, m_slotCapacity, 64);
+
+	// Tree queries and shape distances read the world, so the contacts are gathered on the
+	// calling thread.
+	for (int32 i = 0; i < m_slotCapacity; ++i)
+	{
+		m_slots[i].contactStart = m_contactCount;
+		m_slots[i].contactCount = 0;
+		if (m_slots[i].count > 0 && m_slots[i].radius > 0.0f)
+		{
+			FindContacts(world, i);
+		}
+	}
+
+	PrepareAttachments();
+
+	b2ParallelFor(m_executor, SolveTask, this, m_slotCapacity, 64);
+
+	ApplyImpulses();
+}
+
+void b2RopeSystem::IntegrateTask(int32 startIndex, int32 endIndex, int32 workerIndex, void* context)
+{
+	B2_NOT_USED(workerIndex);
+
+	b2RopeSystem* system = (b2RopeSystem*)context;
+	for (int32 i = startIndex; i < endIndex; ++i)
+	{
+		const b2RopeSlot* slot = system->m_slots + i;
+		if (slot->count == 0)
+		{
+			continue;
+		}
+
+		b2RopeData rope = system->GetData(i);
+		b2IntegrateRope(&rope, system->m_stepTime, slot->position);
+	}
+}
+
+void b2RopeSystem::SolveTask(int32 startIndex, int32 endIndex, int32 workerIndex, void* context)
+{
+	B2_NOT_USED(workerIndex);
+
+	b2RopeSystem* system = (b2RopeSystem*)context;
+	for (int32 i = startIndex; i < endIndex; ++i)
+	{
+		if (system->m_slots[i].count > 0)
+		{
+			system->SolveConstraints(i);
+		}
+	}
+}
+
+// Collects the proxies overlapping a rope with one tree query per rope.
+struct b2RopeQueryCallback
+{
+	bool QueryCallback(int32 proxyId)
+	{
+		if (count == capacity)
+		{
+			capacity = b2Max(2 * capacity, 32);
+			proxies = b2GrowArray(proxies, count, capacity);
+		}
+
+		proxies[count++] = (b2FixtureProxy*)broadPhase->GetUserData(proxyId);
+		return true;
+	}
+
+	const b2BroadPhase* broadPhase;
+	b2FixtureProxy** proxies;
+	int32 count;
+	int32 capacity;
+};
+
+// Collects the children found by a chain tree or heightfield query.
+struct b2RopeChildCallback
+{
+	bool QueryCallback(int32 childIndex)
+	{
+		if (count == capacity)
+		{
+			capacity = b2Max(2 * capacity, 32);
+			children = b2GrowArray(children, count, capacity);
+		}
+
+		children[count++] = childIndex;
+		return true;
+	}
+
+	int32* children;
+	int32 count;
+	int32 capacity;
+};
+
+void b2RopeSystem::FindContacts(b2World* world, int32 ropeId)
+{
+	b2RopeSlot* slot = m_slots + ropeId;
+	b2RopeData rope = GetData(ropeId);
+	float radius = slot->radius;
+
+	// The vertex AABBs cover the start and predicted positions.
+	b2Vec2 r(radius + b2_linearSlop, radius + b2_linearSlop);
+	b2AABB ropeAABB;
+	ropeAABB.lowerBound = b2Min(rope.p0s[0], rope.ps[0]) - r;
+	ropeAABB.upperBound = b2Max(rope.p0s[0], rope.ps[0]) + r;
+	for (int32 i = 1; i < rope.count; ++i)
+	{
+		ropeAABB.lowerBound = b2Min(ropeAABB.lowerBound, b2Min(rope.p0s[i], rope.ps[i]) - r);
+		ropeAABB.upperBound = b2Max(ropeAABB.upperBound, b2Max(rope.p0s[i], rope.ps[i]) + r);
+	}
+
+	b2RopeQueryCallback callback;
+	callback.broadPhase = &world->GetContactManager().m_broadPhase;
+	callback.proxies = nullptr;
+	callback.count = 0;
+	callback.capacity = 0;
+	callback.broadPhase->Query(&callback, ropeAABB);
+
+	b2RopeChildCallback childCallback;
+	childCallback.children = nullptr;
+	childCallback.capacity = 0;
+
+	for (int32 j = 0; j < callback.count; ++j)
+	{
+		const b2FixtureProxy* proxy = callback.proxies[j];
+		b2Fixture* fixture = proxy->fixture;
+		const b2Filter& filter = fixture->GetFilterData();
+		if (fixture->IsSensor() || (filter.categoryBits & slot->maskBits) == 0 || (filter.maskBits & slot->categoryBits) == 0)
+		{
+			continue;
+		}
+
+		const b2Shape* shape = fixture->GetShape();
+		bool chainTree = shape->GetType() == b2Shape::e_chain && ((const b2ChainShape*)shape)->HasTree();
+		if (chainTree || shape->GetType() == b2Shape::e_heightfield || shape->GetType() == b2Shape::e_compound)
+		{
+			// The proxy covers the whole shape, so find the children with a shape query.
+			const b2Transform& xf = fixture->GetBody()->GetTransform();
+			childCallback.count = 0;
+			if (chainTree)
+			{
+				((const b2ChainShape*)shape)->QueryTree(&childCallback, b2MulT(xf, ropeAABB));
+			}
+			else if (shape->GetType() == b2Shape::e_heightfield)
+			{
+				((const b2HeightfieldShape*)shape)->QueryCells(&childCallback, b2MulT(xf, ropeAABB));
+			}
+			else
+			{
+				((const b2CompoundShape*)shape)->QueryTree(&childCallback, b2MulT(xf, ropeAABB));
+			}
+
+			for (int32 k = 0; k < childCallback.count; ++k)
+			{
+				b2AABB childAABB;
+				shape->ComputeAABB(&childAABB, xf, childCallback.children[k]);
+				AddContacts(ropeId, fixture, childCallback.children[k], childAABB);
+			}
+		}
+		else
+		{
+			AddContacts(ropeId, fixture, proxy->childIndex, proxy->aabb);
+		}
+	}
+
+	b2Free(childCallback.children);
+	b2Free(callback.proxies);
+}
+
+void b2RopeSystem::AddContacts(int32 ropeId, b2Fixture* fixture, int32 childIndex, const b2AABB& childAABB)
+{
+	b2RopeSlot* slot = m_slots + ropeId;
+	b2RopeData rope = GetData(ropeId);
+	b2Vec2 r(slot->radius + b2_linearSlop, slot->radius + b2_linearSlop);
+
+	b2Body* body = fixture->GetBody();
+	const b2Transform& xf = body->GetTransform();
+
+	b2DistanceInput input;
+	input.proxyB.Set(fixture->GetShape(), childIndex);
+	input.transformA.SetIdentity();
+	input.transformB = xf;
+	input.useRadii = false;
+
+	float invMass = 0.0f;
+	float invI = 0.0f;
+	if (body->GetType() == b2_dynamicBody)
+	{
+		invMass = 1.0f / body->GetMass();
+		float I = body->GetInertia() - body->GetMass() * b2Dot(body->GetLocalCenter(), body->GetLocalCenter());
+		invI = I > 0.0f ? 1.0f / I : 0.0f;
+	}
+
+	for (int32 i = 0; i < rope.count; ++i)
+	{
+		if (rope.ims[i] == 0.0f)
+		{
+			continue;
+		}
+
+		b2AABB vertexAABB;
+		vertexAABB.lowerBound = b2Min(rope.p0s[i], rope.ps[i]) - r;
+		vertexAABB.upperBound = b2Max(rope.p0s[i], rope.ps[i]) + r;
+		if (b2TestOverlap(vertexAABB, childAABB) == false)
+		{
+			continue;
+		}
+
+		// Linearize the shape at the start position. A vertex that starts inside the
+		// core shape has no usable normal and is skipped.
+		input.proxyA.Set(rope.p0s + i, 1, 0.0f);
+		b2SimplexCache cache;
+		cache.count = 0;
+		b2DistanceOutput output;
+		b2Distance(&output, &cache, &input);
+		if (output.distance < b2_epsilon)
+		{
+			continue;
+		}
+
+		if (m_contactCount == m_contactCapacity)
+		{
+			int32 oldCapacity = m_contactCapacity;
+			m_contactCapacity = b2Max(2 * m_contactCapacity, 64);
+			m_contacts = b2GrowArray(m_contacts, oldCapacity, m_contactCapacity);
+		}
+
+		b2RopeContact* contact = m_contacts + m_contactCount;
+		contact->vertex = slot->vertexStart + i;
+		contact->body = body;
+		contact->normal = (1.0f / output.distance) * (output.pointA - output.pointB);
+		contact->point = output.pointB + input.proxyB.m_radius * contact->normal;
+		contact->surfaceMotion = m_stepTime * body->GetLinearVelocityFromWorldPoint(contact->point);
+		float rn = b2Cross(contact->point - body->GetWorldCenter(), contact->normal);
+		contact->invMass = invMass + invI * rn * rn;
+		contact->friction = b2Sqrt(slot->friction * fixture->GetFriction());
+		contact->offset = 0.0f;
+		contact->normalLambda = 0.0f;
+		contact->tangentLambda = 0.0f;
+		++m_contactCount;
+		++slot->contactCount;
+	}
+}
+
+void b2RopeSystem::PrepareAttachments()
+{
+	for (int32 i = 0; i < m_slotCapacity; ++i)
+	{
+		m_slots[i].attachmentStart = 0;
+		m_slots[i].attachmentCount = 0;
+	}
+
+	int32 attachmentCount = 0;
+	for (int32 i = 0; i < m_attachmentCapacity; ++i)
+	{
+		if (m_attachments[i].body != nullptr)
+		{
+			m_slots[m_attachments[i].ropeId].attachmentCount += 1;
+			++attachmentCount;
+		}
+	}
+
+	if (attachmentCount == 0)
+	{
+		return;
+	}
+
+	if (attachmentCount > m_attachmentOrderCapacity)
+	{
+		b2Free(m_attachmentOrder);
+		m_attachmentOrderCapacity = m_attachmentCapacity;
+		m_attachmentOrder = (int32*)b2Alloc(m_attachmentOrderCapacity * sizeof(int32));
+	}
+
+	int32 start = 0;
+	for (int32 i = 0; i < m_slotCapacity; ++i)
+	{
+		m_slots[i].attachmentStart = start;
+		start += m_slots[i].attachmentCount;
+		m_slots[i].attachmentCount = 0;
+	}
+
+	for (int32 i = 0; i < m_attachmentCapacity; ++i)
+	{
+		b2RopeAttachment* attachment = m_attachments + i;
+		b2Body* body = attachment->body;
+		if (body == nullptr)
+		{
+			continue;
+		}
+
+		b2RopeSlot* slot = m_slots + attachment->ropeId;
+		m_attachmentOrder[slot->attachmentStart + slot->attachmentCount] = i;
+		slot->attachmentCount += 1;
+
+		attachment->anchor = body->GetWorldPoint(attachment->localAnchor);
+		attachment->center = body->GetWorldCenter();
+		attachment->offset.SetZero();
+		attachment->lambda.SetZero();
+		attachment->invMass = 0.0f;
+		attachment->invI = 0.0f;
+		if (body->GetType() == b2_dynamicBody)
+		{
+			attachment->invMass = 1.0f / body->GetMass();
+			float I = body->GetInertia() - body->GetMass() * b2Dot(body->GetLocalCenter(), body->GetLocalCenter());
+			attachment->invI = I > 0.0f ? 1.0f / I : 0.0f;
+		}
+	}
+}
+
+void b2RopeSystem::SolveConstraints(int32 ropeId)
+{
+	const b2RopeSlot* slot = m_slots + ropeId;
+	b2RopeData rope = GetData(ropeId);
+	float dt = m_stepTime;
+	float radius = slot->radius;
+
+	for (int32 iteration = 0; iteration < m_stepIterations; ++iteration)
+	{
+		b2SolveRope(&rope, dt);
+
+		for (int32 i = 0; i < slot->attachmentCount; ++i)
+		{
+			b2RopeAttachment* attachment = m_attachments + m_attachmentOrder[slot->attachmentStart + i];
+			b2Vec2& p = rope.ps[attachment->vertexIndex];
+			float wp = rope.ims[attachment->vertexIndex];
+
+			b2Vec2 d = p - (attachment->anchor + attachment->offset);
+			float C = d.Normalize();
+			if (C < b2_epsilon)
+			{
+				continue;
+			}
+
+			float rn = b2Cross(attachment->anchor - attachment->center, d);
+			float wb = attachment->invMass + attachment->invI * rn * rn;
+			if (wp + wb == 0.0f)
+			{
+				continue;
+			}
+
+			float lambda = C / (wp + wb);
+			p -= (wp * lambda) * d;
+			attachment->offset += (wb * lambda) * d;
+			attachment->lambda += lambda * d;
+		}
+
+		for (int32 i = 0; i < slot->contactCount; ++i)
+		{
+			b2RopeContact* contact = m_contacts + slot->contactStart + i;
+			int32 index = contact->vertex - slot->vertexStart;
+			b2Vec2& p = rope.ps[index];
+			float wp = rope.ims[index];
+			float w = wp + contact->invMass;
+			if (w == 0.0f)
+			{
+				continue;
+			}
+
+			b2Vec2 n = contact->normal;
+			float C = b2Dot(p - contact->point, n) - contact->offset - radius;
+			if (C < 0.0f)
+			{
+				float lambda = -C / w;
+				p += (wp * lambda) * n;
+				contact->offset -= contact->invMass * lambda;
+				contact->normalLambda += lambda;
+			}
+
+			if (contact->normalLambda == 0.0f)
+			{
+				continue;
+			}
+
+			// Positional friction removes the slip relative to the surface, bounded by the
+			// accumulated normal correction.
+			b2Vec2 t = b2Cross(n, 1.0f);
+			float slip = b2Dot(p - rope.p0s[index] - contact->surfaceMotion, t);
+			float maxLambda = contact->friction * contact->normalLambda;
+			float oldLambda = contact->tangentLambda;
+			contact->tangentLambda = b2Clamp(oldLambda - slip / w, -maxLambda, maxLambda);
+			p += (wp * (contact->tangentLambda - oldLambda)) * t;
+		}
+	}
+
+	b2FinishRope(&rope, dt);
+}
+
+// Positional corrections become impulses on the bodies. The rope pulls attached bodies
+// awake but contacts leave sleeping bodies alone.
+void b2RopeSystem::ApplyImpulses()
+{
+	float inv_dt = 1.0f / m_stepTime;
+
+	for (int32 i = 0; i < m_slotCapacity; ++i)
+	{
+		const b2RopeSlot* slot = m_slots + i;
+		for (int32 j = 0; j < slot->attachmentCount; ++j)
+		{
+			const b2RopeAttachment* attachment = m_attachments + m_attachmentOrder[slot->attachmentStart + j];
+			if (attachment->invMass > 0.0f && attachment->lambda.LengthSquared() > 0.0f)
+			{
+				attachment->body->ApplyLinearImpulse(inv_dt * attachment->lambda, attachment->anchor, true);
+			}
+		}
+	}
+
+	for (int32 i = 0; i < m_contactCount; ++i)
+	{
+		const b2RopeContact* contact = m_contacts + i;
+		if (contact->invMass == 0.0f || contact->normalLambda == 0.0f)
+		{
+			continue;
+		}
+
+		b2Vec2 t = b2Cross(contact->normal, 1.0f);
+		b2Vec2 impulse = -inv_dt * (contact->normalLambda * contact->normal + contact->tangentLambda * t);
+		contact->body->ApplyLinearImpulse(impulse, contact->point, false);
+	}
+}
@@ -0,0 +1,200 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "box2d/box2d.h"
+#include "test_check.h"
+
+#include <math.h>
+
+// A saw tooth terrain so a horizontal ray crosses many segments.
+static void CreateSawTooth(b2ChainShape* chain, bool tree)
+{
+	b2Vec2 vertices[41];
+	for (int32 i = 0; i < 41; ++i)
+	{
+		vertices[i].Set(-20.0f + float(i), (i & 1) ? 1.0f : -1.0f);
+	}
+
+	chain->CreateChain(vertices, 41);
+	if (tree)
+	{
+		chain->CreateTree();
+	}
+}
+
+class RayCastCounter : public b2RayCastCallback
+{
+public:
+	RayCastCounter(float answer) : m_answer(answer), m_count(0), m_fraction(1.0f) {}
+
+	float ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float fraction) override
+	{
+		B2_NOT_USED(fixture);
+		B2_NOT_USED(point);
+		B2_NOT_USED(normal);
+		++m_count;
+		m_fraction = b2Min(m_fraction, fraction);
+		return m_answer < 0.0f ? fraction : m_answer;
+	}
+
+	float m_answer;
+	int32 m_count;
+	float m_fraction;
+};
+
+// A chain with a segment tree reports the same ray hits as a chain with a proxy per segment.
+static int TestRayCast()
+{
+	for (int32 pass = 0; pass < 3; ++pass)
+	{
+		// Continue through every hit, clip to each hit, or stop at the first hit.
+		float answer = pass == 0 ? 1.0f : (pass == 1 ? -1.0f : 0.0f);
+
+		b2World plainWorld(b2Vec2(0.0f, -10.0f));
+		b2World treeWorld(b2Vec2(0.0f, -10.0f));
+
+		b2BodyDef bd;
+		b2ChainShape plain, tree;
+		CreateSawTooth(&plain, false);
+		CreateSawTooth(&tree, true);
+		plainWorld.CreateBody(&bd)->CreateFixture(&plain, 0.0f);
+		treeWorld.CreateBody(&bd)->CreateFixture(&tree, 0.0f);
+
+		b2Vec2 p1(-25.0f, 0.0f), p2(25.0f, 0.0f);
+		RayCastCounter plainCounter(answer), treeCounter(answer);
+		plainWorld.RayCast(&plainCounter, p1, p2);
+		treeWorld.RayCast(&treeCounter, p1, p2);
+
+		if (pass == 2)
+		{
+			// The order of the hits is not defined, so only the count is known.
+			CHECK(plainCounter.m_count == 1);
+			CHECK(treeCounter.m_count == 1);
+			continue;
+		}
+
+		if (pass == 0)
+		{
+			CHECK(plainCounter.m_count == 40);
+			CHECK(treeCounter.m_count == 40);
+		}
+
+		// The closest hit is on the first segment, half way up its slope.
+		CHECK(treeCounter.m_fraction == plainCounter.m_fraction);
+		CHECK(b2Abs(treeCounter.m_fraction - 5.5f / 50.0f) < 1.0e-5f);
+	}
+
+	return 0;
+}
+
+// A spinning ring keeps nearly the same AABB, so its proxy never leaves its fat AABB while the
+// segments under a resting ball change. Every segment that reaches the ball must get a contact.
+static int TestMovingChain()
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+
+	b2BodyDef bd;
+	bd.type = b2_kinematicBody;
+	b2Body* ring = world.CreateBody(&bd);
+
+	b2Vec2 vertices[64];
+	for (int32 i = 0; i < 64; ++i)
+	{
+		float angle = 2.0f * b2_pi * float(i) / 64.0f;
+		vertices[i].Set(5.0f * cosf(angle), 5.0f * sinf(angle));
+	}
+
+	b2ChainShape chain;
+	chain.CreateLoop(vertices, 64);
+	chain.CreateTree();
+
+	b2FixtureDef fd;
+	fd.shape = &chain;
+	fd.friction = 0.0f;
+	b2Fixture* ringFixture = ring->CreateFixture(&fd);
+
+	bd.type = b2_dynamicBody;
+	bd.position.Set(0.0f, -4.4f);
+	b2Body* ball = world.CreateBody(&bd);
+
+	b2CircleShape circle;
+	circle.m_radius = 0.5f;
+	fd.shape = &circle;
+	fd.density = 1.0f;
+	ball->CreateFixture(&fd);
+
+	for (int32 i = 0; i < 30; ++i)
+	{
+		world.Step(1.0f / 60.0f, 8, 3);
+	}
+
+	ring->SetAngularVelocity(2.0f);
+	for (int32 step = 0; step < 120; ++step)
+	{
+		world.Step(1.0f / 60.0f, 8, 3);
+
+		b2AABB ballAABB;
+		circle.ComputeAABB(&ballAABB, ball->GetTransform(), 0);
+
+		for (int32 i = 0; i < 64; ++i)
+		{
+			b2AABB segmentAABB;
+			chain.ComputeAABB(&segmentAABB, ring->GetTransform(), i);
+			if (b2TestOverlap(segmentAABB, ballAABB) == false)
+			{
+				continue;
+			}
+
+			bool found = false;
+			for (b2ContactEdge* ce = ball->GetContactList(); ce; ce = ce->next)
+			{
+				b2Contact* contact = ce->contact;
+				found = found || (contact->GetFixtureA() == ringFixture && contact->GetChildIndexA() == i);
+			}
+
+			CHECK(found);
+		}
+	}
+
+	// The ball stays at the bottom of the ring.
+	CHECK(ball->GetPosition().y < -4.4f && ball->GetPosition().y > -4.55f);
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	B2_NOT_USED(argc);
+	B2_NOT_USED(argv);
+
+	int failures = 0;
+	failures += TestRayCast();
+	failures += TestMovingChain();
+
+	if (failures > 0)
+	{
+		printf("chain_test: %d failed\n", failures);
+		return 1;
+	}
+
+	printf("chain_test: passed\n");
+	return 0;
+}
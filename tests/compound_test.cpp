@@ -0,0 +1,152 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "box2d/box2d.h"
+#include "test_check.h"
+
+// Three boxes in a row that make a plank, in the body frame.
+static void CreateBoxes(b2PolygonShape boxes[3])
+{
+	for (int32 i = 0; i < 3; ++i)
+	{
+		boxes[i].SetAsBox(0.5f, 0.25f, b2Vec2(float(i - 1), 0.0f), 0.0f);
+	}
+}
+
+static b2Body* CreatePlank(b2World* world, const b2Vec2& position, bool compound)
+{
+	b2BodyDef bd;
+	bd.type = b2_dynamicBody;
+	bd.position = position;
+	b2Body* body = world->CreateBody(&bd);
+
+	b2PolygonShape boxes[3];
+	CreateBoxes(boxes);
+
+	if (compound)
+	{
+		const b2Shape* shapes[3] = { boxes + 0, boxes + 1, boxes + 2 };
+		b2CompoundShape shape;
+		shape.Create(shapes, 3);
+		body->CreateFixture(&shape, 1.0f);
+	}
+	else
+	{
+		for (int32 i = 0; i < 3; ++i)
+		{
+			body->CreateFixture(boxes + i, 1.0f);
+		}
+	}
+
+	return body;
+}
+
+// A compound rests like the same shapes attached as separate fixtures.
+static int TestResting()
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+
+	b2BodyDef bd;
+	b2Body* ground = world.CreateBody(&bd);
+	b2EdgeShape edge;
+	edge.Set(b2Vec2(-20.0f, 0.0f), b2Vec2(20.0f, 0.0f));
+	ground->CreateFixture(&edge, 0.0f);
+
+	b2Body* compound = CreatePlank(&world, b2Vec2(-5.0f, 1.0f), true);
+	b2Body* separate = CreatePlank(&world, b2Vec2(5.0f, 1.0f), false);
+
+	CHECK(b2Abs(compound->GetMass() - separate->GetMass()) < 1.0e-5f);
+	CHECK(b2Abs(compound->GetInertia() - separate->GetInertia()) < 1.0e-4f);
+
+	for (int32 i = 0; i < 180; ++i)
+	{
+		world.Step(1.0f / 60.0f, 8, 3);
+	}
+
+	b2Vec2 offset = compound->GetPosition() - separate->GetPosition();
+	CHECK(b2Abs(offset.x + 10.0f) < 1.0e-3f);
+	CHECK(b2Abs(offset.y) < 1.0e-3f);
+	CHECK(b2Abs(compound->GetAngle() - separate->GetAngle()) < 1.0e-3f);
+
+	// Both rest on the ground at the half height of the boxes plus the skins of the polygon and
+	// the edge, less the allowed penetration.
+	float restingHeight = 0.25f + 2.0f * b2_polygonRadius - b2_linearSlop;
+	CHECK(b2Abs(compound->GetPosition().y - restingHeight) < 1.0e-3f);
+	CHECK(compound->GetLinearVelocity().Length() < 1.0e-3f);
+	CHECK(separate->GetLinearVelocity().Length() < 1.0e-3f);
+	return 0;
+}
+
+class RayCastCounter : public b2RayCastCallback
+{
+public:
+	RayCastCounter() : m_count(0), m_fraction(1.0f) {}
+
+	float ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float fraction) override
+	{
+		B2_NOT_USED(fixture);
+		B2_NOT_USED(point);
+		B2_NOT_USED(normal);
+		++m_count;
+		m_fraction = b2Min(m_fraction, fraction);
+		return 1.0f;
+	}
+
+	int32 m_count;
+	float m_fraction;
+};
+
+// A ray through a compound reports each child it hits, like separate fixtures.
+static int TestRayCast()
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+	CreatePlank(&world, b2Vec2(-5.0f, 0.0f), true);
+	CreatePlank(&world, b2Vec2(5.0f, 0.0f), false);
+
+	RayCastCounter compound, separate;
+	world.RayCast(&compound, b2Vec2(-9.0f, 0.1f), b2Vec2(-1.0f, 0.1f));
+	world.RayCast(&separate, b2Vec2(1.0f, 0.1f), b2Vec2(9.0f, 0.1f));
+
+	CHECK(compound.m_count == 3);
+	CHECK(separate.m_count == 3);
+	CHECK(b2Abs(compound.m_fraction - separate.m_fraction) < 1.0e-6f);
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	B2_NOT_USED(argc);
+	B2_NOT_USED(argv);
+
+	int failures = 0;
+	failures += TestResting();
+	failures += TestRayCast();
+
+	if (failures > 0)
+	{
+		printf("compound_test: %d failed\n", failures);
+		return 1;
+	}
+
+	printf("compound_test: passed\n");
+	return 0;
+}
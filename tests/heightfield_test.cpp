@@ -0,0 +1,108 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "box2d/box2d.h"
+#include "test_check.h"
+
+class RayCastCounter : public b2RayCastCallback
+{
+public:
+	RayCastCounter() : m_count(0), m_fraction(1.0f) {}
+
+	float ReportFixture(b2Fixture* fixture, const b2Vec2& point, const b2Vec2& normal, float fraction) override
+	{
+		B2_NOT_USED(fixture);
+		B2_NOT_USED(point);
+		B2_NOT_USED(normal);
+		++m_count;
+		m_fraction = b2Min(m_fraction, fraction);
+		return 1.0f;
+	}
+
+	int32 m_count;
+	float m_fraction;
+};
+
+// Rays that only touch an end of the heightfield stay inside its cells.
+static int TestRayCastEdges()
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+
+	// Four samples one meter apart, flat at y = 1.
+	int16 heights[4] = { 10, 10, 10, 10 };
+	b2HeightfieldShape shape;
+	shape.Create(heights, 4, 1.0f, 0.1f);
+
+	b2BodyDef bd;
+	b2Body* ground = world.CreateBody(&bd);
+	ground->CreateFixture(&shape, 0.0f);
+
+	// Straight down the right end.
+	RayCastCounter right;
+	world.RayCast(&right, b2Vec2(3.0f, 10.0f), b2Vec2(3.0f, -10.0f));
+	CHECK(right.m_count == 1);
+	CHECK(b2Abs(right.m_fraction - 0.45f) < 1.0e-4f);
+
+	// Leftward from the right end.
+	RayCastCounter leftward;
+	world.RayCast(&leftward, b2Vec2(3.0f, 2.0f), b2Vec2(0.0f, 0.0f));
+	CHECK(leftward.m_count == 1);
+	CHECK(b2Abs(leftward.m_fraction - 0.5f) < 1.0e-4f);
+
+	// Straight down the left end.
+	RayCastCounter left;
+	world.RayCast(&left, b2Vec2(0.0f, 10.0f), b2Vec2(0.0f, -10.0f));
+	CHECK(left.m_count == 1);
+
+	// Beyond the right end.
+	RayCastCounter miss;
+	world.RayCast(&miss, b2Vec2(3.5f, 10.0f), b2Vec2(3.5f, -10.0f));
+	CHECK(miss.m_count == 0);
+
+	// The first hit cast works at the edge too.
+	b2RayCastInput input;
+	input.p1.Set(3.0f, 10.0f);
+	input.p2.Set(3.0f, -10.0f);
+	input.maxFraction = 1.0f;
+	b2RayCastOutput output;
+	CHECK(shape.RayCastCells(&output, input, ground->GetTransform()));
+	CHECK(b2Abs(output.fraction - 0.45f) < 1.0e-4f);
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	B2_NOT_USED(argc);
+	B2_NOT_USED(argv);
+
+	int failures = 0;
+	failures += TestRayCastEdges();
+
+	if (failures > 0)
+	{
+		printf("heightfield_test: %d failed\n", failures);
+		return 1;
+	}
+
+	printf("heightfield_test: passed\n");
+	return 0;
+}
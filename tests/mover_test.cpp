@@ -0,0 +1,193 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "box2d/box2d.h"
+#include "test_check.h"
+
+// Flat ground with a low step at x = 2 and a high wall at x = 12.
+static void CreateGround(b2World* world)
+{
+	b2BodyDef bd;
+	b2Body* ground = world->CreateBody(&bd);
+
+	b2Vec2 vertices[] =
+	{
+		b2Vec2(-20.0f, 0.0f), b2Vec2(2.0f, 0.0f), b2Vec2(2.0f, 0.2f),
+		b2Vec2(12.0f, 0.2f), b2Vec2(12.0f, 2.0f), b2Vec2(20.0f, 2.0f)
+	};
+
+	b2ChainShape chain;
+	chain.CreateChain(vertices, 6);
+	ground->CreateFixture(&chain, 0.0f);
+}
+
+static void CreateCapsule(b2CapsuleShape* capsule)
+{
+	capsule->m_vertex1.Set(0.0f, -0.4f);
+	capsule->m_vertex2.Set(0.0f, 0.4f);
+	capsule->m_radius = 0.3f;
+}
+
+// Walk with gravity, keeping the fall speed only while in the air.
+static void Walk(b2CharacterMover* mover, float speed, int32 moveCount)
+{
+	float dt = 1.0f / 60.0f;
+	float vy = 0.0f;
+	for (int32 i = 0; i < moveCount; ++i)
+	{
+		vy -= 10.0f * dt;
+		mover->Move(b2Vec2(speed * dt, vy * dt));
+		if (mover->IsGrounded())
+		{
+			vy = 0.0f;
+		}
+	}
+}
+
+// The mover walks onto a low step and stops at a wall higher than its step height.
+static int TestStepUp()
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+	CreateGround(&world);
+
+	b2CapsuleShape capsule;
+	CreateCapsule(&capsule);
+
+	b2CharacterMoverDef def;
+	def.shape = &capsule;
+	def.position.Set(0.0f, 0.71f);
+	def.stepHeight = 0.3f;
+	b2CharacterMover mover(&world, &def);
+
+	Walk(&mover, 3.0f, 120);
+	CHECK(mover.IsGrounded());
+	CHECK(mover.GetPosition().x > 5.0f);
+	CHECK(b2Abs(mover.GetPosition().y - 0.9f) < 0.02f);
+
+	Walk(&mover, 3.0f, 240);
+	CHECK(mover.IsGrounded());
+	CHECK(mover.GetPosition().x < 12.0f - 0.29f);
+	CHECK(mover.GetPosition().x > 11.5f);
+	CHECK(b2Abs(mover.GetPosition().y - 0.9f) < 0.02f);
+	return 0;
+}
+
+// A slow walk reuses the cached broad-phase query, also while bodies elsewhere move.
+static int TestCacheReuse()
+{
+	int32 queryCounts[2];
+	for (int32 pass = 0; pass < 2; ++pass)
+	{
+		b2World world(b2Vec2(0.0f, -10.0f));
+		CreateGround(&world);
+
+		if (pass == 1)
+		{
+			// Falling boxes far away keep re-inserting their proxies.
+			b2BodyDef bd;
+			bd.type = b2_dynamicBody;
+			b2PolygonShape box;
+			box.SetAsBox(0.25f, 0.25f);
+			for (int32 i = 0; i < 40; ++i)
+			{
+				bd.position.Set(100.0f + float(i), 10.0f + float(i));
+				world.CreateBody(&bd)->CreateFixture(&box, 1.0f);
+			}
+		}
+
+		b2CapsuleShape capsule;
+		CreateCapsule(&capsule);
+
+		b2CharacterMoverDef def;
+		def.shape = &capsule;
+		def.position.Set(-10.0f, 0.71f);
+		b2CharacterMover mover(&world, &def);
+
+		float dt = 1.0f / 60.0f;
+		for (int32 i = 0; i < 240; ++i)
+		{
+			world.Step(dt, 8, 3);
+			mover.Move(b2Vec2(1.0f * dt, -0.1f * dt));
+		}
+
+		CHECK(mover.IsGrounded());
+		queryCounts[pass] = mover.GetQueryCount();
+	}
+
+	// Four meters with a one meter margin needs a handful of queries.
+	CHECK(queryCounts[0] <= 8);
+	CHECK(queryCounts[1] == queryCounts[0]);
+	return 0;
+}
+
+// A body created in the cached region is found by the next move.
+static int TestNearbyChange()
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+	CreateGround(&world);
+
+	b2CapsuleShape capsule;
+	CreateCapsule(&capsule);
+
+	b2CharacterMoverDef def;
+	def.shape = &capsule;
+	def.position.Set(-10.0f, 0.71f);
+	b2CharacterMover mover(&world, &def);
+
+	mover.Move(b2Vec2(0.0f, -0.01f));
+	mover.Move(b2Vec2(0.0f, -0.01f));
+	int32 queryCount = mover.GetQueryCount();
+	CHECK(queryCount == 1);
+
+	// A crate just right of the mover.
+	b2BodyDef bd;
+	bd.position.Set(-9.2f, 0.5f);
+	b2Body* crate = world.CreateBody(&bd);
+	b2PolygonShape box;
+	box.SetAsBox(0.5f, 0.5f);
+	crate->CreateFixture(&box, 0.0f);
+
+	mover.Move(b2Vec2(0.5f, -0.01f));
+	CHECK(mover.GetQueryCount() == queryCount + 1);
+	CHECK(mover.GetPosition().x < -9.7f - 0.29f);
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	B2_NOT_USED(argc);
+	B2_NOT_USED(argv);
+
+	int failures = 0;
+	failures += TestStepUp();
+	failures += TestCacheReuse();
+	failures += TestNearbyChange();
+
+	if (failures > 0)
+	{
+		printf("mover_test: %d failed\n", failures);
+		return 1;
+	}
+
+	printf("mover_test: passed\n");
+	return 0;
+}
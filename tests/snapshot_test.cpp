@@ -0,0 +1,215 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "box2d/box2d.h"
+#include "test_check.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// A stack of boxes on the ground, a motorized revolute joint, a prismatic joint at its
+// limit and a mouse joint, so contacts and every kind of joint state are in play.
+static void CreateScene(b2World* world, b2Body** bodies, int32* bodyCount)
+{
+	*bodyCount = 0;
+
+	b2BodyDef bd;
+	b2Body* ground = world->CreateBody(&bd);
+	bodies[(*bodyCount)++] = ground;
+
+	b2EdgeShape edge;
+	edge.Set(b2Vec2(-40.0f, 0.0f), b2Vec2(40.0f, 0.0f));
+	ground->CreateFixture(&edge, 0.0f);
+
+	b2PolygonShape box;
+	box.SetAsBox(0.5f, 0.5f);
+
+	for (int32 i = 0; i < 5; ++i)
+	{
+		bd.type = b2_dynamicBody;
+		bd.position.Set(0.1f * i, 0.5f + 1.01f * i);
+		b2Body* body = world->CreateBody(&bd);
+		body->CreateFixture(&box, 1.0f);
+		bodies[(*bodyCount)++] = body;
+	}
+
+	bd.position.Set(-5.0f, 3.0f);
+	b2Body* wheel = world->CreateBody(&bd);
+	wheel->CreateFixture(&box, 1.0f);
+	bodies[(*bodyCount)++] = wheel;
+
+	b2RevoluteJointDef rjd;
+	rjd.Initialize(ground, wheel, b2Vec2(-5.0f, 3.0f));
+	rjd.enableMotor = true;
+	rjd.motorSpeed = 2.0f;
+	rjd.maxMotorTorque = 50.0f;
+	world->CreateJoint(&rjd);
+
+	bd.position.Set(5.0f, 4.0f);
+	b2Body* slider = world->CreateBody(&bd);
+	slider->CreateFixture(&box, 1.0f);
+	bodies[(*bodyCount)++] = slider;
+
+	b2PrismaticJointDef pjd;
+	pjd.Initialize(ground, slider, b2Vec2(5.0f, 4.0f), b2Vec2(0.0f, 1.0f));
+	pjd.enableLimit = true;
+	pjd.lowerTranslation = -1.0f;
+	pjd.upperTranslation = 1.0f;
+	world->CreateJoint(&pjd);
+
+	bd.position.Set(10.0f, 2.0f);
+	b2Body* dragged = world->CreateBody(&bd);
+	dragged->CreateFixture(&box, 1.0f);
+	bodies[(*bodyCount)++] = dragged;
+
+	b2MouseJointDef mjd;
+	mjd.bodyA = ground;
+	mjd.bodyB = dragged;
+	mjd.target.Set(12.0f, 5.0f);
+	mjd.maxForce = 1000.0f * dragged->GetMass();
+	world->CreateJoint(&mjd);
+}
+
+static void Simulate(b2World* world, int32 stepCount)
+{
+	for (int32 i = 0; i < stepCount; ++i)
+	{
+		world->Step(1.0f / 60.0f, 8, 3);
+	}
+}
+
+// Restoring a snapshot must reproduce the saved bytes and the simulation that follows.
+static int TestRoundTrip()
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+	b2Body* bodies[16];
+	int32 bodyCount;
+	CreateScene(&world, bodies, &bodyCount);
+
+	Simulate(&world, 30);
+
+	int32 size = world.GetSnapshotSize();
+	CHECK(size > 0);
+
+	char* first = (char*)malloc(size);
+	char* second = (char*)malloc(size);
+	CHECK(world.SaveSnapshot(first, size - 1) == 0);
+	CHECK(world.SaveSnapshot(first, size) == size);
+
+	Simulate(&world, 60);
+
+	b2Transform expected[16];
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		expected[i] = bodies[i]->GetTransform();
+	}
+
+	CHECK(world.RestoreSnapshot(first, size));
+	CHECK(world.GetSnapshotSize() == size);
+	CHECK(world.SaveSnapshot(second, size) == size);
+	CHECK(memcmp(first, second, size) == 0);
+
+	Simulate(&world, 60);
+
+	for (int32 i = 0; i < bodyCount; ++i)
+	{
+		b2Transform xf = bodies[i]->GetTransform();
+		CHECK(xf.p.x == expected[i].p.x && xf.p.y == expected[i].p.y);
+		CHECK(xf.q.s == expected[i].q.s && xf.q.c == expected[i].q.c);
+	}
+
+	free(first);
+	free(second);
+	return 0;
+}
+
+// Saving the same state twice gives the same bytes, padding included.
+static int TestByteIdentical()
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+	b2Body* bodies[16];
+	int32 bodyCount;
+	CreateScene(&world, bodies, &bodyCount);
+
+	Simulate(&world, 45);
+
+	int32 size = world.GetSnapshotSize();
+	char* first = (char*)malloc(size);
+	char* second = (char*)malloc(size);
+
+	// Dirty the destination buffers differently so uninitialized bytes would show up.
+	memset(first, 0xAA, size);
+	memset(second, 0x55, size);
+
+	CHECK(world.SaveSnapshot(first, size) == size);
+	CHECK(world.SaveSnapshot(second, size) == size);
+	CHECK(memcmp(first, second, size) == 0);
+
+	free(first);
+	free(second);
+	return 0;
+}
+
+// A snapshot of a different world structure is rejected without changing the world.
+static int TestMismatch()
+{
+	b2World world(b2Vec2(0.0f, -10.0f));
+	b2Body* bodies[16];
+	int32 bodyCount;
+	CreateScene(&world, bodies, &bodyCount);
+	Simulate(&world, 10);
+
+	int32 size = world.GetSnapshotSize();
+	char* data = (char*)malloc(size);
+	CHECK(world.SaveSnapshot(data, size) == size);
+
+	b2BodyDef bd;
+	bd.type = b2_dynamicBody;
+	world.CreateBody(&bd);
+
+	b2Vec2 position = bodies[1]->GetPosition();
+	CHECK(world.RestoreSnapshot(data, size) == false);
+	CHECK(bodies[1]->GetPosition().x == position.x && bodies[1]->GetPosition().y == position.y);
+
+	free(data);
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	B2_NOT_USED(argc);
+	B2_NOT_USED(argv);
+
+	int failures = 0;
+	failures += TestRoundTrip();
+	failures += TestByteIdentical();
+	failures += TestMismatch();
+
+	if (failures > 0)
+	{
+		printf("snapshot_test: %d failed\n", failures);
+		return 1;
+	}
+
+	printf("snapshot_test: passed\n");
+	return 0;
+}
@@ -0,0 +1,199 @@
+// MIT License
+
+// Copyright (c) 2019 Erin Catto
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "box2d/box2d.h"
+#include "test_check.h"
+
+const int32 k_fallingCount = 6;
+const int32 k_sleepingCount = 4;
+
+// Boxes that fall onto the ground and boxes that start asleep in the air.
+static void CreateScene(b2World* world)
+{
+	b2BodyDef bd;
+	b2Body* ground = world->CreateBody(&bd);
+
+	b2EdgeShape edge;
+	edge.Set(b2Vec2(-40.0f, 0.0f), b2Vec2(40.0f, 0.0f));
+	ground->CreateFixture(&edge, 0.0f);
+
+	b2PolygonShape box;
+	box.SetAsBox(0.5f, 0.5f);
+
+	bd.type = b2_dynamicBody;
+	for (int32 i = 0; i < k_fallingCount; ++i)
+	{
+		bd.position.Set(-10.0f + 2.0f * i, 1.0f + 0.5f * i);
+		bd.angle = 0.3f * i;
+		world->CreateBody(&bd)->CreateFixture(&box, 1.0f);
+	}
+
+	bd.awake = false;
+	bd.angle = 0.0f;
+	for (int32 i = 0; i < k_sleepingCount; ++i)
+	{
+		bd.position.Set(20.0f + 2.0f * i, 10.0f);
+		world->CreateBody(&bd)->CreateFixture(&box, 1.0f);
+	}
+}
+
+// The mirror matches the source within half the quantization step.
+static int CheckMirror(const b2World* source, const b2World* mirror, const b2StateDeltaPrecision& precision)
+{
+	// Room for float rounding of the dequantized values.
+	const float slop = 1.0e-4f;
+
+	const b2Body* a = source->GetBodyList();
+	const b2Body* b = mirror->GetBodyList();
+	for (; a && b; a = a->GetNext(), b = b->GetNext())
+	{
+		b2Vec2 dp = a->GetPosition() - b->GetPosition();
+		CHECK(b2Abs(dp.x) <= 0.5f * precision.position + slop);
+		CHECK(b2Abs(dp.y) <= 0.5f * precision.position + slop);
+		CHECK(b2Abs(a->GetAngle() - b->GetAngle()) <= 0.5f * precision.angle + slop);
+
+		b2Vec2 dv = a->GetLinearVelocity() - b->GetLinearVelocity();
+		CHECK(b2Abs(dv.x) <= 0.5f * precision.linearVelocity + slop);
+		CHECK(b2Abs(dv.y) <= 0.5f * precision.linearVelocity + slop);
+		CHECK(b2Abs(a->GetAngularVelocity() - b->GetAngularVelocity()) <= 0.5f * precision.angularVelocity + slop);
+
+		CHECK(a->IsAwake() == b->IsAwake());
+	}
+
+	CHECK(a == nullptr && b == nullptr);
+	return 0;
+}
+
+// A mirror world follows the source through a full frame and a series of delta frames.
+static int TestMirror()
+{
+	b2World source(b2Vec2(0.0f, -10.0f));
+	b2World mirror(b2Vec2(0.0f, -10.0f));
+	CreateScene(&source);
+	CreateScene(&mirror);
+
+	b2StateDeltaEncoder encoder;
+	b2StateDeltaDecoder decoder;
+	const b2StateDeltaPrecision& precision = encoder.GetPrecision();
+
+	uint8 buffer[1024];
+
+	// The first frame holds every body.
+	int32 size = encoder.Encode(&source, buffer, sizeof(buffer));
+	CHECK(size > 0);
+	CHECK(encoder.GetChangedCount() == source.GetBodyCount());
+	CHECK(decoder.Decode(&mirror, buffer, size));
+	CHECK(CheckMirror(&source, &mirror, precision) == 0);
+
+	for (int32 i = 0; i < 300; ++i)
+	{
+		source.Step(1.0f / 60.0f, 8, 3);
+
+		size = encoder.Encode(&source, buffer, sizeof(buffer));
+		CHECK(size > 0);
+		CHECK(decoder.Decode(&mirror, buffer, size));
+		CHECK(decoder.GetSequence() == encoder.GetSequence());
+		CHECK(CheckMirror(&source, &mirror, precision) == 0);
+
+		// The ground and the sleeping boxes are skipped.
+		CHECK(encoder.GetChangedCount() <= k_fallingCount);
+		if (i == 0)
+		{
+			CHECK(encoder.GetChangedCount() == k_fallingCount);
+		}
+	}
+
+	// Once everything sleeps a frame is only the header.
+	for (const b2Body* b = source.GetBodyList(); b; b = b->GetNext())
+	{
+		CHECK(b->IsAwake() == false);
+	}
+
+	source.Step(1.0f / 60.0f, 8, 3);
+	size = encoder.Encode(&source, buffer, sizeof(buffer));
+	CHECK(encoder.GetChangedCount() == 0);
+	CHECK(size <= 6);
+	CHECK(decoder.Decode(&mirror, buffer, size));
+	return 0;
+}
+
+// Frames out of sequence are rejected and a full frame recovers.
+static int TestSequence()
+{
+	b2World source(b2Vec2(0.0f, -10.0f));
+	b2World mirror(b2Vec2(0.0f, -10.0f));
+	CreateScene(&source);
+	CreateScene(&mirror);
+
+	b2StateDeltaEncoder encoder;
+	b2StateDeltaDecoder decoder;
+	uint8 buffer[1024];
+
+	// A delta frame needs a baseline.
+	encoder.Encode(&source, buffer, sizeof(buffer));
+	source.Step(1.0f / 60.0f, 8, 3);
+	int32 size = encoder.Encode(&source, buffer, sizeof(buffer));
+	CHECK(size > 0);
+	CHECK(decoder.Decode(&mirror, buffer, size) == false);
+
+	// A lost frame is detected.
+	encoder.Reset();
+	size = encoder.Encode(&source, buffer, sizeof(buffer));
+	CHECK(decoder.Decode(&mirror, buffer, size));
+	source.Step(1.0f / 60.0f, 8, 3);
+	encoder.Encode(&source, buffer, sizeof(buffer));
+	source.Step(1.0f / 60.0f, 8, 3);
+	size = encoder.Encode(&source, buffer, sizeof(buffer));
+	CHECK(decoder.Decode(&mirror, buffer, size) == false);
+
+	encoder.Reset();
+	size = encoder.Encode(&source, buffer, sizeof(buffer));
+	CHECK(decoder.Decode(&mirror, buffer, size));
+	CHECK(CheckMirror(&source, &mirror, encoder.GetPrecision()) == 0);
+
+	// A buffer that is too small leaves the baseline alone.
+	source.Step(1.0f / 60.0f, 8, 3);
+	CHECK(encoder.Encode(&source, buffer, 4) == 0);
+	size = encoder.Encode(&source, buffer, sizeof(buffer));
+	CHECK(decoder.Decode(&mirror, buffer, size));
+	CHECK(CheckMirror(&source, &mirror, encoder.GetPrecision()) == 0);
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	B2_NOT_USED(argc);
+	B2_NOT_USED(argv);
+
+	int failures = 0;
+	failures += TestMirror();
+	failures += TestSequence();
+
+	if (failures > 0)
+	{
+		printf("state_delta_test: %d failed\n", failures);
+		return 1;
+	}
+
+	printf("state_delta_test: passed\n");
+	return 0;
+}